@@ -222,17 +222,18 @@ static int capture(std::string output_dir, uint8_t deviceId = K4A_DEVICE_DEFAULT
     // downscaled calibration. This example's goal is to show how to configure the calibration and use the
     // transformation API as it is when the user does not need a point cloud from high resolution transformed depth
     // image. The downscaling method here is naively to average binning 2x2 pixels, user should choose their own
-    // appropriate downscale method on the color image, this example is only demonstrating the idea. However, no matter
-    // what scale you choose to downscale the color image, please keep the aspect ratio unchanged (to ensure the
-    // distortion parameters from original calibration can still be used for the downscaled image).
+    // appropriate downscale method on the color image, this example is only demonstrating the idea. The transformation
+    // created from the scaled calibration renders the depth image directly at the downscaled color resolution.
     k4a_calibration_t calibration_color_downscaled;
-    memcpy(&calibration_color_downscaled, &calibration, sizeof(k4a_calibration_t));
-    calibration_color_downscaled.color_camera_calibration.resolution_width /= 2;
-    calibration_color_downscaled.color_camera_calibration.resolution_height /= 2;
-    calibration_color_downscaled.color_camera_calibration.intrinsics.parameters.param.cx /= 2;
-    calibration_color_downscaled.color_camera_calibration.intrinsics.parameters.param.cy /= 2;
-    calibration_color_downscaled.color_camera_calibration.intrinsics.parameters.param.fx /= 2;
-    calibration_color_downscaled.color_camera_calibration.intrinsics.parameters.param.fy /= 2;
+    if (K4A_RESULT_SUCCEEDED !=
+        k4a_calibration_scale_color_camera(&calibration,
+                                           calibration.color_camera_calibration.resolution_width / 2,
+                                           calibration.color_camera_calibration.resolution_height / 2,
+                                           &calibration_color_downscaled))
+    {
+        printf("Failed to scale color camera calibration\n");
+        goto Exit;
+    }
     transformation_color_downscaled = k4a_transformation_create(&calibration_color_downscaled);
     color_image_downscaled = downscale_image_2x2_binning(color_image);
     if (color_image_downscaled == 0)
@@ -304,6 +304,38 @@ K4A_EXPORT k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handl
                                                        k4a_imu_sample_t *imu_sample,
                                                        int32_t timeout_in_ms);
 
+/** Gets the latency histograms, queue depths and drop counts of the capture pipeline.
+ *
+ * \param device_handle
+ * Handle obtained by k4a_device_open().
+ *
+ * \param stats
+ * Location to write the pipeline statistics.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p stats was written. ::K4A_RESULT_FAILED if \p device_handle or \p stats is invalid.
+ *
+ * \relates k4a_device_t
+ *
+ * \remarks
+ * The statistics are always collected and cost a few atomic increments per capture, so this function may be polled
+ * from any thread while the device is streaming, e.g. to detect a pipeline that is falling behind. Counters and
+ * histograms accumulate from k4a_device_open() and are not reset when the cameras or IMU are stopped.
+ *
+ * \remarks
+ * The values are read without stopping the pipeline, so a histogram may not yet include a sample that is already
+ * reflected in a queue depth.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_device_get_pipeline_stats(k4a_device_t device_handle, k4a_pipeline_stats_t *stats);
+
 /** Create an empty capture object.
  *
  * \param capture_handle
@@ -1986,6 +2018,50 @@ K4A_EXPORT k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibrati
                                                              k4a_float2_t *target_point2d,
                                                              int *valid);
 
+/** Scale the color camera of a calibration to a different image size.
+ *
+ * \param calibration
+ * Camera calibration data.
+ *
+ * \param color_width_pixels
+ * Width of the scaled color camera image in pixels.
+ *
+ * \param color_height_pixels
+ * Height of the scaled color camera image in pixels.
+ *
+ * \param scaled_calibration
+ * Location to write the calibration with the scaled color camera. It may point to \p calibration.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p scaled_calibration was successfully written. ::K4A_RESULT_FAILED if \p calibration does
+ * not contain a color camera or the size is not valid.
+ *
+ * \remarks
+ * The scaled color camera covers the same field of view as the color camera in \p calibration, with a resolution of
+ * \p color_width_pixels x \p color_height_pixels. Only the focal length and principal point are changed, so the size
+ * can be any fraction such as 1/2 or 1/4 of the original, and the aspect ratio does not need to be kept.
+ *
+ * \remarks
+ * A transformation created from \p scaled_calibration with k4a_transformation_create() renders directly into the
+ * scaled color geometry. k4a_transformation_depth_image_to_color_camera() then writes an image of the scaled size, and
+ * k4a_transformation_color_image_to_depth_camera() expects a color image of the scaled size. This avoids rendering a
+ * full resolution image only to downscale it afterwards.
+ *
+ * \relates k4a_calibration_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_calibration_scale_color_camera(const k4a_calibration_t *calibration,
+                                                           const int color_width_pixels,
+                                                           const int color_height_pixels,
+                                                           k4a_calibration_t *scaled_calibration);
+
 /** Get handle to transformation handle.
  *
  * \param calibration
@@ -2002,6 +2078,10 @@ K4A_EXPORT k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibrati
  * \remarks
  * The transformation handle must be destroyed with k4a_transformation_destroy() when it is no longer to be used.
  *
+ * \remarks
+ * Depth and color images are transformed on the GPU when the depth engine provides a transform engine, and on the CPU
+ * otherwise.
+ *
  * \relates k4a_calibration_t
  *
  * \xmlonly
@@ -2267,6 +2347,246 @@ K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_point_cloud(k4a_transf
                                                                       const k4a_calibration_type_t camera,
                                                                       k4a_image_t xyz_image);
 
+/** Creates a map to undistort the images of a camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param camera
+ * The camera whose images will be undistorted, either ::K4A_CALIBRATION_TYPE_DEPTH or ::K4A_CALIBRATION_TYPE_COLOR.
+ *
+ * \param pinhole_type
+ * The pinhole model of the undistorted image.
+ *
+ * \param undistortion_map_handle
+ * Pointer to a location to store the handle.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the map was created, ::K4A_RESULT_FAILED if the camera is not available in the calibration
+ * used to create the \p transformation_handle or an argument is invalid.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \remarks
+ * Creating the map evaluates the lens model once for every pixel, which is the expensive part of undistorting an
+ * image. Create the map once and reuse it with k4a_transformation_remap() for every image of the camera.
+ *
+ * \remarks
+ * The intrinsics of the undistorted image can be read with k4a_undistortion_map_get_camera_calibration().
+ *
+ * \remarks
+ * The map must be destroyed with k4a_undistortion_map_destroy(). It does not depend on the \p transformation_handle
+ * and may outlive it.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_create_undistortion_map(k4a_transformation_t transformation_handle,
+                                                                   const k4a_calibration_type_t camera,
+                                                                   const k4a_transformation_pinhole_type_t pinhole_type,
+                                                                   k4a_undistortion_map_t *undistortion_map_handle);
+
+/** Gets the calibration of the undistorted image produced by an undistortion map.
+ *
+ * \param undistortion_map_handle
+ * Handle obtained by k4a_transformation_create_undistortion_map().
+ *
+ * \param pinhole_camera_calibration
+ * Location to write the calibration.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED on success.
+ *
+ * \relates k4a_undistortion_map_t
+ *
+ * \remarks
+ * The calibration has the extrinsics and resolution of the source camera and a distortion free lens model, with the
+ * focal length and principal point selected by the ::k4a_transformation_pinhole_type_t of the map.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t
+k4a_undistortion_map_get_camera_calibration(k4a_undistortion_map_t undistortion_map_handle,
+                                            k4a_calibration_camera_t *pinhole_camera_calibration);
+
+/** Undistorts an image using a pre-computed undistortion map.
+ *
+ * \param undistortion_map_handle
+ * Handle obtained by k4a_transformation_create_undistortion_map().
+ *
+ * \param source_image
+ * Image of the camera the map was created for. Supported formats are ::K4A_IMAGE_FORMAT_COLOR_BGRA32,
+ * ::K4A_IMAGE_FORMAT_DEPTH16, ::K4A_IMAGE_FORMAT_IR16, ::K4A_IMAGE_FORMAT_CUSTOM16 and ::K4A_IMAGE_FORMAT_CUSTOM8.
+ *
+ * \param undistorted_image
+ * Output image, with the same format and resolution as \p source_image.
+ *
+ * \param interpolation_type
+ * Use ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST for depth to avoid creating depth values that don't exist in the
+ * scene, and ::K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR for color and IR images.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p undistorted_image was written, ::K4A_RESULT_FAILED if the image format or size does not
+ * match the map.
+ *
+ * \relates k4a_undistortion_map_t
+ *
+ * \remarks
+ * Pixels of \p undistorted_image without a valid source pixel are set to 0.
+ *
+ * \remarks
+ * Linear interpolation of a ::K4A_IMAGE_FORMAT_DEPTH16 image does not blend invalid depth or depth across
+ * discontinuities, those pixels are set to 0 instead.
+ *
+ * \remarks
+ * Large images are split into bands of rows that are remapped on worker threads owned by the map, which are started
+ * when the map is created and stopped by k4a_undistortion_map_destroy(). Different images may be remapped with the same
+ * map concurrently; while the workers are busy with one image, other images are remapped on their calling thread.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_remap(k4a_undistortion_map_t undistortion_map_handle,
+                                                 const k4a_image_t source_image,
+                                                 k4a_image_t undistorted_image,
+                                                 const k4a_transformation_interpolation_type_t interpolation_type);
+
+/** Transforms a depth image directly into the undistorted geometry of the color camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param undistortion_map_handle
+ * Undistortion map of the color camera, created from \p transformation_handle with
+ * k4a_transformation_create_undistortion_map().
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param transformed_depth_image
+ * Handle to output transformed depth image.
+ *
+ * \remarks
+ * This produces the same image as k4a_transformation_depth_image_to_color_camera() followed by undistorting the result,
+ * but in a single pass: the depth image is rasterized with the pinhole model of \p undistortion_map_handle, which is
+ * returned by k4a_undistortion_map_get_camera_calibration(). Each pixel matches the corresponding pixel of the color
+ * image undistorted by k4a_transformation_remap() with the same map.
+ *
+ * \remarks
+ * \p depth_image and \p transformed_depth_image must be of format ::K4A_IMAGE_FORMAT_DEPTH16.
+ * \p transformed_depth_image must have the width and height of the color camera.
+ *
+ * \remarks
+ * The transformation always runs on the CPU, even if GPU acceleration is used for the other transformation functions.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image was successfully written and ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t
+k4a_transformation_depth_image_to_undistorted_color_camera(k4a_transformation_t transformation_handle,
+                                                           k4a_undistortion_map_t undistortion_map_handle,
+                                                           const k4a_image_t depth_image,
+                                                           k4a_image_t transformed_depth_image);
+
+/** Transforms a depth image and a custom image directly into the undistorted geometry of the color camera.
+ *
+ * \param transformation_handle
+ * Transformation handle.
+ *
+ * \param undistortion_map_handle
+ * Undistortion map of the color camera, created from \p transformation_handle with
+ * k4a_transformation_create_undistortion_map().
+ *
+ * \param depth_image
+ * Handle to input depth image.
+ *
+ * \param custom_image
+ * Handle to input custom image.
+ *
+ * \param transformed_depth_image
+ * Handle to output transformed depth image.
+ *
+ * \param transformed_custom_image
+ * Handle to output transformed custom image.
+ *
+ * \param interpolation_type
+ * Parameter that controls how pixels in \p custom_image should be interpolated when transformed to color camera space.
+ *
+ * \param invalid_custom_value
+ * Defines the custom image pixel value that should be written to \p transformed_custom_image in case the corresponding
+ * depth pixel can not be transformed into the color camera space.
+ *
+ * \remarks
+ * The image requirements are the same as for k4a_transformation_depth_image_to_color_camera_custom(), and the output
+ * geometry is the same as for k4a_transformation_depth_image_to_undistorted_color_camera().
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if \p transformed_depth_image and \p transformed_custom_image were successfully written and
+ * ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_transformation_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT k4a_result_t k4a_transformation_depth_image_to_undistorted_color_camera_custom(
+    k4a_transformation_t transformation_handle,
+    k4a_undistortion_map_t undistortion_map_handle,
+    const k4a_image_t depth_image,
+    const k4a_image_t custom_image,
+    k4a_image_t transformed_depth_image,
+    k4a_image_t transformed_custom_image,
+    k4a_transformation_interpolation_type_t interpolation_type,
+    uint32_t invalid_custom_value);
+
+/** Destroys an undistortion map.
+ *
+ * \param undistortion_map_handle
+ * Handle obtained by k4a_transformation_create_undistortion_map().
+ *
+ * \relates k4a_undistortion_map_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4a.h (include k4a/k4a.h)</requirement>
+ *   <requirement name="Library">k4a.lib</requirement>
+ *   <requirement name="DLL">k4a.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_EXPORT void k4a_undistortion_map_destroy(k4a_undistortion_map_t undistortion_map_handle);
+
 /**
  * @}
  */
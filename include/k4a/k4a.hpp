@@ -759,6 +759,23 @@ struct calibration : public k4a_calibration_t
         return static_cast<bool>(valid);
     }
 
+    /** Get a copy of this calibration with the color camera scaled to color_width_pixels x color_height_pixels.
+     * Throws error on failure.
+     *
+     * \sa k4a_calibration_scale_color_camera
+     */
+    calibration scale_color_camera(int color_width_pixels, int color_height_pixels) const
+    {
+        calibration calib;
+        k4a_result_t result = k4a_calibration_scale_color_camera(this, color_width_pixels, color_height_pixels, &calib);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to scale the color camera calibration!");
+        }
+        return calib;
+    }
+
     /** Get the camera calibration for a device from a raw calibration blob.
      * Throws error on failure.
      *
@@ -1224,6 +1241,23 @@ public:
         return get_imu_sample(imu_sample, std::chrono::milliseconds(K4A_WAIT_INFINITE));
     }
 
+    /** Get the latency histograms, queue depths and drop counts of the capture pipeline
+     * Throws error on failure.
+     *
+     * \sa k4a_device_get_pipeline_stats
+     */
+    k4a_pipeline_stats_t get_pipeline_stats() const
+    {
+        k4a_pipeline_stats_t stats;
+        k4a_result_t result = k4a_device_get_pipeline_stats(m_handle, &stats);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read pipeline statistics!");
+        }
+        return stats;
+    }
+
     /** Starts the K4A device's cameras
      * Throws error on failure.
      *
@@ -194,6 +194,28 @@ K4A_DECLARE_HANDLE(k4a_image_t);
  */
 K4A_DECLARE_HANDLE(k4a_transformation_t);
 
+/** \class k4a_undistortion_map_t k4a.h <k4a/k4a.h>
+ * Handle to a pre-computed map used to undistort the images of one camera.
+ *
+ * \remarks
+ * Handles are created with k4a_transformation_create_undistortion_map() and closed with
+ * k4a_undistortion_map_destroy().
+ *
+ * \remarks
+ * The map stores the source pixel and interpolation weights of every pixel of the undistorted image, so that
+ * k4a_transformation_remap() does not need to evaluate the lens model for each image.
+ *
+ * \remarks
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_undistortion_map_t);
+
 /**
  *
  * @}
@@ -462,6 +484,26 @@ typedef enum
     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,      /**< Linear interpolation */
 } k4a_transformation_interpolation_type_t;
 
+/** Pinhole camera model of an undistorted image.
+ *
+ * \remarks
+ * Used with k4a_transformation_create_undistortion_map() to select the intrinsics of the undistorted image. In both
+ * cases the undistorted image has the same resolution as the source camera.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION = 0, /**< Keep the focal length and principal point of the camera
+                                                        calibration, some of the field of view may be cropped */
+    K4A_TRANSFORMATION_PINHOLE_TYPE_FULL_FOV,        /**< Scale the focal length so the whole valid field of view of
+                                                        the camera fits in the image */
+} k4a_transformation_pinhole_type_t;
+
 /** Color and depth sensor frame rate.
  *
  * \remarks
@@ -786,6 +828,12 @@ typedef enum
  *    't'  - log all messages of level 'trace' or higher criticality
  *    DEFAULT - log all message of level 'error' or higher criticality
  *
+ * K4A_LOG_ASYNC =
+ *    0    - deliver messages on the thread that logged them
+ *    all else  - format messages into a bounded queue and deliver them to the file, stdout and the registered
+ *                callback from a background thread. Messages logged while the queue is full are dropped and counted.
+ *    DEFAULT - deliver messages on the thread that logged them
+ *
  * See remarks section of \p k4a_set_debug_message_handler
  *
  * @{
@@ -1205,6 +1253,145 @@ typedef struct _k4a_imu_sample_t
     uint64_t gyro_timestamp_usec; /**< Timestamp of the gyroscope in microseconds */
 } k4a_imu_sample_t;
 
+/** Number of buckets in a \ref k4a_latency_histogram_t.
+ *
+ * \remarks
+ * Buckets 0 to 7 count latencies of exactly 0 to 7 microseconds. Every following power of two range is split into 8
+ * buckets of equal width, so each bucket is within 12.5% of the latencies it counts. The last bucket also counts all
+ * latencies beyond its range. Use \ref K4A_LATENCY_HISTOGRAM_BUCKET_LOWER_USEC to get the range of a bucket.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_LATENCY_HISTOGRAM_BUCKET_COUNT (200)
+
+/** Smallest latency in microseconds counted by bucket \p _bucket_ of a \ref k4a_latency_histogram_t.
+ *
+ * \remarks
+ * Bucket \p _bucket_ counts the latencies from K4A_LATENCY_HISTOGRAM_BUCKET_LOWER_USEC(_bucket_) up to, but not
+ * including, K4A_LATENCY_HISTOGRAM_BUCKET_LOWER_USEC(_bucket_ + 1).
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+#define K4A_LATENCY_HISTOGRAM_BUCKET_LOWER_USEC(_bucket_)                                                              \
+    ((_bucket_) < 8 ? (uint64_t)(_bucket_) : (uint64_t)(8 + ((_bucket_)-8) % 8) << (((_bucket_)-8) / 8))
+
+/** Latency histogram of one stage of the capture pipeline.
+ *
+ * \remarks
+ * Histograms count every sample since the device was opened. Subtract the buckets of two reads to get the histogram of
+ * the interval between them. Percentiles and the maximum are reported as the upper bound of the bucket they fall in.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_latency_histogram_t
+{
+    uint64_t count;     /**< Number of samples counted by the buckets. */
+    uint64_t p50_usec;  /**< Median latency in microseconds. */
+    uint64_t p90_usec;  /**< 90th percentile latency in microseconds. */
+    uint64_t p99_usec;  /**< 99th percentile latency in microseconds. */
+    uint64_t p999_usec; /**< 99.9th percentile latency in microseconds. */
+    uint64_t max_usec;  /**< Largest latency in microseconds. */
+
+    /** Sample count of each bucket, see \ref K4A_LATENCY_HISTOGRAM_BUCKET_COUNT for the bucket layout. */
+    uint32_t buckets[K4A_LATENCY_HISTOGRAM_BUCKET_COUNT];
+} k4a_latency_histogram_t;
+
+/** State of one of the queues of the capture pipeline.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_queue_stats_t
+{
+    uint32_t depth;         /**< Number of entries currently in the queue. */
+    uint32_t capacity;      /**< Maximum number of entries the queue holds before dropping the oldest. */
+    uint64_t dropped_count; /**< Number of entries dropped because the queue was full, since the device was opened. */
+} k4a_queue_stats_t;
+
+/** Outstanding buffers of the SDK allocator.
+ *
+ * \remarks
+ * The allocator is shared by all devices, so these are the counts of the whole process.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_allocator_stats_t
+{
+    uint32_t user;      /**< Buffers of images created by the user. */
+    uint32_t color;     /**< Buffers of color images. */
+    uint32_t depth;     /**< Buffers of depth and IR images written by the depth engine. */
+    uint32_t imu;       /**< Buffers of IMU samples. */
+    uint32_t usb_depth; /**< USB transfer buffers of the depth sensor. */
+    uint32_t usb_imu;   /**< USB transfer buffers of the IMU. */
+} k4a_allocator_stats_t;
+
+/** Statistics of the capture pipeline of a device.
+ *
+ * \remarks
+ * Depth captures flow from the USB transfer completion through the depth engine queue (dewrapper), the depth engine
+ * and the depth/color synchronization (capturesync) into the capture queue, from which k4a_device_get_capture() pops
+ * them. Color captures enter the pipeline at capturesync.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">k4atypes.h (include k4a/k4a.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_pipeline_stats_t
+{
+    /** Time from the USB transfer completion of a raw depth frame until the depth engine thread dequeues it. */
+    k4a_latency_histogram_t usb_to_depth_engine;
+
+    /** Time the depth engine takes to process a raw depth frame. */
+    k4a_latency_histogram_t depth_engine;
+
+    /** Time a depth or color capture spends in capturesync waiting for its match before being queued for the user. */
+    k4a_latency_histogram_t capturesync;
+
+    /** Time a capture waits in the capture queue until it is popped by k4a_device_get_capture(). */
+    k4a_latency_histogram_t capture_pop;
+
+    /** Time from the earliest system timestamp of the images in a capture until it is popped by
+     * k4a_device_get_capture(). */
+    k4a_latency_histogram_t capture_end_to_end;
+
+    /** Time an IMU sample waits in the IMU queue until it is popped by k4a_device_get_imu_sample(). */
+    k4a_latency_histogram_t imu_pop;
+
+    k4a_queue_stats_t depth_engine_queue;      /**< Raw depth frames waiting for the depth engine. */
+    k4a_queue_stats_t capturesync_depth_queue; /**< Depth captures waiting in capturesync for their color match. */
+    k4a_queue_stats_t capturesync_color_queue; /**< Color captures waiting in capturesync for their depth match. */
+    k4a_queue_stats_t capture_queue;           /**< Captures waiting for k4a_device_get_capture(). */
+    k4a_queue_stats_t imu_queue;               /**< IMU samples waiting for k4a_device_get_imu_sample(). */
+
+    uint64_t depth_engine_dropped_count; /**< Raw depth frames the depth engine failed to process or dropped. */
+    uint64_t capturesync_dropped_count;  /**< Captures capturesync discarded, e.g. without a match while
+                                              k4a_device_configuration_t::synchronized_images_only is set. */
+    uint64_t imu_dropped_count;          /**< IMU samples dropped while waiting for the timestamp reset at start. */
+
+    k4a_allocator_stats_t allocator; /**< Outstanding buffers of the SDK allocator. */
+} k4a_pipeline_stats_t;
+
 /**
  *
  * @}
@@ -111,6 +111,13 @@ void allocator_free(void *buffer);
  */
 long allocator_test_for_leaks(void);
 
+/** Reads the number of outstanding allocations of each allocation source
+ *
+ * \remarks
+ * The counts are shared by all sessions in the process, see allocator_initialize().
+ */
+void allocator_get_stats(k4a_allocator_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
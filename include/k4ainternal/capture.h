@@ -56,6 +56,11 @@ void capture_set_ir_image(k4a_capture_t capture_handle, k4a_image_t image_handle
 void capture_set_temperature_c(k4a_capture_t capture_handle, float temperature_c);
 float capture_get_temperature_c(k4a_capture_t capture_handle);
 
+/** Time the capture arrived at capturesync, from latency_histogram_get_time_nsec(). Used to measure how long captures
+ * wait for their match before being queued for the user. */
+void capture_set_arrival_time_nsec(k4a_capture_t capture_handle, uint64_t time_nsec);
+uint64_t capture_get_arrival_time_nsec(k4a_capture_t capture_handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -108,6 +108,17 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
                              k4a_capture_t capture_raw,
                              bool color_capture);
 
+/** Reads the statistics of the synchronization stage of the capture pipeline
+ *
+ * \param capturesync_handle
+ * The capturesync handle from capturesync_create()
+ *
+ * \param stats
+ * The pipeline statistics to fill in; only the capturesync and capture queue latencies, queues and dropped count are
+ * written.
+ */
+void capturesync_get_stats(capturesync_t capturesync_handle, k4a_pipeline_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
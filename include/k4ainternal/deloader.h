@@ -61,6 +61,9 @@ size_t deloader_transform_engine_get_output_frame_size(k4a_transform_engine_cont
 
 void deloader_transform_engine_destroy(k4a_transform_engine_context_t **context);
 
+// Returns false if the depth engine plugin was loaded and does not export the transform engine functions
+bool deloader_has_transform_engine(void);
+
 #ifdef __cplusplus
 }
 #endif
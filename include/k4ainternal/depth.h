@@ -143,6 +143,16 @@ k4a_result_t depth_start(depth_t depth_handle, const k4a_device_configuration_t
  */
 void depth_stop(depth_t depth_handle);
 
+/** Reads the statistics of the depth engine stage of the capture pipeline
+ *
+ * \param depth_handle [IN]
+ * The depth device handle.
+ *
+ * \param stats [OUT]
+ * The pipeline statistics to fill in; only the depth engine latencies, queue and dropped count are written.
+ */
+void depth_get_stats(depth_t depth_handle, k4a_pipeline_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
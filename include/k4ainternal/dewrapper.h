@@ -56,6 +56,9 @@ k4a_result_t dewrapper_start(dewrapper_t dewrapper_handle,
 void dewrapper_stop(dewrapper_t dewrapper_handle);
 void dewrapper_post_capture(k4a_result_t cb_result, k4a_capture_t capture_raw, void *context);
 
+/** Fills the depth engine fields of \p stats; the depth engine queue and latencies, and the dropped frame count */
+void dewrapper_get_stats(dewrapper_t dewrapper_handle, k4a_pipeline_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -83,6 +83,16 @@ k4a_result_t imu_start(imu_t imu_handle, tickcounter_ms_t color_camera_start_tic
  */
 void imu_stop(imu_t imu_handle);
 
+/** Reads the statistics of the IMU stage of the capture pipeline
+ *
+ * \param imu_handle [IN]
+ * The IMU device handle.
+ *
+ * \param stats [OUT]
+ * The pipeline statistics to fill in; only the IMU queue, its latency and the dropped sample count are written.
+ */
+void imu_get_stats(imu_t imu_handle, k4a_pipeline_stats_t *stats);
+
 /** Get the gyro extrinsic calibration data
  *
  * \param imu_handle [IN]
@@ -473,7 +473,9 @@ typedef void(__stdcall *k4a_te_destroy_fn_t)(k4a_transform_engine_context_t **co
  * \remarks
  * The Azure Kinect SDK will call k4a_register_plugin, and pass in a pointer to a \ref
  * k4a_plugin_t. The plugin must properly fill out all fields of the plugin for
- * the Azure Kinect SDK to accept the plugin.
+ * the Azure Kinect SDK to accept the plugin. The transform engine functions may
+ * all be left NULL by a plugin without a transform engine, transformations are
+ * then done on the CPU.
  *
  * \xmlonly
  * <requirements>
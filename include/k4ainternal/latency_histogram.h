@@ -0,0 +1,53 @@
+/** \file latency_histogram.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ *
+ * Lock free latency histograms backing k4a_device_get_pipeline_stats()
+ */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Latency histogram with the bucket layout of k4a_latency_histogram_t.
+ *
+ * Buckets are incremented atomically, so any number of threads may record into a histogram while another reads it.
+ * Zero initialize the structure before use.
+ */
+typedef struct _latency_histogram_t
+{
+    volatile long buckets[K4A_LATENCY_HISTOGRAM_BUCKET_COUNT];
+} latency_histogram_t;
+
+/** Reads the monotonic clock used for image system timestamps, see image_apply_system_timestamp()
+ *
+ * \returns the current time in nanoseconds, or 0 if the clock could not be read.
+ */
+uint64_t latency_histogram_get_time_nsec(void);
+
+/** Returns the bucket that counts a latency of \p latency_usec */
+uint32_t latency_histogram_get_bucket(uint64_t latency_usec);
+
+/** Counts a latency of \p latency_usec microseconds in \p histogram */
+void latency_histogram_record_usec(latency_histogram_t *histogram, uint64_t latency_usec);
+
+/** Counts the time elapsed since \p start_nsec, a value of latency_histogram_get_time_nsec()
+ *
+ * Samples with a start time of 0 or a start time in the future are ignored.
+ */
+void latency_histogram_record_since(latency_histogram_t *histogram, uint64_t start_nsec);
+
+/** Copies the buckets of \p histogram into \p result and calculates its count, percentiles and maximum */
+void latency_histogram_get(const latency_histogram_t *histogram, k4a_latency_histogram_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LATENCY_HISTOGRAM_H */
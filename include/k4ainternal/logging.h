@@ -59,6 +59,14 @@ k4a_result_t logger_register_message_callback(k4a_logging_message_cb_t *message_
 
 void logger_log(k4a_log_level_t level, const char *file, const int line, const char *format, ...);
 
+/** Waits until messages logged before this call have been delivered
+ *
+ * \remarks
+ * Messages are only delivered later than logger_log() returns when K4A_LOG_ASYNC is enabled, otherwise this returns
+ * immediately.
+ */
+void logger_flush(void);
+
 FORCEINLINE k4a_result_t
 TraceError(k4a_result_t result, const char *szCall, const char *szFile, int line, const char *szFunction)
 {
@@ -9,10 +9,17 @@
 
 #include <k4arecord/types.h>
 #include <k4ainternal/handle.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <list>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #if defined(__clang__)
 
@@ -86,6 +93,12 @@ constexpr uint64_t operator"" _s(unsigned long long x)
 #define CLUSTER_WRITE_QUEUE_WARNING_NS CLUSTER_WRITE_DELAY_NS + 2_s
 #endif
 
+#ifndef RECORD_WRITE_BUFFER_SIZE
+// Write buffer used while recording, so the many small EBML element writes in a cluster, and consecutive clusters, are
+// coalesced into large sequential disk writes.
+#define RECORD_WRITE_BUFFER_SIZE (4 * 1024 * 1024)
+#endif
+
 #ifndef CUE_ENTRY_GAP_NS
 #define CUE_ENTRY_GAP_NS 1_s
 #endif
@@ -94,6 +107,16 @@ constexpr uint64_t operator"" _s(unsigned long long x)
 #define CLUSTER_READ_AHEAD_COUNT 2
 #endif
 
+#ifndef PLAYBACK_MAX_DECODE_AHEAD_COUNT
+// Upper limit for k4a_playback_set_decode_ahead(), each decoded capture may hold a full resolution BGRA image.
+#define PLAYBACK_MAX_DECODE_AHEAD_COUNT 16
+#endif
+
+#ifndef PLAYBACK_GROUP_READ_AHEAD_COUNT
+// Number of captures each recording in a k4a_playback_group_t is read ahead by its reader thread.
+#define PLAYBACK_GROUP_READ_AHEAD_COUNT 4
+#endif
+
 static_assert(MAX_CLUSTER_LENGTH_NS < INT16_MAX * MATROSKA_TIMESCALE_NS, "Cluster length must fit in a 16 bit int");
 static_assert(CLUSTER_WRITE_DELAY_NS >= MAX_CLUSTER_LENGTH_NS * 2, "Cluster write delay is shorter than 2 clusters");
 
@@ -131,6 +154,21 @@ constexpr uint16_t swap_bytes_16(uint16_t input)
 #endif
 }
 
+// Vectorized copy of a 16-bit buffer that also switches endianness, used for the b16g depth and IR tracks.
+// dst and src may be the same buffer for an in-place swap.
+void copy_swap_bytes_16(uint16_t *dst, const uint16_t *src, size_t count);
+
+// Returns the instruction set copy_swap_bytes_16 selected for this CPU: AVX2, SSSE3, NEON, or None
+const char *copy_swap_bytes_16_get_instruction_type();
+
+// Lossless RVL compression for 16-bit depth and IR images, used for the V_K4A/RVL codec.
+// The output buffer passed to rvl_compress must be at least rvl_max_compressed_size(count) bytes.
+size_t rvl_max_compressed_size(size_t count);
+size_t rvl_compress(const uint16_t *input, size_t count, uint8_t *output);
+
+// Returns false if the compressed data is truncated or does not decode to exactly count values.
+bool rvl_decompress(const uint8_t *input, size_t size, uint16_t *output, size_t count);
+
 namespace k4arecord
 {
 /**
@@ -147,13 +185,60 @@ public:
     size_t write(const void *buffer, size_t size) override;
     uint64 getFilePointer() override;
     void close() override;
+    void flush();
     void setOwnerThread();
 
+    // Total time spent in flush(), including flushes made by write() when the write buffer is full.
+    uint64_t getFlushTimeNs() const;
+
 private:
+    void writeBuffer();
+
+    std::unique_ptr<char[]> m_write_buffer; // Data written after the stream position, up to RECORD_WRITE_BUFFER_SIZE
+    size_t m_buffered_size = 0;             // Bytes in m_write_buffer
     std::fstream m_stream;
     std::thread::id m_owner;
+    std::atomic<uint64_t> m_flush_time_ns;
 };
 
+/**
+ * Persistent worker threads for the CPU heavy parts of recording and playback, such as encoding depth frames before a
+ * cluster is written and decoding frames ahead of playback. The threads are started once instead of per frame, and are
+ * joined by stop_worker_pool(). A job must not wait on another job of the same pool.
+ */
+typedef struct _worker_pool_t
+{
+    std::vector<std::thread> workers;       // Locked by lock
+    std::deque<std::function<void()>> jobs; // Locked by lock
+    bool stopping = false;                  // Locked by lock
+    std::mutex lock;
+    // std::condition_variable constructor may throw, so wrap this in a pointer.
+    std::unique_ptr<std::condition_variable> notify;
+} worker_pool_t;
+
+// Starts thread_count threads, unless the pool is already running. If no threads can be started, jobs run on the
+// thread that queues them.
+void start_worker_pool(worker_pool_t *pool, unsigned int thread_count);
+
+// Finishes the queued jobs and joins the threads.
+void stop_worker_pool(worker_pool_t *pool);
+
+// Queues a job on the pool. Returns false if the pool has no threads, the caller needs to run the job itself.
+bool queue_worker_job(worker_pool_t *pool, std::function<void()> job);
+
+// Runs a job on the pool, or on the calling thread if the pool has no threads. The result is returned through the
+// future.
+template<typename T> std::future<T> run_worker_job(worker_pool_t *pool, std::function<T()> job)
+{
+    auto task = std::make_shared<std::packaged_task<T()>>(std::move(job));
+    std::future<T> result = task->get_future();
+    if (!queue_worker_job(pool, [task]() { (*task)(); }))
+    {
+        (*task)();
+    }
+    return result;
+}
+
 // Struct matches https://docs.microsoft.com/en-us/windows/desktop/wmdm/-bitmapinfoheader
 struct BITMAPINFOHEADER
 {
@@ -9,10 +9,14 @@
 #define RECORD_READ_H
 
 #include <k4ainternal/matroska_common.h>
+#include <atomic>
 #include <functional>
 #include <mutex>
 #include <future>
 #include <map>
+#include <deque>
+
+#include <turbojpeg.h>
 
 namespace k4arecord
 {
@@ -68,6 +72,14 @@ typedef struct _block_info_t
     int sub_index = -1;             // Index of the current buffer within the block.
 } block_info_t;
 
+// An image being converted on the decode pool for a block that will be read soon.
+typedef struct _decode_ahead_t
+{
+    std::shared_ptr<block_info_t> block;
+    k4a_image_format_t target_format;
+    std::future<k4a_image_t> image; // NULL if the conversion failed.
+} decode_ahead_t;
+
 typedef struct _track_reader_t
 {
     std::string track_name;
@@ -77,7 +89,6 @@ typedef struct _track_reader_t
     std::string codec_id;
     std::vector<uint8_t> codec_private;
 
-    std::shared_ptr<block_info_t> current_block;
     uint64_t frame_period_ns = 0;
     uint64_t sync_delay_ns = 0;
 
@@ -88,8 +99,49 @@ typedef struct _track_reader_t
     uint32_t height = 0;
     uint32_t stride = 0;
     k4a_image_format_t format = K4A_IMAGE_FORMAT_CUSTOM;
+    bool rvl_compressed = false; // Depth and IR tracks using the V_K4A/RVL codec
+
+    bool enabled = true; // Blocks of disabled tracks are skipped when loading clusters
 } track_reader_t;
 
+// Read position of a single track.
+typedef struct _track_position_t
+{
+    std::shared_ptr<block_info_t> current_block;
+    std::deque<decode_ahead_t> decode_queue; // Images for the blocks following current_block
+} track_position_t;
+
+// Metadata read from the header of a color, depth, or IR block without reading the frame payload.
+typedef struct _block_header_t
+{
+    uint64_t timestamp_ns = 0;      // The timestamp of the block as written in the file.
+    uint64_t sync_timestamp_ns = 0; // The timestamp of the block, including sychronization offsets.
+    uint64_t data_size = 0;         // Size of the frame payload stored in the block.
+} block_header_t;
+
+// Read position of get_capture_info(), which is independent of the track readers used by get_capture().
+typedef struct _capture_info_cursor_t
+{
+    bool started = false;
+    cluster_info_t *next_cluster = NULL; // The next cluster to scan, or NULL if the end of file was reached.
+
+    // Block headers that have been scanned but not yet returned, for the color, depth, and IR tracks.
+    std::deque<block_header_t> pending[3];
+} capture_info_cursor_t;
+
+// A read position within a recording. The playback handle and each k4a_playback_cursor_t keep their own position, the
+// parsed headers, cluster index, and cluster cache in k4a_playback_context_t are shared between them.
+typedef struct _playback_position_t
+{
+    uint64_t seek_timestamp_ns = 0;
+    std::shared_ptr<loaded_cluster_t> seek_cluster; // Keeps the clusters around the seek timestamp loaded.
+
+    std::map<track_reader_t *, track_position_t> tracks;
+    capture_info_cursor_t capture_info_cursor;
+} playback_position_t;
+
+struct _k4a_playback_cursor_context_t;
+
 typedef struct _k4a_playback_context_t
 {
     const char *file_path;
@@ -100,6 +152,11 @@ typedef struct _k4a_playback_context_t
     uint64_t timecode_scale;
     k4a_record_configuration_t record_config;
     k4a_image_format_t color_format_conversion;
+    uint32_t decode_ahead_count;
+    worker_pool_t decode_pool; // Converts images for decode-ahead, started by k4a_playback_set_decode_ahead()
+
+    std::vector<tjhandle> decoders; // Idle turbojpeg decompressors, reused across frames and threads.
+    std::mutex decoder_lock;        // Locks access to decoders
 
     std::unique_ptr<libebml::EbmlStream> stream;
     std::unique_ptr<libmatroska::KaxSegment> segment;
@@ -114,8 +171,11 @@ typedef struct _k4a_playback_context_t
     std::unique_ptr<k4a_calibration_t> device_calibration;
 
     uint64_t sync_period_ns;
-    uint64_t seek_timestamp_ns;
-    std::shared_ptr<loaded_cluster_t> seek_cluster;
+    playback_position_t position; // Read position of the playback handle itself
+    // Set by k4a_playback_close(). Open cursors keep the context alive, it is destroyed once cursors is empty.
+    bool closed;
+    std::vector<_k4a_playback_cursor_context_t *> cursors;
+    std::mutex cursor_lock; // Locks access to closed and cursors
 
     cluster_cache_t cluster_cache;
     std::recursive_mutex cache_lock; // Locks modification of cluster_cache
@@ -126,6 +186,7 @@ typedef struct _k4a_playback_context_t
     track_reader_t *imu_track = nullptr;
 
     std::map<std::string, track_reader_t> track_map;
+    std::vector<uint64_t> disabled_track_numbers; // Locked by io_lock
 
     uint64_t segment_info_offset;
     uint64_t first_cluster_offset;
@@ -136,12 +197,20 @@ typedef struct _k4a_playback_context_t
 
     uint64_t last_file_timestamp_ns; // Relative to start of file.
 
-    // Stats
-    uint64_t seek_count, load_count, cache_hits;
+    // Stats, updated by the playback handle and cursors from any thread
+    std::atomic<uint64_t> seek_count, load_count, cache_hits;
 } k4a_playback_context_t;
 
 K4A_DECLARE_CONTEXT(k4a_playback_t, k4a_playback_context_t);
 
+typedef struct _k4a_playback_cursor_context_t
+{
+    k4a_playback_t playback_handle;
+    playback_position_t position;
+} k4a_playback_cursor_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_playback_cursor_t, k4a_playback_cursor_context_t);
+
 typedef struct _k4a_playback_data_block_context_t
 {
     uint64_t device_timestamp_usec;
@@ -159,12 +228,14 @@ k4a_result_t parse_mkv(k4a_playback_context_t *context);
 k4a_result_t populate_cluster_cache(k4a_playback_context_t *context);
 k4a_result_t parse_recording_config(k4a_playback_context_t *context);
 k4a_result_t read_bitmap_info_header(track_reader_t *track);
-void reset_seek_pointers(k4a_playback_context_t *context, uint64_t seek_timestamp_ns);
+void reset_seek_pointers(k4a_playback_context_t *context, playback_position_t *position, uint64_t seek_timestamp_ns);
 
 k4a_result_t parse_tracks(k4a_playback_context_t *context);
 track_reader_t *find_track(k4a_playback_context_t *context, const char *name, const char *tag_name);
 bool check_track_reader_is_builtin(k4a_playback_context_t *context, track_reader_t *track_reader);
 track_reader_t *get_track_reader_by_name(k4a_playback_context_t *context, std::string track_name);
+track_reader_t *get_enabled_track(track_reader_t *track_reader);
+k4a_result_t set_track_enabled(k4a_playback_context_t *context, track_reader_t *track_reader, bool enabled);
 libmatroska::KaxTag *get_tag(k4a_playback_context_t *context, const char *name);
 std::string get_tag_string(libmatroska::KaxTag *tag);
 libmatroska::KaxAttached *get_attachment_by_name(k4a_playback_context_t *context, const char *file_name);
@@ -193,10 +264,38 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                                     block_info_t *in_block,
                                     k4a_image_t *image_out,
                                     k4a_image_format_t target_format);
-k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k4a_capture_t *capture_handle);
-k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *capture_handle, bool next);
-k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_sample_t *imu_sample, bool next);
+void reset_decode_ahead(track_position_t *track_position);
+void schedule_decode_ahead(k4a_playback_context_t *context,
+                           track_reader_t *track_reader,
+                           track_position_t *track_position,
+                           k4a_image_format_t format);
+void free_decoders(k4a_playback_context_t *context);
+k4a_result_t new_capture(k4a_playback_context_t *context,
+                         playback_position_t *position,
+                         block_info_t *block,
+                         k4a_capture_t *capture_handle);
+k4a_stream_result_t get_capture(k4a_playback_context_t *context,
+                                playback_position_t *position,
+                                k4a_capture_t *capture_handle,
+                                bool next);
+k4a_result_t read_block_headers(k4a_playback_context_t *context,
+                                capture_info_cursor_t *cursor,
+                                cluster_info_t *cluster_info);
+k4a_stream_result_t get_capture_info(k4a_playback_context_t *context,
+                                     playback_position_t *position,
+                                     k4a_playback_capture_info_t *capture_info);
+k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context,
+                                   playback_position_t *position,
+                                   k4a_imu_sample_t *imu_sample,
+                                   bool next);
+k4a_stream_result_t get_imu_samples(k4a_playback_context_t *context,
+                                    uint64_t start_timestamp_usec,
+                                    uint64_t end_timestamp_usec,
+                                    k4a_imu_sample_t *imu_samples,
+                                    size_t max_samples,
+                                    size_t *sample_count);
 k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
+                                   playback_position_t *position,
                                    track_reader_t *track_reader,
                                    k4a_playback_data_block_t *data_block_handle,
                                    bool next);
@@ -10,6 +10,7 @@
 
 #include <k4ainternal/matroska_common.h>
 #include <set>
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <unordered_map>
@@ -30,6 +31,18 @@ typedef struct _track_header_t
      * See k4a_record_subtitle_settings_t::high_freq_data in types.h for more information on timestamp behavior.
      */
     bool high_freq_data = false;
+
+    /**
+     * Depth and IR tracks recorded with the V_K4A/RVL codec store raw little-endian data in the cluster until it is
+     * written, and are compressed by the encode pool in prepare_cluster().
+     */
+    bool rvl_compressed = false;
+
+    /**
+     * With zero-copy captures, b16g depth and IR tracks also store raw little-endian data in the cluster, and the
+     * encode pool swaps it to big-endian in prepare_cluster().
+     */
+    bool deferred_byte_swap = false;
 } track_header_t;
 
 typedef struct _track_data_t
@@ -44,6 +57,9 @@ typedef struct _cluster_t
     uint64_t time_start_ns;
     uint64_t time_end_ns;
     std::vector<std::pair<uint64_t, track_data_t>> data;
+
+    uint64_t data_size = 0; // Total size of the buffers in data, before compression.
+    bool prepared = false;  // Set by prepare_cluster() once data is sorted and compressed.
 } cluster_t;
 
 typedef struct _k4a_record_context_t
@@ -90,14 +106,46 @@ typedef struct _k4a_record_context_t
     std::unordered_map<std::string, track_header_t> tracks;
 
     std::list<cluster_t *> pending_clusters;
-    std::mutex pending_cluster_lock; // Locks last_written_timestamp, most_recent_timestamp, and pending_clusters
+    // Locks last_written_timestamp, most_recent_timestamp, pending_clusters, and pending_bytes
+    std::mutex pending_cluster_lock;
+
+    /**
+     * The amount of track data buffered in memory, including clusters being written by the writer thread.
+     * Reported by k4a_record_get_stats().
+     */
+    uint64_t pending_bytes;
+
+    // Total bytes rendered to the file and time spent rendering them into the file's write buffer. Together with the
+    // file's flush time, used to calculate write throughput.
+    std::atomic<uint64_t> bytes_written;
+    std::atomic<uint64_t> render_time_ns;
+
+    /**
+     * Maximum value of pending_bytes, or 0 for no limit. Set by k4a_record_set_memory_budget().
+     * When more than half of the budget is in use, the writer thread writes clusters before CLUSTER_WRITE_DELAY_NS.
+     * Budget fields are locked by pending_cluster_lock.
+     */
+    uint64_t memory_budget;
+    k4a_record_memory_policy_t memory_policy;
+    uint64_t dropped_count;   // Number of track data buffers dropped by K4A_RECORD_MEMORY_POLICY_DROP
+    uint64_t blocked_time_ns; // Time spent blocked by K4A_RECORD_MEMORY_POLICY_BLOCK
+
+    // Notified when pending_bytes decreases, or the writer thread exits.
+    std::unique_ptr<std::condition_variable> pending_space_notify;
 
     bool writer_stopping;
+    bool writer_exited; // Set if the writer thread stopped, locked by pending_cluster_lock
     std::thread writer_thread;
     // std::condition_variable constructor may throw, so wrap this in a pointer.
     std::unique_ptr<std::condition_variable> writer_notify;
     std::mutex writer_lock;
 
+    // Encodes raw depth and IR track data, started with the writer thread and joined when it stops.
+    worker_pool_t encode_pool;
+
+    // Set by k4a_record_enable_zero_copy(), captures are queued by reference instead of copied.
+    bool zero_copy_captures;
+
     bool header_written, first_cluster_written;
 } k4a_record_context_t;
 
@@ -134,6 +182,8 @@ k4a_result_t write_track_data(k4a_record_context_t *context,
 
 cluster_t *get_cluster_for_timestamp(k4a_record_context_t *context, uint64_t timestamp_ns);
 
+k4a_result_t prepare_cluster(k4a_record_context_t *context, cluster_t *cluster);
+
 k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, uint64_t *time_end_ns = NULL);
 
 k4a_result_t start_matroska_writer_thread(k4a_record_context_t *context);
@@ -0,0 +1,93 @@
+/** \file perf_trace.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ *
+ * Binary hot path tracing exported in the Chrome trace event format
+ */
+
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include <k4a/k4atypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Environment variable holding the path of the trace file to write.
+ *
+ * When set, begin and end events are recorded into a fixed size ring per thread and written to the file when the
+ * library is unloaded. The file uses the JSON array form of the Chrome trace event format, which can be opened with
+ * chrome://tracing or https://ui.perfetto.dev. Each SDK binary in the process appends its own events to the file.
+ *
+ * The file is never truncated, so events of later runs are appended to an existing trace. Delete the file to start a
+ * new one.
+ */
+#define K4A_ENV_VAR_TRACE_FILE "K4A_TRACE_FILE"
+
+/** Phase of a trace event */
+typedef enum
+{
+    PERF_TRACE_PHASE_BEGIN = 0, /**< Start of a duration on the calling thread */
+    PERF_TRACE_PHASE_END,       /**< End of the most recent duration started on the calling thread */
+} perf_trace_phase_t;
+
+/** Records a trace event on the calling thread
+ *
+ * \param name
+ * Name of the event. This must be a string literal; only the pointer is stored and it is written to the trace without
+ * escaping.
+ *
+ * \param phase
+ * Whether the event begins or ends a duration.
+ *
+ * \remarks
+ * This does nothing unless \ref K4A_ENV_VAR_TRACE_FILE is set. Recording does not take locks or allocate memory
+ * except for the first event of each thread. When a thread records more events than its ring holds, the oldest events
+ * are overwritten.
+ */
+void perf_trace_event(const char *name, perf_trace_phase_t phase);
+
+/** Writes the events recorded so far to the trace file
+ *
+ * \remarks
+ * This is called automatically when the library is unloaded. Events are only written once, so calling it again only
+ * writes the events recorded since the last call.
+ */
+void perf_trace_flush(void);
+
+/** Begins a duration named \p name on the calling thread */
+#define PERF_TRACE_BEGIN(name) perf_trace_event(name, PERF_TRACE_PHASE_BEGIN)
+
+/** Ends the duration named \p name on the calling thread */
+#define PERF_TRACE_END(name) perf_trace_event(name, PERF_TRACE_PHASE_END)
+
+#ifdef __cplusplus
+}
+
+/** Traces the lifetime of a C++ scope as a duration, including early returns and exceptions */
+class perf_trace_scope
+{
+public:
+    explicit perf_trace_scope(const char *name) : m_name(name)
+    {
+        PERF_TRACE_BEGIN(m_name);
+    }
+    ~perf_trace_scope()
+    {
+        PERF_TRACE_END(m_name);
+    }
+
+    perf_trace_scope(const perf_trace_scope &) = delete;
+    perf_trace_scope &operator=(const perf_trace_scope &) = delete;
+
+private:
+    const char *m_name;
+};
+
+/** Traces the rest of the enclosing C++ scope as a duration named \p name */
+#define PERF_TRACE_SCOPE(name) perf_trace_scope perf_trace_scope_instance(name)
+#endif
+
+#endif /* PERF_TRACE_H */
@@ -116,6 +116,20 @@ void queue_push_w_dropped(queue_t queue_handle, k4a_capture_t capture_handle, k4
  */
 k4a_wait_result_t queue_pop(queue_t queue_handle, int32_t wait_in_ms, k4a_capture_t *capture_handle);
 
+/** Reads the depth and drop count of the queue, and how long captures waited in it before being popped
+ *
+ * \param queue_handle [in]
+ *  A queue handle
+ *
+ * \param stats [out]
+ * The location to write the current depth, capacity and the number of captures dropped since the queue was created
+ *
+ * \param wait_latency [out]
+ * Optional location to write the histogram of the time between queue_push() and queue_pop() of each capture. Captures
+ * that are dropped or flushed are not counted.
+ */
+void queue_get_stats(queue_t queue_handle, k4a_queue_stats_t *stats, k4a_latency_histogram_t *wait_latency);
+
 /** Enables the queue for accepting data
  *
  * \param queue_handle [in]
@@ -114,9 +114,12 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_paramete
     uint8_t *transformed_custom_image_data,
     k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor);
 
+// If color_pinhole is not NULL the depth image is rasterized into an undistorted color image with that pinhole model,
+// instead of the distorted color camera described by calibration.
 k4a_buffer_result_t transformation_depth_image_to_color_camera_internal(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const k4a_transformation_pinhole_t *color_pinhole,
     const uint8_t *depth_image_data,
     const k4a_transformation_image_descriptor_t *depth_image_descriptor,
     const uint8_t *custom_image_data,
@@ -141,6 +144,20 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
     k4a_transformation_interpolation_type_t interpolation_type,
     uint32_t invalid_custom_value);
 
+k4a_result_t transformation_depth_image_to_undistorted_color_camera(
+    k4a_transformation_t transformation_handle,
+    k4a_undistortion_map_t undistortion_map_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *custom_image_data,
+    const k4a_transformation_image_descriptor_t *custom_image_descriptor,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
+    uint8_t *transformed_custom_image_data,
+    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    k4a_transformation_interpolation_type_t interpolation_type,
+    uint32_t invalid_custom_value);
+
 k4a_buffer_result_t transformation_color_image_to_depth_camera_validate_parameters(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
@@ -185,6 +202,29 @@ transformation_depth_image_to_point_cloud(k4a_transformation_t transformation_ha
                                           uint8_t *xyz_image_data,
                                           k4a_transformation_image_descriptor_t *xyz_image_descriptor);
 
+// Undistortion
+k4a_result_t transformation_create_undistortion_map(k4a_transformation_t transformation_handle,
+                                                    const k4a_calibration_type_t camera,
+                                                    const k4a_transformation_pinhole_type_t pinhole_type,
+                                                    k4a_undistortion_map_t *undistortion_map_handle);
+
+k4a_result_t undistortion_map_create(const k4a_calibration_t *calibration,
+                                     const k4a_calibration_type_t camera,
+                                     const k4a_transformation_pinhole_type_t pinhole_type,
+                                     k4a_undistortion_map_t *undistortion_map_handle);
+
+void undistortion_map_destroy(k4a_undistortion_map_t undistortion_map_handle);
+
+k4a_result_t undistortion_map_get_camera_calibration(k4a_undistortion_map_t undistortion_map_handle,
+                                                     k4a_calibration_camera_t *pinhole_calibration);
+
+k4a_result_t undistortion_map_remap(k4a_undistortion_map_t undistortion_map_handle,
+                                    const uint8_t *source_image_data,
+                                    const k4a_transformation_image_descriptor_t *source_image_descriptor,
+                                    uint8_t *destination_image_data,
+                                    const k4a_transformation_image_descriptor_t *destination_image_descriptor,
+                                    const k4a_transformation_interpolation_type_t interpolation_type);
+
 // Mode specific calibration
 k4a_result_t
 transformation_get_mode_specific_depth_camera_calibration(const k4a_calibration_camera_t *raw_camera_calibration,
@@ -202,6 +242,12 @@ transformation_get_mode_specific_camera_calibration(const k4a_calibration_camera
                                                     k4a_calibration_camera_t *mode_specific_camera_calibration,
                                                     bool pixelized_zero_centered_output);
 
+// Scales the intrinsics of a camera to an image of width x height pixels covering the same field of view.
+k4a_result_t transformation_get_scaled_camera_calibration(const k4a_calibration_camera_t *camera_calibration,
+                                                          const int width,
+                                                          const int height,
+                                                          k4a_calibration_camera_t *scaled_camera_calibration);
+
 // Intrinsic transformations
 k4a_result_t transformation_unproject(const k4a_calibration_camera_t *camera_calibration,
                                       const float point2d[2],
@@ -0,0 +1,301 @@
+/** \file virtual_device.h
+ * Copyright (c) Microsoft Corporation. All rights reserved.
+ * Licensed under the MIT License.
+ * Kinect For Azure SDK.
+ *
+ * Hardware-free device backend. A virtual device replays the raw depth, color and IMU payloads stored in a replay file
+ * through the same usbcmd_t and color interfaces a physical device uses, so everything above them (depthmcu, colormcu,
+ * dewrapper, capturesync, imu, the public API) runs unmodified.
+ */
+
+#ifndef VIRTUAL_DEVICE_H
+#define VIRTUAL_DEVICE_H
+
+#include <k4a/k4atypes.h>
+#include <k4ainternal/allocator.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/handle.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//**************Symbolic Constant Macros (defines)  *************
+
+// List of replay files separated by ';'. When set, the SDK enumerates one virtual device per file instead of the
+// physical devices.
+#define VIRTUAL_DEVICE_ENV_FILES "K4A_VIRTUAL_DEVICE"
+
+// Playback rate relative to the recorded timestamps: 1 is real time (default), 4 is four times faster, and 0 delivers
+// payloads as fast as the consumers accept them.
+#define VIRTUAL_DEVICE_ENV_RATE "K4A_VIRTUAL_DEVICE_RATE"
+
+// Set to 0 to stop streaming at the end of the replay file. By default the file is replayed in a loop with timestamps
+// continuing to increase.
+#define VIRTUAL_DEVICE_ENV_LOOP "K4A_VIRTUAL_DEVICE_LOOP"
+
+// Depth engine plugin that decodes the virtual raw depth payload, loaded by the deloader in place of the depth engine
+// whenever virtual devices are enabled.
+#define VIRTUAL_DEVICE_DEPTH_ENGINE_NAME "k4avirtualdepthengine"
+
+// Test hooks of the virtual depth engine, read each time a depth or transform engine is created. The wrappers are
+// tested and benchmarked by loading the virtual depth engine with K4A_DEPTH_ENGINE_PLUGIN.
+//
+// Time each process_frame call spends spinning on the CPU, like the GPU work of the real engine. Defaults to 0.
+#define VIRTUAL_DEPTH_ENGINE_ENV_COST_USEC "K4A_VIRTUAL_DEPTH_ENGINE_COST_USEC"
+// Size in bytes reported by the depth engine get_output_frame_size, instead of the size of the depth and IR images of
+// the mode. Frames fail with K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_OUTPUT_BUFFER_SIZE when it is too small.
+#define VIRTUAL_DEPTH_ENGINE_ENV_OUTPUT_SIZE "K4A_VIRTUAL_DEPTH_ENGINE_OUTPUT_SIZE"
+// When N > 0, every Nth process_frame call of an engine fails with VIRTUAL_DEPTH_ENGINE_ENV_FAIL_CODE, which defaults
+// to K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT.
+#define VIRTUAL_DEPTH_ENGINE_ENV_FAIL_EVERY "K4A_VIRTUAL_DEPTH_ENGINE_FAIL_EVERY"
+#define VIRTUAL_DEPTH_ENGINE_ENV_FAIL_CODE "K4A_VIRTUAL_DEPTH_ENGINE_FAIL_CODE"
+// Set to 1 before the plugin is loaded to register a nearest neighbor transform engine. Read once, when loading.
+#define VIRTUAL_DEPTH_ENGINE_ENV_TRANSFORM "K4A_VIRTUAL_DEPTH_ENGINE_TRANSFORM"
+
+#define VIRTUAL_DEVICE_MAX_COUNT 8
+
+#define VIRTUAL_DEVICE_FILE_MAGIC "K4AVIRT"
+#define VIRTUAL_DEVICE_FILE_VERSION 1
+
+#define VIRTUAL_DEVICE_RAW_DEPTH_MAGIC 0x4456524B // "KRVD"
+#define VIRTUAL_DEVICE_RAW_DEPTH_FLAG_DEPTH 0x1   // Payload has a depth image in front of the IR image
+
+//************************ Typedefs *****************************
+typedef enum
+{
+    VIRTUAL_DEVICE_STREAM_DEPTH = 0,
+    VIRTUAL_DEVICE_STREAM_COLOR,
+    VIRTUAL_DEVICE_STREAM_IMU,
+
+    VIRTUAL_DEVICE_STREAM_COUNT
+} virtual_device_stream_t;
+
+#pragma pack(push, 1)
+
+// The replay file starts with this header, followed by calibration_size bytes of raw calibration JSON and then a
+// sequence of records sorted by device timestamp. All values are little endian.
+typedef struct _virtual_device_file_header_t
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t depth_mode;       // k4a_depth_mode_t the depth records were captured in
+    uint32_t color_format;     // k4a_image_format_t of the color records
+    uint32_t color_resolution; // k4a_color_resolution_t of the color records
+    uint32_t camera_fps;       // k4a_fps_t
+    char serial_number[MAX_SERIAL_NUMBER_LENGTH];
+    uint32_t calibration_size;
+} virtual_device_file_header_t;
+
+typedef struct _virtual_device_record_header_t
+{
+    uint32_t stream; // virtual_device_stream_t
+    uint32_t payload_size;
+    uint64_t device_timestamp_usec;
+} virtual_device_record_header_t;
+
+// Payload of a depth record. The record is exactly virtual_device_get_raw_depth_size() bytes, the size a physical
+// sensor streams in the same mode, so depthmcu accepts it. The header is followed by width * height 16 bit depth values
+// (when VIRTUAL_DEVICE_RAW_DEPTH_FLAG_DEPTH is set) and width * height 16 bit IR values.
+typedef struct _virtual_device_raw_depth_header_t
+{
+    uint32_t magic;
+    uint16_t width;
+    uint16_t height;
+    uint32_t flags;
+    float sensor_temp;
+    uint64_t center_of_exposure_in_ticks; // 90kHz device clock, as reported by the depth engine
+} virtual_device_raw_depth_header_t;
+
+// Payload of a color record, followed by the image data.
+typedef struct _virtual_device_color_header_t
+{
+    uint32_t format; // k4a_image_format_t
+    uint32_t width;
+    uint32_t height;
+    uint32_t stride;
+} virtual_device_color_header_t;
+
+// The payload of an IMU record is the raw color mcu stream payload, imu_payload_metadata_t followed by the gyro and
+// accelerometer samples.
+
+#pragma pack(pop)
+
+/** Handle to one stream of a virtual device.
+ *
+ * Handles are created with \ref virtual_device_create and closed with \ref virtual_device_destroy. Each handle has its
+ * own view of the replay file, so the depth, color and IMU streams of the same device are paced independently.
+ */
+K4A_DECLARE_HANDLE(virtual_device_t);
+
+/** Delivers a replayed payload. Matches usb_cmd_stream_cb_t, the image is only valid during the callback unless a
+ * reference is taken.
+ */
+typedef void(virtual_device_stream_cb_t)(k4a_result_t result, k4a_image_t image_handle, void *context);
+
+K4A_DECLARE_HANDLE(virtual_device_writer_t);
+
+//******************* Function Prototypes ***********************
+
+/** Returns the number of virtual devices configured through \ref VIRTUAL_DEVICE_ENV_FILES, 0 if virtual devices are not
+ * enabled.
+ */
+uint32_t virtual_device_get_count(void);
+
+/** Writes the container ID a virtual device reports, so the depth and color halves of the same device can find each
+ * other like they do on a physical device.
+ */
+void virtual_device_get_container_id(uint32_t device_index, guid_t *container_id);
+
+/** Returns true if container_id belongs to a virtual device, and the index of that device.
+ */
+bool virtual_device_find_container_id(const guid_t *container_id, uint32_t *device_index);
+
+/** Opens one stream of a virtual device.
+ *
+ * \param device_index
+ * Index of the virtual device, less than \ref virtual_device_get_count.
+ *
+ * \param stream
+ * The stream this handle replays.
+ *
+ * \param virtual_device_handle [OUT]
+ * Handle to the opened virtual device stream.
+ *
+ * \return K4A_RESULT_SUCCEEDED if the replay file was opened and its header is valid.
+ */
+k4a_result_t virtual_device_create(uint32_t device_index,
+                                   virtual_device_stream_t stream,
+                                   virtual_device_t *virtual_device_handle);
+
+void virtual_device_destroy(virtual_device_t virtual_device_handle);
+
+/** Returns the header of the replay file backing this handle. */
+const virtual_device_file_header_t *virtual_device_get_file_header(virtual_device_t virtual_device_handle);
+
+/** Emulates the firmware side of a command transaction, with the same semantics as the physical usb_cmd_io().
+ *
+ * Serial number, version, calibration and jack state reads are answered from the replay file, writes that configure
+ * or start the sensors are acknowledged, and unknown commands complete with a not implemented status.
+ */
+k4a_result_t virtual_device_command(virtual_device_t virtual_device_handle,
+                                    uint32_t cmd,
+                                    const void *p_cmd_data,
+                                    size_t cmd_data_size,
+                                    void *p_rx_data,
+                                    size_t rx_data_size,
+                                    size_t *transfer_count,
+                                    uint32_t *cmd_status);
+
+/** Starts replaying the records of this handle's stream on a dedicated thread.
+ *
+ * \param source
+ * Allocation source for the images handed to the callback.
+ *
+ * \param payload_size
+ * Largest payload the consumer accepts, 0 if the payload size is not constrained. Depth records that do not fit fail
+ * the start, which means the replay file was captured in a different depth mode.
+ *
+ * \remarks
+ * Every start replays the file from the beginning, with the device timestamps rebased so the first record in the file
+ * is shortly after time zero, like a physical device resets its clock when the cameras start.
+ *
+ * \remarks
+ * If a record can't be read, the callback is called once with K4A_RESULT_FAILED and a NULL image and replay stops.
+ *
+ * \remarks
+ * Once replay stops at the end of a file that is not looped, or on an error, the stream may be started again without
+ * calling \ref virtual_device_stream_stop.
+ */
+k4a_result_t virtual_device_stream_start(virtual_device_t virtual_device_handle,
+                                         allocation_source_t source,
+                                         size_t payload_size,
+                                         virtual_device_stream_cb_t *callback,
+                                         void *callback_context);
+
+/** Stops the replay thread. No callbacks are made once this returns. */
+void virtual_device_stream_stop(virtual_device_t virtual_device_handle);
+
+/** Size of the raw depth payload a sensor streams in depth_mode, 0 for K4A_DEPTH_MODE_OFF.
+ *
+ * \remarks
+ * A depth record must fit the header and both images in this size. That rules out K4A_DEPTH_MODE_PASSIVE_IR, whose
+ * 1024x1024 IR image is larger than the raw payload of the mode.
+ */
+size_t virtual_device_get_raw_depth_size(k4a_depth_mode_t depth_mode);
+
+/** Creates a replay file.
+ *
+ * \param path
+ * File to create.
+ *
+ * \param config
+ * Configuration the payloads were captured with. The depth mode, color format, color resolution and frame rate are
+ * stored in the file header.
+ *
+ * \param serial_number
+ * Serial number the virtual device reports.
+ *
+ * \param calibration
+ * Raw calibration JSON the virtual device reports, as returned by k4a_device_get_raw_calibration().
+ *
+ * \param calibration_size
+ * Size of calibration in bytes.
+ *
+ * \param writer_handle [OUT]
+ * Handle to the writer.
+ */
+k4a_result_t virtual_device_writer_create(const char *path,
+                                          const k4a_device_configuration_t *config,
+                                          const char *serial_number,
+                                          const uint8_t *calibration,
+                                          size_t calibration_size,
+                                          virtual_device_writer_t *writer_handle);
+
+/** Appends a depth record. width and height are those of the IR image.
+ *
+ * \remarks
+ * Fails without writing if the image does not match the depth mode given to \ref virtual_device_writer_create. The
+ * image must have the size of the mode, or twice that size to be binned on replay, and depth must be NULL exactly when
+ * the mode is K4A_DEPTH_MODE_PASSIVE_IR.
+ */
+k4a_result_t virtual_device_writer_write_depth(virtual_device_writer_t writer_handle,
+                                               uint64_t device_timestamp_usec,
+                                               const uint16_t *depth,
+                                               const uint16_t *ir,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               float sensor_temp);
+
+/** Appends a color record holding one image of the format and resolution given to \ref virtual_device_writer_create.
+ *
+ * \remarks
+ * Fails without writing if width and height do not match the resolution, or if the stride and data_size of an
+ * uncompressed format are too small for the image.
+ */
+k4a_result_t virtual_device_writer_write_color(virtual_device_writer_t writer_handle,
+                                               uint64_t device_timestamp_usec,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               uint32_t stride,
+                                               const uint8_t *data,
+                                               size_t data_size);
+
+/** Appends IMU records, packing the samples into raw color mcu payloads.
+ *
+ * \remarks
+ * The samples are quantized to the resolution of the IMU and are rectified again by the calibration when replayed.
+ */
+k4a_result_t virtual_device_writer_write_imu(virtual_device_writer_t writer_handle,
+                                             const k4a_imu_sample_t *samples,
+                                             size_t sample_count);
+
+/** Flushes and closes the replay file. */
+k4a_result_t virtual_device_writer_close(virtual_device_writer_t writer_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VIRTUAL_DEVICE_H */
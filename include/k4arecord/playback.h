@@ -406,6 +406,86 @@ K4ARECORD_EXPORT k4a_buffer_result_t k4a_playback_get_tag(k4a_playback_t playbac
 K4ARECORD_EXPORT k4a_result_t k4a_playback_set_color_conversion(k4a_playback_t playback_handle,
                                                                 k4a_image_format_t target_format);
 
+/** Convert the images of upcoming captures on background threads.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param capture_count
+ * The number of captures to convert ahead of the capture most recently returned by k4a_playback_get_next_capture(), up
+ * to 16. Set to 0 to convert images on the calling thread, which is the default.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the value was set. ::K4A_RESULT_FAILED if \p capture_count is too large.
+ *
+ * \remarks
+ * Only images that need decoding, such as MJPG color images converted by k4a_playback_set_color_conversion() or
+ * RVL compressed depth images, are converted ahead. Each call to k4a_playback_get_next_capture() then picks up images
+ * that are already converted, and starts converting the next capture in sequence. This lets playback decode several
+ * frames in parallel, and is most useful when the application processes captures at the rate they are read.
+ *
+ * \remarks
+ * Images converted ahead are held in memory until they are read, so memory usage grows with \p capture_count. Converted
+ * images are discarded by k4a_playback_seek_timestamp(), k4a_playback_get_previous_capture(), and when the color
+ * conversion format is changed.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_decode_ahead(k4a_playback_t playback_handle, uint32_t capture_count);
+
+/** Enable or disable reading a track during playback.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param track_name
+ * The name of a built-in or custom track, such as ::K4A_TRACK_NAME_COLOR.
+ *
+ * \param enabled
+ * False to skip the track during playback, true to read it again.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the track was enabled or disabled. ::K4A_RESULT_FAILED if the track does not exist.
+ *
+ * \remarks
+ * All tracks are enabled when a recording is opened. The blocks of a disabled track are skipped over when reading the
+ * recording from disk, and are never copied or converted. Disabling tracks that are not needed, such as the color track
+ * when only depth is used, can make playback significantly faster.
+ *
+ * \remarks
+ * Captures returned by k4a_playback_get_next_capture() and k4a_playback_get_previous_capture() will not contain
+ * images from disabled tracks, and are returned as if the track was not in the recording. If the IMU track is disabled,
+ * k4a_playback_get_next_imu_sample() and k4a_playback_get_previous_imu_sample() will return ::K4A_STREAM_RESULT_EOF.
+ * Reading a disabled custom track with k4a_playback_get_next_data_block() will fail.
+ *
+ * \remarks
+ * Disabling a track does not change the playback position. Enabling a track that was disabled seeks to the current
+ * playback position, as if k4a_playback_seek_timestamp() was called with the timestamp just after the last capture
+ * returned. The next call to k4a_playback_get_next_capture() returns the following capture, including the enabled
+ * track. IMU samples are read from the same timestamp.
+ *
+ * \relates k4a_playback_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_set_track_enabled(k4a_playback_t playback_handle,
+                                                             const char *track_name,
+                                                             bool enabled);
+
 /** Reads an attachment file from a recording.
  *
  * \param playback_handle
@@ -527,6 +607,45 @@ K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_next_capture(k4a_playback_
 K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_previous_capture(k4a_playback_t playback_handle,
                                                                        k4a_capture_t *capture_handle);
 
+/** Read the metadata of the next capture in the recording sequence, without reading any image data.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param capture_info
+ * If successful this contains the timestamp and size of each image in the next capture.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if capture metadata is returned, or ::K4A_STREAM_RESULT_EOF if the end of the recording
+ * is reached. All other failures will return ::K4A_STREAM_RESULT_FAILED.
+ *
+ * \relates k4a_playback_t
+ *
+ * \remarks
+ * Images are grouped into captures the same way as k4a_playback_get_next_capture(), but only the block headers are
+ * read from the file, and no images are allocated or decoded. This is much faster than reading captures when only the
+ * timestamps of a recording are needed, such as when building an index of a large recording.
+ *
+ * \remarks
+ * k4a_playback_get_next_capture_info() keeps its own position in the recording, and does not change which capture is
+ * returned by k4a_playback_get_next_capture() or k4a_playback_get_previous_capture(). Both positions are moved by
+ * k4a_playback_seek_timestamp(), and the first call to k4a_playback_get_next_capture_info() after a seek will return
+ * the same capture as k4a_playback_get_next_capture().
+ *
+ * \remarks
+ * Exposure and other per-image settings are not stored in recordings, and are not available from this API.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_next_capture_info(k4a_playback_t playback_handle,
+                                                                        k4a_playback_capture_info_t *capture_info);
+
 /** Read the next IMU sample in the recording sequence.
  *
  * \param playback_handle
@@ -601,6 +720,61 @@ K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_next_imu_sample(k4a_playba
 K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_previous_imu_sample(k4a_playback_t playback_handle,
                                                                           k4a_imu_sample_t *imu_sample);
 
+/** Read all IMU samples within a range of device timestamps.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param start_timestamp_usec
+ * The first device timestamp to include, in microseconds.
+ *
+ * \param end_timestamp_usec
+ * The device timestamp to stop at, in microseconds. Samples at or after this timestamp are not returned.
+ *
+ * \param imu_samples [OUT]
+ * The array to write the IMU samples to.
+ *
+ * \param max_samples
+ * The number of samples \p imu_samples can hold.
+ *
+ * \param sample_count [OUT]
+ * The number of samples written to \p imu_samples.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if at least one sample is returned, or ::K4A_STREAM_RESULT_EOF if there are no
+ * samples in the range. All other failures will return ::K4A_STREAM_RESULT_FAILED.
+ *
+ * \relates k4a_playback_t
+ *
+ * \remarks
+ * Samples are selected by their accelerometer timestamp, which is a device timestamp in the same time base as
+ * k4a_imu_sample_t::acc_timestamp_usec and ::K4A_PLAYBACK_SEEK_DEVICE_TIME.
+ *
+ * \remarks
+ * Whole IMU blocks are decoded directly into \p imu_samples, which is much faster than calling
+ * k4a_playback_get_next_imu_sample() for each sample. If \p sample_count equals \p max_samples there may be more
+ * samples in the range, call k4a_playback_get_imu_samples() again with \p start_timestamp_usec set to one past the
+ * accelerometer timestamp of the last returned sample.
+ *
+ * \remarks
+ * This function does not use or change the playback position of k4a_playback_get_next_imu_sample() and
+ * k4a_playback_get_previous_imu_sample().
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_get_imu_samples(k4a_playback_t playback_handle,
+                                                                  uint64_t start_timestamp_usec,
+                                                                  uint64_t end_timestamp_usec,
+                                                                  k4a_imu_sample_t *imu_samples,
+                                                                  size_t max_samples,
+                                                                  size_t *sample_count);
+
 /** Read the next data block for a particular track.
  *
  * \param playback_handle
@@ -887,6 +1061,207 @@ K4ARECORD_EXPORT uint64_t k4a_playback_get_recording_length_usec(k4a_playback_t
  */
 K4ARECORD_DEPRECATED_EXPORT uint64_t k4a_playback_get_last_timestamp_usec(k4a_playback_t playback_handle);
 
+/** Create an additional read position within an open recording.
+ *
+ * \param playback_handle
+ * Handle obtained by k4a_playback_open().
+ *
+ * \param cursor_handle
+ * If successful, this contains a pointer to the cursor handle. Caller must call k4a_playback_cursor_destroy() when
+ * done with it.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \remarks
+ * A cursor shares the parsed recording header, cluster index, and loaded clusters of the playback handle, but has its
+ * own seek position. Cursors start at the beginning of the recording, and are not affected by seeking or reading from
+ * the playback handle or other cursors.
+ *
+ * \remarks
+ * Each cursor may be used from a different thread at the same time, which allows separate time ranges of one
+ * recording to be processed in parallel without opening the file multiple times. A single cursor must not be used
+ * from multiple threads at the same time.
+ *
+ * \remarks
+ * Cursors use the color conversion, decode-ahead, and track settings of the playback handle. These settings should be
+ * configured before cursors are created, and not changed while cursors are being read from other threads.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_cursor_create(k4a_playback_t playback_handle,
+                                                         k4a_playback_cursor_t *cursor_handle);
+
+/** Seek a cursor to a specific timestamp within a recording.
+ *
+ * \param cursor_handle
+ * Handle obtained by k4a_playback_cursor_create().
+ *
+ * \param offset_usec
+ * The timestamp offset to seek to, relative to \p origin
+ *
+ * \param origin
+ * Specifies how the given timestamp should be interpreted. Seek can be done relative to the beginning or end of the
+ * recording, or using an absolute device timestamp.
+ *
+ * \returns
+ * ::K4A_RESULT_SUCCEEDED if the seek operation was successful, or ::K4A_RESULT_FAILED if an error occured. The current
+ * seek position is left unchanged if a failure is returned.
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \sa k4a_playback_seek_timestamp()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_cursor_seek_timestamp(k4a_playback_cursor_t cursor_handle,
+                                                                 int64_t offset_usec,
+                                                                 k4a_playback_seek_origin_t origin);
+
+/** Read the next capture at a cursor's position, and advance the cursor.
+ *
+ * \param cursor_handle
+ * Handle obtained by k4a_playback_cursor_create().
+ *
+ * \param capture_handle
+ * If successful this contains a handle to a capture object. Caller must call k4a_capture_release() when its done using
+ * this capture.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a capture is returned, or ::K4A_STREAM_RESULT_EOF if the end of the recording is
+ * reached. All other failures will return ::K4A_STREAM_RESULT_FAILED.
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \sa k4a_playback_get_next_capture()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_cursor_get_next_capture(k4a_playback_cursor_t cursor_handle,
+                                                                          k4a_capture_t *capture_handle);
+
+/** Read the previous capture at a cursor's position, and move the cursor backward.
+ *
+ * \param cursor_handle
+ * Handle obtained by k4a_playback_cursor_create().
+ *
+ * \param capture_handle
+ * If successful this contains a handle to a capture object. Caller must call k4a_capture_release() when its done using
+ * this capture.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a capture is returned, or ::K4A_STREAM_RESULT_EOF if the start of the recording is
+ * reached. All other failures will return ::K4A_STREAM_RESULT_FAILED.
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \sa k4a_playback_get_previous_capture()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_cursor_get_previous_capture(k4a_playback_cursor_t cursor_handle,
+                                                                              k4a_capture_t *capture_handle);
+
+/** Read the next IMU sample at a cursor's position, and advance the cursor.
+ *
+ * \param cursor_handle
+ * Handle obtained by k4a_playback_cursor_create().
+ *
+ * \param imu_sample
+ * The location to write the IMU sample.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a sample is returned, or ::K4A_STREAM_RESULT_EOF if the end of the recording is
+ * reached. All other failures will return ::K4A_STREAM_RESULT_FAILED.
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \sa k4a_playback_get_next_imu_sample()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_cursor_get_next_imu_sample(k4a_playback_cursor_t cursor_handle,
+                                                                             k4a_imu_sample_t *imu_sample);
+
+/** Read the previous IMU sample at a cursor's position, and move the cursor backward.
+ *
+ * \param cursor_handle
+ * Handle obtained by k4a_playback_cursor_create().
+ *
+ * \param imu_sample
+ * The location to write the IMU sample.
+ *
+ * \returns
+ * ::K4A_STREAM_RESULT_SUCCEEDED if a sample is returned, or ::K4A_STREAM_RESULT_EOF if the start of the recording is
+ * reached. All other failures will return ::K4A_STREAM_RESULT_FAILED.
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \sa k4a_playback_get_previous_imu_sample()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_cursor_get_previous_imu_sample(k4a_playback_cursor_t cursor_handle,
+                                                                                 k4a_imu_sample_t *imu_sample);
+
+/** Destroys a playback cursor.
+ *
+ * \param cursor_handle
+ * Handle obtained by k4a_playback_cursor_create().
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \relates k4a_playback_cursor_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT void k4a_playback_cursor_destroy(k4a_playback_cursor_t cursor_handle);
+
 /** Closes a recording playback handle.
  *
  * \param playback_handle
@@ -896,6 +1271,11 @@ K4ARECORD_DEPRECATED_EXPORT uint64_t k4a_playback_get_last_timestamp_usec(k4a_pl
  *
  * \relates k4a_playback_t
  *
+ * \remarks
+ * Cursors created with k4a_playback_cursor_create() that are still open keep the recording open, and may keep being
+ * used, including on other threads while the playback handle is closed. The file is closed when the last cursor is
+ * destroyed with k4a_playback_cursor_destroy(). The playback handle itself must not be used after it is closed.
+ *
  * \xmlonly
  * <requirements>
  *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
@@ -906,6 +1286,188 @@ K4ARECORD_DEPRECATED_EXPORT uint64_t k4a_playback_get_last_timestamp_usec(k4a_pl
  */
 K4ARECORD_EXPORT void k4a_playback_close(k4a_playback_t playback_handle);
 
+/** Opens a set of recordings made by externally synchronized devices, for reading together.
+ *
+ * \param paths
+ * Filesystem paths of the existing recordings.
+ *
+ * \param path_count
+ * Number of entries in \p paths.
+ *
+ * \param group_handle
+ * If successful, this contains a pointer to the playback group handle. Caller must call k4a_playback_group_close()
+ * when finished with the recordings.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success. ::K4A_RESULT_FAILED is returned if any of the recordings
+ * fail to open, or were not recorded with ::K4A_WIRED_SYNC_MODE_MASTER or ::K4A_WIRED_SYNC_MODE_SUBORDINATE, or more
+ * than one of the recordings is the master.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \remarks
+ * Each recording is read ahead by its own thread, so reading and decoding of the files happens in parallel.
+ *
+ * \remarks
+ * Captures from all of the recordings are returned in order by k4a_playback_group_get_next_capture(). Subordinate
+ * recordings are aligned to the master by subtracting \p subordinate_delay_off_master_usec from their device
+ * timestamps, so the captures of one synchronized frame are returned next to each other.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_group_open(const char *const *paths,
+                                                      size_t path_count,
+                                                      k4a_playback_group_t *group_handle);
+
+/** Get the number of recordings in a playback group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns The number of recordings, or 0 if \p group_handle is invalid. Recordings are indexed in the same order as
+ * the paths passed to k4a_playback_group_open().
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT size_t k4a_playback_group_get_count(k4a_playback_group_t group_handle);
+
+/** Get the record configuration for one of the recordings in a playback group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \param index
+ * Index of the recording, in the order the paths were passed to k4a_playback_group_open().
+ *
+ * \param config
+ * Location to write the recording configuration.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED if \p config was successfully written. ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \sa k4a_playback_get_record_configuration()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_group_get_record_configuration(k4a_playback_group_t group_handle,
+                                                                          size_t index,
+                                                                          k4a_record_configuration_t *config);
+
+/** Get the camera calibration for one of the recordings in a playback group.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \param index
+ * Index of the recording, in the order the paths were passed to k4a_playback_group_open().
+ *
+ * \param calibration
+ * Location to write the camera calibration.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED if \p calibration was successfully written. ::K4A_RESULT_FAILED otherwise.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \sa k4a_playback_get_calibration()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_playback_group_get_calibration(k4a_playback_group_t group_handle,
+                                                                 size_t index,
+                                                                 k4a_calibration_t *calibration);
+
+/** Read the next capture from a playback group, across all of its recordings.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \param capture_handle
+ * If successful this contains a handle to a capture object. Caller must call k4a_capture_release() when its done using
+ * this capture.
+ *
+ * \param index
+ * If successful this contains the index of the recording the capture was read from. This parameter is optional and
+ * may be NULL.
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \returns ::K4A_STREAM_RESULT_SUCCEEDED if a capture is returned, or ::K4A_STREAM_RESULT_EOF if the end of every
+ * recording has been reached. ::K4A_STREAM_RESULT_FAILED is returned if a recording could not be read.
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \remarks
+ * Captures are returned in order of the earliest image timestamp in each capture, after the subordinate delay is
+ * removed. When captures from several recordings have the same aligned timestamp, they are returned in index order.
+ *
+ * \remarks
+ * This function blocks until the next capture of each recording that has not reached its end has been read.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_stream_result_t k4a_playback_group_get_next_capture(k4a_playback_group_t group_handle,
+                                                                         k4a_capture_t *capture_handle,
+                                                                         size_t *index);
+
+/** Closes a playback group, and all of its recordings.
+ *
+ * \param group_handle
+ * Handle obtained by k4a_playback_group_open().
+ *
+ * \headerfile playback.h <k4arecord/playback.h>
+ *
+ * \relates k4a_playback_group_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">playback.h (include k4arecord/playback.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT void k4a_playback_group_close(k4a_playback_group_t group_handle);
+
 /**
  * @}
  */
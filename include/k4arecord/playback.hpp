@@ -118,6 +118,191 @@ private:
     k4a_playback_data_block_t m_handle;
 };
 
+/** \class playback_cursor playback.hpp <k4arecord/playback.hpp>
+ * Wrapper for \ref k4a_playback_cursor_t
+ *
+ * The cursor must be destroyed before the k4a::playback it was created from is closed.
+ *
+ * \sa k4a_playback_cursor_t
+ */
+class playback_cursor
+{
+public:
+    /** Creates a k4a::playback_cursor from a k4a_playback_cursor_t
+     * Takes ownership of the handle, i.e. you should not call
+     * k4a_playback_cursor_destroy on the handle after giving it to the
+     * k4a::playback_cursor; the k4a::playback_cursor will take care of that.
+     */
+    playback_cursor(k4a_playback_cursor_t handle = nullptr) noexcept : m_handle(handle) {}
+
+    /** Moves another k4a::playback_cursor into a new k4a::playback_cursor
+     */
+    playback_cursor(playback_cursor &&other) noexcept : m_handle(other.m_handle)
+    {
+        other.m_handle = nullptr;
+    }
+
+    playback_cursor(const playback_cursor &) = delete;
+
+    ~playback_cursor()
+    {
+        reset();
+    }
+
+    playback_cursor &operator=(const playback_cursor &) = delete;
+
+    /** Moves another k4a::playback_cursor into this k4a::playback_cursor; other is set to invalid
+     */
+    playback_cursor &operator=(playback_cursor &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+
+        return *this;
+    }
+
+    /** Returns true if the k4a::playback_cursor is valid, false otherwise
+     */
+    explicit operator bool() const noexcept
+    {
+        return is_valid();
+    }
+
+    /** Returns true if the k4a::playback_cursor is valid, false otherwise
+     */
+    bool is_valid() const noexcept
+    {
+        return m_handle != nullptr;
+    }
+
+    /** Destroys the underlying k4a_playback_cursor_t; the k4a::playback_cursor is set to invalid.
+     *
+     * \sa k4a_playback_cursor_destroy
+     */
+    void reset() noexcept
+    {
+        if (m_handle != nullptr)
+        {
+            k4a_playback_cursor_destroy(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    /** Get the next capture at the cursor's position.
+     * Returns true if a capture was available, false if there are none left.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_cursor_get_next_capture
+     */
+    bool get_next_capture(capture *cap)
+    {
+        k4a_capture_t capture_handle;
+        k4a_stream_result_t result = k4a_playback_cursor_get_next_capture(m_handle, &capture_handle);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            *cap = capture(capture_handle);
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get next capture!");
+    }
+
+    /** Get the previous capture at the cursor's position.
+     * Returns true if a capture was available, false if there are none left.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_cursor_get_previous_capture
+     */
+    bool get_previous_capture(capture *cap)
+    {
+        k4a_capture_t capture_handle;
+        k4a_stream_result_t result = k4a_playback_cursor_get_previous_capture(m_handle, &capture_handle);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            *cap = capture(capture_handle);
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get previous capture!");
+    }
+
+    /** Get the next IMU sample at the cursor's position.
+     * Returns true if a sample was available, false if there are none left.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_cursor_get_next_imu_sample
+     */
+    bool get_next_imu_sample(k4a_imu_sample_t *sample)
+    {
+        k4a_stream_result_t result = k4a_playback_cursor_get_next_imu_sample(m_handle, sample);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get next IMU sample!");
+    }
+
+    /** Get the previous IMU sample at the cursor's position.
+     * Returns true if a sample was available, false if there are none left.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_cursor_get_previous_imu_sample
+     */
+    bool get_previous_imu_sample(k4a_imu_sample_t *sample)
+    {
+        k4a_stream_result_t result = k4a_playback_cursor_get_previous_imu_sample(m_handle, sample);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get previous IMU sample!");
+    }
+
+    /** Seeks the cursor to a specific time point in the recording.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_cursor_seek_timestamp
+     */
+    void seek_timestamp(std::chrono::microseconds offset, k4a_playback_seek_origin_t origin)
+    {
+        k4a_result_t result = k4a_playback_cursor_seek_timestamp(m_handle, offset.count(), origin);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to seek recording!");
+        }
+    }
+
+private:
+    k4a_playback_cursor_t m_handle;
+};
+
 /** \class playback playback.hpp <k4arecord/playback.hpp>
  * Wrapper for \ref k4a_playback_t
  *
@@ -276,6 +461,28 @@ public:
         throw error("Failed to get next capture!");
     }
 
+    /** Get the metadata of the next capture in the recording, without reading any image data.
+     * Returns true if a capture was available, false if there are none left.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_get_next_capture_info
+     */
+    bool get_next_capture_info(k4a_playback_capture_info_t *capture_info)
+    {
+        k4a_stream_result_t result = k4a_playback_get_next_capture_info(m_handle, capture_info);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get next capture info!");
+    }
+
     /** Get the previous capture in the recording.
      * Returns true if a capture was available, false if there are none left.
      * Throws error on failure.
@@ -378,6 +585,33 @@ public:
         throw error("Failed to get previous IMU sample!");
     }
 
+    /** Get the IMU samples with device timestamps in [start, end).
+     * Returns the number of samples written to samples, which is 0 if there are none in the range.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_get_imu_samples
+     */
+    size_t get_imu_samples(std::chrono::microseconds start,
+                           std::chrono::microseconds end,
+                           k4a_imu_sample_t *samples,
+                           size_t max_samples)
+    {
+        size_t sample_count = 0;
+        k4a_stream_result_t result = k4a_playback_get_imu_samples(m_handle,
+                                                                  static_cast<uint64_t>(start.count()),
+                                                                  static_cast<uint64_t>(end.count()),
+                                                                  samples,
+                                                                  max_samples,
+                                                                  &sample_count);
+
+        if (K4A_STREAM_RESULT_FAILED == result)
+        {
+            throw error("Failed to get IMU samples!");
+        }
+
+        return sample_count;
+    }
+
     /** Seeks to a specific time point in the recording
      * Throws error on failure.
      *
@@ -419,6 +653,39 @@ public:
         }
     }
 
+    /** Set the number of captures to convert on background threads ahead of get_next_capture().
+     *
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_decode_ahead
+     */
+    void set_decode_ahead(uint32_t capture_count)
+    {
+        k4a_result_t result = k4a_playback_set_decode_ahead(m_handle, capture_count);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set decode ahead!");
+        }
+    }
+
+    /** Enable or disable reading a track during playback. Blocks of disabled tracks are skipped when reading the
+     * recording, and images from disabled tracks are not included in captures.
+     *
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_set_track_enabled
+     */
+    void set_track_enabled(const char *track_name, bool enabled)
+    {
+        k4a_result_t result = k4a_playback_set_track_enabled(m_handle, track_name, enabled);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to set track enabled!");
+        }
+    }
+
     /** Get the next data block in the recording.
      * Returns true if a block was available, false if there are none left.
      * Throws error on failure.
@@ -490,6 +757,24 @@ public:
         return false;
     }
 
+    /** Creates a cursor with its own read position in the recording, starting at the beginning.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_cursor_create
+     */
+    playback_cursor create_cursor() const
+    {
+        k4a_playback_cursor_t handle = nullptr;
+        k4a_result_t result = k4a_playback_cursor_create(m_handle, &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to create playback cursor!");
+        }
+
+        return playback_cursor(handle);
+    }
+
     /** Opens a K4A recording for playback.
      * Throws error on failure.
      *
@@ -512,6 +797,177 @@ private:
     k4a_playback_t m_handle;
 };
 
+/** \class playback_group playback.hpp <k4arecord/playback.hpp>
+ * Wrapper for \ref k4a_playback_group_t
+ *
+ * Wraps a handle for a set of recordings from externally synchronized devices
+ *
+ * \sa k4a_playback_group_t
+ */
+class playback_group
+{
+public:
+    /** Creates a k4a::playback_group from a k4a_playback_group_t
+     * Takes ownership of the handle, i.e. you should not call
+     * k4a_playback_group_close on the handle after giving it to the
+     * k4a::playback_group; the k4a::playback_group will take care of that.
+     */
+    playback_group(k4a_playback_group_t handle = nullptr) noexcept : m_handle(handle) {}
+
+    /** Moves another k4a::playback_group into a new k4a::playback_group
+     */
+    playback_group(playback_group &&other) noexcept : m_handle(other.m_handle)
+    {
+        other.m_handle = nullptr;
+    }
+
+    playback_group(const playback_group &) = delete;
+
+    ~playback_group()
+    {
+        close();
+    }
+
+    playback_group &operator=(const playback_group &) = delete;
+
+    /** Moves another k4a::playback_group into this k4a::playback_group; other is set to invalid
+     */
+    playback_group &operator=(playback_group &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            m_handle = other.m_handle;
+            other.m_handle = nullptr;
+        }
+
+        return *this;
+    }
+
+    /** Returns true if the k4a::playback_group is valid, false otherwise
+     */
+    explicit operator bool() const noexcept
+    {
+        return is_valid();
+    }
+
+    /** Returns true if the k4a::playback_group is valid, false otherwise
+     */
+    bool is_valid() const noexcept
+    {
+        return m_handle != nullptr;
+    }
+
+    /** Closes the recordings in the group.
+     *
+     * \sa k4a_playback_group_close
+     */
+    void close() noexcept
+    {
+        if (m_handle != nullptr)
+        {
+            k4a_playback_group_close(m_handle);
+            m_handle = nullptr;
+        }
+    }
+
+    /** Get the number of recordings in the group.
+     *
+     * \sa k4a_playback_group_get_count
+     */
+    size_t get_count() const noexcept
+    {
+        return k4a_playback_group_get_count(m_handle);
+    }
+
+    /** Gets the configuration of one of the recordings in the group.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_group_get_record_configuration
+     */
+    k4a_record_configuration_t get_record_configuration(size_t index) const
+    {
+        k4a_record_configuration_t config;
+        k4a_result_t result = k4a_playback_group_get_record_configuration(m_handle, index, &config);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read record configuration!");
+        }
+
+        return config;
+    }
+
+    /** Get the camera calibration for the K4A device that made one of the recordings in the group.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_group_get_calibration
+     */
+    calibration get_calibration(size_t index) const
+    {
+        calibration calib;
+        k4a_result_t result = k4a_playback_group_get_calibration(m_handle, index, &calib);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to read device calibration from recording!");
+        }
+
+        return calib;
+    }
+
+    /** Get the next capture across all of the recordings in the group, and the index of the recording it came from.
+     * Returns true if a capture was available, false if there are none left.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_group_get_next_capture
+     */
+    bool get_next_capture(capture *cap, size_t *index = nullptr)
+    {
+        k4a_capture_t capture_handle;
+        k4a_stream_result_t result = k4a_playback_group_get_next_capture(m_handle, &capture_handle, index);
+
+        if (K4A_STREAM_RESULT_SUCCEEDED == result)
+        {
+            *cap = capture(capture_handle);
+            return true;
+        }
+        else if (K4A_STREAM_RESULT_EOF == result)
+        {
+            return false;
+        }
+
+        throw error("Failed to get next capture!");
+    }
+
+    /** Opens a set of K4A recordings from externally synchronized devices for playback.
+     * Throws error on failure.
+     *
+     * \sa k4a_playback_group_open
+     */
+    static playback_group open(const std::vector<std::string> &paths)
+    {
+        std::vector<const char *> path_strings;
+        for (const std::string &path : paths)
+        {
+            path_strings.push_back(path.c_str());
+        }
+
+        k4a_playback_group_t handle = nullptr;
+        k4a_result_t result = k4a_playback_group_open(path_strings.data(), path_strings.size(), &handle);
+
+        if (K4A_RESULT_SUCCEEDED != result)
+        {
+            throw error("Failed to open recordings!");
+        }
+
+        return playback_group(handle);
+    }
+
+private:
+    k4a_playback_group_t m_handle;
+};
+
 } // namespace k4a
 
 #endif
@@ -129,6 +129,77 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_add_tag(k4a_record_t recording_handle,
  */
 K4ARECORD_EXPORT k4a_result_t k4a_record_add_imu_track(k4a_record_t recording_handle);
 
+/** Sets the codec used to store the depth and IR tracks.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param codec
+ * The codec to use for the depth and IR tracks.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * The codec needs to be set before the recording header is written.
+ *
+ * \remarks
+ * By default depth and IR are stored uncompressed using the b16g codec, which is supported by tools such as ffmpeg.
+ * ::K4A_RECORD_DEPTH_CODEC_RVL losslessly compresses each frame on the recording's writer thread, which typically
+ * reduces depth track size by more than half. RVL recordings can be read by the Azure Kinect playback API, but not by
+ * third party tools.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_depth_codec(k4a_record_t recording_handle,
+                                                         k4a_record_depth_codec_t codec);
+
+/** Enables zero-copy captures, where the recording holds a reference to each image instead of copying it.
+ *
+ * \param recording_handle
+ * The handle of a new recording, obtained by k4a_record_create().
+ *
+ * \param enable
+ * True to queue images by reference, false to copy images when they are written (Default).
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * This must be called before the recording header is written.
+ *
+ * \remarks
+ * By default k4a_record_write_capture() copies each image so the capture can be reused immediately. With zero-copy
+ * enabled, k4a_record_write_capture() only adds a reference to each image, and any processing of depth and IR images is
+ * moved to the recording's writer thread. This removes a full frame copy from the calling thread. The references are
+ * released once the images are written to disk, typically about 2 seconds later.
+ *
+ * \remarks
+ * Image buffers must not be modified after the capture is written. Since images are held longer, this may increase the
+ * number of images allocated at a time.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_enable_zero_copy(k4a_record_t recording_handle, bool enable);
+
 /** Adds an attachment to the recording.
  *
  * \param recording_handle
@@ -410,6 +481,79 @@ K4ARECORD_EXPORT k4a_result_t k4a_record_write_custom_track_data(const k4a_recor
                                                                  uint8_t *custom_data,
                                                                  size_t custom_data_size);
 
+/** Limits the amount of memory a recording uses to buffer data that has not been written to disk.
+ *
+ * \param recording_handle
+ * Handle obtained by k4a_record_create().
+ *
+ * \param max_pending_bytes
+ * The maximum size in bytes of the buffered track data, or 0 for no limit (Default).
+ *
+ * \param policy
+ * Whether writes block or drop data when the budget is full.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * Recording data is normally buffered for 2 seconds before it is written so that data from different tracks can be
+ * interleaved in timestamp order. If the disk can't keep up, this buffer grows without limit. Once half of the budget
+ * is used, buffered data is written before the usual delay, and data written after that with an older timestamp will
+ * fail to be recorded.
+ *
+ * \remarks
+ * When the budget is full, ::K4A_RECORD_MEMORY_POLICY_BLOCK blocks k4a_record_write_capture(),
+ * k4a_record_write_imu_sample() and k4a_record_write_custom_track_data() until enough data has been written to disk.
+ * ::K4A_RECORD_MEMORY_POLICY_DROP discards the new data and the write call still succeeds. Dropped data and time spent
+ * blocked are reported by k4a_record_get_stats().
+ *
+ * \remarks
+ * The budget can be changed at any time while recording.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_set_memory_budget(k4a_record_t recording_handle,
+                                                           uint64_t max_pending_bytes,
+                                                           k4a_record_memory_policy_t policy);
+
+/** Gets the write queue statistics of a recording.
+ *
+ * \param recording_handle
+ * Handle obtained by k4a_record_create().
+ *
+ * \param stats
+ * Location to write the recording statistics.
+ *
+ * \headerfile record.h <k4arecord/record.h>
+ *
+ * \relates k4a_record_t
+ *
+ * \returns ::K4A_RESULT_SUCCEEDED is returned on success
+ *
+ * \remarks
+ * Recording data is buffered in memory and written to disk by a background thread. These statistics can be used to
+ * monitor whether the disk is keeping up with the rate data is being recorded. This function may be called from any
+ * thread while the recording is being written.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">record.h (include k4arecord/record.h)</requirement>
+ *   <requirement name="Library">k4arecord.lib</requirement>
+ *   <requirement name="DLL">k4arecord.dll</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4ARECORD_EXPORT k4a_result_t k4a_record_get_stats(k4a_record_t recording_handle, k4a_record_stats_t *stats);
+
 /** Flushes all pending recording data to disk.
  *
  * \param recording_handle
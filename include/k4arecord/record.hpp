@@ -104,6 +104,39 @@ public:
         }
     }
 
+    /** Limits the amount of memory used to buffer data that has not been written to disk
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_memory_budget
+     */
+    void set_memory_budget(uint64_t max_pending_bytes, k4a_record_memory_policy_t policy)
+    {
+        k4a_result_t result = k4a_record_set_memory_budget(m_handle, max_pending_bytes, policy);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set memory budget!");
+        }
+    }
+
+    /** Gets the write queue statistics of the recording
+     * Throws error on failure
+     *
+     * \sa k4a_record_get_stats
+     */
+    k4a_record_stats_t get_stats() const
+    {
+        k4a_record_stats_t stats;
+        k4a_result_t result = k4a_record_get_stats(m_handle, &stats);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to get recording stats!");
+        }
+
+        return stats;
+    }
+
     /** Adds a tag to the recording
      * Throws error on failure
      *
@@ -134,6 +167,36 @@ public:
         }
     }
 
+    /** Sets the codec used to store the depth and IR tracks
+     * Throws error on failure
+     *
+     * \sa k4a_record_set_depth_codec
+     */
+    void set_depth_codec(k4a_record_depth_codec_t codec)
+    {
+        k4a_result_t result = k4a_record_set_depth_codec(m_handle, codec);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to set depth codec!");
+        }
+    }
+
+    /** Enables zero-copy captures, where the recording holds a reference to each image instead of copying it
+     * Throws error on failure
+     *
+     * \sa k4a_record_enable_zero_copy
+     */
+    void enable_zero_copy(bool enable)
+    {
+        k4a_result_t result = k4a_record_enable_zero_copy(m_handle, enable);
+
+        if (K4A_FAILED(result))
+        {
+            throw error("Failed to enable zero-copy!");
+        }
+    }
+
     /** Adds an attachment to the recording
      * Throws error on failure
      *
@@ -48,6 +48,36 @@ K4A_DECLARE_HANDLE(k4a_record_t);
  */
 K4A_DECLARE_HANDLE(k4a_playback_t);
 
+/** \class k4a_playback_cursor_t types.h <k4arecord/types.h>
+ * Handle to an independent read position within a k4a recording opened for playback.
+ *
+ * \remarks
+ * Handles are created with k4a_playback_cursor_create(), and destroyed with k4a_playback_cursor_destroy().
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_playback_cursor_t);
+
+/** \class k4a_playback_group_t types.h <k4arecord/types.h>
+ * Handle to a set of k4a recordings from externally synchronized devices, opened for playback together.
+ *
+ * \remarks
+ * Handles are created with k4a_playback_group_open(), and closed with k4a_playback_group_close().
+ * Invalid handles are set to 0.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+K4A_DECLARE_HANDLE(k4a_playback_group_t);
+
 /** \class k4a_playback_data_block_t types.h <k4arecord/types.h>
  * Handle to a block of data read from a k4a_playback_t custom track.
  *
@@ -147,6 +177,36 @@ typedef enum
     K4A_PLAYBACK_SEEK_DEVICE_TIME /**< Seek to an absolute device timestamp. */
 } k4a_playback_seek_origin_t;
 
+/** Codecs used to store the built-in depth and IR tracks.
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_RECORD_DEPTH_CODEC_B16G = 0, /**< Uncompressed 16-bit big-endian grayscale. (Default) */
+    K4A_RECORD_DEPTH_CODEC_RVL,      /**< Lossless RVL compression, smaller files at a small CPU cost. */
+} k4a_record_depth_codec_t;
+
+/** Behavior of a recording when its memory budget is full.
+ *
+ * \see k4a_record_set_memory_budget()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef enum
+{
+    K4A_RECORD_MEMORY_POLICY_BLOCK = 0, /**< Block the write call until data has been written to disk. (Default) */
+    K4A_RECORD_MEMORY_POLICY_DROP,      /**< Discard the new data and continue. */
+} k4a_record_memory_policy_t;
+
 /**
  * @}
  *
@@ -250,6 +310,103 @@ typedef struct _k4a_record_subtitle_settings_t
     bool high_freq_data;
 } k4a_record_subtitle_settings_t;
 
+/** Structure containing the write queue statistics of a recording.
+ *
+ * \see k4a_record_get_stats()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_record_stats_t
+{
+    /** Number of clusters waiting in the write queue. */
+    uint32_t pending_cluster_count;
+
+    /** Size of the track data buffered in memory that has not been written to disk yet. */
+    uint64_t pending_bytes;
+
+    /** Time range covered by the buffered data, from the end of the last written cluster to the newest timestamp. */
+    uint64_t pending_duration_usec;
+
+    /** Total bytes of cluster data written to the file. */
+    uint64_t bytes_written;
+
+    /**
+     * Average rate cluster data is written to the file, measured only over render_time_usec and flush_time_usec. This
+     * does not wait for the operating system to sync its cache to disk. If this is lower than the rate data is passed
+     * to the recording, the write queue will grow.
+     */
+    uint64_t write_bytes_per_second;
+
+    /** The memory budget set by k4a_record_set_memory_budget(), or 0 if there is no limit. */
+    uint64_t memory_budget;
+
+    /** Number of images, IMU samples, or custom track blocks dropped because the memory budget was full. */
+    uint64_t dropped_count;
+
+    /** Total time write calls spent blocked waiting for space in the memory budget. */
+    uint64_t blocked_time_usec;
+
+    /** Total time spent rendering clusters into the file's write buffer. */
+    uint64_t render_time_usec;
+
+    /**
+     * Total time spent flushing the file's write buffer to the operating system. The buffer is flushed when it is full,
+     * and by k4a_record_flush() and k4a_record_close().
+     */
+    uint64_t flush_time_usec;
+} k4a_record_stats_t;
+
+/** Structure containing the metadata of a single image in a recording, read without loading the image data.
+ *
+ * \see k4a_playback_capture_info_t
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_playback_image_info_t
+{
+    /** True if the capture contains an image from this track. All other fields are 0 if this is false. */
+    bool present;
+
+    /** The device timestamp of the image, matching k4a_image_get_device_timestamp_usec() during playback. */
+    uint64_t device_timestamp_usec;
+
+    /**
+     * Size of the image data as stored in the recording. For compressed tracks such as MJPG or RVL, this is the
+     * compressed size, not the size of the image returned by k4a_playback_get_next_capture().
+     */
+    size_t size;
+} k4a_playback_image_info_t;
+
+/** Structure containing the metadata of a capture in a recording.
+ *
+ * \see k4a_playback_get_next_capture_info()
+ *
+ * \xmlonly
+ * <requirements>
+ *   <requirement name="Header">types.h (include k4arecord/types.h)</requirement>
+ * </requirements>
+ * \endxmlonly
+ */
+typedef struct _k4a_playback_capture_info_t
+{
+    /** Metadata of the color image in the capture. */
+    k4a_playback_image_info_t color;
+
+    /** Metadata of the depth image in the capture. */
+    k4a_playback_image_info_t depth;
+
+    /** Metadata of the IR image in the capture. */
+    k4a_playback_image_info_t ir;
+} k4a_playback_capture_info_t;
+
 /**
  * @}
  */
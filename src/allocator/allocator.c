@@ -113,6 +113,8 @@ typedef struct _capture_context_t
     k4a_image_t image[IMAGE_TYPE_COUNT];
 
     float temperature_c; /** Temperature in Celsius */
+
+    uint64_t arrival_time_nsec; /** Time the capture arrived at capturesync */
 } capture_context_t;
 
 K4A_DECLARE_CONTEXT(k4a_capture_t, capture_context_t);
@@ -290,6 +292,18 @@ long allocator_test_for_leaks(void)
            g_allocated_image_count_imu + g_allocated_image_count_usb_depth + g_allocated_image_count_usb_imu;
 }
 
+void allocator_get_stats(k4a_allocator_stats_t *stats)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stats == NULL);
+
+    stats->user = (uint32_t)g_allocated_image_count_user;
+    stats->color = (uint32_t)g_allocated_image_count_color;
+    stats->depth = (uint32_t)g_allocated_image_count_depth;
+    stats->imu = (uint32_t)g_allocated_image_count_imu;
+    stats->usb_depth = (uint32_t)g_allocated_image_count_usb_depth;
+    stats->usb_imu = (uint32_t)g_allocated_image_count_usb_imu;
+}
+
 void capture_dec_ref(k4a_capture_t capture_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_capture_t, capture_handle);
@@ -470,3 +484,19 @@ float capture_get_temperature_c(k4a_capture_t capture_handle)
     capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
     return capture->temperature_c;
 }
+
+void capture_set_arrival_time_nsec(k4a_capture_t capture_handle, uint64_t time_nsec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_capture_t, capture_handle);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+    capture->arrival_time_nsec = time_nsec;
+}
+
+uint64_t capture_get_arrival_time_nsec(k4a_capture_t capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_capture_t, capture_handle);
+
+    capture_context_t *capture = k4a_capture_t_get_context(capture_handle);
+    return capture->arrival_time_nsec;
+}
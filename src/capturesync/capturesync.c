@@ -7,11 +7,14 @@
 // Dependent libraries
 #include <k4ainternal/handle.h>
 #include <k4ainternal/queue.h>
+#include <k4ainternal/latency_histogram.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/perf_trace.h>
 #include <k4ainternal/common.h>
 
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/envvariable.h>
+#include <azure_c_shared_utility/refcount.h>
 
 // System dependencies
 #include <stdlib.h>
@@ -49,6 +52,10 @@ typedef struct _capturesync_context_t
     volatile bool running;              // We have received start and should be processing data when true.
     LOCK_HANDLE lock;
 
+    latency_histogram_t sync_latency;       // Time from a capture arriving to it being queued in sync_queue
+    latency_histogram_t end_to_end_latency; // Time from the earliest image system timestamp to the capture being popped
+    volatile long dropped_count;      // Captures discarded instead of being queued in sync_queue
+
 } capturesync_context_t;
 
 K4A_DECLARE_CONTEXT(capturesync_t, capturesync_context_t);
@@ -59,6 +66,21 @@ K4A_DECLARE_CONTEXT(capturesync_t, capturesync_context_t);
 #define DEPTH_CAPTURE (false)
 #define COLOR_CAPTURE (true)
 
+// Queues a capture for the user, counting the time it spent waiting in capturesync. When only synchronized captures
+// are wanted, an unmatched capture is discarded instead.
+static void publish_capture(capturesync_context_t *sync, k4a_capture_t capture, bool matched)
+{
+    if (matched || !sync->synchronized_images_only)
+    {
+        latency_histogram_record_since(&sync->sync_latency, capture_get_arrival_time_nsec(capture));
+        queue_push(sync->sync_queue, capture);
+    }
+    else
+    {
+        INC_REF_VAR(sync->dropped_count);
+    }
+}
+
 /**
  * This function is responsible for updating the information in either capturesync_context_t->depth_ir or in
  * capturesync_context_t->color. capturesync_context_t holds the capture, image, and ts for the sample we are currenly
@@ -87,10 +109,7 @@ drop_sample(capturesync_context_t *sync, k4a_wait_result_t *wresult, bool color_
 
         // If drop_into_queue is provided, then that caller wants the capture to placed into the provided queue, if no
         // drop_into_queue is provided, then it is dropped on the floor
-        if (!sync->synchronized_images_only)
-        {
-            queue_push(sync->sync_queue, frame_info->capture);
-        }
+        publish_capture(sync, frame_info->capture, false);
     }
 
     capture_dec_ref(frame_info->capture);
@@ -141,10 +160,7 @@ static void replace_sample(capturesync_context_t *sync, k4a_capture_t capture_ne
               frame_info->ts,
               frame_info->color_capture ? "Color" : "Depth");
 
-    if (!sync->synchronized_images_only)
-    {
-        queue_push(sync->sync_queue, frame_info->capture);
-    }
+    publish_capture(sync, frame_info->capture, false);
     capture_dec_ref(frame_info->capture);
     image_dec_ref(frame_info->image);
 
@@ -185,6 +201,9 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
     k4a_result_t result;
     bool locked = false;
     uint64_t ts_raw_capture = 0;
+    uint64_t arrival_time_nsec = latency_histogram_get_time_nsec();
+
+    PERF_TRACE_BEGIN("capturesync_add_capture");
 
     result = K4A_RESULT_FROM_BOOL(capturesync_handle != NULL);
     if (K4A_SUCCEEDED(result))
@@ -213,6 +232,11 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
         result = K4A_RESULT_FROM_BOOL(capture_raw != NULL);
     }
 
+    if (K4A_SUCCEEDED(result))
+    {
+        capture_set_arrival_time_nsec(capture_raw, arrival_time_nsec);
+    }
+
     // Read the timestamp of the raw sample
     if (K4A_SUCCEEDED(result))
     {
@@ -255,7 +279,7 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
         if (sync->sync_captures == false || sync->disable_sync == true)
         {
             // we are not synchronizing samples, just copy to the queue
-            queue_push(sync->sync_queue, capture_raw);
+            publish_capture(sync, capture_raw, true);
             result = K4A_RESULT_FAILED; // Not an error, just a graceful exit
         }
         else if (!color_capture && sync->waiting_for_clean_depth_ts)
@@ -265,6 +289,7 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
             if (ts_raw_capture / sync->fps_period > 10)
             {
                 sync->depth_captures_dropped++;
+                INC_REF_VAR(sync->dropped_count);
                 result = K4A_RESULT_FAILED; // Not an error, just a graceful exit
             }
             else
@@ -368,8 +393,11 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
                     LOG_INFO("capturesync_link,TS_Color, %10lld, TS_Depth, %10lld,", sync->color.ts, sync->depth_ir.ts);
                 }
 
+                // The merged capture is the depth capture, so count the color capture's wait separately
+                latency_histogram_record_since(&sync->sync_latency,
+                                               capture_get_arrival_time_nsec(sync->color.capture));
                 k4a_capture_t merged = merge_captures(sync->depth_ir.capture, sync->color.capture);
-                queue_push(sync->sync_queue, merged);
+                publish_capture(sync, merged, true);
                 merged = NULL; // No need to call capture_dec_ref() here.
 
                 // Use drop symantic to get another sample from the queue if present. Synchronized sample is
@@ -392,6 +420,8 @@ void capturesync_add_capture(capturesync_t capturesync_handle,
         Unlock(sync->lock);
         locked = false;
     }
+
+    PERF_TRACE_END("capturesync_add_capture");
 }
 
 k4a_result_t capturesync_create(capturesync_t *capturesync_handle)
@@ -562,6 +592,31 @@ void capturesync_stop(capturesync_t capturesync_handle)
     Unlock(sync->lock);
 }
 
+// Counts the time since the oldest image of the capture was received from the sensor
+static void record_end_to_end_latency(capturesync_context_t *sync, k4a_capture_t capture)
+{
+    k4a_image_t images[] = { capture_get_color_image(capture), capture_get_ir_image(capture) };
+    uint64_t oldest_nsec = UINT64_MAX;
+
+    for (size_t i = 0; i < COUNTOF(images); i++)
+    {
+        if (images[i])
+        {
+            uint64_t timestamp_nsec = image_get_system_timestamp_nsec(images[i]);
+            if (timestamp_nsec != 0 && timestamp_nsec < oldest_nsec)
+            {
+                oldest_nsec = timestamp_nsec;
+            }
+            image_dec_ref(images[i]);
+        }
+    }
+
+    if (oldest_nsec != UINT64_MAX)
+    {
+        latency_histogram_record_since(&sync->end_to_end_latency, oldest_nsec);
+    }
+}
+
 k4a_wait_result_t capturesync_get_capture(capturesync_t capturesync_handle,
                                           k4a_capture_t *capture,
                                           int32_t timeout_in_ms)
@@ -575,7 +630,22 @@ k4a_wait_result_t capturesync_get_capture(capturesync_t capturesync_handle,
     k4a_wait_result_t wresult = queue_pop(sync->sync_queue, timeout_in_ms, &capture_handle);
     if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
     {
+        record_end_to_end_latency(sync, capture_handle);
         *capture = capture_handle;
     }
     return wresult;
 }
+
+void capturesync_get_stats(capturesync_t capturesync_handle, k4a_pipeline_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, capturesync_t, capturesync_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stats == NULL);
+    capturesync_context_t *sync = capturesync_t_get_context(capturesync_handle);
+
+    latency_histogram_get(&sync->sync_latency, &stats->capturesync);
+    latency_histogram_get(&sync->end_to_end_latency, &stats->capture_end_to_end);
+    queue_get_stats(sync->depth_ir.queue, &stats->capturesync_depth_queue, NULL);
+    queue_get_stats(sync->color.queue, &stats->capturesync_color_queue, NULL);
+    queue_get_stats(sync->sync_queue, &stats->capture_queue, &stats->capture_pop);
+    stats->capturesync_dropped_count = (uint64_t)sync->dropped_count;
+}
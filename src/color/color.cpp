@@ -5,6 +5,8 @@
 #include <k4ainternal/color.h>
 
 // Dependent libraries
+#include <k4ainternal/capture.h>
+#include <k4ainternal/virtual_device.h>
 
 // System dependencies
 #include <stdlib.h>
@@ -35,6 +37,12 @@ typedef struct _color_context_t
     void *capture_ready_cb_context;
     tickcounter_ms_t sensor_start_time_tick;
     std::array<color_control_cap_t, K4A_COLOR_CONTROL_POWERLINE_FREQUENCY + 1> control_cap = {};
+
+    // Set when the color camera is replayed by a virtual device, which has no controls to apply. The control values
+    // are only stored so they read back as written.
+    virtual_device_t virtual_device;
+    std::array<k4a_color_control_mode_t, K4A_COLOR_CONTROL_POWERLINE_FREQUENCY + 1> virtual_control_mode = {};
+    std::array<int32_t, K4A_COLOR_CONTROL_POWERLINE_FREQUENCY + 1> virtual_control_value = {};
 #ifdef _WIN32
     Microsoft::WRL::ComPtr<CMFCameraReader> m_spCameraReader;
 #else
@@ -44,6 +52,29 @@ typedef struct _color_context_t
 
 K4A_DECLARE_CONTEXT(color_t, color_context_t);
 
+static void color_virtual_image_available(k4a_result_t result, k4a_image_t image_handle, void *context)
+{
+    k4a_capture_t capture = NULL;
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(capture_create(&capture));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        capture_set_color_image(capture, image_handle);
+    }
+
+    color_capture_available(result, capture, context);
+
+    if (capture)
+    {
+        // Valid for the duration of the callback, like the captures of the camera readers
+        capture_dec_ref(capture);
+    }
+}
+
 k4a_result_t color_create(TICK_COUNTER_HANDLE tick_handle,
                           const guid_t *container_id,
                           const char *serial_number,
@@ -65,14 +96,22 @@ k4a_result_t color_create(TICK_COUNTER_HANDLE tick_handle,
         color->capture_ready_cb_context = capture_ready_context;
         color->sensor_start_time_tick = 0;
         color->tick = tick_handle;
+    }
 
+    uint32_t virtual_device_index = 0;
+    if (K4A_SUCCEEDED(result) && virtual_device_find_container_id(container_id, &virtual_device_index))
+    {
+        result = TRACE_CALL(
+            virtual_device_create(virtual_device_index, VIRTUAL_DEVICE_STREAM_COLOR, &color->virtual_device));
+    }
+    else if (K4A_SUCCEEDED(result))
+    {
 #ifdef _WIN32
         (void)(serial_number);
         static_assert(sizeof(guid_t) == sizeof(GUID), "Windows GUID and this guid_t are not the same");
         result = K4A_RESULT_FROM_BOOL(SUCCEEDED(
             Microsoft::WRL::MakeAndInitialize<CMFCameraReader>(&color->m_spCameraReader, (GUID *)container_id)));
 #else
-        (void)(container_id);
         color->m_spCameraReader.reset(new (std::nothrow) UVCCameraReader);
         if (!color->m_spCameraReader)
         {
@@ -105,6 +144,12 @@ void color_destroy(color_t color_handle)
         color->m_spCameraReader->Shutdown();
         color->m_spCameraReader = nullptr;
     }
+
+    if (color->virtual_device)
+    {
+        virtual_device_destroy(color->virtual_device);
+        color->virtual_device = NULL;
+    }
     color_t_destroy(color_handle);
 }
 
@@ -184,7 +229,29 @@ k4a_result_t color_start(color_t color_handle, const k4a_device_configuration_t
 
     result = K4A_RESULT_FROM_BOOL(tickcounter_get_current_ms(color->tick, &color->sensor_start_time_tick) == 0);
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && color->virtual_device)
+    {
+        const virtual_device_file_header_t *header = virtual_device_get_file_header(color->virtual_device);
+        if (header->color_format != (uint32_t)config->color_format ||
+            header->color_resolution != (uint32_t)config->color_resolution)
+        {
+            LOG_ERROR("Virtual device color was captured as format %u resolution %u, which does not match the "
+                      "requested configuration",
+                      header->color_format,
+                      header->color_resolution);
+            result = K4A_RESULT_FAILED;
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            result = TRACE_CALL(virtual_device_stream_start(color->virtual_device,
+                                                            ALLOCATION_SOURCE_COLOR,
+                                                            0, // Color payloads are not size constrained
+                                                            &color_virtual_image_available,
+                                                            color));
+        }
+    }
+    else if (K4A_SUCCEEDED(result))
     {
         result = TRACE_CALL(color->m_spCameraReader->Start(width,
                                                            height,                   // Resolution
@@ -216,6 +283,11 @@ void color_stop(color_t color_handle)
         color->m_spCameraReader->Stop();
     }
 
+    if (color->virtual_device)
+    {
+        virtual_device_stream_stop(color->virtual_device);
+    }
+
     return;
 }
 
@@ -248,7 +320,18 @@ k4a_result_t color_get_control_capabilities(const color_t handle,
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
     color_context_t *color = color_t_get_context(handle);
 
-    if (color->control_cap[command].valid == false)
+    if (color->control_cap[command].valid == false && color->virtual_device)
+    {
+        color_control_cap_t *cap = &color->control_cap[command];
+        cap->minValue = 0;
+        cap->maxValue = INT32_MAX;
+        cap->stepValue = 1;
+        cap->defaultValue = 0;
+        cap->defaultMode = K4A_COLOR_CONTROL_MODE_AUTO;
+        cap->supportAuto = true;
+        cap->valid = true;
+    }
+    else if (color->control_cap[command].valid == false)
     {
         result = color->m_spCameraReader->GetCameraControlCapabilities(command, &(color->control_cap[command]));
     }
@@ -279,6 +362,13 @@ k4a_result_t color_get_control(const color_t handle,
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, value == NULL);
     color_context_t *color = color_t_get_context(handle);
 
+    if (color->virtual_device)
+    {
+        *mode = color->virtual_control_mode[command];
+        *value = color->virtual_control_value[command];
+        return K4A_RESULT_SUCCEEDED;
+    }
+
     return color->m_spCameraReader->GetCameraControl(command, mode, value);
 }
 
@@ -295,6 +385,13 @@ k4a_result_t color_set_control(const color_t handle,
                         mode != K4A_COLOR_CONTROL_MODE_AUTO && mode != K4A_COLOR_CONTROL_MODE_MANUAL);
     color_context_t *color = color_t_get_context(handle);
 
+    if (color->virtual_device)
+    {
+        color->virtual_control_mode[command] = mode;
+        color->virtual_control_value[command] = value;
+        return K4A_RESULT_SUCCEEDED;
+    }
+
     return color->m_spCameraReader->SetCameraControl(command, mode, value);
 }
 
@@ -2,6 +2,7 @@
 #include "ksmetadata.h"
 #include <k4ainternal/common.h>
 #include <k4ainternal/capture.h>
+#include <k4ainternal/perf_trace.h>
 
 #define COLOR_CAMERA_VID 0x045e
 #define COLOR_CAMERA_PID 0x097d // K4A
@@ -1117,6 +1118,7 @@ static void uvc_camerareader_free_allocation(void *buffer, void *context)
 
 void UVCCameraReader::Callback(uvc_frame_t *frame)
 {
+    PERF_TRACE_SCOPE("UVCCameraReader::Callback");
     std::lock_guard<std::mutex> lock(m_mutex);
 
     if (m_streaming && frame)
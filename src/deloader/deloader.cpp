@@ -7,6 +7,11 @@
 #include <k4ainternal/global.h>
 #include <k4ainternal/logging.h>
 #include <k4ainternal/dynlib.h>
+#include <k4ainternal/virtual_device.h>
+#include <azure_c_shared_utility/envvariable.h>
+
+// Name of a depth engine plugin to load instead of the default one, for example a stand-in engine for benchmarking
+#define DELOADER_ENV_PLUGIN_NAME "K4A_DEPTH_ENGINE_PLUGIN"
 
 typedef struct
 {
@@ -14,6 +19,7 @@ typedef struct
     dynlib_t handle;
     k4a_register_plugin_fn registerFn;
     volatile bool loaded;
+    bool has_transform_engine; // False if the plugin left all transform engine functions NULL
 } deloader_global_context_t;
 
 static void deloader_init_once(deloader_global_context_t *global);
@@ -55,10 +61,12 @@ static bool verify_plugin(const k4a_plugin_t *plugin)
     RETURN_VALUE_IF_ARG(false, plugin->depth_engine_process_frame == NULL);
     RETURN_VALUE_IF_ARG(false, plugin->depth_engine_get_output_frame_size == NULL);
     RETURN_VALUE_IF_ARG(false, plugin->depth_engine_destroy == NULL);
-    RETURN_VALUE_IF_ARG(false, plugin->transform_engine_create_and_initialize == NULL);
-    RETURN_VALUE_IF_ARG(false, plugin->transform_engine_process_frame == NULL);
-    RETURN_VALUE_IF_ARG(false, plugin->transform_engine_get_output_frame_size == NULL);
-    RETURN_VALUE_IF_ARG(false, plugin->transform_engine_destroy == NULL);
+
+    // The transform engine is optional, but its function pointers must be all set or all NULL
+    bool has_transform_engine = plugin->transform_engine_create_and_initialize != NULL;
+    RETURN_VALUE_IF_ARG(false, (plugin->transform_engine_process_frame != NULL) != has_transform_engine);
+    RETURN_VALUE_IF_ARG(false, (plugin->transform_engine_get_output_frame_size != NULL) != has_transform_engine);
+    RETURN_VALUE_IF_ARG(false, (plugin->transform_engine_destroy != NULL) != has_transform_engine);
 
     return true;
 }
@@ -68,11 +76,18 @@ static void deloader_init_once(deloader_global_context_t *global)
 {
     // All members are initialized to zero
 
-    k4a_result_t result = dynlib_create(K4A_PLUGIN_DYNAMIC_LIBRARY_NAME, K4A_PLUGIN_VERSION, &global->handle);
+    const char *plugin_name = environment_get_variable(DELOADER_ENV_PLUGIN_NAME);
+    if (plugin_name == NULL || plugin_name[0] == '\0')
+    {
+        // Virtual devices stream payloads only their own depth engine can decode
+        plugin_name = virtual_device_get_count() > 0 ? VIRTUAL_DEVICE_DEPTH_ENGINE_NAME :
+                                                       K4A_PLUGIN_DYNAMIC_LIBRARY_NAME;
+    }
+
+    k4a_result_t result = dynlib_create(plugin_name, K4A_PLUGIN_VERSION, &global->handle);
     if (K4A_FAILED(result))
     {
-        LOG_ERROR("Failed to Load Depth Engine Plugin (%s). Depth functionality will not work",
-                  K4A_PLUGIN_DYNAMIC_LIBRARY_NAME);
+        LOG_ERROR("Failed to Load Depth Engine Plugin (%s). Depth functionality will not work", plugin_name);
         LOG_ERROR("Make sure the depth engine plugin is in your loaders path", 0);
     }
 
@@ -93,6 +108,7 @@ static void deloader_init_once(deloader_global_context_t *global)
 
     if (K4A_SUCCEEDED(result))
     {
+        global->has_transform_engine = global->plugin.transform_engine_create_and_initialize != NULL;
         global->loaded = true;
     }
 }
@@ -187,6 +203,12 @@ k4a_depth_engine_result_code_t deloader_transform_engine_create_and_initialize(k
         return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
     }
 
+    if (!global->has_transform_engine)
+    {
+        LOG_ERROR("Depth engine plugin does not provide a transform engine", 0);
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
+    }
+
     return global->plugin.transform_engine_create_and_initialize(context,
                                                                  camera_calibration,
                                                                  callback,
@@ -209,7 +231,7 @@ deloader_transform_engine_process_frame(k4a_transform_engine_context_t *context,
 {
     deloader_global_context_t *global = deloader_global_context_t_get();
 
-    if (!is_plugin_loaded(global))
+    if (!is_plugin_loaded(global) || !global->has_transform_engine)
     {
         return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_ENGINE_NOT_LOADED;
     }
@@ -233,7 +255,7 @@ size_t deloader_transform_engine_get_output_frame_size(k4a_transform_engine_cont
 {
     deloader_global_context_t *global = deloader_global_context_t_get();
 
-    if (!is_plugin_loaded(global))
+    if (!is_plugin_loaded(global) || !global->has_transform_engine)
     {
         return 0;
     }
@@ -245,7 +267,7 @@ void deloader_transform_engine_destroy(k4a_transform_engine_context_t **context)
 {
     deloader_global_context_t *global = deloader_global_context_t_get();
 
-    if (!is_plugin_loaded(global))
+    if (!is_plugin_loaded(global) || !global->has_transform_engine)
     {
         return;
     }
@@ -253,6 +275,13 @@ void deloader_transform_engine_destroy(k4a_transform_engine_context_t **context)
     global->plugin.transform_engine_destroy(context);
 }
 
+bool deloader_has_transform_engine(void)
+{
+    deloader_global_context_t *global = deloader_global_context_t_get();
+    // A plugin that failed to load is reported by the transform engine functions, not as a missing transform engine
+    return !is_plugin_loaded(global) || global->has_transform_engine;
+}
+
 void deloader_deinit(void)
 {
     deloader_global_context_t *global = deloader_global_context_t_get();
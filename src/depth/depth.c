@@ -439,6 +439,15 @@ void depth_stop_internal(depth_t depth_handle, bool quiet)
     depth->running = false;
 }
 
+void depth_get_stats(depth_t depth_handle, k4a_pipeline_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, depth_t, depth_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stats == NULL);
+
+    depth_context_t *depth = depth_t_get_context(depth_handle);
+    dewrapper_get_stats(depth->dewrapper, stats);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -8,6 +8,8 @@
 #include <k4ainternal/queue.h>
 #include <k4ainternal/calibration.h>
 #include <k4ainternal/deloader.h>
+#include <k4ainternal/latency_histogram.h>
+#include <k4ainternal/perf_trace.h>
 #include <azure_c_shared_utility/threadapi.h>
 #include <azure_c_shared_utility/condition.h>
 #include <azure_c_shared_utility/tickcounter.h>
@@ -45,6 +47,10 @@ typedef struct _dewrapper_context_t
 
     k4a_depth_engine_context_t *depth_engine;
 
+    latency_histogram_t usb_latency;          // USB transfer completion to the raw capture being popped off queue
+    latency_histogram_t depth_engine_latency; // Duration of deloader_depth_engine_process_frame()
+    volatile long dropped_count;              // Raw captures dropped by the depth engine thread
+
 } dewrapper_context_t;
 
 typedef struct _shared_image_context_t
@@ -222,12 +228,19 @@ static int depth_engine_thread(void *param)
             result = K4A_RESULT_FAILED;
         }
 
+        PERF_TRACE_BEGIN("depth_engine_thread");
+
         if (K4A_SUCCEEDED(result))
         {
             image_raw = capture_get_ir_image(capture_raw);
             result = K4A_RESULT_FROM_BOOL(image_raw != NULL);
         }
 
+        if (K4A_SUCCEEDED(result))
+        {
+            latency_histogram_record_since(&dewrapper->usb_latency, image_get_system_timestamp_nsec(image_raw));
+        }
+
         if (K4A_SUCCEEDED(result))
         {
             raw_image_buffer = image_get_buffer(image_raw);
@@ -249,6 +262,8 @@ static int depth_engine_thread(void *param)
             tickcounter_ms_t stop_time = 0;
 
             tickcounter_get_current_ms(dewrapper->tick, &start_time);
+            uint64_t start_time_nsec = latency_histogram_get_time_nsec();
+            PERF_TRACE_BEGIN("deloader_depth_engine_process_frame");
             k4a_depth_engine_result_code_t deresult =
                 deloader_depth_engine_process_frame(dewrapper->depth_engine,
                                                     raw_image_buffer,
@@ -258,6 +273,8 @@ static int depth_engine_thread(void *param)
                                                     depth_engine_output_buffer_size,
                                                     &outputCaptureInfo,
                                                     NULL);
+            PERF_TRACE_END("deloader_depth_engine_process_frame");
+            latency_histogram_record_since(&dewrapper->depth_engine_latency, start_time_nsec);
             tickcounter_get_current_ms(dewrapper->tick, &stop_time);
             if (deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_WAIT_PROCESSING_COMPLETE_FAILED ||
                 deresult == K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT)
@@ -398,9 +415,13 @@ static int depth_engine_thread(void *param)
 
         if (dropped)
         {
+            INC_REF_VAR(dewrapper->dropped_count);
+
             // It is not a fatal error when we drop a frame, so we reset 'result' so that we can continue to run.
             result = K4A_RESULT_SUCCEEDED;
         }
+
+        PERF_TRACE_END("depth_engine_thread");
     }
 
     if (K4A_FAILED(result))
@@ -592,3 +613,15 @@ void dewrapper_stop(dewrapper_t dewrapper_handle)
 
     queue_disable(dewrapper->queue);
 }
+
+void dewrapper_get_stats(dewrapper_t dewrapper_handle, k4a_pipeline_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, dewrapper_t, dewrapper_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stats == NULL);
+    dewrapper_context_t *dewrapper = dewrapper_t_get_context(dewrapper_handle);
+
+    latency_histogram_get(&dewrapper->usb_latency, &stats->usb_to_depth_engine);
+    latency_histogram_get(&dewrapper->depth_engine_latency, &stats->depth_engine);
+    queue_get_stats(dewrapper->queue, &stats->depth_engine_queue, NULL);
+    stats->depth_engine_dropped_count = (uint64_t)dewrapper->dropped_count;
+}
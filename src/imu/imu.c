@@ -56,6 +56,7 @@ typedef struct _imu_context_t
     colormcu_t color_mcu;
     queue_t queue;
     uint32_t dropped_count;
+    uint64_t dropped_total; // Like dropped_count, but not reset when logged
     float temperature;
 
     k4a_calibration_imu_t gyro_calibration;
@@ -175,6 +176,7 @@ void imu_capture_ready(k4a_result_t result, k4a_image_t image, void *p_context)
                 {
                     result = K4A_RESULT_FAILED; // dropping this IMU sample
                     p_imu->dropped_count++;
+                    p_imu->dropped_total++;
                 }
                 else
                 {
@@ -588,6 +590,16 @@ void imu_stop(imu_t imu_handle)
     p_imu->running = false;
 }
 
+void imu_get_stats(imu_t imu_handle, k4a_pipeline_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, imu_t, imu_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stats == NULL);
+    imu_context_t *p_imu = imu_t_get_context(imu_handle);
+
+    queue_get_stats(p_imu->queue, &stats->imu_queue, &stats->imu_pop);
+    stats->imu_dropped_count = p_imu->dropped_total;
+}
+
 /**
  *  Function returning a pointer to extrinsic calibration of gyro.
  *
@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/latency_histogram.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <azure_c_shared_utility/refcount.h>
+
+// System dependencies
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define LATENCY_HISTOGRAM_SUB_BUCKET_BITS (3)
+#define LATENCY_HISTOGRAM_SUB_BUCKET_COUNT (1 << LATENCY_HISTOGRAM_SUB_BUCKET_BITS)
+
+uint64_t latency_histogram_get_time_nsec(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER qpc = { 0 }, freq = { 0 };
+    if (QueryPerformanceCounter(&qpc) == 0 || QueryPerformanceFrequency(&freq) == 0)
+    {
+        return 0;
+    }
+
+    // Same conversion as image_apply_system_timestamp(), so latencies can be measured from image system timestamps
+    return (uint64_t)(qpc.QuadPart / freq.QuadPart * 1000000000 +
+                      qpc.QuadPart % freq.QuadPart * 1000000000 / freq.QuadPart);
+#else
+    struct timespec ts_time;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts_time) != 0)
+    {
+        return 0;
+    }
+    return (uint64_t)ts_time.tv_sec * 1000000000 + (uint64_t)ts_time.tv_nsec;
+#endif
+}
+
+uint32_t latency_histogram_get_bucket(uint64_t latency_usec)
+{
+    if (latency_usec < LATENCY_HISTOGRAM_SUB_BUCKET_COUNT)
+    {
+        return (uint32_t)latency_usec;
+    }
+
+    uint32_t msb = 0;
+    for (uint64_t value = latency_usec; value > 1; value >>= 1)
+    {
+        msb++;
+    }
+
+    // The top bits below the most significant bit select the sub bucket within the power of two range
+    uint32_t shift = msb - LATENCY_HISTOGRAM_SUB_BUCKET_BITS;
+    uint32_t sub_bucket = (uint32_t)(latency_usec >> shift) & (LATENCY_HISTOGRAM_SUB_BUCKET_COUNT - 1);
+    uint32_t bucket = LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + shift * LATENCY_HISTOGRAM_SUB_BUCKET_COUNT + sub_bucket;
+
+    return bucket < K4A_LATENCY_HISTOGRAM_BUCKET_COUNT ? bucket : K4A_LATENCY_HISTOGRAM_BUCKET_COUNT - 1;
+}
+
+void latency_histogram_record_usec(latency_histogram_t *histogram, uint64_t latency_usec)
+{
+    INC_REF_VAR(histogram->buckets[latency_histogram_get_bucket(latency_usec)]);
+}
+
+void latency_histogram_record_since(latency_histogram_t *histogram, uint64_t start_nsec)
+{
+    uint64_t now_nsec = latency_histogram_get_time_nsec();
+    if (start_nsec != 0 && now_nsec >= start_nsec)
+    {
+        latency_histogram_record_usec(histogram, (now_nsec - start_nsec) / 1000);
+    }
+}
+
+// Largest latency counted by a bucket
+static uint64_t latency_histogram_bucket_upper_usec(uint32_t bucket)
+{
+    return K4A_LATENCY_HISTOGRAM_BUCKET_LOWER_USEC(bucket + 1) - 1;
+}
+
+void latency_histogram_get(const latency_histogram_t *histogram, k4a_latency_histogram_t *result)
+{
+    const uint32_t permille[] = { 500, 900, 990, 999 };
+    uint64_t *percentiles[] = { &result->p50_usec, &result->p90_usec, &result->p99_usec, &result->p999_usec };
+
+    memset(result, 0, sizeof(*result));
+    for (uint32_t i = 0; i < K4A_LATENCY_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        result->buckets[i] = (uint32_t)histogram->buckets[i];
+        result->count += result->buckets[i];
+    }
+
+    uint64_t cumulative = 0;
+    uint32_t percentile = 0;
+    for (uint32_t i = 0; i < K4A_LATENCY_HISTOGRAM_BUCKET_COUNT; i++)
+    {
+        if (result->buckets[i] == 0)
+        {
+            continue;
+        }
+
+        cumulative += result->buckets[i];
+        while (percentile < COUNTOF(permille) && cumulative * 1000 >= result->count * permille[percentile])
+        {
+            *percentiles[percentile++] = latency_histogram_bucket_upper_usec(i);
+        }
+        result->max_usec = latency_histogram_bucket_upper_usec(i);
+    }
+}
@@ -12,9 +12,16 @@
 #include <azure_c_shared_utility/threadapi.h>
 
 // System dependencies
+#include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
 
 // External dependencies
 
@@ -24,6 +31,7 @@
 #pragma warning(disable : 4702)
 #endif
 #include <spdlog/spdlog.h>
+#include <spdlog/details/os.h>
 #ifdef _MSC_VER
 #pragma warning(default : 4702)
 #endif
@@ -47,9 +55,67 @@ extern "C" {
 
 static const char K4A_ENABLE_LOG_TO_STDOUT[] = "K4A_ENABLE_LOG_TO_STDOUT";
 static const char K4A_LOG_LEVEL[] = "K4A_LOG_LEVEL";
+static const char K4A_LOG_ASYNC[] = "K4A_LOG_ASYNC";
 static const char K4A_LOG_FILE_NAME[] = "k4a.log";
 static size_t K4A_LOG_FILE_50MB_MAX_SIZE = (1048576 * 50);
 
+// Size of a formatted message, longer messages are truncated
+#define LOG_MESSAGE_MAX_SIZE (1024)
+
+// Number of messages the asynchronous queue holds before new messages are dropped, must be a power of 2
+#define LOG_ASYNC_QUEUE_SIZE (256)
+
+// How long the asynchronous logging thread sleeps before checking for messages that arrived without a wake up
+#define LOG_ASYNC_IDLE_WAIT_MS (100)
+
+// How long logger_deinit waits for the asynchronous logging thread to deliver the queued messages
+#define LOG_ASYNC_STOP_TIMEOUT_MS (1000)
+
+// Pattern of the stdout and file logger, and of the prefix written by the asynchronous logging thread in its place
+//[2018-08-27 10:44:23.218] [level] [threadID] <message>
+#define LOG_PATTERN "[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [t=%t] %v"
+#define LOG_ASYNC_PATTERN "%v"
+
+// A message waiting in the asynchronous queue
+typedef struct _logger_async_message_t
+{
+    // Equal to the queue position when the slot is free for a producer, and position + 1 once the message is written
+    std::atomic<uint32_t> sequence;
+
+    k4a_log_level_t level;
+    const char *file;
+    int line;
+
+    // Time and thread of the logger_log() call, the sink would otherwise record those of the logging thread
+    std::chrono::system_clock::time_point time;
+    size_t thread_id;
+
+    char message[LOG_MESSAGE_MAX_SIZE];
+} logger_async_message_t;
+
+// Bounded multi producer, single consumer queue of formatted messages. Producers claim a slot with a compare and
+// swap and never block; the logging thread delivers the messages to the sinks in order.
+typedef struct _logger_async_t
+{
+    logger_async_message_t messages[LOG_ASYNC_QUEUE_SIZE];
+    std::atomic<uint32_t> enqueue_position;
+    std::atomic<uint32_t> delivered_position; // Written by the logging thread only
+    std::atomic<uint32_t> dropped_count;
+
+    // Most verbose level any sink accepts, or -1 when no sink is enabled. Lets producers filter messages without
+    // taking the global lock.
+    std::atomic<int> max_level;
+
+    std::atomic<bool> running;
+    std::atomic<bool> stopping;
+    bool exited; // Protected by wake_lock
+    std::mutex wake_lock;
+    std::mutex deliver_lock; // Held while delivering, so the logging thread and logger_async_stop() never both deliver
+    std::condition_variable wake;
+    std::condition_variable delivered;
+    std::thread thread;
+} logger_async_t;
+
 typedef struct
 {
     k4a_rwlock_t lock;
@@ -63,10 +129,15 @@ typedef struct
     std::shared_ptr<spdlog::logger> env_logger;
     bool env_logger_is_file_based;
     k4a_log_level_t env_log_level;
+
+    // Set when K4A_LOG_ASYNC is enabled. Not freed on deinit, as other threads may still be logging.
+    logger_async_t *async;
 } logger_global_context_t;
 
 static void logger_init_once(logger_global_context_t *global);
 static void logger_deinit();
+static void logger_async_start(logger_global_context_t *global);
+static void logger_async_update_level(logger_global_context_t *global);
 
 // Creates a function called logger_global_context_t_get() which returns the initialized
 // singleton global
@@ -99,6 +170,9 @@ k4a_result_t logger_register_message_callback(k4a_logging_message_cb_t *message_
         RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, min_level > K4A_LOG_LEVEL_OFF);
     }
 
+    // Messages logged before the change still go to the previous callback, as they would without K4A_LOG_ASYNC
+    logger_flush();
+
     rwlock_acquire_write(&g_context->lock);
 
     // The user may set the callback,  clear the callback, or set the callback to the
@@ -110,6 +184,7 @@ k4a_result_t logger_register_message_callback(k4a_logging_message_cb_t *message_
         g_context->user_log_level = min_level;
         g_context->user_callback = message_cb;
         g_context->user_callback_context = message_cb_context;
+        logger_async_update_level(g_context);
     }
     else
     {
@@ -210,9 +285,8 @@ static void logger_init_once(logger_global_context_t *global)
     {
         global->env_log_level = K4A_LOG_LEVEL_ERROR;
 
-        //[2018-08-27 10:44:23.218] [level] [threadID] <message>
         // https://github.com/gabime/spdlog/wiki/3.-Custom-formatting
-        spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%^%l%$] [t=%t] %v");
+        spdlog::set_pattern(LOG_PATTERN);
 
         // Set the default logging level SPD will allow. g_env_log_level will furthar refine this.
         spdlog::set_level(spdlog::level::trace);
@@ -249,12 +323,340 @@ static void logger_init_once(logger_global_context_t *global)
 
         global->env_logger->flush_on(spdlog::level::warn);
     }
+
+    const char *enable_async_logging = environment_get_variable(K4A_LOG_ASYNC);
+    if (enable_async_logging && enable_async_logging[0] != '\0' && enable_async_logging[0] != '0')
+    {
+        logger_async_start(global);
+    }
+}
+
+static void logger_async_update_level(logger_global_context_t *global)
+{
+    if (global->async == nullptr)
+    {
+        return;
+    }
+
+    int max_level = -1;
+    if (global->env_logger && global->env_log_level != K4A_LOG_LEVEL_OFF)
+    {
+        max_level = (int)global->env_log_level;
+    }
+    if (global->user_callback && global->user_log_level != K4A_LOG_LEVEL_OFF && global->user_log_level > max_level)
+    {
+        max_level = (int)global->user_log_level;
+    }
+    global->async->max_level.store(max_level);
+}
+
+// Delivers a formatted message to the registered callback and the stdout or file logger. The caller must hold the
+// global lock for read. prefix is written before the file name by the stdout or file logger.
+static void logger_deliver(logger_global_context_t *g_context,
+                           k4a_log_level_t level,
+                           const char *file,
+                           const int line,
+                           const char *buffer,
+                           const char *prefix)
+{
+    if ((level <= g_context->user_log_level) && (g_context->user_log_level != K4A_LOG_LEVEL_OFF))
+    {
+        if (g_context->user_callback)
+        {
+            g_context->user_callback(g_context->user_callback_context, level, file, line, buffer);
+        }
+    }
+
+    if ((level <= g_context->env_log_level) && (g_context->env_log_level != K4A_LOG_LEVEL_OFF))
+    {
+        if (g_context->env_logger)
+        {
+            switch (level)
+            {
+            case K4A_LOG_LEVEL_CRITICAL:
+                g_context->env_logger->critical("{0}{1} ({2}): {3}", prefix, file, line, buffer);
+                break;
+            case K4A_LOG_LEVEL_ERROR:
+                g_context->env_logger->error("{0}{1} ({2}): {3}", prefix, file, line, buffer);
+                break;
+            case K4A_LOG_LEVEL_WARNING:
+                g_context->env_logger->warn("{0}{1} ({2}): {3}", prefix, file, line, buffer);
+                break;
+            case K4A_LOG_LEVEL_INFO:
+                g_context->env_logger->info("{0}{1} ({2}): {3}", prefix, file, line, buffer);
+                break;
+            case K4A_LOG_LEVEL_TRACE:
+            default:
+                g_context->env_logger->trace("{0}{1} ({2}): {3}", prefix, file, line, buffer);
+                break;
+            }
+        }
+    }
+}
+
+// Formats the part of LOG_PATTERN that precedes the message with the time and thread of the logger_log() call
+static void logger_async_format_prefix(k4a_log_level_t level,
+                                       std::chrono::system_clock::time_point time_point,
+                                       size_t thread_id,
+                                       char *prefix,
+                                       size_t prefix_size)
+{
+    // Level names used by spdlog
+    static const char *level_names[] = { "critical", "error", "warning", "info", "trace" };
+    const char *level_name = level_names[K4A_LOG_LEVEL_TRACE];
+    if (level >= K4A_LOG_LEVEL_CRITICAL && level <= K4A_LOG_LEVEL_TRACE)
+    {
+        level_name = level_names[level];
+    }
+
+    std::tm time = spdlog::details::os::localtime(std::chrono::system_clock::to_time_t(time_point));
+    auto since_epoch = std::chrono::duration_cast<std::chrono::milliseconds>(time_point.time_since_epoch());
+    int milliseconds = (int)(since_epoch.count() % 1000);
+
+    snprintf(prefix,
+             prefix_size,
+             "[%04d-%02d-%02d %02d:%02d:%02d.%03d] [%s] [t=%zu] ",
+             time.tm_year + 1900,
+             time.tm_mon + 1,
+             time.tm_mday,
+             time.tm_hour,
+             time.tm_min,
+             time.tm_sec,
+             milliseconds,
+             level_name,
+             thread_id);
+}
+
+// Delivers the messages that are ready in the asynchronous queue. Returns the number of messages delivered. Called
+// with deliver_lock held.
+static uint32_t logger_async_deliver_ready(logger_global_context_t *g_context)
+{
+    logger_async_t *async = g_context->async;
+    uint32_t position = async->delivered_position.load();
+    uint32_t delivered = 0;
+    char prefix[128];
+
+    rwlock_acquire_read(&g_context->lock);
+
+    for (;;)
+    {
+        logger_async_message_t *message = &async->messages[position & (LOG_ASYNC_QUEUE_SIZE - 1)];
+        if (message->sequence.load(std::memory_order_acquire) != position + 1)
+        {
+            // Empty, or a producer has claimed the slot and is still formatting the message
+            break;
+        }
+
+        prefix[0] = '\0';
+        if (g_context->env_logger && message->level <= g_context->env_log_level)
+        {
+            logger_async_format_prefix(message->level, message->time, message->thread_id, prefix, sizeof(prefix));
+        }
+        logger_deliver(g_context, message->level, message->file, message->line, message->message, prefix);
+
+        // Release the slot for the producer that wraps around to it
+        message->sequence.store(position + LOG_ASYNC_QUEUE_SIZE, std::memory_order_release);
+        position++;
+        delivered++;
+    }
+
+    // Messages are dropped while the queue is full, so they were logged after the ones just delivered. Reporting
+    // them before delivered_position is updated lets logger_flush() callers see the report.
+    uint32_t dropped = async->dropped_count.exchange(0);
+    if (dropped != 0)
+    {
+        char buffer[LOG_MESSAGE_MAX_SIZE];
+        snprintf(buffer, sizeof(buffer), "%u log messages were dropped, the asynchronous log queue was full", dropped);
+
+        prefix[0] = '\0';
+        if (g_context->env_logger && K4A_LOG_LEVEL_WARNING <= g_context->env_log_level)
+        {
+            logger_async_format_prefix(K4A_LOG_LEVEL_WARNING,
+                                       std::chrono::system_clock::now(),
+                                       spdlog::details::os::thread_id(),
+                                       prefix,
+                                       sizeof(prefix));
+        }
+        logger_deliver(g_context, K4A_LOG_LEVEL_WARNING, __FILE__, __LINE__, buffer, prefix);
+    }
+
+    rwlock_release_read(&g_context->lock);
+
+    if (delivered != 0)
+    {
+        std::lock_guard<std::mutex> lock(async->wake_lock);
+        async->delivered_position.store(position);
+        async->delivered.notify_all();
+    }
+
+    return delivered;
+}
+
+static void logger_async_thread(logger_global_context_t *g_context)
+{
+    logger_async_t *async = g_context->async;
+
+    while (!async->stopping.load())
+    {
+        uint32_t delivered;
+        {
+            std::lock_guard<std::mutex> deliver(async->deliver_lock);
+            delivered = logger_async_deliver_ready(g_context);
+        }
+
+        if (delivered == 0)
+        {
+            // Producers notify without taking wake_lock so they never block, which means a wake up can be missed.
+            // The timeout bounds the delay of such a message.
+            std::unique_lock<std::mutex> lock(async->wake_lock);
+            async->wake.wait_for(lock, std::chrono::milliseconds(LOG_ASYNC_IDLE_WAIT_MS));
+        }
+    }
+
+    // Deliver whatever was queued before the stop
+    {
+        std::lock_guard<std::mutex> deliver(async->deliver_lock);
+        logger_async_deliver_ready(g_context);
+    }
+
+    std::lock_guard<std::mutex> lock(async->wake_lock);
+    async->exited = true;
+    async->delivered.notify_all();
+}
+
+static void logger_async_start(logger_global_context_t *global)
+{
+    logger_async_t *async = new (std::nothrow) logger_async_t();
+    if (async == nullptr)
+    {
+        printf("ERROR: Logger unable to allocate the asynchronous log queue.\n");
+        return;
+    }
+
+    for (uint32_t i = 0; i < LOG_ASYNC_QUEUE_SIZE; i++)
+    {
+        async->messages[i].sequence.store(i);
+    }
+    global->async = async;
+    logger_async_update_level(global);
+
+    try
+    {
+        async->thread = std::thread(logger_async_thread, global);
+        async->running.store(true);
+
+        // The logging thread writes the time and thread of each message itself
+        if (global->env_logger)
+        {
+            global->env_logger->set_pattern(LOG_ASYNC_PATTERN);
+        }
+    }
+    catch (std::system_error &)
+    {
+        // Fall back to delivering messages on the calling thread
+        printf("ERROR: Logger unable to start the asynchronous logging thread.\n");
+    }
+}
+
+static void logger_async_stop(logger_global_context_t *g_context)
+{
+    logger_async_t *async = g_context->async;
+    if (async == nullptr || !async->running.load())
+    {
+        return;
+    }
+
+    async->stopping.store(true);
+    async->wake.notify_one();
+
+    // This runs from a static destructor, where joining a thread deadlocks on Windows as the thread cannot exit while
+    // the loader lock is held. Wait for the thread to signal it delivered the queued messages instead, and only for a
+    // bounded time, as the thread may already have been terminated on process exit.
+    {
+        std::unique_lock<std::mutex> lock(async->wake_lock);
+        async->delivered.wait_for(lock, std::chrono::milliseconds(LOG_ASYNC_STOP_TIMEOUT_MS), [async]() {
+            return async->exited;
+        });
+    }
+    async->thread.detach();
+
+    // Later messages are delivered on the calling thread
+    async->running.store(false);
+
+    // Deliver the messages queued after the logging thread's last pass, or left behind by a thread that was terminated
+    // or timed out. Skipped if the thread holds deliver_lock, as it is still delivering or was terminated doing so.
+    std::unique_lock<std::mutex> deliver(async->deliver_lock, std::try_to_lock);
+    if (deliver.owns_lock())
+    {
+        logger_async_deliver_ready(g_context);
+    }
+
+    std::lock_guard<std::mutex> lock(async->wake_lock);
+    async->delivered.notify_all();
+}
+
+// Formats a message into a free slot of the asynchronous queue without blocking. Returns false if the queue is full.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((__format__(__printf__, 5, 0)))
+#endif
+static bool logger_async_enqueue(logger_async_t *async,
+                                 k4a_log_level_t level,
+                                 const char *file,
+                                 const int line,
+                                 const char *format,
+                                 va_list args)
+{
+    logger_async_message_t *message = nullptr;
+    uint32_t position = async->enqueue_position.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        message = &async->messages[position & (LOG_ASYNC_QUEUE_SIZE - 1)];
+        int32_t diff = (int32_t)(message->sequence.load(std::memory_order_acquire) - position);
+        if (diff == 0)
+        {
+            if (async->enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds a message from the previous lap, the queue is full
+            async->dropped_count++;
+            return false;
+        }
+        else
+        {
+            position = async->enqueue_position.load(std::memory_order_relaxed);
+        }
+    }
+
+    message->level = level;
+    message->file = file;
+    message->line = line;
+    message->time = std::chrono::system_clock::now();
+    message->thread_id = spdlog::details::os::thread_id();
+#ifndef _WIN32
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#endif
+    vsnprintf(message->message, sizeof(message->message), format, args);
+#ifndef _WIN32
+#pragma GCC diagnostic pop
+#endif
+    message->sequence.store(position + 1, std::memory_order_release);
+
+    async->wake.notify_one();
+    return true;
 }
 
 void logger_deinit(void)
 {
     logger_global_context_t *g_context = logger_global_context_t_get();
 
+    // Drain the asynchronous queue while the env logger still exists
+    logger_async_stop(g_context);
+
     rwlock_acquire_write(&g_context->lock);
 
     g_context->env_logger = nullptr;
@@ -262,14 +664,47 @@ void logger_deinit(void)
     rwlock_release_write(&g_context->lock);
 }
 
+void logger_flush(void)
+{
+    logger_global_context_t *g_context = logger_global_context_t_get();
+    logger_async_t *async = g_context->async;
+    if (async == nullptr || !async->running.load() || std::this_thread::get_id() == async->thread.get_id())
+    {
+        // Nothing is queued, or this is a callback running on the logging thread which would wait on itself
+        return;
+    }
+
+    uint32_t target = async->enqueue_position.load();
+
+    std::unique_lock<std::mutex> lock(async->wake_lock);
+    async->wake.notify_one();
+    async->delivered.wait(lock, [async, target]() {
+        return (int32_t)(async->delivered_position.load() - target) >= 0 || !async->running.load();
+    });
+}
+
 #if defined(__GNUC__) || defined(__clang__)
 // Enable printf type checking in clang and gcc
-__attribute__((__format__ (__printf__, 2, 0)))
+__attribute__((__format__ (__printf__, 4, 0)))
 #endif
 void logger_log(k4a_log_level_t level, const char * file, const int line, const char *format, ...)
 {
     logger_global_context_t *g_context = logger_global_context_t_get();
 
+    logger_async_t *async = g_context->async;
+    if (async != nullptr && async->running.load(std::memory_order_relaxed))
+    {
+        // Never take the global lock or wait on the sinks from the logging thread
+        if ((int)level <= async->max_level.load(std::memory_order_relaxed))
+        {
+            va_list args;
+            va_start(args, format);
+            logger_async_enqueue(async, level, file, line, format, args);
+            va_end(args);
+        }
+        return;
+    }
+
     rwlock_acquire_read(&g_context->lock);
 
     // Quick exit if we are not logging the message
@@ -280,7 +715,7 @@ void logger_log(k4a_log_level_t level, const char * file, const int line, const
         return;
     }
 
-    char buffer[1024];
+    char buffer[LOG_MESSAGE_MAX_SIZE];
     va_list args;
     va_start(args, format);
 #ifndef _WIN32
@@ -293,39 +728,7 @@ void logger_log(k4a_log_level_t level, const char * file, const int line, const
 #endif
     va_end(args);
 
-    if ((level <= g_context->user_log_level) && (g_context->user_log_level != K4A_LOG_LEVEL_OFF))
-    {
-        if (g_context->user_callback)
-        {
-            g_context->user_callback(g_context->user_callback_context, level, file, line, buffer);
-        }
-    }
-
-    if ((level <= g_context->env_log_level) && (g_context->env_log_level != K4A_LOG_LEVEL_OFF))
-    {
-        if (g_context->env_logger)
-        {
-            switch (level)
-            {
-            case K4A_LOG_LEVEL_CRITICAL:
-                g_context->env_logger->critical("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_ERROR:
-                g_context->env_logger->error("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_WARNING:
-                g_context->env_logger->warn("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_INFO:
-                g_context->env_logger->info("{0} ({1}): {2}", file, line, buffer);
-                break;
-            case K4A_LOG_LEVEL_TRACE:
-            default:
-                g_context->env_logger->trace("{0} ({1}): {2}", file, line, buffer);
-                break;
-            }
-        }
-    }
+    logger_deliver(g_context, level, file, line, buffer, "");
 
     rwlock_release_read(&g_context->lock);
 }
@@ -0,0 +1,358 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// This library
+#include <k4ainternal/perf_trace.h>
+
+// Dependent libraries
+#include <k4ainternal/common.h>
+#include <k4ainternal/global.h>
+#include <k4ainternal/latency_histogram.h>
+#include <k4ainternal/rwlock.h>
+
+#include <azure_c_shared_utility/envvariable.h>
+
+// System dependencies
+#include <atomic>
+#include <new>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Events each thread can hold before the oldest are overwritten, 1.5MB per traced thread
+#define PERF_TRACE_RING_SIZE (1 << 16)
+
+// Threads beyond this limit are not traced. Rings of exited threads are exported and reused, so this only limits the
+// threads that are alive at the same time.
+#define PERF_TRACE_MAX_THREADS (64)
+
+// The fields are atomic because the exporter may read a record while its thread overwrites it after the ring wrapped.
+// Relaxed accesses compile to plain loads and stores; perf_trace_export_ring detects and skips torn records.
+typedef struct _perf_trace_record_t
+{
+    std::atomic<const char *> name;
+    std::atomic<uint64_t> time_nsec;
+    std::atomic<uint32_t> phase; // perf_trace_phase_t
+} perf_trace_record_t;
+
+typedef struct _perf_trace_ring_t
+{
+    uint64_t thread_id;
+
+    // Only the owning thread writes events; write_count is published with release semantics so the exporter sees
+    // completed records. Record N is stored in records[N % PERF_TRACE_RING_SIZE] while write_count is N.
+    std::atomic<uint64_t> write_count;
+
+    // Export state, protected by the global lock
+    uint64_t export_count;
+    uint32_t export_depth;
+
+    // Set once the owning thread exited and all its events were exported, protected by the global lock
+    bool free;
+
+    perf_trace_record_t records[PERF_TRACE_RING_SIZE];
+} perf_trace_ring_t;
+
+typedef struct
+{
+    k4a_rwlock_t lock;
+    bool enabled;
+    char file_path[1024];
+    uint64_t process_id;
+
+    perf_trace_ring_t *rings[PERF_TRACE_MAX_THREADS];
+    uint32_t ring_count;
+} perf_trace_global_context_t;
+
+static void perf_trace_init_once(perf_trace_global_context_t *global);
+
+// Creates a function called perf_trace_global_context_t_get() which returns the initialized singleton global
+K4A_DECLARE_GLOBAL(perf_trace_global_context_t, perf_trace_init_once);
+
+// Ring of the calling thread, or NULL before its first event
+static thread_local perf_trace_ring_t *t_ring = NULL;
+
+// Set once a thread found tracing disabled or the ring table full, so later events return without taking the lock
+static thread_local bool t_untraced = false;
+
+static void perf_trace_release_thread(perf_trace_ring_t *ring);
+
+// Exports the events of a thread's ring when the thread exits and returns the ring for reuse. Kept separate from t_ring
+// so recording an event does not go through the initialization check of a thread_local with a destructor.
+class perf_trace_thread_exit
+{
+public:
+    perf_trace_thread_exit() : ring(NULL) {}
+    ~perf_trace_thread_exit()
+    {
+        if (ring != NULL)
+        {
+            perf_trace_release_thread(ring);
+        }
+    }
+    perf_trace_ring_t *ring;
+};
+static thread_local perf_trace_thread_exit t_thread_exit;
+
+// Set once any thread of this binary registered a ring
+static std::atomic<bool> g_perf_trace_recorded(false);
+
+// Writes the remaining events when the library is unloaded, see logger_global_destroy in logging.cpp. Binaries that
+// never recorded an event skip the flush so they do not initialize the global during unload.
+class perf_trace_global_flush
+{
+public:
+    perf_trace_global_flush() {}
+    ~perf_trace_global_flush()
+    {
+        if (g_perf_trace_recorded.load())
+        {
+            perf_trace_flush();
+        }
+    }
+};
+static perf_trace_global_flush flush_perf_trace_on_binary_unload;
+
+static uint64_t perf_trace_get_thread_id(void)
+{
+#ifdef _WIN32
+    return (uint64_t)GetCurrentThreadId();
+#else
+    return (uint64_t)syscall(SYS_gettid);
+#endif
+}
+
+static void perf_trace_init_once(perf_trace_global_context_t *global)
+{
+    // All other members are initialized to zero
+    rwlock_init(&global->lock);
+
+    // environment_get_variable will return null or "\0" if the env var is not set - depends on the OS.
+    const char *file_path = environment_get_variable(K4A_ENV_VAR_TRACE_FILE);
+    if (file_path == NULL || file_path[0] == '\0' || strlen(file_path) >= sizeof(global->file_path))
+    {
+        return;
+    }
+
+#ifdef _WIN32
+    global->process_id = (uint64_t)GetCurrentProcessId();
+#else
+    global->process_id = (uint64_t)getpid();
+#endif
+    memcpy(global->file_path, file_path, strlen(file_path) + 1);
+
+    // Every SDK binary in the process has its own copy of this module and initializes it separately, so none of them
+    // may truncate the file; one binary would discard the events another already exported. The file is only appended
+    // to, and whichever binary exports into an empty file starts the JSON array.
+    FILE *file = fopen(global->file_path, "a");
+    if (file == NULL)
+    {
+        printf("ERROR: Unable to open trace file \"%s\".\n", global->file_path);
+        return;
+    }
+    fclose(file);
+
+    global->enabled = true;
+}
+
+static perf_trace_ring_t *perf_trace_register_thread(void)
+{
+    perf_trace_global_context_t *g_context = perf_trace_global_context_t_get();
+    if (!g_context->enabled)
+    {
+        return NULL;
+    }
+
+    perf_trace_ring_t *ring = NULL;
+    rwlock_acquire_write(&g_context->lock);
+    for (uint32_t i = 0; i < g_context->ring_count; i++)
+    {
+        if (g_context->rings[i]->free)
+        {
+            // The previous thread's events were all exported, so the ring starts over empty
+            ring = g_context->rings[i];
+            ring->write_count.store(0, std::memory_order_relaxed);
+            ring->export_count = 0;
+            ring->export_depth = 0;
+            ring->free = false;
+            break;
+        }
+    }
+    if (ring == NULL && g_context->ring_count < PERF_TRACE_MAX_THREADS)
+    {
+        ring = new (std::nothrow) perf_trace_ring_t();
+        if (ring != NULL)
+        {
+            g_context->rings[g_context->ring_count++] = ring;
+            g_perf_trace_recorded.store(true);
+        }
+    }
+    if (ring != NULL)
+    {
+        ring->thread_id = perf_trace_get_thread_id();
+    }
+    rwlock_release_write(&g_context->lock);
+
+    return ring;
+}
+
+void perf_trace_event(const char *name, perf_trace_phase_t phase)
+{
+    perf_trace_ring_t *ring = t_ring;
+    if (ring == NULL)
+    {
+        if (t_untraced)
+        {
+            return;
+        }
+
+        ring = perf_trace_register_thread();
+        if (ring == NULL)
+        {
+            t_untraced = true;
+            return;
+        }
+        t_ring = ring;
+        t_thread_exit.ring = ring;
+    }
+
+    uint64_t count = ring->write_count.load(std::memory_order_relaxed);
+    perf_trace_record_t *record = &ring->records[count % PERF_TRACE_RING_SIZE];
+
+    // Pairs with the acquire fence in perf_trace_export_ring: an exporter that reads any field stored below also sees
+    // the write_count of this event, which tells it the record is being reused
+    std::atomic_thread_fence(std::memory_order_release);
+    record->name.store(name, std::memory_order_relaxed);
+    record->time_nsec.store(latency_histogram_get_time_nsec(), std::memory_order_relaxed);
+    record->phase.store((uint32_t)phase, std::memory_order_relaxed);
+    ring->write_count.store(count + 1, std::memory_order_release);
+}
+
+static void perf_trace_export_ring(FILE *file, uint64_t process_id, perf_trace_ring_t *ring)
+{
+    uint64_t write_count = ring->write_count.load(std::memory_order_acquire);
+    uint64_t first = ring->export_count;
+    if (write_count - first > PERF_TRACE_RING_SIZE)
+    {
+        // The oldest events were overwritten, so the durations still open at export_count can no longer be ended
+        first = write_count - PERF_TRACE_RING_SIZE;
+        ring->export_depth = 0;
+    }
+
+    for (uint64_t i = first; i < write_count; i++)
+    {
+        const perf_trace_record_t *record = &ring->records[i % PERF_TRACE_RING_SIZE];
+        const char *name = record->name.load(std::memory_order_relaxed);
+        uint64_t time_nsec = record->time_nsec.load(std::memory_order_relaxed);
+        uint32_t phase = record->phase.load(std::memory_order_relaxed);
+
+        // The thread keeps recording during the export. Once it reached record i + PERF_TRACE_RING_SIZE, the copy
+        // above may mix the fields of both records, so the record is dropped like one overwritten before the export.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (ring->write_count.load(std::memory_order_relaxed) >= i + PERF_TRACE_RING_SIZE)
+        {
+            ring->export_depth = 0;
+            continue;
+        }
+
+        if (phase == PERF_TRACE_PHASE_END)
+        {
+            if (ring->export_depth == 0)
+            {
+                // The matching begin was overwritten
+                continue;
+            }
+            ring->export_depth--;
+        }
+        else
+        {
+            ring->export_depth++;
+        }
+
+        // Trace event timestamps are in microseconds
+        fprintf(file,
+                "{\"name\":\"%s\",\"ph\":\"%s\",\"pid\":%llu,\"tid\":%llu,\"ts\":%llu.%03u},\n",
+                name,
+                phase == PERF_TRACE_PHASE_BEGIN ? "B" : "E",
+                (unsigned long long)process_id,
+                (unsigned long long)ring->thread_id,
+                (unsigned long long)(time_nsec / 1000),
+                (unsigned int)(time_nsec % 1000));
+    }
+
+    ring->export_count = write_count;
+}
+
+// Opens the trace file to append events, called with the global lock held
+static FILE *perf_trace_open_file(perf_trace_global_context_t *g_context)
+{
+    FILE *file = fopen(g_context->file_path, "a");
+    if (file != NULL)
+    {
+        // The append position is only defined once something was written, so seek to find out if the file is empty
+        if (fseek(file, 0, SEEK_END) == 0 && ftell(file) == 0)
+        {
+            fputs("[\n", file);
+        }
+    }
+    return file;
+}
+
+static void perf_trace_release_thread(perf_trace_ring_t *ring)
+{
+    perf_trace_global_context_t *g_context = perf_trace_global_context_t_get();
+
+    rwlock_acquire_write(&g_context->lock);
+
+    // The ring is only reused once its events are in the file. If the file cannot be opened, the ring keeps its events.
+    FILE *file = perf_trace_open_file(g_context);
+    if (file != NULL)
+    {
+        perf_trace_export_ring(file, g_context->process_id, ring);
+        fclose(file);
+        ring->free = true;
+    }
+
+    rwlock_release_write(&g_context->lock);
+}
+
+void perf_trace_flush(void)
+{
+    perf_trace_global_context_t *g_context = perf_trace_global_context_t_get();
+    if (!g_context->enabled)
+    {
+        return;
+    }
+
+    rwlock_acquire_write(&g_context->lock);
+
+    FILE *file = perf_trace_open_file(g_context);
+    if (file != NULL)
+    {
+        for (uint32_t i = 0; i < g_context->ring_count; i++)
+        {
+            // Free rings were exported when their thread exited
+            if (!g_context->rings[i]->free)
+            {
+                perf_trace_export_ring(file, g_context->process_id, g_context->rings[i]);
+            }
+        }
+        fclose(file);
+    }
+
+    rwlock_release_write(&g_context->lock);
+}
+
+#ifdef __cplusplus
+}
+#endif
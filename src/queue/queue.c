@@ -6,6 +6,7 @@
 
 // Dependent libraries
 #include <k4ainternal/allocator.h>
+#include <k4ainternal/latency_histogram.h>
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/condition.h>
 #include <azure_c_shared_utility/threadapi.h>
@@ -18,6 +19,7 @@
 typedef struct _queue_entry_t
 {
     k4a_capture_t capture;
+    uint64_t push_time_nsec; // Time the capture was pushed, for the wait latency
 } queue_entry_t;
 
 typedef struct _queue_context_t
@@ -31,6 +33,9 @@ typedef struct _queue_context_t
     uint32_t depth;             // 1 element larger than the max elements the queue can hold.
     const char *name;           // Queue name in logger
     uint32_t dropped_count;     // Count of the dropped captures
+    uint64_t dropped_total;     // Count of the dropped captures since create, not reset by logging
+
+    latency_histogram_t wait_latency; // Time captures spend in the queue before being popped
 
     LOCK_HANDLE lock;
     COND_HANDLE condition;
@@ -96,6 +101,16 @@ static k4a_capture_t queue_pop_internal_locked(queue_context_t *queue)
     return NULL;
 }
 
+// Pops a capture being handed to a consumer, as opposed to one being dropped or flushed
+static k4a_capture_t queue_pop_consumer_locked(queue_context_t *queue)
+{
+    if (is_queue_empty(queue) == false)
+    {
+        latency_histogram_record_since(&queue->wait_latency, queue->queue[queue->read_location].push_time_nsec);
+    }
+    return queue_pop_internal_locked(queue);
+}
+
 k4a_wait_result_t queue_pop(queue_t queue_handle, int32_t wait_in_ms, k4a_capture_t *out_capture)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_WAIT_RESULT_FAILED, queue_t, queue_handle);
@@ -118,7 +133,7 @@ k4a_wait_result_t queue_pop(queue_t queue_handle, int32_t wait_in_ms, k4a_captur
         wresult = K4A_WAIT_RESULT_TIMEOUT;
         queue->queue_pop_blocked++;
 
-        capture = queue_pop_internal_locked(queue);
+        capture = queue_pop_consumer_locked(queue);
         if (capture != NULL)
         {
             wresult = K4A_WAIT_RESULT_SUCCEEDED;
@@ -138,7 +153,7 @@ k4a_wait_result_t queue_pop(queue_t queue_handle, int32_t wait_in_ms, k4a_captur
             COND_RESULT cond_result = Condition_Wait(queue->condition, queue->lock, wait_in_ms);
             if (cond_result == COND_OK)
             {
-                capture = queue_pop_internal_locked(queue);
+                capture = queue_pop_consumer_locked(queue);
                 wresult = K4A_WAIT_RESULT_SUCCEEDED;
 
                 // Condition_Wait should only return COND_OK if there is data or if we are shutting down.
@@ -184,6 +199,7 @@ static void queue_push_internal_locked(queue_context_t *queue, k4a_capture_t cap
 {
     queue_entry_t *entry = &queue->queue[queue->write_location];
     entry->capture = capture;
+    entry->push_time_nsec = latency_histogram_get_time_nsec();
 
     queue->write_location = inc_read_write_location(queue, queue->write_location);
 }
@@ -208,6 +224,7 @@ void queue_push_w_dropped(queue_t queue_handle, k4a_capture_t capture, k4a_captu
             if (dropped == NULL)
             {
                 queue->dropped_count++;
+                queue->dropped_total++;
                 capture_dec_ref(queue_pop_internal_locked(queue));
             }
             else
@@ -232,6 +249,24 @@ void queue_push(queue_t queue_handle, k4a_capture_t capture)
     queue_push_w_dropped(queue_handle, capture, NULL);
 }
 
+void queue_get_stats(queue_t queue_handle, k4a_queue_stats_t *stats, k4a_latency_histogram_t *wait_latency)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, queue_t, queue_handle);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, stats == NULL);
+    queue_context_t *queue = queue_t_get_context(queue_handle);
+
+    Lock(queue->lock);
+    stats->depth = (queue->write_location + queue->depth - queue->read_location) % queue->depth;
+    stats->capacity = queue->depth - 1;
+    stats->dropped_count = queue->dropped_total;
+    Unlock(queue->lock);
+
+    if (wait_latency != NULL)
+    {
+        latency_histogram_get(&queue->wait_latency, wait_latency);
+    }
+}
+
 void queue_destroy(queue_t queue_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, queue_t, queue_handle);
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "k4ainternal/matroska_common.h"
+#include "byteswap_priv.h"
+
+#include <cstring>
+
+#if defined(K4A_USING_SSE) && defined(_MSC_VER)
+#include <intrin.h> // __cpuid, _xgetbv
+#elif defined(K4A_USING_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace
+{
+typedef size_t(copy_swap_bytes_16_kernel_t)(uint16_t *dst, const uint16_t *src, size_t count);
+
+struct copy_swap_bytes_16_dispatch
+{
+    copy_swap_bytes_16_kernel_t *kernel;
+    const char *instruction_type;
+};
+
+#if defined(K4A_USING_NEON)
+size_t copy_swap_bytes_16_neon(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        uint8x16_t v0 = vld1q_u8(reinterpret_cast<const uint8_t *>(src + i));
+        uint8x16_t v1 = vld1q_u8(reinterpret_cast<const uint8_t *>(src + i + 8));
+        uint8x16_t v2 = vld1q_u8(reinterpret_cast<const uint8_t *>(src + i + 16));
+        uint8x16_t v3 = vld1q_u8(reinterpret_cast<const uint8_t *>(src + i + 24));
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i), vrev16q_u8(v0));
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i + 8), vrev16q_u8(v1));
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i + 16), vrev16q_u8(v2));
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i + 24), vrev16q_u8(v3));
+    }
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(src + i));
+        vst1q_u8(reinterpret_cast<uint8_t *>(dst + i), vrev16q_u8(v));
+    }
+    return i;
+}
+#endif
+
+#if defined(K4A_USING_SSE)
+// Checks CPUID, and for AVX2 that the OS saves the YMM registers, so the kernels built for newer instruction sets are
+// only used on CPUs that run them.
+bool cpu_supports_avx2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+    {
+        return false;
+    }
+    __cpuid(info, 1);
+    const int osxsave_avx = (1 << 27) | (1 << 28);
+    if ((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    // Also checks the OS support of the YMM registers
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+bool cpu_supports_ssse3()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+#endif
+
+copy_swap_bytes_16_dispatch select_kernel()
+{
+#if defined(K4A_USING_SSE)
+    if (cpu_supports_avx2())
+    {
+        return { copy_swap_bytes_16_avx2, "AVX2" };
+    }
+    if (cpu_supports_ssse3())
+    {
+        return { copy_swap_bytes_16_ssse3, "SSSE3" };
+    }
+#elif defined(K4A_USING_NEON)
+    return { copy_swap_bytes_16_neon, "NEON" };
+#endif
+    return { nullptr, "None" };
+}
+
+const copy_swap_bytes_16_dispatch &get_dispatch()
+{
+    // Selected once, on first use
+    static const copy_swap_bytes_16_dispatch dispatch = select_kernel();
+    return dispatch;
+}
+} // namespace
+
+const char *copy_swap_bytes_16_get_instruction_type()
+{
+    return get_dispatch().instruction_type;
+}
+
+// Copies count 16-bit values from src to dst, switching the endianness of each value.
+// src and dst may point to the same buffer, but must not otherwise overlap.
+void copy_swap_bytes_16(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    size_t i = 0;
+
+    copy_swap_bytes_16_kernel_t *kernel = get_dispatch().kernel;
+    if (kernel != nullptr)
+    {
+        i = kernel(dst, src, count);
+    }
+
+    // Remaining values that don't fill a full vector, or all values if no vector instructions are available.
+    for (; i < count; i++)
+    {
+        dst[i] = swap_bytes_16(src[i]);
+    }
+}
@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "byteswap_priv.h"
+
+#if defined(K4A_USING_SSE)
+#include <immintrin.h> // AVX2
+
+size_t copy_swap_bytes_16_avx2(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    size_t i = 0;
+
+    // Swap the 2 bytes in each 16-bit lane. vpshufb shuffles within each 128-bit half, so both halves use the same
+    // pattern.
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+    for (; i + 64 <= count; i += 64)
+    {
+        __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 16));
+        __m256i v2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 32));
+        __m256i v3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + 48));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(v0, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 16), _mm256_shuffle_epi8(v1, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 32), _mm256_shuffle_epi8(v2, shuffle));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i + 48), _mm256_shuffle_epi8(v3, shuffle));
+    }
+    for (; i + 16 <= count; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_shuffle_epi8(v, shuffle));
+    }
+
+    // Avoid the AVX to SSE transition penalty in the caller
+    _mm256_zeroupper();
+    return i;
+}
+#endif
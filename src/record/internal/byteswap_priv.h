@@ -0,0 +1,24 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef BYTESWAP_PRIV_H
+#define BYTESWAP_PRIV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
+#define K4A_USING_SSE
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define K4A_USING_NEON
+#endif
+
+#if defined(K4A_USING_SSE)
+// Vector kernels of copy_swap_bytes_16, each in its own file compiled for the instruction set it uses. They swap the
+// largest multiple of their vector width that fits in count and return the number of values swapped. Only call a
+// kernel after checking the CPU supports it.
+size_t copy_swap_bytes_16_avx2(uint16_t *dst, const uint16_t *src, size_t count);
+size_t copy_swap_bytes_16_ssse3(uint16_t *dst, const uint16_t *src, size_t count);
+#endif
+
+#endif /* BYTESWAP_PRIV_H */
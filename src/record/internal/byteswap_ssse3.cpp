@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "byteswap_priv.h"
+
+#if defined(K4A_USING_SSE)
+#include <tmmintrin.h> // SSSE3
+
+size_t copy_swap_bytes_16_ssse3(uint16_t *dst, const uint16_t *src, size_t count)
+{
+    size_t i = 0;
+
+    // Swap the 2 bytes in each 16-bit lane with a single shuffle.
+    const __m128i shuffle = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+    for (; i + 32 <= count; i += 32)
+    {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 8));
+        __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16));
+        __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 24));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(v0, shuffle));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 8), _mm_shuffle_epi8(v1, shuffle));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 16), _mm_shuffle_epi8(v2, shuffle));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i + 24), _mm_shuffle_epi8(v3, shuffle));
+    }
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(v, shuffle));
+    }
+    return i;
+}
+#endif
@@ -3,12 +3,17 @@
 
 #include "k4ainternal/matroska_common.h"
 
+#include <chrono>
+#include <string.h>
+
 using namespace k4arecord;
 
 static_assert(sizeof(std::streamoff) == sizeof(int64), "64-bit seeking is not supported on this architecture");
 static_assert(sizeof(std::streamsize) == sizeof(int64), "64-bit seeking is not supported on this architecture");
 
-LargeFileIOCallback::LargeFileIOCallback(const char *path, const open_mode mode) : m_owner(std::this_thread::get_id())
+LargeFileIOCallback::LargeFileIOCallback(const char *path, const open_mode mode) :
+    m_owner(std::this_thread::get_id()),
+    m_flush_time_ns(0)
 {
     assert(path);
     std::ios::openmode om = std::ios::binary;
@@ -31,6 +36,13 @@ LargeFileIOCallback::LargeFileIOCallback(const char *path, const open_mode mode)
         throw std::invalid_argument("Unknown file mode specified");
     }
 
+    if (mode != MODE_READ)
+    {
+        // Writes are collected here instead of in the stream buffer, since std::filebuf may pass large writes straight
+        // to the OS.
+        m_write_buffer.reset(new char[RECORD_WRITE_BUFFER_SIZE]);
+    }
+
     m_stream.exceptions(std::ios::failbit | std::ios::badbit);
     m_stream.open(path, om);
     m_stream.exceptions(std::ios::badbit); // Don't throw exceptions for EOF errors
@@ -46,6 +58,11 @@ uint32 LargeFileIOCallback::read(void *buffer, size_t size)
     assert(size <= UINT32_MAX); // can't properly return > uint32
     assert(m_owner == std::this_thread::get_id());
 
+    if (m_buffered_size > 0)
+    {
+        flush();
+    }
+
     m_stream.read((char *)buffer, (std::streamsize)size);
     return (uint32)m_stream.gcount();
 }
@@ -55,6 +72,11 @@ void LargeFileIOCallback::setFilePointer(int64 offset, libebml::seek_mode mode)
     assert(mode == SEEK_SET || mode == SEEK_CUR || mode == SEEK_END);
     assert(m_owner == std::this_thread::get_id());
 
+    if (m_buffered_size > 0)
+    {
+        flush();
+    }
+
     switch (mode)
     {
     case SEEK_SET:
@@ -76,7 +98,32 @@ size_t LargeFileIOCallback::write(const void *buffer, size_t size)
     assert(size <= INT64_MAX); // m_stream.write() takes a signed long input
     assert(m_owner == std::this_thread::get_id());
 
-    m_stream.write((const char *)buffer, (std::streamsize)size);
+    if (!m_write_buffer)
+    {
+        m_stream.write((const char *)buffer, (std::streamsize)size);
+        return size;
+    }
+
+    // Data is only handed to the OS when the write buffer is full, so many small EBML element writes and consecutive
+    // clusters are coalesced into large sequential writes.
+    if (m_buffered_size + size > RECORD_WRITE_BUFFER_SIZE)
+    {
+        flush();
+    }
+
+    if (size >= RECORD_WRITE_BUFFER_SIZE)
+    {
+        // Too large to buffer, count it as a flush since it goes straight to the OS.
+        auto write_start = std::chrono::steady_clock::now();
+        m_stream.write((const char *)buffer, (std::streamsize)size);
+        auto write_time = std::chrono::steady_clock::now() - write_start;
+        m_flush_time_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(write_time).count();
+    }
+    else
+    {
+        memcpy(m_write_buffer.get() + m_buffered_size, buffer, size);
+        m_buffered_size += size;
+    }
     return size;
 }
 
@@ -85,7 +132,24 @@ uint64 LargeFileIOCallback::getFilePointer()
     assert(m_owner == std::this_thread::get_id());
     std::streampos pos = m_stream.tellg();
     assert(pos >= 0); // tellg() should have thrown an exception if this happens
-    return (uint64)pos;
+    return (uint64)pos + m_buffered_size;
+}
+
+void LargeFileIOCallback::flush()
+{
+    assert(m_owner == std::this_thread::get_id());
+
+    auto flush_start = std::chrono::steady_clock::now();
+    writeBuffer();
+    m_stream.flush();
+    auto flush_time = std::chrono::steady_clock::now() - flush_start;
+
+    m_flush_time_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(flush_time).count();
+}
+
+uint64_t LargeFileIOCallback::getFlushTimeNs() const
+{
+    return m_flush_time_ns;
 }
 
 void LargeFileIOCallback::close()
@@ -97,10 +161,22 @@ void LargeFileIOCallback::close()
         // exception. Enable failbit exceptions again for file close.
         m_stream.clear();
         m_stream.exceptions(std::ios::failbit | std::ios::badbit);
+        writeBuffer();
         m_stream.close();
     }
 }
 
+void LargeFileIOCallback::writeBuffer()
+{
+    if (m_buffered_size > 0)
+    {
+        // Clear the count first so a failed write is not retried by close().
+        size_t size = m_buffered_size;
+        m_buffered_size = 0;
+        m_stream.write(m_write_buffer.get(), (std::streamsize)size);
+    }
+}
+
 void LargeFileIOCallback::setOwnerThread()
 {
     m_owner = std::this_thread::get_id();
@@ -11,6 +11,7 @@
 #include <k4ainternal/matroska_read.h>
 #include <k4ainternal/common.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/perf_trace.h>
 
 #include <turbojpeg.h>
 #include <libyuv.h>
@@ -809,6 +810,27 @@ k4a_result_t read_bitmap_info_header(track_reader_t *track)
 
         return K4A_RESULT_SUCCEEDED;
     }
+    else if (track->codec_id == "V_K4A/RVL")
+    {
+        KaxCodecPrivate &codec_private = GetChild<KaxCodecPrivate>(*track->track);
+        RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, codec_private.GetSize() != sizeof(BITMAPINFOHEADER));
+        track->codec_private.assign(codec_private.GetBuffer(), codec_private.GetBuffer() + codec_private.GetSize());
+
+        BITMAPINFOHEADER *bitmap_header = reinterpret_cast<BITMAPINFOHEADER *>(track->codec_private.data());
+        if (bitmap_header->biCompression != 0x204C5652 || bitmap_header->biBitCount != 16) // "RVL "
+        {
+            LOG_ERROR("Unsupported RVL format for track '%s': %x",
+                      GetChild<KaxTrackName>(*track->track).GetValueUTF8().c_str(),
+                      bitmap_header->biCompression);
+            return K4A_RESULT_FAILED;
+        }
+
+        // RVL decompresses to 16 bit little-endian grayscale.
+        track->format = K4A_IMAGE_FORMAT_DEPTH16;
+        track->stride = track->width * 2;
+        track->rvl_compressed = true;
+        return K4A_RESULT_SUCCEEDED;
+    }
     else
     {
         LOG_ERROR("Unsupported codec id for track '%s': %s",
@@ -818,17 +840,20 @@ k4a_result_t read_bitmap_info_header(track_reader_t *track)
     }
 }
 
-void reset_seek_pointers(k4a_playback_context_t *context, uint64_t seek_timestamp_ns)
+void reset_seek_pointers(k4a_playback_context_t *context, playback_position_t *position, uint64_t seek_timestamp_ns)
 {
     RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, position == NULL);
 
-    context->seek_timestamp_ns = seek_timestamp_ns;
+    position->seek_timestamp_ns = seek_timestamp_ns;
 
-    for (auto &itr : context->track_map)
+    for (auto &itr : position->tracks)
     {
-        auto &track_reader = itr.second;
-        track_reader.current_block.reset();
+        reset_decode_ahead(&itr.second);
     }
+    position->tracks.clear();
+
+    position->capture_info_cursor = capture_info_cursor_t();
 }
 
 k4a_result_t parse_tracks(k4a_playback_context_t *context)
@@ -948,6 +973,97 @@ track_reader_t *get_track_reader_by_name(k4a_playback_context_t *context, std::s
     return nullptr;
 }
 
+// Returns the track reader if it is enabled, or NULL if it doesn't exist or was disabled.
+track_reader_t *get_enabled_track(track_reader_t *track_reader)
+{
+    return track_reader != NULL && track_reader->enabled ? track_reader : NULL;
+}
+
+// Returns the file timestamp to seek to so that the next capture read from position follows the last one it returned.
+static uint64_t get_capture_resume_timestamp(k4a_playback_context_t *context, playback_position_t *position)
+{
+    uint64_t resume_timestamp_ns = position->seek_timestamp_ns;
+    bool read_since_seek = false;
+
+    track_reader_t *capture_tracks[] = { context->color_track, context->depth_track, context->ir_track };
+    for (track_reader_t *track_reader : capture_tracks)
+    {
+        auto itr = position->tracks.find(track_reader);
+        if (track_reader == NULL || itr == position->tracks.end() || itr->second.current_block == nullptr)
+        {
+            continue;
+        }
+
+        const block_info_t *block = itr->second.current_block.get();
+        uint64_t timestamp_ns = 0;
+        if (block->block != NULL)
+        {
+            timestamp_ns = block->timestamp_ns + 1;
+        }
+        else if (block->index >= 0)
+        {
+            // The end of the recording was reached, a block pointing to the start of the file has a negative index.
+            timestamp_ns = context->last_file_timestamp_ns + 1;
+        }
+
+        if (!read_since_seek || timestamp_ns > resume_timestamp_ns)
+        {
+            resume_timestamp_ns = timestamp_ns;
+        }
+        read_since_seek = true;
+    }
+
+    return resume_timestamp_ns;
+}
+
+k4a_result_t set_track_enabled(k4a_playback_context_t *context, track_reader_t *track_reader, bool enabled)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_reader == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_reader->track == NULL);
+
+    if (track_reader->enabled == enabled)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    uint64_t track_number = track_reader->track->TrackNumber().GetValue();
+    {
+        std::lock_guard<std::mutex> lock(context->io_lock);
+        std::vector<uint64_t> &disabled_tracks = context->disabled_track_numbers;
+        if (enabled)
+        {
+            disabled_tracks.erase(std::remove(disabled_tracks.begin(), disabled_tracks.end(), track_number),
+                                  disabled_tracks.end());
+        }
+        else
+        {
+            disabled_tracks.push_back(track_number);
+        }
+        track_reader->enabled = enabled;
+    }
+    reset_decode_ahead(&context->position.tracks[track_reader]);
+
+    if (enabled)
+    {
+        // Clusters loaded while the track was disabled are missing its blocks. Drop them from the cache and seek back
+        // to the current playback position so they get reloaded.
+        uint64_t resume_timestamp_ns = get_capture_resume_timestamp(context, &context->position);
+        {
+            std::lock_guard<std::recursive_mutex> lock(context->cache_lock);
+            for (cluster_info_t *cluster_info = context->cluster_cache.get(); cluster_info != NULL;
+                 cluster_info = cluster_info->next)
+            {
+                cluster_info->cluster.reset();
+            }
+        }
+        context->position.seek_cluster.reset();
+        reset_seek_pointers(context, &context->position, resume_timestamp_ns);
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
 KaxTag *get_tag(k4a_playback_context_t *context, const char *name)
 {
     RETURN_VALUE_IF_ARG(NULL, context == NULL);
@@ -1294,6 +1410,116 @@ cluster_info_t *next_cluster(k4a_playback_context_t *context, cluster_info_t *cu
     }
 }
 
+// Read the track number, timecode, and frame data size from a SimpleBlock or BlockGroup element without reading the
+// frame data. The file pointer must be at the start of the element data, and is left somewhere inside the element.
+// Throws std::ios_base::failure on IO errors.
+static k4a_result_t read_block_header(k4a_playback_context_t *context,
+                                      EbmlElement *element,
+                                      uint64_t *track_number,
+                                      int16_t *timecode,
+                                      uint64_t *data_size)
+{
+    std::unique_ptr<EbmlElement> block;
+    if (EbmlId(*element) == KaxBlockGroup::ClassInfos.GlobalId)
+    {
+        // Find the Block inside the BlockGroup, the other children of the group are not needed.
+        block = next_child(context, element);
+        while (block != nullptr && EbmlId(*block) != KaxBlock::ClassInfos.GlobalId)
+        {
+            RETURN_IF_ERROR(skip_element(context, block.get()));
+            block = next_child(context, element);
+        }
+        if (block == nullptr)
+        {
+            LOG_ERROR("Block group at %llu does not contain a block", element->GetElementPosition());
+            return K4A_RESULT_FAILED;
+        }
+    }
+    uint64_t block_size = block ? block->GetSize() : element->GetSize();
+
+    // The track number is an EBML variable length integer of 1 to 8 bytes, followed by a 16-bit big-endian timecode
+    // and a flags byte.
+    uint8_t header[8 + 2];
+    if (context->ebml_file->read(header, 1) != 1 || header[0] == 0)
+    {
+        LOG_ERROR("Invalid block header at %llu", element->GetElementPosition());
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t number_length = 1;
+    while ((header[0] & (0x80 >> (number_length - 1))) == 0)
+    {
+        number_length++;
+    }
+    size_t header_length = number_length + 2;
+    if (block_size < header_length + 1 ||
+        context->ebml_file->read(header + 1, header_length - 1) != header_length - 1)
+    {
+        LOG_ERROR("Invalid block header at %llu", element->GetElementPosition());
+        return K4A_RESULT_FAILED;
+    }
+
+    *track_number = header[0] & (0xFFu >> number_length);
+    for (size_t i = 1; i < number_length; i++)
+    {
+        *track_number = (*track_number << 8) | header[i];
+    }
+    *timecode = (int16_t)(uint16_t)(header[number_length] << 8 | header[number_length + 1]);
+    *data_size = block_size - (header_length + 1);
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Read the contents of a cluster, skipping the blocks of disabled tracks without reading their frame data.
+// The file pointer must be at the start of the cluster data, and the caller should own the io lock.
+static k4a_result_t read_cluster_filtered(k4a_playback_context_t *context, KaxCluster *cluster)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cluster == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, !cluster->IsFiniteSize());
+
+    const std::vector<uint64_t> &disabled_tracks = context->disabled_track_numbers;
+    try
+    {
+        uint64_t cluster_end = cluster->GetElementPosition() + cluster->HeadSize() + cluster->GetSize();
+        while (context->ebml_file->getFilePointer() < cluster_end)
+        {
+            std::unique_ptr<EbmlElement> element = next_child(context, cluster);
+            if (element == nullptr)
+            {
+                break;
+            }
+
+            EbmlId element_id(*element);
+            uint64_t data_start = element->GetElementPosition() + element->HeadSize();
+            assert(data_start + element->GetSize() <= INT64_MAX);
+            if (element_id == KaxSimpleBlock::ClassInfos.GlobalId || element_id == KaxBlockGroup::ClassInfos.GlobalId)
+            {
+                uint64_t track_number = 0;
+                int16_t timecode = 0;
+                uint64_t data_size = 0;
+                RETURN_IF_ERROR(read_block_header(context, element.get(), &track_number, &timecode, &data_size));
+                if (std::find(disabled_tracks.begin(), disabled_tracks.end(), track_number) != disabled_tracks.end())
+                {
+                    context->ebml_file->setFilePointer((int64_t)(data_start + element->GetSize()));
+                    continue;
+                }
+                context->ebml_file->setFilePointer((int64_t)data_start);
+            }
+
+            int upper_level = 0;
+            EbmlElement *dummy = nullptr;
+            element->Read(*context->stream, element->Generic().Context, upper_level, dummy, true);
+            cluster->PushElement(*element.release()); // Element will be freed with the cluster.
+        }
+        return K4A_RESULT_SUCCEEDED;
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to read cluster in recording '%s': %s", context->file_path, e.what());
+        return K4A_RESULT_FAILED;
+    }
+}
+
 // Load a cluster from the cluster cache / disk without any neighbor preloading.
 // This should never fail unless there is a file IO error.
 std::shared_ptr<KaxCluster> load_cluster_internal(k4a_playback_context_t *context, cluster_info_t *cluster_info)
@@ -1344,7 +1570,15 @@ std::shared_ptr<KaxCluster> load_cluster_internal(k4a_playback_context_t *contex
                 cluster = find_next<KaxCluster>(context, true);
                 if (cluster)
                 {
-                    if (read_element<KaxCluster>(context, cluster.get()) == NULL)
+                    if (context->disabled_track_numbers.empty())
+                    {
+                        if (read_element<KaxCluster>(context, cluster.get()) == NULL)
+                        {
+                            LOG_ERROR("Failed to load cluster at: %llu", cluster_info->file_offset);
+                            return nullptr;
+                        }
+                    }
+                    else if (K4A_FAILED(TRACE_CALL(read_cluster_filtered(context, cluster.get()))))
                     {
                         LOG_ERROR("Failed to load cluster at: %llu", cluster_info->file_offset);
                         return nullptr;
@@ -1671,12 +1905,229 @@ static void free_vector_buffer(void *buffer, void *context)
     delete vector;
 }
 
+// Take an idle turbojpeg decompressor from the pool, or create a new one if they are all in use.
+static tjhandle acquire_decoder(k4a_playback_context_t *context)
+{
+    {
+        std::lock_guard<std::mutex> lock(context->decoder_lock);
+        if (!context->decoders.empty())
+        {
+            tjhandle decoder = context->decoders.back();
+            context->decoders.pop_back();
+            return decoder;
+        }
+    }
+
+    tjhandle decoder = tjInitDecompress();
+    if (decoder == NULL)
+    {
+        LOG_ERROR("Failed to initialize jpeg decompressor: %s", tjGetErrorStr());
+    }
+    return decoder;
+}
+
+static void release_decoder(k4a_playback_context_t *context, tjhandle decoder)
+{
+    std::lock_guard<std::mutex> lock(context->decoder_lock);
+    context->decoders.push_back(decoder);
+}
+
+void free_decoders(k4a_playback_context_t *context)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+
+    std::lock_guard<std::mutex> lock(context->decoder_lock);
+    for (tjhandle decoder : context->decoders)
+    {
+        (void)tjDestroy(decoder);
+    }
+    context->decoders.clear();
+}
+
+// Jpegs store full range YCbCr, while NV12 and YUY2 images use BT.601 video range (Y in [16, 235], Cb and Cr in
+// [16, 240]) like the color camera and libyuv. Scales the decoded planes in place to video range.
+static void jpeg_to_video_range(uint8_t *luma, size_t luma_size, uint8_t *chroma, size_t chroma_size)
+{
+    static const struct range_tables
+    {
+        uint8_t luma[256];
+        uint8_t chroma[256];
+        range_tables()
+        {
+            for (int i = 0; i < 256; i++)
+            {
+                luma[i] = (uint8_t)(16 + (i * 219 + 127) / 255);
+                int c = (i - 128) * 224;
+                chroma[i] = (uint8_t)(128 + (c + (c >= 0 ? 127 : -127)) / 255);
+            }
+        }
+    } tables;
+
+    for (size_t i = 0; i < luma_size; i++)
+    {
+        luma[i] = tables.luma[luma[i]];
+    }
+    for (size_t i = 0; i < chroma_size; i++)
+    {
+        chroma[i] = tables.chroma[chroma[i]];
+    }
+}
+
+// Decode a jpeg straight to NV12 or YUY2 from the planar YUV data it is stored as, without a BGRA intermediate.
+// If the jpeg subsampling can't be converted directly, buffer_out is left NULL and the caller should convert via BGRA.
+static k4a_result_t convert_mjpeg_to_yuv(k4a_playback_context_t *context,
+                                         DataBuffer &data_buffer,
+                                         int width,
+                                         int height,
+                                         k4a_image_format_t target_format,
+                                         std::vector<uint8_t> **buffer_out,
+                                         int *stride_out)
+{
+    *buffer_out = NULL;
+    if (width % 2 != 0 || height % 2 != 0)
+    {
+        return K4A_RESULT_SUCCEEDED;
+    }
+
+    tjhandle decoder = acquire_decoder(context);
+    if (decoder == NULL)
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    int jpeg_width = 0, jpeg_height = 0, subsampling = 0, colorspace = 0;
+    if (tjDecompressHeader3(
+            decoder, data_buffer.Buffer(), data_buffer.Size(), &jpeg_width, &jpeg_height, &subsampling, &colorspace) !=
+        0)
+    {
+        LOG_ERROR("Failed to read jpeg header: %s", tjGetErrorStr());
+        result = K4A_RESULT_FAILED;
+    }
+    else if (jpeg_width != width || jpeg_height != height)
+    {
+        LOG_ERROR("Jpeg image size %dx%d does not match the track size %dx%d", jpeg_width, jpeg_height, width, height);
+        result = K4A_RESULT_FAILED;
+    }
+    else if (subsampling == TJSAMP_420 || subsampling == TJSAMP_422)
+    {
+        size_t y_size = (size_t)(width * height);
+        int chroma_width = tjPlaneWidth(1, width, subsampling);
+        int chroma_height = tjPlaneHeight(1, height, subsampling);
+        size_t chroma_size = (size_t)(chroma_width * chroma_height);
+        bool nv12 = target_format == K4A_IMAGE_FORMAT_COLOR_NV12;
+
+        // For NV12 the Y plane is decoded straight into the output image, U and V are interleaved afterwards. 4:2:2
+        // chroma has twice as many rows as NV12, so space is added for the U and V planes with row pairs averaged.
+        bool average_rows = nv12 && subsampling == TJSAMP_422;
+        std::vector<uint8_t> planes((nv12 ? 0 : y_size) + chroma_size * 2 + (average_rows ? chroma_size : 0));
+        std::vector<uint8_t> *buffer = NULL;
+        unsigned char *dst_planes[3];
+        int strides[3] = { width, chroma_width, chroma_width };
+        if (nv12)
+        {
+            *stride_out = width;
+            buffer = new std::vector<uint8_t>(y_size + y_size / 2);
+            dst_planes[0] = buffer->data();
+            dst_planes[1] = planes.data();
+            dst_planes[2] = planes.data() + chroma_size;
+        }
+        else
+        {
+            *stride_out = width * 2;
+            buffer = new std::vector<uint8_t>(y_size * 2);
+            dst_planes[0] = planes.data();
+            dst_planes[1] = planes.data() + y_size;
+            dst_planes[2] = planes.data() + y_size + chroma_size;
+        }
+
+        if (tjDecompressToYUVPlanes(decoder,
+                                    data_buffer.Buffer(),
+                                    data_buffer.Size(),
+                                    dst_planes,
+                                    width,
+                                    strides,
+                                    height,
+                                    TJFLAG_FASTDCT) != 0)
+        {
+            LOG_ERROR("Failed to decompress jpeg image to YUV planes: %s", tjGetErrorStr());
+            result = K4A_RESULT_FAILED;
+        }
+        else if (nv12)
+        {
+            // The U and V planes are adjacent in both layouts.
+            jpeg_to_video_range(dst_planes[0], y_size, dst_planes[1], chroma_size * 2);
+
+            uint8_t *u_plane = dst_planes[1];
+            uint8_t *v_plane = dst_planes[2];
+            if (average_rows)
+            {
+                u_plane = planes.data() + chroma_size * 2;
+                v_plane = u_plane + chroma_size / 2;
+                for (int i = 1; i <= 2; i++)
+                {
+                    libyuv::InterpolatePlane(dst_planes[i],
+                                             chroma_width * 2,
+                                             dst_planes[i] + chroma_width,
+                                             chroma_width * 2,
+                                             i == 1 ? u_plane : v_plane,
+                                             chroma_width,
+                                             chroma_width,
+                                             height / 2,
+                                             128);
+                }
+            }
+            libyuv::MergeUVPlane(u_plane,
+                                 chroma_width,
+                                 v_plane,
+                                 chroma_width,
+                                 buffer->data() + y_size,
+                                 width,
+                                 chroma_width,
+                                 height / 2);
+        }
+        else
+        {
+            jpeg_to_video_range(dst_planes[0], y_size, dst_planes[1], chroma_size * 2);
+
+            auto to_yuy2 = subsampling == TJSAMP_422 ? libyuv::I422ToYUY2 : libyuv::I420ToYUY2;
+            if (to_yuy2(dst_planes[0],
+                        strides[0],
+                        dst_planes[1],
+                        strides[1],
+                        dst_planes[2],
+                        strides[2],
+                        buffer->data(),
+                        *stride_out,
+                        width,
+                        height) != 0)
+            {
+                LOG_ERROR("Failed to convert YUV planes to YUY2 format.", 0);
+                result = K4A_RESULT_FAILED;
+            }
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            *buffer_out = buffer;
+        }
+        else
+        {
+            delete buffer;
+        }
+    }
+
+    release_decoder(context, decoder);
+    return result;
+}
+
 // Allocates a new image in the specified format from in_block
 k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                                     block_info_t *in_block,
                                     k4a_image_t *image_out,
                                     k4a_image_format_t target_format)
 {
+    PERF_TRACE_SCOPE("convert_block_to_image");
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, in_block == nullptr);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, image_out == nullptr);
@@ -1700,22 +2151,35 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
     {
     case K4A_IMAGE_FORMAT_DEPTH16:
     case K4A_IMAGE_FORMAT_IR16:
-        buffer = new std::vector<uint8_t>(data_buffer.Buffer(), data_buffer.Buffer() + data_buffer.Size());
-        if (in_block->reader->format == K4A_IMAGE_FORMAT_DEPTH16 || in_block->reader->format == K4A_IMAGE_FORMAT_IR16)
-        {
-            // 16 bit grayscale needs to be converted from big-endian back to little-endian.
-            assert(buffer->size() % sizeof(uint16_t) == 0);
-            uint16_t *buffer_raw = reinterpret_cast<uint16_t *>(buffer->data());
-            size_t buffer_size = buffer->size() / sizeof(uint16_t);
-            for (size_t i = 0; i < buffer_size; i++)
+        if (in_block->reader->rvl_compressed)
+        {
+            size_t pixel_count = (size_t)out_width * (size_t)out_height;
+            buffer = new std::vector<uint8_t>(pixel_count * sizeof(uint16_t));
+            if (!rvl_decompress(data_buffer.Buffer(),
+                                data_buffer.Size(),
+                                reinterpret_cast<uint16_t *>(buffer->data()),
+                                pixel_count))
             {
-                buffer_raw[i] = swap_bytes_16(buffer_raw[i]);
+                LOG_ERROR("Failed to decompress RVL block in track '%s'", in_block->reader->track_name.c_str());
+                result = K4A_RESULT_FAILED;
             }
         }
+        else if (in_block->reader->format == K4A_IMAGE_FORMAT_DEPTH16 ||
+                 in_block->reader->format == K4A_IMAGE_FORMAT_IR16)
+        {
+            // 16 bit grayscale needs to be converted from big-endian back to little-endian.
+            // The byte swap is done while copying out of the block so the frame is only read once.
+            assert(data_buffer.Size() % sizeof(uint16_t) == 0);
+            buffer = new std::vector<uint8_t>(data_buffer.Size());
+            copy_swap_bytes_16(reinterpret_cast<uint16_t *>(buffer->data()),
+                               reinterpret_cast<const uint16_t *>(data_buffer.Buffer()),
+                               buffer->size() / sizeof(uint16_t));
+        }
         else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_YUY2)
         {
             // For backward compatibility with early recordings, the YUY2 format was used. The actual data buffer is
             // 16-bit little-endian, so we can just use the buffer as-is.
+            buffer = new std::vector<uint8_t>(data_buffer.Buffer(), data_buffer.Buffer() + data_buffer.Size());
         }
         else
         {
@@ -1734,100 +2198,72 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
         }
         else
         {
-            // Convert the buffer to BGRA format first
-            out_stride = out_width * 4 * (int)sizeof(uint8_t);
-            buffer = new std::vector<uint8_t>((size_t)(out_height * out_stride));
-
-            if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_MJPG)
-            {
-                tjhandle turbojpeg_handle = tjInitDecompress();
-                if (tjDecompress2(turbojpeg_handle,
-                                  data_buffer.Buffer(),
-                                  data_buffer.Size(),
-                                  buffer->data(),
-                                  out_width,
-                                  0, // pitch
-                                  out_height,
-                                  TJPF_BGRA,
-                                  TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
-                {
-                    LOG_ERROR("Failed to decompress jpeg image to BGRA format.", 0);
-                    result = K4A_RESULT_FAILED;
-                }
-                (void)tjDestroy(turbojpeg_handle);
-            }
-            else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_NV12)
-            {
-                // The endianness of libyuv's ARGB is opposite our BGRA format. They are the same byte order.
-                if (libyuv::NV12ToARGB(data_buffer.Buffer(),
-                                       (int)in_block->reader->stride,
-                                       data_buffer.Buffer() + (out_height * (int)in_block->reader->stride),
-                                       (int)in_block->reader->stride,
-                                       buffer->data(),
-                                       out_stride,
-                                       out_width,
-                                       out_height) != 0)
-                {
-                    LOG_ERROR("Failed to convert NV12 image to BGRA format.", 0);
-                    result = K4A_RESULT_FAILED;
-                }
-            }
-            else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_YUY2)
+            // Jpegs are stored as planar YUV, so NV12 and YUY2 targets can skip the BGRA intermediate.
+            if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_MJPG &&
+                target_format != K4A_IMAGE_FORMAT_COLOR_BGRA32)
             {
-                // The endianness of libyuv's ARGB is opposite our BGRA format. They are the same byte order.
-                if (libyuv::YUY2ToARGB(data_buffer.Buffer(),
-                                       (int)in_block->reader->stride,
-                                       buffer->data(),
-                                       out_stride,
-                                       out_width,
-                                       out_height) != 0)
-                {
-                    LOG_ERROR("Failed to convert YUY2 image to BGRA format.", 0);
-                    result = K4A_RESULT_FAILED;
-                }
-            }
-            else
-            {
-                LOG_ERROR("Unsupported image format conversion: %d to %d", in_block->reader->format, target_format);
-                result = K4A_RESULT_FAILED;
+                result = TRACE_CALL(convert_mjpeg_to_yuv(
+                    context, data_buffer, out_width, out_height, target_format, &buffer, &out_stride));
             }
 
-            if (K4A_SUCCEEDED(result) && target_format != K4A_IMAGE_FORMAT_COLOR_BGRA32)
+            if (K4A_SUCCEEDED(result) && buffer == NULL)
             {
-                auto bgra_buffer = buffer;
-                buffer = NULL;
-                int bgra_stride = out_stride;
+                // Convert the buffer to BGRA format first
+                out_stride = out_width * 4 * (int)sizeof(uint8_t);
+                buffer = new std::vector<uint8_t>((size_t)(out_height * out_stride));
 
-                if (target_format == K4A_IMAGE_FORMAT_COLOR_NV12)
+                if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_MJPG)
                 {
-                    out_stride = out_width;
-                    size_t y_plane_size = (size_t)(out_height * out_stride);
-                    // Round up the size of the UV plane in case the resolution is odd.
-                    size_t uv_plane_size = (size_t)(out_height * out_stride + 1) / 2;
-                    buffer = new std::vector<uint8_t>(y_plane_size + uv_plane_size);
-
-                    if (libyuv::ARGBToNV12(bgra_buffer->data(),
-                                           bgra_stride,
+                    tjhandle decoder = acquire_decoder(context);
+                    if (decoder == NULL)
+                    {
+                        result = K4A_RESULT_FAILED;
+                    }
+                    else
+                    {
+                        if (tjDecompress2(decoder,
+                                          data_buffer.Buffer(),
+                                          data_buffer.Size(),
+                                          buffer->data(),
+                                          out_width,
+                                          0, // pitch
+                                          out_height,
+                                          TJPF_BGRA,
+                                          TJFLAG_FASTDCT | TJFLAG_FASTUPSAMPLE) != 0)
+                        {
+                            LOG_ERROR("Failed to decompress jpeg image to BGRA format.", 0);
+                            result = K4A_RESULT_FAILED;
+                        }
+                        release_decoder(context, decoder);
+                    }
+                }
+                else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_NV12)
+                {
+                    // The endianness of libyuv's ARGB is opposite our BGRA format. They are the same byte order.
+                    if (libyuv::NV12ToARGB(data_buffer.Buffer(),
+                                           (int)in_block->reader->stride,
+                                           data_buffer.Buffer() + (out_height * (int)in_block->reader->stride),
+                                           (int)in_block->reader->stride,
                                            buffer->data(),
                                            out_stride,
-                                           buffer->data() + y_plane_size,
-                                           out_stride,
                                            out_width,
                                            out_height) != 0)
                     {
-                        LOG_ERROR("Failed to convert BGRA image to NV12 format.", 0);
+                        LOG_ERROR("Failed to convert NV12 image to BGRA format.", 0);
                         result = K4A_RESULT_FAILED;
                     }
                 }
-                else if (target_format == K4A_IMAGE_FORMAT_COLOR_YUY2)
+                else if (in_block->reader->format == K4A_IMAGE_FORMAT_COLOR_YUY2)
                 {
-                    out_stride = out_width * 2;
-                    buffer = new std::vector<uint8_t>((size_t)(out_height * out_stride));
-
-                    if (libyuv::ARGBToYUY2(
-                            bgra_buffer->data(), bgra_stride, buffer->data(), out_stride, out_width, out_height) != 0)
+                    // The endianness of libyuv's ARGB is opposite our BGRA format. They are the same byte order.
+                    if (libyuv::YUY2ToARGB(data_buffer.Buffer(),
+                                           (int)in_block->reader->stride,
+                                           buffer->data(),
+                                           out_stride,
+                                           out_width,
+                                           out_height) != 0)
                     {
-                        LOG_ERROR("Failed to convert BGRA image to YUY2 format.", 0);
+                        LOG_ERROR("Failed to convert YUY2 image to BGRA format.", 0);
                         result = K4A_RESULT_FAILED;
                     }
                 }
@@ -1837,9 +2273,61 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
                     result = K4A_RESULT_FAILED;
                 }
 
-                if (bgra_buffer != NULL)
+                if (K4A_SUCCEEDED(result) && target_format != K4A_IMAGE_FORMAT_COLOR_BGRA32)
                 {
-                    delete bgra_buffer;
+                    auto bgra_buffer = buffer;
+                    buffer = NULL;
+                    int bgra_stride = out_stride;
+
+                    if (target_format == K4A_IMAGE_FORMAT_COLOR_NV12)
+                    {
+                        out_stride = out_width;
+                        size_t y_plane_size = (size_t)(out_height * out_stride);
+                        // Round up the size of the UV plane in case the resolution is odd.
+                        size_t uv_plane_size = (size_t)(out_height * out_stride + 1) / 2;
+                        buffer = new std::vector<uint8_t>(y_plane_size + uv_plane_size);
+
+                        if (libyuv::ARGBToNV12(bgra_buffer->data(),
+                                               bgra_stride,
+                                               buffer->data(),
+                                               out_stride,
+                                               buffer->data() + y_plane_size,
+                                               out_stride,
+                                               out_width,
+                                               out_height) != 0)
+                        {
+                            LOG_ERROR("Failed to convert BGRA image to NV12 format.", 0);
+                            result = K4A_RESULT_FAILED;
+                        }
+                    }
+                    else if (target_format == K4A_IMAGE_FORMAT_COLOR_YUY2)
+                    {
+                        out_stride = out_width * 2;
+                        buffer = new std::vector<uint8_t>((size_t)(out_height * out_stride));
+
+                        if (libyuv::ARGBToYUY2(bgra_buffer->data(),
+                                               bgra_stride,
+                                               buffer->data(),
+                                               out_stride,
+                                               out_width,
+                                               out_height) != 0)
+                        {
+                            LOG_ERROR("Failed to convert BGRA image to YUY2 format.", 0);
+                            result = K4A_RESULT_FAILED;
+                        }
+                    }
+                    else
+                    {
+                        LOG_ERROR("Unsupported image format conversion: %d to %d",
+                                  in_block->reader->format,
+                                  target_format);
+                        result = K4A_RESULT_FAILED;
+                    }
+
+                    if (bgra_buffer != NULL)
+                    {
+                        delete bgra_buffer;
+                    }
                 }
             }
         }
@@ -1873,9 +2361,95 @@ k4a_result_t convert_block_to_image(k4a_playback_context_t *context,
     return result;
 }
 
-k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k4a_capture_t *capture_handle)
+// Release any images that were decoded ahead for a track, waiting for conversions that are still running.
+void reset_decode_ahead(track_position_t *track_position)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, track_position == NULL);
+
+    for (decode_ahead_t &entry : track_position->decode_queue)
+    {
+        k4a_image_t image = entry.image.get();
+        if (image != NULL)
+        {
+            k4a_image_release(image);
+        }
+    }
+    track_position->decode_queue.clear();
+}
+
+// Start converting the blocks following the track's current block on the decode pool, so they are ready by the time
+// the next captures are read.
+void schedule_decode_ahead(k4a_playback_context_t *context,
+                           track_reader_t *track_reader,
+                           track_position_t *track_position,
+                           k4a_image_format_t format)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, context == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, track_reader == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, track_position == NULL);
+
+    if (!track_reader->rvl_compressed && track_reader->format == format)
+    {
+        // Blocks that only need to be copied are faster to convert than to hand off to another thread.
+        return;
+    }
+
+    std::deque<decode_ahead_t> &queue = track_position->decode_queue;
+    std::shared_ptr<block_info_t> last_block = queue.empty() ? track_position->current_block : queue.back().block;
+    while (last_block && queue.size() < context->decode_ahead_count)
+    {
+        std::shared_ptr<block_info_t> block = next_block(context, last_block.get(), true);
+        if (block == nullptr || block->block == NULL)
+        {
+            break;
+        }
+
+        decode_ahead_t entry;
+        entry.block = block;
+        entry.target_format = format;
+        entry.image = run_worker_job<k4a_image_t>(&context->decode_pool, [context, block, format] {
+            k4a_image_t image = NULL;
+            k4a_result_t result = TRACE_CALL(convert_block_to_image(context, block.get(), &image, format));
+            return K4A_SUCCEEDED(result) ? image : NULL;
+        });
+        queue.push_back(std::move(entry));
+        last_block = block;
+    }
+}
+
+// Convert a block to an image, using the decode-ahead result if the block has already been converted.
+static k4a_result_t get_block_image(k4a_playback_context_t *context,
+                                    track_position_t *track_position,
+                                    block_info_t *block,
+                                    k4a_image_format_t target_format,
+                                    k4a_image_t *image_out)
+{
+    std::deque<decode_ahead_t> &queue = track_position->decode_queue;
+    if (!queue.empty())
+    {
+        decode_ahead_t &entry = queue.front();
+        if (entry.block->cluster->cluster_info == block->cluster->cluster_info && entry.block->index == block->index &&
+            entry.target_format == target_format)
+        {
+            *image_out = entry.image.get();
+            queue.pop_front();
+            return *image_out != NULL ? K4A_RESULT_SUCCEEDED : K4A_RESULT_FAILED;
+        }
+
+        // Playback moved somewhere other than the next block, the decoded images will not be used.
+        reset_decode_ahead(track_position);
+    }
+
+    return TRACE_CALL(convert_block_to_image(context, block, image_out, target_format));
+}
+
+k4a_result_t new_capture(k4a_playback_context_t *context,
+                         playback_position_t *position,
+                         block_info_t *block,
+                         k4a_capture_t *capture_handle)
 {
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, position == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, capture_handle == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, block == nullptr);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, block->reader == NULL);
@@ -1888,19 +2462,21 @@ k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k
 
     k4a_image_t image_handle = NULL;
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    track_position_t *track_position = &position->tracks[block->reader];
     if (block->reader == context->color_track)
     {
-        result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, context->color_format_conversion));
+        result = TRACE_CALL(
+            get_block_image(context, track_position, block, context->color_format_conversion, &image_handle));
         k4a_capture_set_color_image(*capture_handle, image_handle);
     }
     else if (block->reader == context->depth_track)
     {
-        result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, K4A_IMAGE_FORMAT_DEPTH16));
+        result = TRACE_CALL(get_block_image(context, track_position, block, K4A_IMAGE_FORMAT_DEPTH16, &image_handle));
         k4a_capture_set_depth_image(*capture_handle, image_handle);
     }
     else if (block->reader == context->ir_track)
     {
-        result = TRACE_CALL(convert_block_to_image(context, block, &image_handle, K4A_IMAGE_FORMAT_IR16));
+        result = TRACE_CALL(get_block_image(context, track_position, block, K4A_IMAGE_FORMAT_IR16, &image_handle));
         k4a_capture_set_ir_image(*capture_handle, image_handle);
     }
     else
@@ -1916,12 +2492,19 @@ k4a_result_t new_capture(k4a_playback_context_t *context, block_info_t *block, k
     return result;
 }
 
-k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *capture_handle, bool next)
+k4a_stream_result_t get_capture(k4a_playback_context_t *context,
+                                playback_position_t *position,
+                                k4a_capture_t *capture_handle,
+                                bool next)
 {
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, position == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
 
-    track_reader_t *blocks[] = { context->color_track, context->depth_track, context->ir_track };
+    track_reader_t *blocks[] = { get_enabled_track(context->color_track),
+                                 get_enabled_track(context->depth_track),
+                                 get_enabled_track(context->ir_track) };
+    track_position_t *positions[arraysize(blocks)] = { NULL };
     std::shared_ptr<block_info_t> next_blocks[arraysize(blocks)];
 
     uint64_t timestamp_start_ns = UINT64_MAX;
@@ -1934,11 +2517,12 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
         if (blocks[i] != NULL)
         {
             enabled_tracks++;
+            positions[i] = &position->tracks[blocks[i]];
 
             // If the current block is NULL, find the next block before/after the seek timestamp.
-            if (blocks[i]->current_block == nullptr)
+            if (positions[i]->current_block == nullptr)
             {
-                next_blocks[i] = find_block(context, blocks[i], context->seek_timestamp_ns);
+                next_blocks[i] = find_block(context, blocks[i], position->seek_timestamp_ns);
                 if (!next && next_blocks[i])
                 {
                     next_blocks[i] = next_block(context, next_blocks[i].get(), false);
@@ -1946,7 +2530,7 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
             }
             else
             {
-                next_blocks[i] = next_block(context, blocks[i]->current_block.get(), next);
+                next_blocks[i] = next_block(context, positions[i]->current_block.get(), next);
             }
             if (next_blocks[i] && next_blocks[i]->block)
             {
@@ -1963,7 +2547,7 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
             else
             {
                 LOG_TRACE("%s of recording reached", next ? "End" : "Beginning");
-                blocks[i]->current_block = next_blocks[i];
+                positions[i]->current_block = next_blocks[i];
             }
         }
     }
@@ -2016,11 +2600,11 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
             bool filled = false;
             for (size_t i = 0; i < arraysize(blocks); i++)
             {
-                if (blocks[i] != NULL && next_blocks[i] == nullptr && blocks[i]->current_block == nullptr)
+                if (blocks[i] != NULL && next_blocks[i] == nullptr && positions[i]->current_block == nullptr)
                 {
                     std::shared_ptr<block_info_t> test_block = find_block(context,
                                                                           blocks[i],
-                                                                          context->seek_timestamp_ns);
+                                                                          position->seek_timestamp_ns);
                     if (next)
                     {
                         test_block = next_block(context, test_block.get(), false);
@@ -2051,11 +2635,11 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
                 {
                     if (next_blocks[i])
                     {
-                        blocks[i]->current_block = next_blocks[i];
+                        positions[i]->current_block = next_blocks[i];
                     }
                 }
 
-                return get_capture(context, capture_handle, false);
+                return get_capture(context, position, capture_handle, false);
             }
         }
     }
@@ -2071,8 +2655,9 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
     {
         if (next_blocks[i] && next_blocks[i]->block)
         {
-            blocks[i]->current_block = next_blocks[i];
-            k4a_result_t result = TRACE_CALL(new_capture(context, blocks[i]->current_block.get(), capture_handle));
+            positions[i]->current_block = next_blocks[i];
+            k4a_result_t result = TRACE_CALL(
+                new_capture(context, position, positions[i]->current_block.get(), capture_handle));
             if (K4A_FAILED(result))
             {
                 if (*capture_handle != NULL)
@@ -2084,9 +2669,260 @@ k4a_stream_result_t get_capture(k4a_playback_context_t *context, k4a_capture_t *
             }
         }
     }
+
+    if (next && context->decode_ahead_count > 0)
+    {
+        k4a_image_format_t formats[] = { context->color_format_conversion,
+                                         K4A_IMAGE_FORMAT_DEPTH16,
+                                         K4A_IMAGE_FORMAT_IR16 };
+        for (size_t i = 0; i < arraysize(blocks); i++)
+        {
+            if (blocks[i] != NULL)
+            {
+                schedule_decode_ahead(context, blocks[i], positions[i], formats[i]);
+            }
+        }
+    }
+
     return valid_blocks == 0 ? K4A_STREAM_RESULT_EOF : K4A_STREAM_RESULT_SUCCEEDED;
 }
 
+// Scan a cluster for color, depth, and IR blocks and append their headers to the capture info cursor. Only the
+// element headers are read from disk, the frame payloads are skipped over.
+k4a_result_t read_block_headers(k4a_playback_context_t *context,
+                                capture_info_cursor_t *cursor,
+                                cluster_info_t *cluster_info)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cursor == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->ebml_file == nullptr);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cluster_info == NULL);
+
+    track_reader_t *readers[] = { get_enabled_track(context->color_track),
+                                  get_enabled_track(context->depth_track),
+                                  get_enabled_track(context->ir_track) };
+    uint64_t track_numbers[arraysize(readers)] = { 0 };
+    for (size_t i = 0; i < arraysize(readers); i++)
+    {
+        if (readers[i] != NULL)
+        {
+            track_numbers[i] = readers[i]->track->TrackNumber().GetValue();
+        }
+    }
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->io_lock);
+        if (context->file_closing)
+        {
+            // User called k4a_playback_close(), return immediately.
+            return K4A_RESULT_FAILED;
+        }
+
+        LargeFileIOCallback *file_io = dynamic_cast<LargeFileIOCallback *>(context->ebml_file.get());
+        if (file_io != NULL)
+        {
+            file_io->setOwnerThread();
+        }
+
+        RETURN_IF_ERROR(seek_offset(context, cluster_info->file_offset));
+        std::unique_ptr<KaxCluster> cluster = find_next<KaxCluster>(context, true);
+        if (cluster == nullptr || !cluster->IsFiniteSize())
+        {
+            LOG_ERROR("Failed to find cluster at: %llu", cluster_info->file_offset);
+            return K4A_RESULT_FAILED;
+        }
+
+        uint64_t cluster_end = cluster->GetElementPosition() + cluster->HeadSize() + cluster->GetSize();
+        uint64_t cluster_timecode = 0;
+        bool timecode_found = false;
+        while (context->ebml_file->getFilePointer() < cluster_end)
+        {
+            std::unique_ptr<EbmlElement> element = next_child(context, cluster.get());
+            if (element == nullptr)
+            {
+                break;
+            }
+
+            EbmlId element_id(*element);
+            uint64_t element_end = element->GetElementPosition() + element->HeadSize() + element->GetSize();
+            if (element_id == KaxClusterTimecode::ClassInfos.GlobalId)
+            {
+                KaxClusterTimecode *timecode = read_element<KaxClusterTimecode>(context, element.get());
+                if (timecode == NULL)
+                {
+                    return K4A_RESULT_FAILED;
+                }
+                cluster_timecode = timecode->GetValue();
+                timecode_found = true;
+            }
+            else if (element_id == KaxSimpleBlock::ClassInfos.GlobalId ||
+                     element_id == KaxBlockGroup::ClassInfos.GlobalId)
+            {
+                uint64_t track_number = 0;
+                int16_t local_timecode = 0;
+                uint64_t data_size = 0;
+                RETURN_IF_ERROR(read_block_header(context, element.get(), &track_number, &local_timecode, &data_size));
+                if (!timecode_found)
+                {
+                    LOG_ERROR("Cluster timecode not found before block at: %llu", element->GetElementPosition());
+                    return K4A_RESULT_FAILED;
+                }
+
+                for (size_t i = 0; i < arraysize(readers); i++)
+                {
+                    if (readers[i] != NULL && track_number == track_numbers[i])
+                    {
+                        block_header_t header;
+                        header.timestamp_ns = (uint64_t)((int64_t)cluster_timecode + local_timecode) *
+                                              context->timecode_scale;
+                        header.sync_timestamp_ns = header.timestamp_ns + readers[i]->sync_delay_ns;
+                        header.data_size = data_size;
+                        cursor->pending[i].push_back(header);
+                        break;
+                    }
+                }
+            }
+
+            // Skip past the rest of the element, including any frame data.
+            assert(element_end <= INT64_MAX);
+            context->ebml_file->setFilePointer((int64_t)element_end);
+        }
+
+        return K4A_RESULT_SUCCEEDED;
+    }
+    catch (std::ios_base::failure &e)
+    {
+        LOG_ERROR("Failed to read block headers in recording '%s': %s", context->file_path, e.what());
+        return K4A_RESULT_FAILED;
+    }
+}
+
+k4a_stream_result_t get_capture_info(k4a_playback_context_t *context,
+                                     playback_position_t *position,
+                                     k4a_playback_capture_info_t *capture_info)
+{
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, position == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_info == NULL);
+
+    *capture_info = {};
+
+    track_reader_t *readers[] = { get_enabled_track(context->color_track),
+                                  get_enabled_track(context->depth_track),
+                                  get_enabled_track(context->ir_track) };
+    k4a_playback_image_info_t *images[] = { &capture_info->color, &capture_info->depth, &capture_info->ir };
+    capture_info_cursor_t &cursor = position->capture_info_cursor;
+
+    bool first_capture = !cursor.started;
+    if (first_capture)
+    {
+        // Start scanning one cluster early, since the first capture after a seek may include blocks before the seek
+        // timestamp.
+        cursor.next_cluster = find_cluster(context, position->seek_timestamp_ns);
+        if (cursor.next_cluster == NULL)
+        {
+            LOG_ERROR("Failed to find data cluster for timestamp: %llu", position->seek_timestamp_ns);
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        cluster_info_t *previous_cluster = next_cluster(context, cursor.next_cluster, false);
+        if (previous_cluster != NULL)
+        {
+            cursor.next_cluster = previous_cluster;
+        }
+        cursor.started = true;
+    }
+
+    // Scan clusters until there is a pending block after the seek timestamp for every track, or the end of the file is
+    // reached.
+    auto tracks_ready = [&]() {
+        for (size_t i = 0; i < arraysize(readers); i++)
+        {
+            if (readers[i] != NULL &&
+                (cursor.pending[i].empty() || cursor.pending[i].back().sync_timestamp_ns < position->seek_timestamp_ns))
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    while (cursor.next_cluster != NULL && !tracks_ready())
+    {
+        if (K4A_FAILED(TRACE_CALL(read_block_headers(context, &cursor, cursor.next_cluster))))
+        {
+            return K4A_STREAM_RESULT_FAILED;
+        }
+        cursor.next_cluster = next_cluster(context, cursor.next_cluster, true);
+    }
+
+    // Blocks before the seek timestamp are only kept in case they are within the sync window of the first capture.
+    block_header_t before_seek[arraysize(readers)];
+    bool before_seek_found[arraysize(readers)] = { false };
+    for (size_t i = 0; i < arraysize(readers); i++)
+    {
+        while (!cursor.pending[i].empty() && cursor.pending[i].front().sync_timestamp_ns < position->seek_timestamp_ns)
+        {
+            before_seek[i] = cursor.pending[i].front();
+            before_seek_found[i] = first_capture;
+            cursor.pending[i].pop_front();
+        }
+    }
+
+    // Group the earliest blocks within the sync window into a capture, the same as get_capture().
+    uint64_t timestamp_start_ns = UINT64_MAX;
+    for (size_t i = 0; i < arraysize(readers); i++)
+    {
+        if (!cursor.pending[i].empty() && cursor.pending[i].front().sync_timestamp_ns < timestamp_start_ns)
+        {
+            timestamp_start_ns = cursor.pending[i].front().sync_timestamp_ns;
+        }
+    }
+    if (timestamp_start_ns == UINT64_MAX)
+    {
+        LOG_TRACE("End of recording reached", 0);
+        return K4A_STREAM_RESULT_EOF;
+    }
+
+    const block_header_t *capture_blocks[arraysize(readers)] = { NULL };
+    uint64_t timestamp_end_ns = timestamp_start_ns;
+    for (size_t i = 0; i < arraysize(readers); i++)
+    {
+        if (!cursor.pending[i].empty() &&
+            cursor.pending[i].front().sync_timestamp_ns - timestamp_start_ns < context->sync_period_ns / 2)
+        {
+            capture_blocks[i] = &cursor.pending[i].front();
+            timestamp_end_ns = std::max(timestamp_end_ns, capture_blocks[i]->sync_timestamp_ns);
+        }
+    }
+
+    // If the seek timestamp was in the middle of a capture, fill in the images from before the seek.
+    for (size_t i = 0; i < arraysize(readers); i++)
+    {
+        if (capture_blocks[i] == NULL && before_seek_found[i] &&
+            timestamp_end_ns - before_seek[i].sync_timestamp_ns < context->sync_period_ns / 2)
+        {
+            capture_blocks[i] = &before_seek[i];
+        }
+    }
+
+    for (size_t i = 0; i < arraysize(readers); i++)
+    {
+        if (capture_blocks[i] != NULL)
+        {
+            images[i]->present = true;
+            images[i]->device_timestamp_usec = capture_blocks[i]->timestamp_ns / 1000 +
+                                               (uint64_t)context->record_config.start_timestamp_offset_usec;
+            images[i]->size = (size_t)capture_blocks[i]->data_size;
+            if (capture_blocks[i] != &before_seek[i])
+            {
+                cursor.pending[i].pop_front();
+            }
+        }
+    }
+
+    return K4A_STREAM_RESULT_SUCCEEDED;
+}
+
 // Returns NULL if the buffer is invalid.
 static matroska_imu_sample_t *parse_imu_sample_buffer(DataBuffer &data_buffer)
 {
@@ -2108,9 +2944,13 @@ static matroska_imu_sample_t *parse_imu_sample_buffer(DataBuffer &data_buffer)
     }
 }
 
-k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_sample_t *imu_sample, bool next)
+k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context,
+                                   playback_position_t *position,
+                                   k4a_imu_sample_t *imu_sample,
+                                   bool next)
 {
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, position == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
 
     if (context->imu_track == NULL)
@@ -2119,13 +2959,20 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
         *imu_sample = { 0 };
         return K4A_STREAM_RESULT_EOF;
     }
+    else if (!context->imu_track->enabled)
+    {
+        LOG_WARNING("IMU track is disabled.", 0);
+        *imu_sample = { 0 };
+        return K4A_STREAM_RESULT_EOF;
+    }
 
-    std::shared_ptr<block_info_t> block_info = context->imu_track->current_block;
+    track_position_t *track_position = &position->tracks[context->imu_track];
+    std::shared_ptr<block_info_t> block_info = track_position->current_block;
 
     if (block_info == nullptr)
     {
         // There is no current IMU sample, find the next/previous sample based on seek_timestamp.
-        block_info = find_block(context, context->imu_track, context->seek_timestamp_ns);
+        block_info = find_block(context, context->imu_track, position->seek_timestamp_ns);
         if (block_info && !block_info->block)
         {
             // The seek timestamp is past the end of the file, get the last block instead.
@@ -2137,12 +2984,12 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
             // The returned block will not have an accurate sub_index due to timestamp estimation, select the correct
             // sub_index based on the real timestamp stored in the sample.
             size_t sample_count = block_info->block->NumberFrames();
-            if (block_info->sync_timestamp_ns > context->seek_timestamp_ns)
+            if (block_info->sync_timestamp_ns > position->seek_timestamp_ns)
             {
                 // The timestamp we're looking for is before the found block.
                 block_info->sub_index = next ? 0 : -1;
             }
-            else if (block_info->sync_timestamp_ns + block_info->block_duration_ns <= context->seek_timestamp_ns)
+            else if (block_info->sync_timestamp_ns + block_info->block_duration_ns <= position->seek_timestamp_ns)
             {
                 // The timestamp we're looking for is after the found block.
                 block_info->sub_index = (int)sample_count + (next ? 0 : -1);
@@ -2152,7 +2999,7 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
                 // The timestamp we're looking for is within the found block.
                 // IMU timestamps within the sample buffer are device timestamps, not relative to start of file.
                 // The seek timestamp needs to be converted to a device timestamp when comparing.
-                uint64_t seek_device_timestamp_ns = context->seek_timestamp_ns +
+                uint64_t seek_device_timestamp_ns = position->seek_timestamp_ns +
                                                     ((uint64_t)context->record_config.start_timestamp_offset_usec *
                                                      1000);
                 block_info->sub_index = -1;
@@ -2183,7 +3030,7 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
         block_info = next_block(context, block_info.get(), next);
     }
 
-    context->imu_track->current_block = block_info;
+    track_position->current_block = block_info;
 
     if (block_info && block_info->block && block_info->sub_index >= 0 &&
         block_info->sub_index < (int)block_info->block->NumberFrames())
@@ -2214,21 +3061,111 @@ k4a_stream_result_t get_imu_sample(k4a_playback_context_t *context, k4a_imu_samp
     return K4A_STREAM_RESULT_EOF;
 }
 
+k4a_stream_result_t get_imu_samples(k4a_playback_context_t *context,
+                                    uint64_t start_timestamp_usec,
+                                    uint64_t end_timestamp_usec,
+                                    k4a_imu_sample_t *imu_samples,
+                                    size_t max_samples,
+                                    size_t *sample_count)
+{
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_samples == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, sample_count == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, max_samples == 0);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, end_timestamp_usec < start_timestamp_usec);
+
+    *sample_count = 0;
+    if (context->imu_track == NULL)
+    {
+        LOG_WARNING("Recording has no IMU track.", 0);
+        return K4A_STREAM_RESULT_EOF;
+    }
+    else if (!context->imu_track->enabled)
+    {
+        LOG_WARNING("IMU track is disabled.", 0);
+        return K4A_STREAM_RESULT_EOF;
+    }
+
+    // Block timestamps are relative to the start of the file, while the requested range and the timestamps stored in
+    // the sample buffers are device timestamps.
+    uint64_t start_offset_usec = context->record_config.start_timestamp_offset_usec;
+    uint64_t seek_timestamp_ns = 0;
+    if (start_timestamp_usec > start_offset_usec)
+    {
+        seek_timestamp_ns = (start_timestamp_usec - start_offset_usec) * 1000;
+    }
+
+    std::shared_ptr<block_info_t> block_info = find_block(context, context->imu_track, seek_timestamp_ns);
+    size_t count = 0;
+    while (block_info && block_info->block && count < max_samples)
+    {
+        // Decode the whole block straight into the output array instead of stepping through it one sample at a time.
+        size_t frame_count = block_info->block->NumberFrames();
+        for (size_t i = 0; i < frame_count && count < max_samples; i++)
+        {
+            matroska_imu_sample_t *sample = parse_imu_sample_buffer(block_info->block->GetBuffer((unsigned int)i));
+            if (sample == NULL)
+            {
+                *sample_count = count;
+                return K4A_STREAM_RESULT_FAILED;
+            }
+
+            uint64_t acc_timestamp_usec = sample->acc_timestamp_ns / 1000;
+            if (acc_timestamp_usec >= end_timestamp_usec)
+            {
+                block_info = nullptr;
+                break;
+            }
+            else if (acc_timestamp_usec >= start_timestamp_usec)
+            {
+                k4a_imu_sample_t *imu_sample = &imu_samples[count++];
+                imu_sample->acc_timestamp_usec = acc_timestamp_usec;
+                imu_sample->gyro_timestamp_usec = sample->gyro_timestamp_ns / 1000;
+                imu_sample->temperature = std::numeric_limits<float>::quiet_NaN();
+                for (size_t j = 0; j < 3; j++)
+                {
+                    imu_sample->acc_sample.v[j] = sample->acc_data[j];
+                    imu_sample->gyro_sample.v[j] = sample->gyro_data[j];
+                }
+            }
+        }
+
+        if (block_info && count < max_samples)
+        {
+            // Skip to the next block rather than the next sample in this one.
+            block_info->sub_index = (int)frame_count - 1;
+            block_info = next_block(context, block_info.get(), true);
+        }
+    }
+
+    *sample_count = count;
+    return count > 0 ? K4A_STREAM_RESULT_SUCCEEDED : K4A_STREAM_RESULT_EOF;
+}
+
 k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
+                                   playback_position_t *position,
                                    track_reader_t *track_reader,
                                    k4a_playback_data_block_t *data_block_handle,
                                    bool next)
 {
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, position == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, track_reader == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, data_block_handle == NULL);
 
-    std::shared_ptr<block_info_t> read_block = track_reader->current_block;
+    if (!track_reader->enabled)
+    {
+        LOG_ERROR("Track is disabled: %s", track_reader->track_name.c_str());
+        return K4A_STREAM_RESULT_FAILED;
+    }
+
+    track_position_t *track_position = &position->tracks[track_reader];
+    std::shared_ptr<block_info_t> read_block = track_position->current_block;
     if (read_block == nullptr)
     {
         // If the track current block is nullptr, it means we just performed a seek frame operation.
         // find_block() always finds the block with timestamp >= seek_timestamp.
-        read_block = find_block(context, track_reader, context->seek_timestamp_ns);
+        read_block = find_block(context, track_reader, position->seek_timestamp_ns);
         if (!next && read_block)
         {
             // In order to find the first timestamp < seek_timestamp, we need to query the previous block.
@@ -2245,7 +3182,7 @@ k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
         return K4A_STREAM_RESULT_FAILED;
     }
 
-    track_reader->current_block = read_block;
+    track_position->current_block = read_block;
 
     // Reach EOF
     if (read_block->block == nullptr)
@@ -2260,10 +3197,9 @@ k4a_stream_result_t get_data_block(k4a_playback_context_t *context,
         return K4A_STREAM_RESULT_FAILED;
     }
 
-    DataBuffer &data_buffer = track_reader->current_block->block->GetBuffer(
-        (unsigned int)track_reader->current_block->sub_index);
+    DataBuffer &data_buffer = read_block->block->GetBuffer((unsigned int)read_block->sub_index);
 
-    data_block_context->device_timestamp_usec = estimate_block_timestamp_ns(track_reader->current_block) / 1000 +
+    data_block_context->device_timestamp_usec = estimate_block_timestamp_ns(read_block) / 1000 +
                                                 context->record_config.start_timestamp_offset_usec;
     data_block_context->data_block.assign(data_buffer.Buffer(), data_buffer.Buffer() + data_buffer.Size());
 
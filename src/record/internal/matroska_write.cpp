@@ -1,14 +1,17 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <chrono>
 #include <ctime>
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <future>
 
 #include <k4a/k4a.h>
 #include <k4ainternal/matroska_write.h>
 #include <k4ainternal/logging.h>
+#include <k4ainternal/perf_trace.h>
 
 using namespace LIBMATROSKA_NAMESPACE;
 
@@ -171,6 +174,8 @@ track_header_t *add_track(k4a_record_context_t *context,
     track_header.track = track;
     track_header.custom_track = false;
     track_header.high_freq_data = false;
+    track_header.rvl_compressed = false;
+    track_header.deferred_byte_swap = false;
     auto entry = context->tracks.emplace(std::string(name), track_header);
 
     return &entry.first->second;
@@ -189,7 +194,9 @@ void set_track_info_video(track_header_t *track, uint64_t width, uint64_t height
 }
 
 // Buffer needs to be valid until it is flushed to disk. The DataBuffer free callback can be used to assist with this.
-// If a failure is returned, the caller will need to free the buffer.
+// If a failure is returned, the caller will need to free the buffer. If the buffer is dropped because the memory budget
+// is full, it is freed and success is returned.
+// May block the caller until there is space in the memory budget, see k4a_record_set_memory_budget().
 k4a_result_t
 write_track_data(k4a_record_context_t *context, track_header_t *track, uint64_t timestamp_ns, DataBuffer *buffer)
 {
@@ -201,7 +208,43 @@ write_track_data(k4a_record_context_t *context, track_header_t *track, uint64_t
 
     try
     {
-        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        std::unique_lock<std::mutex> lock(context->pending_cluster_lock);
+
+        if (context->memory_budget > 0 && context->pending_bytes + buffer->Size() > context->memory_budget)
+        {
+            if (context->memory_policy == K4A_RECORD_MEMORY_POLICY_DROP)
+            {
+                if (context->dropped_count == 0)
+                {
+                    LOG_WARNING("Recording memory budget of %llu bytes exceeded, dropping data.",
+                                (unsigned long long)context->memory_budget);
+                }
+                context->dropped_count++;
+                buffer->FreeBuffer(*buffer);
+                delete buffer;
+                return K4A_RESULT_SUCCEEDED;
+            }
+
+            if (context->pending_space_notify)
+            {
+                // Make sure the writer thread sees the budget is full, it will write clusters early to make space.
+                context->writer_notify->notify_one();
+
+                auto wait_start = std::chrono::steady_clock::now();
+                context->pending_space_notify->wait(lock, [context, buffer]() {
+                    // Stop waiting if the writer can't free any more memory: only the newest cluster is left in the
+                    // queue, or the writer thread has exited.
+                    return context->pending_bytes + buffer->Size() <= context->memory_budget ||
+                           context->pending_clusters.empty() ||
+                           (context->pending_clusters.size() == 1 &&
+                            context->pending_clusters.front()->data_size == context->pending_bytes) ||
+                           context->writer_exited;
+                });
+                context->blocked_time_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                std::chrono::steady_clock::now() - wait_start)
+                                                .count();
+            }
+        }
 
         if (context->most_recent_timestamp < timestamp_ns)
         {
@@ -217,6 +260,8 @@ write_track_data(k4a_record_context_t *context, track_header_t *track, uint64_t
 
         track_data_t data = { track, buffer };
         cluster->data.push_back(std::make_pair(timestamp_ns, data));
+        cluster->data_size += buffer->Size();
+        context->pending_bytes += buffer->Size();
     }
     catch (std::system_error &e)
     {
@@ -296,6 +341,118 @@ static bool sort_by_pair_asc(const std::pair<uint64_t, track_data_t> &a, const s
     return (a.first < b.first);
 }
 
+static bool free_encoded_buffer(const DataBuffer &buffer)
+{
+    delete[] buffer.Buffer();
+    return true;
+}
+
+// Replaces the raw depth or IR buffer in data with the encoding used by its track: RVL compressed, or byte swapped to
+// big-endian for b16g tracks recorded with zero-copy captures.
+static k4a_result_t encode_track_data(track_data_t *data)
+{
+    DataBuffer *raw_buffer = data->buffer;
+    size_t count = raw_buffer->Size() / sizeof(uint16_t);
+
+    // Raw buffers are queued in native little-endian order by k4a_record_write_capture().
+    const uint16_t *raw_data = reinterpret_cast<const uint16_t *>(raw_buffer->Buffer());
+    binary *encoded = NULL;
+    size_t encoded_size = 0;
+    if (data->track->rvl_compressed)
+    {
+        size_t max_size = rvl_max_compressed_size(count);
+        encoded = new (std::nothrow) binary[max_size];
+        if (encoded != NULL)
+        {
+            encoded_size = rvl_compress(raw_data, count, encoded);
+            assert(encoded_size <= max_size);
+        }
+    }
+    else
+    {
+        encoded_size = count * sizeof(uint16_t);
+        encoded = new (std::nothrow) binary[encoded_size];
+        if (encoded != NULL)
+        {
+            copy_swap_bytes_16(reinterpret_cast<uint16_t *>(encoded), raw_data, count);
+        }
+    }
+
+    if (encoded == NULL)
+    {
+        LOG_ERROR("Failed to allocate buffer for depth encoding.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    data->buffer = new DataBuffer(encoded, (uint32)encoded_size, &free_encoded_buffer);
+    raw_buffer->FreeBuffer(*raw_buffer);
+    delete raw_buffer;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Sorts the data in the cluster by timestamp and queues all depth and IR track data that was stored raw to be encoded.
+// Each frame is independent, so frames are encoded in parallel on the encode pool to keep encoding from limiting the
+// rate the writer thread can flush clusters to disk. The encode results must be collected with
+// finish_prepare_cluster() before the cluster is written or freed.
+static void start_prepare_cluster(k4a_record_context_t *context,
+                                  cluster_t *cluster,
+                                  std::vector<std::future<k4a_result_t>> *encode_results)
+{
+    std::sort(cluster->data.begin(), cluster->data.end(), sort_by_pair_asc);
+
+    for (auto &data : cluster->data)
+    {
+        if (data.second.track->rvl_compressed || data.second.track->deferred_byte_swap)
+        {
+            std::function<k4a_result_t()> encode = std::bind(encode_track_data, &data.second);
+            encode_results->push_back(run_worker_job(&context->encode_pool, encode));
+        }
+    }
+}
+
+// Waits for the encoding queued by start_prepare_cluster() to finish.
+static k4a_result_t finish_prepare_cluster(cluster_t *cluster, std::vector<std::future<k4a_result_t>> *encode_results)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    for (auto &encode_result : *encode_results)
+    {
+        if (K4A_FAILED(encode_result.get()))
+        {
+            result = K4A_RESULT_FAILED;
+        }
+    }
+    encode_results->clear();
+
+    if (K4A_SUCCEEDED(result))
+    {
+        cluster->prepared = true;
+    }
+    return result;
+}
+
+// Frees a cluster and its data without writing it to disk.
+static void free_cluster(cluster_t *cluster)
+{
+    for (std::pair<uint64_t, track_data_t> data : cluster->data)
+    {
+        data.second.buffer->FreeBuffer(*data.second.buffer);
+        delete data.second.buffer;
+    }
+    delete cluster;
+}
+
+// Does the CPU work needed before a cluster can be written: sorts the data by timestamp and encodes raw depth data.
+k4a_result_t prepare_cluster(k4a_record_context_t *context, cluster_t *cluster)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cluster == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cluster->prepared);
+
+    std::vector<std::future<k4a_result_t>> encode_results;
+    start_prepare_cluster(context, cluster, &encode_results);
+    return finish_prepare_cluster(cluster, &encode_results);
+}
+
 // Writes the cluster to disk and frees the cluster.
 // Updated time_end_ns is optionally returned through the argument pointer.
 k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, uint64_t *time_end_ns)
@@ -311,8 +468,12 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
         return K4A_RESULT_FAILED;
     }
 
-    // Sort the data in the cluster by timestamp so it can be written in order
-    std::sort(cluster->data.begin(), cluster->data.end(), sort_by_pair_asc);
+    if (!cluster->prepared && K4A_FAILED(TRACE_CALL(prepare_cluster(context, cluster))))
+    {
+        // Buffers that failed to encode are still raw, skip the cluster rather than write invalid data.
+        free_cluster(cluster);
+        return K4A_RESULT_FAILED;
+    }
 
     KaxCluster *new_cluster = new KaxCluster();
 
@@ -411,7 +572,15 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
     auto &cues = GetChild<KaxCues>(*context->file_segment);
     try
     {
-        new_cluster->Render(*context->ebml_file, cues);
+        // The cluster is rendered into the file's write buffer, which is only flushed to the OS when it is full or the
+        // recording is flushed, so consecutive clusters are coalesced into large writes. Flush time is tracked by the
+        // LargeFileIOCallback.
+        auto render_start = std::chrono::steady_clock::now();
+        filepos_t cluster_size = new_cluster->Render(*context->ebml_file, cues);
+        auto render_time = std::chrono::steady_clock::now() - render_start;
+
+        context->bytes_written += cluster_size;
+        context->render_time_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(render_time).count();
     }
     catch (std::ios_base::failure &e)
     {
@@ -451,6 +620,69 @@ k4a_result_t write_cluster(k4a_record_context_t *context, cluster_t *cluster, ui
     return result;
 }
 
+// Removes written or dropped cluster data from the pending byte count, and wakes any writes blocked on the budget.
+static void release_pending_bytes(k4a_record_context_t *context, uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+    assert(context->pending_bytes >= size);
+    context->pending_bytes -= size;
+    if (context->pending_space_notify)
+    {
+        context->pending_space_notify->notify_all();
+    }
+}
+
+// Writes a batch of clusters in order. While one cluster is being rendered to disk, the next one is encoded on the
+// encode pool so that file IO is not stalled behind encoding.
+static k4a_result_t write_cluster_batch(k4a_record_context_t *context, const std::vector<cluster_t *> &clusters)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    std::vector<std::future<k4a_result_t>> encode_results;
+
+    if (!clusters.empty())
+    {
+        start_prepare_cluster(context, clusters[0], &encode_results);
+    }
+
+    size_t i = 0;
+    for (; i < clusters.size() && K4A_SUCCEEDED(result); i++)
+    {
+        cluster_t *cluster = clusters[i];
+        uint64_t data_size = cluster->data_size;
+
+        k4a_result_t prepare_result = TRACE_CALL(finish_prepare_cluster(cluster, &encode_results));
+        if (i + 1 < clusters.size())
+        {
+            start_prepare_cluster(context, clusters[i + 1], &encode_results);
+        }
+
+        if (K4A_SUCCEEDED(prepare_result))
+        {
+            result = TRACE_CALL(write_cluster(context, cluster));
+        }
+        else
+        {
+            free_cluster(cluster);
+            result = K4A_RESULT_FAILED;
+        }
+
+        release_pending_bytes(context, data_size);
+    }
+
+    // On failure, wait for any in-progress encoding and drop the rest of the batch.
+    for (auto &encode_result : encode_results)
+    {
+        encode_result.wait();
+    }
+    for (; i < clusters.size(); i++)
+    {
+        release_pending_bytes(context, clusters[i]->data_size);
+        free_cluster(clusters[i]);
+    }
+
+    return result;
+}
+
 static void matroska_writer_thread(k4a_record_context_t *context)
 {
     assert(context->writer_notify);
@@ -465,44 +697,53 @@ static void matroska_writer_thread(k4a_record_context_t *context)
             file_io->setOwnerThread();
         }
 
+        std::vector<cluster_t *> ready_clusters;
         while (!context->writer_stopping)
         {
+            ready_clusters.clear();
+            bool queue_full = false;
+
             context->pending_cluster_lock.lock();
 
-            // Check the oldest pending cluster to see if we should write to disk.
-            cluster_t *oldest_cluster = NULL;
-            if (!context->pending_clusters.empty())
+            // Take every pending cluster that is old enough to write, so they can be written back to back.
+            // If over half of the memory budget is in use, also take the oldest clusters early, except for the newest
+            // cluster which is still receiving data.
+            uint64_t queued_bytes = context->pending_bytes;
+            while (!context->pending_clusters.empty())
             {
-                oldest_cluster = context->pending_clusters.front();
-                if (context->most_recent_timestamp >= oldest_cluster->time_end_ns)
+                cluster_t *oldest_cluster = context->pending_clusters.front();
+                bool expired = context->most_recent_timestamp >= oldest_cluster->time_end_ns &&
+                               context->most_recent_timestamp - oldest_cluster->time_end_ns > CLUSTER_WRITE_DELAY_NS;
+                bool over_budget = context->memory_budget > 0 && queued_bytes > context->memory_budget / 2 &&
+                                   context->pending_clusters.size() > 1;
+                if (!expired && !over_budget)
                 {
-                    uint64_t age = context->most_recent_timestamp - oldest_cluster->time_end_ns;
-                    if (age > CLUSTER_WRITE_DELAY_NS)
-                    {
-                        assert(oldest_cluster->time_start_ns >= context->last_written_timestamp);
-                        context->pending_clusters.pop_front();
-                        context->last_written_timestamp = oldest_cluster->time_end_ns;
-                        if (age > CLUSTER_WRITE_QUEUE_WARNING_NS)
-                        {
-                            LOG_ERROR("Disk write speed is too low, write queue is filling up.", 0);
-                        }
-                    }
-                    else
-                    {
-                        oldest_cluster = NULL;
-                    }
+                    break;
                 }
-                else
+
+                assert(oldest_cluster->time_start_ns >= context->last_written_timestamp);
+                if (expired &&
+                    context->most_recent_timestamp - oldest_cluster->time_end_ns > CLUSTER_WRITE_QUEUE_WARNING_NS)
                 {
-                    oldest_cluster = NULL;
+                    queue_full = true;
                 }
+                queued_bytes -= oldest_cluster->data_size;
+                context->pending_clusters.pop_front();
+                context->last_written_timestamp = oldest_cluster->time_end_ns;
+                ready_clusters.push_back(oldest_cluster);
             }
 
             context->pending_cluster_lock.unlock();
 
-            if (oldest_cluster)
+            if (queue_full)
             {
-                k4a_result_t result = TRACE_CALL(write_cluster(context, oldest_cluster));
+                LOG_ERROR("Disk write speed is too low, write queue is filling up.", 0);
+            }
+
+            if (!ready_clusters.empty())
+            {
+                PERF_TRACE_SCOPE("matroska_writer_thread");
+                k4a_result_t result = TRACE_CALL(write_cluster_batch(context, ready_clusters));
                 if (K4A_FAILED(result))
                 {
                     // write_cluster failures are not recoverable (file IO errors only, the file is likely corrupt)
@@ -512,7 +753,7 @@ static void matroska_writer_thread(k4a_record_context_t *context)
             }
 
             // Wait until more clusters arrive up to 100ms, or 1ms if the queue is not empty.
-            context->writer_notify->wait_for(lock, std::chrono::milliseconds(oldest_cluster ? 1 : 100));
+            context->writer_notify->wait_for(lock, std::chrono::milliseconds(ready_clusters.empty() ? 100 : 1));
 
             if (file_io != NULL)
             {
@@ -524,6 +765,21 @@ static void matroska_writer_thread(k4a_record_context_t *context)
     {
         LOG_ERROR("Writer thread threw exception: %s", e.what());
     }
+
+    try
+    {
+        // Release any writes waiting on the memory budget, since nothing else will be written in the background.
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        context->writer_exited = true;
+        if (context->pending_space_notify)
+        {
+            context->pending_space_notify->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Writer thread threw exception: %s", e.what());
+    }
 }
 
 k4a_result_t start_matroska_writer_thread(k4a_record_context_t *context)
@@ -534,13 +790,18 @@ k4a_result_t start_matroska_writer_thread(k4a_record_context_t *context)
     try
     {
         context->writer_notify.reset(new std::condition_variable());
+        context->pending_space_notify.reset(new std::condition_variable());
 
         context->writer_stopping = false;
+        context->writer_exited = false;
+        // The writer thread renders clusters while they are encoded, so leave it a core.
+        start_worker_pool(&context->encode_pool, std::max(2u, std::thread::hardware_concurrency()) - 1);
         context->writer_thread = std::thread(matroska_writer_thread, context);
     }
     catch (std::system_error &e)
     {
         LOG_ERROR("Failed to start recording writer thread: %s", e.what());
+        stop_worker_pool(&context->encode_pool);
         return K4A_RESULT_FAILED;
     }
 
@@ -563,6 +824,8 @@ void stop_matroska_writer_thread(k4a_record_context_t *context)
     {
         LOG_ERROR("Failed to stop recording writer thread: %s", e.what());
     }
+
+    stop_worker_pool(&context->encode_pool);
 }
 
 KaxTag *
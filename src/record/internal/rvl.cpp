@@ -0,0 +1,192 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include "k4ainternal/matroska_common.h"
+
+// RVL lossless depth compression, as described in "Fast Lossless Depth Image Compression" (Andrew D. Wilson, 2017).
+//
+// The image is encoded as a sequence of runs: [zero run length][non-zero run length][non-zero values...]. Non-zero
+// values are stored as the zig-zag encoded delta from the previous non-zero value. All integers use a variable length
+// encoding of 4-bit nibbles (3 bits of data + 1 continuation bit), packed 8 nibbles at a time into 32-bit words that
+// are stored little-endian.
+
+namespace
+{
+class nibble_writer
+{
+public:
+    explicit nibble_writer(uint8_t *output) : m_output(output), m_start(output) {}
+
+    void write_vle(uint32_t value)
+    {
+        do
+        {
+            uint32_t nibble = value & 0x7;
+            value >>= 3;
+            if (value)
+            {
+                nibble |= 0x8;
+            }
+            m_word = (m_word << 4) | nibble;
+            if (++m_nibbles == 8)
+            {
+                flush_word();
+            }
+        } while (value);
+    }
+
+    size_t finish()
+    {
+        if (m_nibbles)
+        {
+            m_word <<= 4 * (8 - m_nibbles);
+            flush_word();
+        }
+        return static_cast<size_t>(m_output - m_start);
+    }
+
+private:
+    void flush_word()
+    {
+        m_output[0] = static_cast<uint8_t>(m_word);
+        m_output[1] = static_cast<uint8_t>(m_word >> 8);
+        m_output[2] = static_cast<uint8_t>(m_word >> 16);
+        m_output[3] = static_cast<uint8_t>(m_word >> 24);
+        m_output += 4;
+        m_word = 0;
+        m_nibbles = 0;
+    }
+
+    uint8_t *m_output;
+    uint8_t *m_start;
+    uint32_t m_word = 0;
+    int m_nibbles = 0;
+};
+
+class nibble_reader
+{
+public:
+    nibble_reader(const uint8_t *input, size_t size) : m_input(input), m_end(input + (size & ~(size_t)3)) {}
+
+    // Returns false if the input ends before the value is complete, or the value overflows 32 bits.
+    bool read_vle(uint32_t *value)
+    {
+        uint32_t result = 0;
+        int shift = 0;
+        uint32_t nibble;
+        do
+        {
+            if (m_nibbles == 0)
+            {
+                if (m_input == m_end)
+                {
+                    return false;
+                }
+                m_word = (uint32_t)m_input[0] | (uint32_t)m_input[1] << 8 | (uint32_t)m_input[2] << 16 |
+                         (uint32_t)m_input[3] << 24;
+                m_input += 4;
+                m_nibbles = 8;
+            }
+            if (shift > 30)
+            {
+                return false;
+            }
+            nibble = m_word >> 28;
+            result |= (nibble & 0x7) << shift;
+            m_word <<= 4;
+            m_nibbles--;
+            shift += 3;
+        } while (nibble & 0x8);
+
+        *value = result;
+        return true;
+    }
+
+private:
+    const uint8_t *m_input;
+    const uint8_t *m_end;
+    uint32_t m_word = 0;
+    int m_nibbles = 0;
+};
+} // namespace
+
+size_t rvl_max_compressed_size(size_t count)
+{
+    // Each non-zero value takes at most 6 nibbles (17-bit zig-zag delta), and run lengths are amortized over the pixels
+    // in each run. Leave room for the first run header and the final partial word.
+    return count * 3 + 16;
+}
+
+size_t rvl_compress(const uint16_t *input, size_t count, uint8_t *output)
+{
+    nibble_writer writer(output);
+    const uint16_t *end = input + count;
+    int32_t previous = 0;
+
+    while (input != end)
+    {
+        uint32_t zeros = 0;
+        for (; input != end && *input == 0; input++)
+        {
+            zeros++;
+        }
+        writer.write_vle(zeros);
+
+        uint32_t nonzeros = 0;
+        for (const uint16_t *p = input; p != end && *p != 0; p++)
+        {
+            nonzeros++;
+        }
+        writer.write_vle(nonzeros);
+
+        for (uint32_t i = 0; i < nonzeros; i++)
+        {
+            int32_t current = *input++;
+            int32_t delta = current - previous;
+            writer.write_vle((static_cast<uint32_t>(delta) << 1) ^ static_cast<uint32_t>(delta >> 31));
+            previous = current;
+        }
+    }
+
+    return writer.finish();
+}
+
+bool rvl_decompress(const uint8_t *input, size_t size, uint16_t *output, size_t count)
+{
+    nibble_reader reader(input, size);
+    uint16_t *end = output + count;
+    uint32_t previous = 0;
+
+    while (output != end)
+    {
+        uint32_t zeros, nonzeros;
+        if (!reader.read_vle(&zeros) || zeros > static_cast<size_t>(end - output))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < zeros; i++)
+        {
+            *output++ = 0;
+        }
+
+        if (!reader.read_vle(&nonzeros) || nonzeros > static_cast<size_t>(end - output))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < nonzeros; i++)
+        {
+            uint32_t positive;
+            if (!reader.read_vle(&positive))
+            {
+                return false;
+            }
+            // Unsigned math wraps the same way as the encoder for valid data, and avoids overflow on corrupt data.
+            uint32_t delta = (positive >> 1) ^ (0u - (positive & 1));
+            uint16_t current = static_cast<uint16_t>(previous + delta);
+            *output++ = current;
+            previous = current;
+        }
+    }
+
+    return true;
+}
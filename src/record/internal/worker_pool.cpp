@@ -0,0 +1,117 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <k4ainternal/matroska_common.h>
+#include <k4ainternal/logging.h>
+
+namespace k4arecord
+{
+static void worker_pool_thread(worker_pool_t *pool)
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(pool->lock);
+        while (true)
+        {
+            pool->notify->wait(lock, [pool]() { return pool->stopping || !pool->jobs.empty(); });
+            if (pool->jobs.empty())
+            {
+                break;
+            }
+
+            std::function<void()> job = std::move(pool->jobs.front());
+            pool->jobs.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Worker thread threw exception: %s", e.what());
+    }
+}
+
+void start_worker_pool(worker_pool_t *pool, unsigned int thread_count)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, pool == NULL);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(pool->lock);
+        if (!pool->workers.empty())
+        {
+            return;
+        }
+
+        if (!pool->notify)
+        {
+            pool->notify.reset(new std::condition_variable());
+        }
+        pool->stopping = false;
+
+        for (unsigned int i = 0; i < thread_count; i++)
+        {
+            pool->workers.emplace_back(worker_pool_thread, pool);
+        }
+    }
+    catch (std::system_error &e)
+    {
+        // Any threads that did start are used.
+        LOG_WARNING("Failed to start worker thread: %s", e.what());
+    }
+}
+
+void stop_worker_pool(worker_pool_t *pool)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, pool == NULL);
+
+    try
+    {
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(pool->lock);
+            pool->stopping = true;
+            workers.swap(pool->workers);
+        }
+
+        if (!workers.empty())
+        {
+            pool->notify->notify_all();
+        }
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop worker threads: %s", e.what());
+    }
+}
+
+bool queue_worker_job(worker_pool_t *pool, std::function<void()> job)
+{
+    RETURN_VALUE_IF_ARG(false, pool == NULL);
+
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(pool->lock);
+            if (pool->workers.empty())
+            {
+                return false;
+            }
+            pool->jobs.push_back(std::move(job));
+        }
+        pool->notify->notify_one();
+    }
+    catch (std::system_error &e)
+    {
+        LOG_WARNING("Failed to queue worker job: %s", e.what());
+        return false;
+    }
+    return true;
+}
+
+} // namespace k4arecord
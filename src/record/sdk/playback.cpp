@@ -4,6 +4,7 @@
 #include <ctime>
 #include <iostream>
 #include <sstream>
+#include <algorithm>
 
 #include <k4a/k4a.h>
 #include <k4arecord/playback.h>
@@ -56,8 +57,8 @@ k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle
         }
         else
         {
-            context->seek_cluster = load_cluster(context, seek_cluster_info);
-            if (context->seek_cluster == nullptr)
+            context->position.seek_cluster = load_cluster(context, seek_cluster_info);
+            if (context->position.seek_cluster == nullptr)
             {
                 LOG_ERROR("Failed to load first data cluster of recording.", 0);
                 result = K4A_RESULT_FAILED;
@@ -67,7 +68,7 @@ k4a_result_t k4a_playback_open(const char *path, k4a_playback_t *playback_handle
 
     if (K4A_SUCCEEDED(result))
     {
-        reset_seek_pointers(context, 0);
+        reset_seek_pointers(context, &context->position, 0);
     }
     else
     {
@@ -412,6 +413,47 @@ k4a_result_t k4a_playback_set_color_conversion(k4a_playback_t playback_handle, k
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t k4a_playback_set_decode_ahead(k4a_playback_t playback_handle, uint32_t capture_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, capture_count > PLAYBACK_MAX_DECODE_AHEAD_COUNT);
+
+    context->decode_ahead_count = capture_count;
+    if (capture_count > 0)
+    {
+        // Leave a core for the thread reading captures.
+        start_worker_pool(&context->decode_pool, std::max(2u, std::thread::hardware_concurrency()) - 1);
+    }
+    else
+    {
+        for (auto &itr : context->position.tracks)
+        {
+            reset_decode_ahead(&itr.second);
+        }
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_set_track_enabled(k4a_playback_t playback_handle, const char *track_name, bool enabled)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, track_name == NULL);
+
+    track_reader_t *track_reader = get_track_reader_by_name(context, track_name);
+    if (track_reader == nullptr)
+    {
+        LOG_ERROR("Track name cannot be found: %s", track_name);
+        return K4A_RESULT_FAILED;
+    }
+
+    return set_track_enabled(context, track_reader, enabled);
+}
+
 k4a_buffer_result_t
 k4a_playback_get_attachment(k4a_playback_t playback_handle, const char *file_name, uint8_t *data, size_t *data_size)
 {
@@ -451,7 +493,7 @@ k4a_stream_result_t k4a_playback_get_next_capture(k4a_playback_t playback_handle
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
 
-    return get_capture(context, capture_handle, true);
+    return get_capture(context, &context->position, capture_handle, true);
 }
 
 k4a_stream_result_t k4a_playback_get_previous_capture(k4a_playback_t playback_handle, k4a_capture_t *capture_handle)
@@ -461,7 +503,18 @@ k4a_stream_result_t k4a_playback_get_previous_capture(k4a_playback_t playback_ha
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
 
-    return get_capture(context, capture_handle, false);
+    return get_capture(context, &context->position, capture_handle, false);
+}
+
+k4a_stream_result_t k4a_playback_get_next_capture_info(k4a_playback_t playback_handle,
+                                                       k4a_playback_capture_info_t *capture_info)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_info == NULL);
+
+    return get_capture_info(context, &context->position, capture_info);
 }
 
 k4a_stream_result_t k4a_playback_get_next_imu_sample(k4a_playback_t playback_handle, k4a_imu_sample_t *imu_sample)
@@ -471,7 +524,7 @@ k4a_stream_result_t k4a_playback_get_next_imu_sample(k4a_playback_t playback_han
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
 
-    return get_imu_sample(context, imu_sample, true);
+    return get_imu_sample(context, &context->position, imu_sample, true);
 }
 
 k4a_stream_result_t k4a_playback_get_previous_imu_sample(k4a_playback_t playback_handle, k4a_imu_sample_t *imu_sample)
@@ -481,7 +534,25 @@ k4a_stream_result_t k4a_playback_get_previous_imu_sample(k4a_playback_t playback
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
 
-    return get_imu_sample(context, imu_sample, false);
+    return get_imu_sample(context, &context->position, imu_sample, false);
+}
+
+k4a_stream_result_t k4a_playback_get_imu_samples(k4a_playback_t playback_handle,
+                                                uint64_t start_timestamp_usec,
+                                                uint64_t end_timestamp_usec,
+                                                k4a_imu_sample_t *imu_samples,
+                                                size_t max_samples,
+                                                size_t *sample_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_samples == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, max_samples == 0);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, sample_count == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, end_timestamp_usec < start_timestamp_usec);
+
+    return get_imu_samples(context, start_timestamp_usec, end_timestamp_usec, imu_samples, max_samples, sample_count);
 }
 
 k4a_stream_result_t k4a_playback_get_next_data_block(k4a_playback_t playback_handle,
@@ -507,7 +578,7 @@ k4a_stream_result_t k4a_playback_get_next_data_block(k4a_playback_t playback_han
         return K4A_STREAM_RESULT_FAILED;
     }
 
-    return get_data_block(context, track_reader, data_block_handle, true);
+    return get_data_block(context, &context->position, track_reader, data_block_handle, true);
 }
 
 k4a_stream_result_t k4a_playback_get_previous_data_block(k4a_playback_t playback_handle,
@@ -533,7 +604,7 @@ k4a_stream_result_t k4a_playback_get_previous_data_block(k4a_playback_t playback
         return K4A_STREAM_RESULT_FAILED;
     }
 
-    return get_data_block(context, track_reader, data_block_handle, false);
+    return get_data_block(context, &context->position, track_reader, data_block_handle, false);
 }
 
 uint64_t k4a_playback_data_block_get_device_timestamp_usec(k4a_playback_data_block_t data_block_handle)
@@ -566,14 +637,12 @@ void k4a_playback_data_block_release(k4a_playback_data_block_t data_block_handle
     k4a_playback_data_block_t_destroy(data_block_handle);
 }
 
-k4a_result_t k4a_playback_seek_timestamp(k4a_playback_t playback_handle,
-                                         int64_t offset_usec,
-                                         k4a_playback_seek_origin_t origin)
+// Moves the playback handle or a cursor to the specified timestamp.
+static k4a_result_t seek_position(k4a_playback_context_t *context,
+                                  playback_position_t *position,
+                                  int64_t offset_usec,
+                                  k4a_playback_seek_origin_t origin)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
-
-    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
-    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context->segment == nullptr);
     RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
                         origin != K4A_PLAYBACK_SEEK_BEGIN && origin != K4A_PLAYBACK_SEEK_END &&
@@ -629,41 +698,41 @@ k4a_result_t k4a_playback_seek_timestamp(k4a_playback_t playback_handle,
         return K4A_RESULT_FAILED;
     }
 
-    context->seek_cluster = seek_cluster;
-    reset_seek_pointers(context, target_time_ns);
+    position->seek_cluster = seek_cluster;
+    reset_seek_pointers(context, position, target_time_ns);
 
     return K4A_RESULT_SUCCEEDED;
 }
 
-uint64_t k4a_playback_get_recording_length_usec(k4a_playback_t playback_handle)
+k4a_result_t k4a_playback_seek_timestamp(k4a_playback_t playback_handle,
+                                         int64_t offset_usec,
+                                         k4a_playback_seek_origin_t origin)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_t, playback_handle);
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
 
     k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
-    RETURN_VALUE_IF_ARG(0, context == NULL);
-    return context->last_file_timestamp_ns / 1000;
-}
-
-uint64_t k4a_playback_get_last_timestamp_usec(k4a_playback_t playback_handle)
-{
-    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_t, playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
 
-    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
-    RETURN_VALUE_IF_ARG(0, context == NULL);
-    return context->last_file_timestamp_ns / 1000;
+    return seek_position(context, &context->position, offset_usec, origin);
 }
 
-void k4a_playback_close(const k4a_playback_t playback_handle)
+// Closes the file and frees the playback handle, once it has been closed and no cursors are left.
+static void destroy_playback(k4a_playback_t playback_handle)
 {
-    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_playback_t, playback_handle);
-
     k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
     if (context != NULL)
     {
         LOG_TRACE("File reading stats:", 0);
-        LOG_TRACE("  Seek count: %llu", context->seek_count);
-        LOG_TRACE("  Cluster load count: %llu", context->load_count);
-        LOG_TRACE("  Cluster cache hits: %llu", context->cache_hits);
+        LOG_TRACE("  Seek count: %llu", context->seek_count.load());
+        LOG_TRACE("  Cluster load count: %llu", context->load_count.load());
+        LOG_TRACE("  Cluster cache hits: %llu", context->cache_hits.load());
+
+        for (auto &itr : context->position.tracks)
+        {
+            reset_decode_ahead(&itr.second);
+        }
+        stop_worker_pool(&context->decode_pool);
+        free_decoders(context);
 
         context->file_closing = true;
 
@@ -688,3 +757,186 @@ void k4a_playback_close(const k4a_playback_t playback_handle)
     }
     k4a_playback_t_destroy(playback_handle);
 }
+
+k4a_result_t k4a_playback_cursor_create(k4a_playback_t playback_handle, k4a_playback_cursor_t *cursor_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_t, playback_handle);
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cursor_handle == NULL);
+
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_create(cursor_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(cursor != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        cursor->playback_handle = playback_handle;
+        result = TRACE_CALL(seek_position(context, &cursor->position, 0, K4A_PLAYBACK_SEEK_BEGIN));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        std::lock_guard<std::mutex> lock(context->cursor_lock);
+        if (context->closed)
+        {
+            LOG_ERROR("Cursor created on a closed playback handle.", 0);
+            result = K4A_RESULT_FAILED;
+        }
+        else
+        {
+            context->cursors.push_back(cursor);
+        }
+    }
+
+    if (K4A_FAILED(result) && cursor != NULL)
+    {
+        k4a_playback_cursor_t_destroy(*cursor_handle);
+        *cursor_handle = NULL;
+    }
+
+    return result;
+}
+
+// Returns the playback context a cursor was created from, or NULL if the cursor is invalid. The context stays valid
+// while the cursor exists, even after the playback handle is closed.
+static k4a_playback_context_t *get_cursor_playback_context(k4a_playback_cursor_context_t *cursor)
+{
+    if (cursor == NULL)
+    {
+        return NULL;
+    }
+    return k4a_playback_t_get_context(cursor->playback_handle);
+}
+
+k4a_result_t k4a_playback_cursor_seek_timestamp(k4a_playback_cursor_t cursor_handle,
+                                                int64_t offset_usec,
+                                                k4a_playback_seek_origin_t origin)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_cursor_t, cursor_handle);
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_get_context(cursor_handle);
+    k4a_playback_context_t *context = get_cursor_playback_context(cursor);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    return seek_position(context, &cursor->position, offset_usec, origin);
+}
+
+k4a_stream_result_t k4a_playback_cursor_get_next_capture(k4a_playback_cursor_t cursor_handle,
+                                                         k4a_capture_t *capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_cursor_t, cursor_handle);
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_get_context(cursor_handle);
+    k4a_playback_context_t *context = get_cursor_playback_context(cursor);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    return get_capture(context, &cursor->position, capture_handle, true);
+}
+
+k4a_stream_result_t k4a_playback_cursor_get_previous_capture(k4a_playback_cursor_t cursor_handle,
+                                                             k4a_capture_t *capture_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_cursor_t, cursor_handle);
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_get_context(cursor_handle);
+    k4a_playback_context_t *context = get_cursor_playback_context(cursor);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    return get_capture(context, &cursor->position, capture_handle, false);
+}
+
+k4a_stream_result_t k4a_playback_cursor_get_next_imu_sample(k4a_playback_cursor_t cursor_handle,
+                                                            k4a_imu_sample_t *imu_sample)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_cursor_t, cursor_handle);
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_get_context(cursor_handle);
+    k4a_playback_context_t *context = get_cursor_playback_context(cursor);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
+
+    return get_imu_sample(context, &cursor->position, imu_sample, true);
+}
+
+k4a_stream_result_t k4a_playback_cursor_get_previous_imu_sample(k4a_playback_cursor_t cursor_handle,
+                                                                k4a_imu_sample_t *imu_sample)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_cursor_t, cursor_handle);
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_get_context(cursor_handle);
+    k4a_playback_context_t *context = get_cursor_playback_context(cursor);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, imu_sample == NULL);
+
+    return get_imu_sample(context, &cursor->position, imu_sample, false);
+}
+
+void k4a_playback_cursor_destroy(k4a_playback_cursor_t cursor_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_playback_cursor_t, cursor_handle);
+
+    k4a_playback_cursor_context_t *cursor = k4a_playback_cursor_t_get_context(cursor_handle);
+    k4a_playback_context_t *context = get_cursor_playback_context(cursor);
+    k4a_playback_t playback_handle = NULL;
+    bool last_reference = false;
+    if (cursor != NULL)
+    {
+        playback_handle = cursor->playback_handle;
+        for (auto &itr : cursor->position.tracks)
+        {
+            reset_decode_ahead(&itr.second);
+        }
+        cursor->position = playback_position_t();
+    }
+    if (context != NULL)
+    {
+        std::lock_guard<std::mutex> lock(context->cursor_lock);
+        context->cursors.erase(std::remove(context->cursors.begin(), context->cursors.end(), cursor),
+                               context->cursors.end());
+        last_reference = context->closed && context->cursors.empty();
+    }
+    k4a_playback_cursor_t_destroy(cursor_handle);
+
+    if (last_reference)
+    {
+        // The playback handle was closed while this cursor was open, and no other cursor keeps it alive.
+        destroy_playback(playback_handle);
+    }
+}
+
+uint64_t k4a_playback_get_recording_length_usec(k4a_playback_t playback_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_t, playback_handle);
+
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+    return context->last_file_timestamp_ns / 1000;
+}
+
+uint64_t k4a_playback_get_last_timestamp_usec(k4a_playback_t playback_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_t, playback_handle);
+
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+    return context->last_file_timestamp_ns / 1000;
+}
+
+void k4a_playback_close(const k4a_playback_t playback_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_playback_t, playback_handle);
+
+    k4a_playback_context_t *context = k4a_playback_t_get_context(playback_handle);
+    if (context != NULL)
+    {
+        // Open cursors keep the context alive, since they may be reading from it on other threads. The last cursor
+        // destroyed with k4a_playback_cursor_destroy() closes the file.
+        std::lock_guard<std::mutex> lock(context->cursor_lock);
+        context->closed = true;
+        if (!context->cursors.empty())
+        {
+            LOG_WARNING("Playback closed while %zu cursors are still open, the recording is closed when they are "
+                        "destroyed.",
+                        context->cursors.size());
+            return;
+        }
+    }
+    destroy_playback(playback_handle);
+}
@@ -0,0 +1,394 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <k4a/k4a.h>
+#include <k4arecord/playback.h>
+#include <k4ainternal/matroska_common.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/logging.h>
+
+using namespace k4arecord;
+
+typedef struct _playback_group_capture_t
+{
+    uint64_t aligned_timestamp_usec;
+    k4a_capture_t capture;
+} playback_group_capture_t;
+
+typedef struct _playback_group_member_t
+{
+    std::string path;
+    k4a_playback_t playback = NULL;
+    k4a_record_configuration_t record_config = {};
+
+    // Captures read ahead by the reader thread, locked by the group lock.
+    std::deque<playback_group_capture_t> captures;
+    // K4A_STREAM_RESULT_SUCCEEDED until the reader thread stops at the end of the file or on a failure.
+    k4a_stream_result_t reader_result = K4A_STREAM_RESULT_SUCCEEDED;
+    std::thread reader_thread;
+} playback_group_member_t;
+
+typedef struct _k4a_playback_group_context_t
+{
+    std::vector<std::unique_ptr<playback_group_member_t>> members;
+
+    std::mutex lock;
+    bool stopping = false; // Locked by lock
+    // std::condition_variable constructor may throw, so wrap these in a pointer.
+    // Notified by the reader threads when a capture is queued or a reader stops.
+    std::unique_ptr<std::condition_variable> capture_notify;
+    // Notified when a capture is removed from a queue, or the group is closing.
+    std::unique_ptr<std::condition_variable> space_notify;
+} k4a_playback_group_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_playback_group_t, k4a_playback_group_context_t);
+
+// Returns the timestamp of the earliest image in the capture, shifted onto the master device's frame timing.
+static uint64_t get_aligned_timestamp(k4a_capture_t capture, const k4a_record_configuration_t &record_config)
+{
+    uint64_t min_timestamp = UINT64_MAX;
+    k4a_image_t images[] = { k4a_capture_get_color_image(capture),
+                             k4a_capture_get_depth_image(capture),
+                             k4a_capture_get_ir_image(capture) };
+    for (k4a_image_t image : images)
+    {
+        if (image != NULL)
+        {
+            min_timestamp = std::min(min_timestamp, k4a_image_get_device_timestamp_usec(image));
+            k4a_image_release(image);
+        }
+    }
+
+    uint64_t delay = record_config.subordinate_delay_off_master_usec;
+    if (record_config.wired_sync_mode == K4A_WIRED_SYNC_MODE_SUBORDINATE && min_timestamp != UINT64_MAX)
+    {
+        min_timestamp = min_timestamp > delay ? min_timestamp - delay : 0;
+    }
+    return min_timestamp;
+}
+
+static void playback_group_reader_thread(k4a_playback_group_context_t *context, playback_group_member_t *member)
+{
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->lock);
+        while (!context->stopping)
+        {
+            if (member->captures.size() >= PLAYBACK_GROUP_READ_AHEAD_COUNT)
+            {
+                context->space_notify->wait(lock);
+                continue;
+            }
+
+            // Read without holding the lock, so the other recordings can be read and consumed in parallel.
+            lock.unlock();
+            playback_group_capture_t next = {};
+            k4a_stream_result_t result = k4a_playback_get_next_capture(member->playback, &next.capture);
+            if (result == K4A_STREAM_RESULT_SUCCEEDED)
+            {
+                next.aligned_timestamp_usec = get_aligned_timestamp(next.capture, member->record_config);
+            }
+            lock.lock();
+
+            if (result != K4A_STREAM_RESULT_SUCCEEDED)
+            {
+                member->reader_result = result;
+                break;
+            }
+            member->captures.push_back(next);
+            context->capture_notify->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Playback group reader thread threw exception: %s", e.what());
+    }
+
+    try
+    {
+        // Wake up the consumer, it may be waiting for this recording.
+        std::lock_guard<std::mutex> lock(context->lock);
+        if (member->reader_result == K4A_STREAM_RESULT_SUCCEEDED)
+        {
+            member->reader_result = K4A_STREAM_RESULT_FAILED;
+        }
+        context->capture_notify->notify_all();
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Playback group reader thread threw exception: %s", e.what());
+    }
+}
+
+// Stops all of the reader threads, and closes all of the recordings.
+static void playback_group_destroy(k4a_playback_group_context_t *context)
+{
+    try
+    {
+        {
+            std::lock_guard<std::mutex> lock(context->lock);
+            context->stopping = true;
+        }
+        if (context->space_notify)
+        {
+            context->space_notify->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to stop playback group reader threads: %s", e.what());
+    }
+
+    for (auto &member : context->members)
+    {
+        if (member->reader_thread.joinable())
+        {
+            try
+            {
+                member->reader_thread.join();
+            }
+            catch (std::system_error &e)
+            {
+                LOG_ERROR("Failed to stop playback group reader thread: %s", e.what());
+            }
+        }
+
+        for (playback_group_capture_t &queued : member->captures)
+        {
+            k4a_capture_release(queued.capture);
+        }
+        member->captures.clear();
+
+        if (member->playback != NULL)
+        {
+            k4a_playback_close(member->playback);
+            member->playback = NULL;
+        }
+    }
+}
+
+k4a_result_t k4a_playback_group_open(const char *const *paths, size_t path_count, k4a_playback_group_t *group_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, paths == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path_count == 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, group_handle == NULL);
+    k4a_playback_group_context_t *context = NULL;
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    context = k4a_playback_group_t_create(group_handle);
+    result = K4A_RESULT_FROM_BOOL(context != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        try
+        {
+            context->capture_notify.reset(new std::condition_variable());
+            context->space_notify.reset(new std::condition_variable());
+        }
+        catch (std::system_error &e)
+        {
+            LOG_ERROR("Failed to create playback group: %s", e.what());
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    // Open each recording file and validate they were recorded in master/subordinate mode.
+    const char *master_path = NULL;
+    for (size_t i = 0; K4A_SUCCEEDED(result) && i < path_count; i++)
+    {
+        if (paths[i] == NULL)
+        {
+            LOG_ERROR("Recording path %zu is NULL.", i);
+            result = K4A_RESULT_FAILED;
+            break;
+        }
+
+        context->members.emplace_back(new playback_group_member_t());
+        playback_group_member_t *member = context->members.back().get();
+        member->path = paths[i];
+
+        result = TRACE_CALL(k4a_playback_open(paths[i], &member->playback));
+        if (K4A_SUCCEEDED(result))
+        {
+            result = TRACE_CALL(k4a_playback_get_record_configuration(member->playback, &member->record_config));
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            if (member->record_config.wired_sync_mode == K4A_WIRED_SYNC_MODE_MASTER)
+            {
+                if (master_path != NULL)
+                {
+                    LOG_ERROR("Multiple master recordings in playback group: %s, %s", master_path, paths[i]);
+                    result = K4A_RESULT_FAILED;
+                }
+                master_path = paths[i];
+            }
+            else if (member->record_config.wired_sync_mode != K4A_WIRED_SYNC_MODE_SUBORDINATE)
+            {
+                LOG_ERROR("Recording was not recorded in master/subordinate mode: %s", paths[i]);
+                result = K4A_RESULT_FAILED;
+            }
+        }
+    }
+
+    for (size_t i = 0; K4A_SUCCEEDED(result) && i < context->members.size(); i++)
+    {
+        try
+        {
+            playback_group_member_t *member = context->members[i].get();
+            member->reader_thread = std::thread(playback_group_reader_thread, context, member);
+        }
+        catch (std::system_error &e)
+        {
+            LOG_ERROR("Failed to start playback group reader thread: %s", e.what());
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_FAILED(result) && context != NULL)
+    {
+        playback_group_destroy(context);
+        k4a_playback_group_t_destroy(*group_handle);
+        *group_handle = NULL;
+    }
+
+    return result;
+}
+
+size_t k4a_playback_group_get_count(k4a_playback_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(0, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(0, context == NULL);
+
+    return context->members.size();
+}
+
+k4a_result_t k4a_playback_group_get_record_configuration(k4a_playback_group_t group_handle,
+                                                         size_t index,
+                                                         k4a_record_configuration_t *config)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, index >= context->members.size());
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+
+    // The configuration is read when the group is opened, so the reader threads don't need to be interrupted.
+    *config = context->members[index]->record_config;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_playback_group_get_calibration(k4a_playback_group_t group_handle,
+                                                size_t index,
+                                                k4a_calibration_t *calibration)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, index >= context->members.size());
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration == NULL);
+
+    // Calibration is parsed from the attachments read on open, it does not touch the file the reader thread is using.
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->lock);
+        return TRACE_CALL(k4a_playback_get_calibration(context->members[index]->playback, calibration));
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to lock playback group: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+}
+
+k4a_stream_result_t k4a_playback_group_get_next_capture(k4a_playback_group_t group_handle,
+                                                        k4a_capture_t *capture_handle,
+                                                        size_t *index)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_STREAM_RESULT_FAILED, k4a_playback_group_t, group_handle);
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, context == NULL);
+    RETURN_VALUE_IF_ARG(K4A_STREAM_RESULT_FAILED, capture_handle == NULL);
+
+    try
+    {
+        std::unique_lock<std::mutex> lock(context->lock);
+        while (true)
+        {
+            // The next capture can only be picked once every recording that is still being read has one queued.
+            bool waiting = false;
+            size_t next_index = context->members.size();
+            for (size_t i = 0; i < context->members.size(); i++)
+            {
+                playback_group_member_t *member = context->members[i].get();
+                if (member->captures.empty())
+                {
+                    if (member->reader_result == K4A_STREAM_RESULT_SUCCEEDED)
+                    {
+                        waiting = true;
+                        break;
+                    }
+                    else if (member->reader_result == K4A_STREAM_RESULT_FAILED)
+                    {
+                        LOG_ERROR("Failed to read next capture from recording: %s", member->path.c_str());
+                        return K4A_STREAM_RESULT_FAILED;
+                    }
+                }
+                else if (next_index == context->members.size() ||
+                         member->captures.front().aligned_timestamp_usec <
+                             context->members[next_index]->captures.front().aligned_timestamp_usec)
+                {
+                    next_index = i;
+                }
+            }
+
+            if (waiting)
+            {
+                context->capture_notify->wait(lock);
+                continue;
+            }
+
+            if (next_index == context->members.size())
+            {
+                return K4A_STREAM_RESULT_EOF;
+            }
+
+            playback_group_member_t *member = context->members[next_index].get();
+            *capture_handle = member->captures.front().capture;
+            member->captures.pop_front();
+            if (index != NULL)
+            {
+                *index = next_index;
+            }
+            context->space_notify->notify_all();
+            return K4A_STREAM_RESULT_SUCCEEDED;
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to read next capture from playback group: %s", e.what());
+        return K4A_STREAM_RESULT_FAILED;
+    }
+}
+
+void k4a_playback_group_close(k4a_playback_group_t group_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_playback_group_t, group_handle);
+
+    k4a_playback_group_context_t *context = k4a_playback_group_t_get_context(group_handle);
+    if (context != NULL)
+    {
+        playback_group_destroy(context);
+    }
+    k4a_playback_group_t_destroy(group_handle);
+}
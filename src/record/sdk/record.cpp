@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft Corporation. All rights reserved.
 // Licensed under the MIT License.
 
+#include <cstring>
 #include <ctime>
 #include <iostream>
 #include <sstream>
@@ -441,6 +442,77 @@ k4a_result_t k4a_record_add_imu_track(const k4a_record_t recording_handle)
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t k4a_record_set_depth_codec(const k4a_record_t recording_handle, k4a_record_depth_codec_t codec)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        codec != K4A_RECORD_DEPTH_CODEC_B16G && codec != K4A_RECORD_DEPTH_CODEC_RVL);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("The depth codec must be set before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    track_header_t *tracks[] = { context->depth_track, context->ir_track };
+    for (track_header_t *track : tracks)
+    {
+        if (track == nullptr)
+        {
+            continue;
+        }
+
+        auto &codec_private = GetChild<KaxCodecPrivate>(*track->track);
+        if (codec_private.GetSize() != sizeof(BITMAPINFOHEADER))
+        {
+            LOG_ERROR("Depth track codec private has unexpected size: %llu",
+                      (unsigned long long)codec_private.GetSize());
+            return K4A_RESULT_FAILED;
+        }
+
+        BITMAPINFOHEADER codec_info;
+        memcpy(&codec_info, codec_private.GetBuffer(), sizeof(codec_info));
+        if (codec == K4A_RECORD_DEPTH_CODEC_RVL)
+        {
+            codec_info.biCompression = 0x204C5652; // "RVL "
+            codec_info.biSizeImage = 0;            // RVL is variable size
+            GetChild<KaxCodecID>(*track->track).SetValue("V_K4A/RVL");
+        }
+        else
+        {
+            RETURN_IF_ERROR(populate_bitmap_info_header(&codec_info,
+                                                        codec_info.biWidth,
+                                                        codec_info.biHeight,
+                                                        K4A_IMAGE_FORMAT_DEPTH16));
+            GetChild<KaxCodecID>(*track->track).SetValue("V_MS/VFW/FOURCC");
+        }
+        codec_private.CopyBuffer(reinterpret_cast<uint8_t *>(&codec_info), sizeof(codec_info));
+        track->rvl_compressed = codec == K4A_RECORD_DEPTH_CODEC_RVL;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_enable_zero_copy(const k4a_record_t recording_handle, bool enable)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    if (context->header_written)
+    {
+        LOG_ERROR("Zero-copy captures must be enabled before the recording header is written.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    context->zero_copy_captures = enable;
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t k4a_record_add_custom_video_track(const k4a_record_t recording_handle,
                                                const char *track_name,
                                                const char *codec_id,
@@ -534,6 +606,16 @@ k4a_result_t k4a_record_write_header(const k4a_record_t recording_handle)
         return K4A_RESULT_FAILED;
     }
 
+    // With zero-copy captures, b16g images are queued as-is and swapped to big-endian by the writer thread.
+    track_header_t *depth_tracks[] = { context->depth_track, context->ir_track };
+    for (track_header_t *track : depth_tracks)
+    {
+        if (track != nullptr)
+        {
+            track->deferred_byte_swap = context->zero_copy_captures && !track->rvl_compressed;
+        }
+    }
+
     try
     {
         // Make sure we're at the beginning of the file in case we're rewriting a file.
@@ -595,6 +677,35 @@ k4a_result_t k4a_record_write_header(const k4a_record_t recording_handle)
     return K4A_RESULT_SUCCEEDED;
 }
 
+// DataBuffer free callback for byte-swapped depth and IR buffers allocated in k4a_record_write_capture()
+static bool free_swapped_buffer(const DataBuffer &buffer)
+{
+    delete[] buffer.Buffer();
+    return true;
+}
+
+// DataBuffer that holds a reference to a k4a_image_t instead of a copy of its data, used for zero-copy captures.
+// The image is released when the buffer is freed after being written to disk.
+class ImageDataBuffer : public DataBuffer
+{
+public:
+    ImageDataBuffer(k4a_image_t image, binary *buffer, uint32 size) :
+        DataBuffer(buffer, size, &ImageDataBuffer::release_image),
+        m_image(image)
+    {
+    }
+
+private:
+    static bool release_image(const DataBuffer &buffer)
+    {
+        // This callback is only registered by ImageDataBuffer.
+        k4a_image_release(static_cast<const ImageDataBuffer &>(buffer).m_image);
+        return true;
+    }
+
+    k4a_image_t m_image;
+};
+
 k4a_result_t k4a_record_write_capture(const k4a_record_t recording_handle, k4a_capture_t capture)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
@@ -633,22 +744,53 @@ k4a_result_t k4a_record_write_capture(const k4a_record_t recording_handle, k4a_c
                 k4a_image_format_t image_format = k4a_image_get_format(images[i]);
                 if (image_format == expected_formats[i])
                 {
-                    // Create a copy of the image buffer for writing to file.
                     assert(buffer_size <= UINT32_MAX);
-                    DataBuffer *data_buffer = new (std::nothrow)
-                        DataBuffer(image_buffer, (uint32)buffer_size, NULL, true);
-                    if (image_format == K4A_IMAGE_FORMAT_DEPTH16 || image_format == K4A_IMAGE_FORMAT_IR16)
+                    uint64_t timestamp_ns = k4a_image_get_device_timestamp_usec(images[i]) * 1000;
+                    DataBuffer *data_buffer = NULL;
+                    bool rvl_track = tracks[i] != nullptr && tracks[i]->rvl_compressed;
+                    if (context->zero_copy_captures)
+                    {
+                        // Queue the image by reference, depth encoding is done later on the writer thread.
+                        data_buffer = new (std::nothrow) ImageDataBuffer(images[i], image_buffer, (uint32)buffer_size);
+                        if (data_buffer != NULL)
+                        {
+                            images[i] = NULL; // The image reference is now owned by data_buffer.
+                        }
+                    }
+                    else if ((image_format == K4A_IMAGE_FORMAT_DEPTH16 || image_format == K4A_IMAGE_FORMAT_IR16) &&
+                             !rvl_track)
                     {
                         // 16 bit grayscale needs to be converted to big-endian in the file.
-                        assert(data_buffer->Size() % sizeof(uint16_t) == 0);
-                        uint16_t *data_buffer_raw = reinterpret_cast<uint16_t *>(data_buffer->Buffer());
-                        for (size_t j = 0; j < data_buffer->Size() / sizeof(uint16_t); j++)
+                        // The byte swap is done while copying so the frame is only read once.
+                        assert(buffer_size % sizeof(uint16_t) == 0);
+                        binary *swapped_buffer = new (std::nothrow) binary[buffer_size];
+                        if (swapped_buffer != NULL)
                         {
-                            data_buffer_raw[j] = swap_bytes_16(data_buffer_raw[j]);
+                            copy_swap_bytes_16(reinterpret_cast<uint16_t *>(swapped_buffer),
+                                               reinterpret_cast<const uint16_t *>(image_buffer),
+                                               buffer_size / sizeof(uint16_t));
+                            data_buffer = new (std::nothrow)
+                                DataBuffer(swapped_buffer, (uint32)buffer_size, &free_swapped_buffer);
+                            if (data_buffer == NULL)
+                            {
+                                delete[] swapped_buffer;
+                            }
                         }
                     }
+                    else
+                    {
+                        // Create a copy of the image buffer for writing to file.
+                        // RVL tracks are copied as-is and compressed later on the writer thread.
+                        data_buffer = new (std::nothrow) DataBuffer(image_buffer, (uint32)buffer_size, NULL, true);
+                    }
+                    if (data_buffer == NULL)
+                    {
+                        LOG_ERROR("Failed to allocate image buffer for recording.", 0);
+                        result = K4A_RESULT_FAILED;
+                        k4a_image_release(images[i]);
+                        continue;
+                    }
 
-                    uint64_t timestamp_ns = k4a_image_get_device_timestamp_usec(images[i]) * 1000;
                     k4a_result_t tmp_result = TRACE_CALL(
                         write_track_data(context, tracks[i], timestamp_ns, data_buffer));
                     if (K4A_FAILED(tmp_result))
@@ -665,7 +807,10 @@ k4a_result_t k4a_record_write_capture(const k4a_record_t recording_handle, k4a_c
                     result = K4A_RESULT_FAILED;
                 }
             }
-            k4a_image_release(images[i]);
+            if (images[i])
+            {
+                k4a_image_release(images[i]);
+            }
         }
     }
 
@@ -761,6 +906,89 @@ k4a_result_t k4a_record_write_custom_track_data(const k4a_record_t recording_han
     return result;
 }
 
+k4a_result_t k4a_record_set_memory_budget(const k4a_record_t recording_handle,
+                                          uint64_t max_pending_bytes,
+                                          k4a_record_memory_policy_t policy)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        policy != K4A_RECORD_MEMORY_POLICY_BLOCK && policy != K4A_RECORD_MEMORY_POLICY_DROP);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+        context->memory_budget = max_pending_bytes;
+        context->memory_policy = policy;
+
+        // Re-check any blocked writes against the new budget.
+        if (context->pending_space_notify)
+        {
+            context->pending_space_notify->notify_all();
+        }
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to set recording memory budget: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+k4a_result_t k4a_record_get_stats(const k4a_record_t recording_handle, k4a_record_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stats == NULL);
+
+    k4a_record_context_t *context = k4a_record_t_get_context(recording_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, context == NULL);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock(context->pending_cluster_lock);
+
+        stats->pending_cluster_count = (uint32_t)context->pending_clusters.size();
+        stats->pending_bytes = context->pending_bytes;
+        stats->pending_duration_usec = 0;
+        if (context->most_recent_timestamp > context->last_written_timestamp)
+        {
+            stats->pending_duration_usec = (context->most_recent_timestamp - context->last_written_timestamp) / 1000;
+        }
+        stats->memory_budget = context->memory_budget;
+        stats->dropped_count = context->dropped_count;
+        stats->blocked_time_usec = context->blocked_time_ns / 1000;
+    }
+    catch (std::system_error &e)
+    {
+        LOG_ERROR("Failed to read recording stats: %s", e.what());
+        return K4A_RESULT_FAILED;
+    }
+
+    uint64_t bytes_written = context->bytes_written;
+    uint64_t render_time_ns = context->render_time_ns;
+    uint64_t flush_time_ns = 0;
+    LargeFileIOCallback *file_io = dynamic_cast<LargeFileIOCallback *>(context->ebml_file.get());
+    if (file_io != NULL)
+    {
+        flush_time_ns = file_io->getFlushTimeNs();
+    }
+
+    stats->bytes_written = bytes_written;
+    stats->render_time_usec = render_time_ns / 1000;
+    stats->flush_time_usec = flush_time_ns / 1000;
+    stats->write_bytes_per_second = 0;
+    if (render_time_ns + flush_time_ns > 0)
+    {
+        stats->write_bytes_per_second = (uint64_t)((double)bytes_written * 1e9 /
+                                                   (double)(render_time_ns + flush_time_ns));
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_record_t, recording_handle);
@@ -796,6 +1024,17 @@ k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
                 }
             }
             context->pending_clusters.clear();
+            context->pending_bytes = 0;
+            if (context->pending_space_notify)
+            {
+                context->pending_space_notify->notify_all();
+            }
+        }
+
+        // Hand the clusters to the OS before seeking back to update the headers.
+        if (file_io != NULL)
+        {
+            file_io->flush();
         }
 
         auto &segment_info = GetChild<KaxInfo>(*context->file_segment);
@@ -879,6 +1118,10 @@ k4a_result_t k4a_record_flush(const k4a_record_t recording_handle)
         // Set the write pointer back in case we're not done recording yet.
         assert(current_position <= INT64_MAX);
         context->ebml_file->setFilePointer((int64_t)current_position);
+        if (file_io != NULL)
+        {
+            file_io->flush();
+        }
     }
     catch (std::ios_base::failure &e)
     {
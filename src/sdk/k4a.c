@@ -279,6 +279,20 @@ k4a_wait_result_t k4a_device_get_imu_sample(k4a_device_t device_handle,
     return TRACE_WAIT_CALL(imu_get_sample(device->imu, imu_sample, timeout_in_ms));
 }
 
+k4a_result_t k4a_device_get_pipeline_stats(k4a_device_t device_handle, k4a_pipeline_stats_t *stats)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stats == NULL);
+    k4a_context_t *device = k4a_device_t_get_context(device_handle);
+
+    memset(stats, 0, sizeof(*stats));
+    depth_get_stats(device->depth, stats);
+    capturesync_get_stats(device->capturesync, stats);
+    imu_get_stats(device->imu, stats);
+    allocator_get_stats(&stats->allocator);
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t k4a_device_start_imu(k4a_device_t device_handle)
 {
     RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_device_t, device_handle);
@@ -1148,6 +1162,30 @@ k4a_result_t k4a_calibration_color_2d_to_depth_2d(const k4a_calibration_t *calib
         transformation_color_2d_to_depth_2d(calibration, source_point2d->v, depth_image, target_point2d->v, valid));
 }
 
+k4a_result_t k4a_calibration_scale_color_camera(const k4a_calibration_t *calibration,
+                                                const int color_width_pixels,
+                                                const int color_height_pixels,
+                                                k4a_calibration_t *scaled_calibration)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, scaled_calibration == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration->color_resolution == K4A_COLOR_RESOLUTION_OFF);
+
+    k4a_calibration_camera_t color_camera_calibration;
+    if (K4A_FAILED(TRACE_CALL(transformation_get_scaled_camera_calibration(&calibration->color_camera_calibration,
+                                                                           color_width_pixels,
+                                                                           color_height_pixels,
+                                                                           &color_camera_calibration))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    // calibration and scaled_calibration may be the same structure
+    memmove(scaled_calibration, calibration, sizeof(k4a_calibration_t));
+    scaled_calibration->color_camera_calibration = color_camera_calibration;
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_transformation_t k4a_transformation_create(const k4a_calibration_t *calibration)
 {
     return transformation_create(calibration, TRANSFORM_ENABLE_GPU_OPTIMIZATION);
@@ -1286,6 +1324,114 @@ k4a_result_t k4a_transformation_depth_image_to_point_cloud(k4a_transformation_t
                                                                 &xyz_image_descriptor));
 }
 
+k4a_result_t k4a_transformation_create_undistortion_map(k4a_transformation_t transformation_handle,
+                                                        const k4a_calibration_type_t camera,
+                                                        const k4a_transformation_pinhole_type_t pinhole_type,
+                                                        k4a_undistortion_map_t *undistortion_map_handle)
+{
+    return TRACE_CALL(
+        transformation_create_undistortion_map(transformation_handle, camera, pinhole_type, undistortion_map_handle));
+}
+
+k4a_result_t k4a_undistortion_map_get_camera_calibration(k4a_undistortion_map_t undistortion_map_handle,
+                                                         k4a_calibration_camera_t *pinhole_camera_calibration)
+{
+    return TRACE_CALL(undistortion_map_get_camera_calibration(undistortion_map_handle, pinhole_camera_calibration));
+}
+
+k4a_result_t k4a_transformation_remap(k4a_undistortion_map_t undistortion_map_handle,
+                                      const k4a_image_t source_image,
+                                      k4a_image_t undistorted_image,
+                                      const k4a_transformation_interpolation_type_t interpolation_type)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source_image == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, undistorted_image == NULL);
+
+    k4a_transformation_image_descriptor_t source_image_descriptor = k4a_image_get_descriptor(source_image);
+    k4a_transformation_image_descriptor_t undistorted_image_descriptor = k4a_image_get_descriptor(undistorted_image);
+
+    uint8_t *source_image_buffer = k4a_image_get_buffer(source_image);
+    uint8_t *undistorted_image_buffer = k4a_image_get_buffer(undistorted_image);
+
+    return TRACE_CALL(undistortion_map_remap(undistortion_map_handle,
+                                             source_image_buffer,
+                                             &source_image_descriptor,
+                                             undistorted_image_buffer,
+                                             &undistorted_image_descriptor,
+                                             interpolation_type));
+}
+
+k4a_result_t k4a_transformation_depth_image_to_undistorted_color_camera(k4a_transformation_t transformation_handle,
+                                                                        k4a_undistortion_map_t undistortion_map_handle,
+                                                                        const k4a_image_t depth_image,
+                                                                        k4a_image_t transformed_depth_image)
+{
+    k4a_transformation_image_descriptor_t depth_image_descriptor = k4a_image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = k4a_image_get_descriptor(
+        transformed_depth_image);
+
+    uint8_t *depth_image_buffer = k4a_image_get_buffer(depth_image);
+    uint8_t *transformed_depth_image_buffer = k4a_image_get_buffer(transformed_depth_image);
+
+    // Same as k4a_transformation_depth_image_to_color_camera, the custom image parameters are ignored.
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+    k4a_transformation_interpolation_type_t interpolation_type = K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR;
+
+    return TRACE_CALL(transformation_depth_image_to_undistorted_color_camera(transformation_handle,
+                                                                             undistortion_map_handle,
+                                                                             depth_image_buffer,
+                                                                             &depth_image_descriptor,
+                                                                             NULL,
+                                                                             &dummy_descriptor,
+                                                                             transformed_depth_image_buffer,
+                                                                             &transformed_depth_image_descriptor,
+                                                                             NULL,
+                                                                             &dummy_descriptor,
+                                                                             interpolation_type,
+                                                                             0));
+}
+
+k4a_result_t k4a_transformation_depth_image_to_undistorted_color_camera_custom(
+    k4a_transformation_t transformation_handle,
+    k4a_undistortion_map_t undistortion_map_handle,
+    const k4a_image_t depth_image,
+    const k4a_image_t custom_image,
+    k4a_image_t transformed_depth_image,
+    k4a_image_t transformed_custom_image,
+    k4a_transformation_interpolation_type_t interpolation_type,
+    uint32_t invalid_custom_value)
+{
+    k4a_transformation_image_descriptor_t depth_image_descriptor = k4a_image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t custom_image_descriptor = k4a_image_get_descriptor(custom_image);
+    k4a_transformation_image_descriptor_t transformed_depth_image_descriptor = k4a_image_get_descriptor(
+        transformed_depth_image);
+    k4a_transformation_image_descriptor_t transformed_custom_image_descriptor = k4a_image_get_descriptor(
+        transformed_custom_image);
+
+    uint8_t *depth_image_buffer = k4a_image_get_buffer(depth_image);
+    uint8_t *custom_image_buffer = k4a_image_get_buffer(custom_image);
+    uint8_t *transformed_depth_image_buffer = k4a_image_get_buffer(transformed_depth_image);
+    uint8_t *transformed_custom_image_buffer = k4a_image_get_buffer(transformed_custom_image);
+
+    return TRACE_CALL(transformation_depth_image_to_undistorted_color_camera(transformation_handle,
+                                                                             undistortion_map_handle,
+                                                                             depth_image_buffer,
+                                                                             &depth_image_descriptor,
+                                                                             custom_image_buffer,
+                                                                             &custom_image_descriptor,
+                                                                             transformed_depth_image_buffer,
+                                                                             &transformed_depth_image_descriptor,
+                                                                             transformed_custom_image_buffer,
+                                                                             &transformed_custom_image_descriptor,
+                                                                             interpolation_type,
+                                                                             invalid_custom_value));
+}
+
+void k4a_undistortion_map_destroy(k4a_undistortion_map_t undistortion_map_handle)
+{
+    undistortion_map_destroy(undistortion_map_handle);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -27,7 +27,8 @@ typedef struct _tewrapper_context_t
     COND_HANDLE worker_condition;
     volatile bool thread_started;
     volatile bool thread_stop;
-    volatile bool worker_locked;
+    bool frame_pending; // Set by the API thread when it posts a frame, cleared once processed. Locked by worker_lock
+    bool thread_exited; // Set when the transform engine thread stops taking frames. Locked by worker_lock
     k4a_result_t thread_start_result;
     k4a_result_t thread_processing_result;
 
@@ -90,21 +91,25 @@ static int transform_engine_thread(void *param)
     Lock(tewrapper->main_lock);
     tewrapper->thread_started = true;
     tewrapper->thread_start_result = result;
-    tewrapper->worker_locked = false;
     Condition_Post(tewrapper->main_condition);
     Unlock(tewrapper->main_lock);
 
+    // The frame requests are tracked by frame_pending under the worker lock, so a frame posted before this thread waits
+    // for one is not lost, and a wake up without a frame is not taken for one.
+    Lock(tewrapper->worker_lock);
     while (result != K4A_RESULT_FAILED && tewrapper->thread_stop == false)
     {
         // Waiting the main thread to request processing a frame
-        Lock(tewrapper->worker_lock);
-        tewrapper->worker_locked = true;
-        Condition_Post(tewrapper->main_condition);
-        int infinite_timeout = 0;
-        COND_RESULT cond_result = Condition_Wait(tewrapper->worker_condition, tewrapper->worker_lock, infinite_timeout);
-        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
-
-        if (tewrapper->thread_stop == false)
+        if (!tewrapper->frame_pending)
+        {
+            int infinite_timeout = 0;
+            COND_RESULT cond_result = Condition_Wait(tewrapper->worker_condition,
+                                                     tewrapper->worker_lock,
+                                                     infinite_timeout);
+            result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+        }
+
+        if (tewrapper->thread_stop == false && tewrapper->frame_pending)
         {
             if (K4A_SUCCEEDED(result))
             {
@@ -176,14 +181,23 @@ static int transform_engine_thread(void *param)
                     result = K4A_RESULT_FAILED;
                 }
             }
+
+            // Notify the API thread that transform engine thread completed a frame processing
+            tewrapper->thread_processing_result = result;
+            tewrapper->frame_pending = false;
+            Condition_Post(tewrapper->main_condition);
         }
+    }
 
-        // Notify the API thread that transform engine thread completed a frame processing
-        tewrapper->thread_processing_result = result;
-        Condition_Post(tewrapper->main_condition);
-        Unlock(tewrapper->worker_lock);
-        tewrapper->worker_locked = false;
+    // Fail a frame posted while this thread was stopping, and the ones posted after it
+    if (tewrapper->frame_pending)
+    {
+        tewrapper->thread_processing_result = K4A_RESULT_FAILED;
+        tewrapper->frame_pending = false;
     }
+    tewrapper->thread_exited = true;
+    Condition_Post(tewrapper->main_condition);
+    Unlock(tewrapper->worker_lock);
 
     transform_engine_stop_helper(tewrapper);
 
@@ -207,21 +221,20 @@ k4a_result_t tewrapper_process_frame(tewrapper_t tewrapper_handle,
 
     k4a_result_t result = K4A_RESULT_SUCCEEDED;
 
+    // The main lock lets one API thread at a time post a frame and wait for its result
     Lock(tewrapper->main_lock);
+    Lock(tewrapper->worker_lock);
 
-    // Ensure the worker thread loop to acquire the worker lock before this function acquires the worker lock to avoid
-    // dead lock
-    if (!tewrapper->worker_locked)
+    if (tewrapper->thread_exited)
     {
-        int infinite_timeout = 0;
-        COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition, tewrapper->main_lock, infinite_timeout);
-        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+        // The worker thread exits after failing to process a frame
+        LOG_ERROR("Transform Engine thread is not running", 0);
+        result = K4A_RESULT_FAILED;
     }
 
     if (K4A_SUCCEEDED(result))
     {
         // Notify the transform engine thread to process a frame
-        Lock(tewrapper->worker_lock);
         tewrapper->type = type;
         tewrapper->depth_image_data = depth_image_data;
         tewrapper->depth_image_size = depth_image_size;
@@ -233,22 +246,27 @@ k4a_result_t tewrapper_process_frame(tewrapper_t tewrapper_handle,
         tewrapper->transformed_image2_size = transformed_image2_size;
         tewrapper->interpolation = interpolation;
         tewrapper->invalid_value = invalid_value;
+        tewrapper->frame_pending = true;
         Condition_Post(tewrapper->worker_condition);
 
         // Waiting the transform engine thread to finish processing
-        int infinite_timeout = 0;
-        COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition, tewrapper->worker_lock, infinite_timeout);
-        result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+        while (K4A_SUCCEEDED(result) && tewrapper->frame_pending)
+        {
+            int infinite_timeout = 0;
+            COND_RESULT cond_result = Condition_Wait(tewrapper->main_condition,
+                                                     tewrapper->worker_lock,
+                                                     infinite_timeout);
+            result = K4A_RESULT_FROM_BOOL(cond_result == COND_OK);
+        }
 
         if (K4A_SUCCEEDED(result) && K4A_FAILED(tewrapper->thread_processing_result))
         {
             LOG_ERROR("Transform Engine thread failed to process", 0);
             result = tewrapper->thread_processing_result;
         }
-
-        Unlock(tewrapper->worker_lock);
     }
 
+    Unlock(tewrapper->worker_lock);
     Unlock(tewrapper->main_lock);
 
     return result;
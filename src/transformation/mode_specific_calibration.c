@@ -219,4 +219,42 @@ transformation_get_mode_specific_color_camera_calibration(const k4a_calibration_
         return K4A_RESULT_FAILED;
     }
     }
-}
\ No newline at end of file
+}
+
+k4a_result_t transformation_get_scaled_camera_calibration(const k4a_calibration_camera_t *camera_calibration,
+                                                          const int width,
+                                                          const int height,
+                                                          k4a_calibration_camera_t *scaled_camera_calibration)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, camera_calibration == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, scaled_camera_calibration == NULL);
+    if (K4A_FAILED(K4A_RESULT_FROM_BOOL(camera_calibration->resolution_width > 0 &&
+                                        camera_calibration->resolution_height > 0 && width > 0 && height > 0)))
+    {
+        LOG_ERROR("Expect camera resolution and scaled resolution are larger than 0, actual values are camera "
+                  "resolution: (%d,%d), scaled resolution: (%d,%d).",
+                  camera_calibration->resolution_width,
+                  camera_calibration->resolution_height,
+                  width,
+                  height);
+        return K4A_RESULT_FAILED;
+    }
+
+    memcpy(scaled_camera_calibration, camera_calibration, sizeof(k4a_calibration_camera_t));
+
+    // Distortion is applied to normalized image coordinates, so only the focal length and principal point depend on
+    // the image size. The principal point is scaled around the top left corner of the top left pixel, which is at
+    // (-0.5,-0.5) in the pixelized and 0-centered convention used in the SDK.
+    float scale_x = (float)width / (float)camera_calibration->resolution_width;
+    float scale_y = (float)height / (float)camera_calibration->resolution_height;
+    k4a_calibration_intrinsic_parameters_t *params = &scaled_camera_calibration->intrinsics.parameters;
+    params->param.cx = (params->param.cx + 0.5f) * scale_x - 0.5f;
+    params->param.cy = (params->param.cy + 0.5f) * scale_y - 0.5f;
+    params->param.fx *= scale_x;
+    params->param.fy *= scale_y;
+
+    scaled_camera_calibration->resolution_width = width;
+    scaled_camera_calibration->resolution_height = height;
+
+    return K4A_RESULT_SUCCEEDED;
+}
@@ -36,6 +36,7 @@ typedef struct _k4a_transformation_rgbz_context_t
 {
     const k4a_calibration_t *calibration;
     const k4a_transformation_xy_tables_t *xy_tables;
+    const k4a_transformation_pinhole_t *color_pinhole; // If set, project with this model instead of the calibration
     k4a_transformation_input_image_t depth_image;
     k4a_transformation_input_image_t color_image;
     k4a_transformation_input_image_t custom_image;
@@ -136,6 +137,32 @@ transformation_init_output_image(k4a_transformation_image_descriptor_t *descript
     return image;
 }
 
+// Projects a point in color camera space to an undistorted color image. Points behind the camera, or so far outside
+// the image that they could not be a corner of a quad overlapping it, are marked invalid so the rasterizer never sees
+// coordinates that overflow when converted to pixel indices.
+static void transformation_project_pinhole(const k4a_transformation_pinhole_t *pinhole,
+                                           const k4a_float3_t *point3d,
+                                           k4a_correspondence_t *correspondence)
+{
+    correspondence->valid = 0;
+    if (point3d->xyz.z <= 0.f)
+    {
+        return;
+    }
+
+    float x = point3d->xyz.x / point3d->xyz.z * pinhole->fx + pinhole->px;
+    float y = point3d->xyz.y / point3d->xyz.z * pinhole->fy + pinhole->py;
+    if (x < (float)-pinhole->width || x > (float)(2 * pinhole->width) || y < (float)-pinhole->height ||
+        y > (float)(2 * pinhole->height))
+    {
+        return;
+    }
+
+    correspondence->point2d.xy.x = x;
+    correspondence->point2d.xy.y = y;
+    correspondence->valid = 1;
+}
+
 static k4a_result_t transformation_compute_correspondence(const int depth_index,
                                                           const uint16_t depth,
                                                           const k4a_transformation_rgbz_context_t *context,
@@ -163,6 +190,12 @@ static k4a_result_t transformation_compute_correspondence(const int depth_index,
     }
     correspondence->depth = color_point3d.xyz.z;
 
+    if (context->color_pinhole != NULL)
+    {
+        transformation_project_pinhole(context->color_pinhole, &color_point3d, correspondence);
+        return K4A_RESULT_SUCCEEDED;
+    }
+
     if (K4A_FAILED(TRACE_CALL(transformation_3d_to_2d(context->calibration,
                                                       color_point3d.v,
                                                       K4A_CALIBRATION_TYPE_COLOR,
@@ -791,6 +824,7 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_validate_paramete
 k4a_buffer_result_t transformation_depth_image_to_color_camera_internal(
     const k4a_calibration_t *calibration,
     const k4a_transformation_xy_tables_t *xy_tables_depth_camera,
+    const k4a_transformation_pinhole_t *color_pinhole,
     const uint8_t *depth_image_data,
     const k4a_transformation_image_descriptor_t *depth_image_descriptor,
     const uint8_t *custom_image_data,
@@ -823,6 +857,7 @@ k4a_buffer_result_t transformation_depth_image_to_color_camera_internal(
 
     context.xy_tables = xy_tables_depth_camera;
     context.calibration = calibration;
+    context.color_pinhole = color_pinhole;
 
     context.depth_image = transformation_init_input_image(depth_image_descriptor, depth_image_data);
 
@@ -633,11 +633,22 @@ k4a_transformation_t transformation_create(const k4a_calibration_t *calibration,
                &transformation_context->depth_camera_xy_tables,
                sizeof(k4a_transformation_xy_tables_t));
 
-        transformation_context->tewrapper = tewrapper_create(&transform_engine_calibration);
-        if (K4A_FAILED(K4A_RESULT_FROM_BOOL(transformation_context->tewrapper != NULL)))
+        // The loaded depth engine may not provide a transform engine, the virtual depth engine does not. The CPU
+        // implementation produces the same images, so use it in that case. A transform engine that fails to start is
+        // still an error.
+        if (!deloader_has_transform_engine())
         {
-            transformation_destroy(transformation_handle);
-            return 0;
+            LOG_WARNING("Transform engine is not available, depth and color images are transformed on the CPU", 0);
+            transformation_context->enable_gpu_optimization = false;
+        }
+        else
+        {
+            transformation_context->tewrapper = tewrapper_create(&transform_engine_calibration);
+            if (K4A_FAILED(K4A_RESULT_FROM_BOOL(transformation_context->tewrapper != NULL)))
+            {
+                transformation_destroy(transformation_handle);
+                return 0;
+            }
         }
     }
 
@@ -672,6 +683,23 @@ void transformation_destroy(k4a_transformation_t transformation_handle)
     k4a_transformation_t_destroy(transformation_handle);
 }
 
+k4a_result_t transformation_create_undistortion_map(k4a_transformation_t transformation_handle,
+                                                    const k4a_calibration_type_t camera,
+                                                    const k4a_transformation_pinhole_type_t pinhole_type,
+                                                    k4a_undistortion_map_t *undistortion_map_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (K4A_FAILED(TRACE_CALL(transformation_possible(&transformation_context->calibration, camera))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    return TRACE_CALL(
+        undistortion_map_create(&transformation_context->calibration, camera, pinhole_type, undistortion_map_handle));
+}
+
 k4a_result_t transformation_depth_image_to_color_camera_custom(
     k4a_transformation_t transformation_handle,
     const uint8_t *depth_image_data,
@@ -769,6 +797,7 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
             TRACE_BUFFER_CALL(
                 transformation_depth_image_to_color_camera_internal(&transformation_context->calibration,
                                                                     &transformation_context->depth_camera_xy_tables,
+                                                                    NULL,
                                                                     depth_image_data,
                                                                     depth_image_descriptor,
                                                                     custom_image_data,
@@ -786,6 +815,77 @@ k4a_result_t transformation_depth_image_to_color_camera_custom(
     return K4A_RESULT_SUCCEEDED;
 }
 
+k4a_result_t transformation_depth_image_to_undistorted_color_camera(
+    k4a_transformation_t transformation_handle,
+    k4a_undistortion_map_t undistortion_map_handle,
+    const uint8_t *depth_image_data,
+    const k4a_transformation_image_descriptor_t *depth_image_descriptor,
+    const uint8_t *custom_image_data,
+    const k4a_transformation_image_descriptor_t *custom_image_descriptor,
+    uint8_t *transformed_depth_image_data,
+    k4a_transformation_image_descriptor_t *transformed_depth_image_descriptor,
+    uint8_t *transformed_custom_image_data,
+    k4a_transformation_image_descriptor_t *transformed_custom_image_descriptor,
+    k4a_transformation_interpolation_type_t interpolation_type,
+    uint32_t invalid_custom_value)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_transformation_t, transformation_handle);
+    k4a_transformation_context_t *transformation_context = k4a_transformation_t_get_context(transformation_handle);
+
+    if (!transformation_context->enable_depth_color_transform)
+    {
+        LOG_ERROR("Expect both depth camera and color camera are running to transform depth image to color camera.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_calibration_camera_t pinhole_calibration;
+    if (K4A_FAILED(TRACE_CALL(undistortion_map_get_camera_calibration(undistortion_map_handle, &pinhole_calibration))))
+    {
+        return K4A_RESULT_FAILED;
+    }
+
+    // The undistortion map keeps the resolution and extrinsics of its source camera, which must be the color camera.
+    const k4a_calibration_camera_t *color_calibration = &transformation_context->calibration.color_camera_calibration;
+    bool same_extrinsics = memcmp(&pinhole_calibration.extrinsics,
+                                  &color_calibration->extrinsics,
+                                  sizeof(k4a_calibration_extrinsics_t)) == 0;
+    if (pinhole_calibration.resolution_width != color_calibration->resolution_width ||
+        pinhole_calibration.resolution_height != color_calibration->resolution_height || !same_extrinsics)
+    {
+        LOG_ERROR("Undistortion map was not created for the color camera of this transformation.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_transformation_pinhole_t color_pinhole;
+    color_pinhole.px = pinhole_calibration.intrinsics.parameters.param.cx;
+    color_pinhole.py = pinhole_calibration.intrinsics.parameters.param.cy;
+    color_pinhole.fx = pinhole_calibration.intrinsics.parameters.param.fx;
+    color_pinhole.fy = pinhole_calibration.intrinsics.parameters.param.fy;
+    color_pinhole.width = pinhole_calibration.resolution_width;
+    color_pinhole.height = pinhole_calibration.resolution_height;
+
+    // The depth engine only implements the distorted color camera model, so this always runs on the CPU.
+    if (K4A_BUFFER_RESULT_SUCCEEDED !=
+        TRACE_BUFFER_CALL(
+            transformation_depth_image_to_color_camera_internal(&transformation_context->calibration,
+                                                                &transformation_context->depth_camera_xy_tables,
+                                                                &color_pinhole,
+                                                                depth_image_data,
+                                                                depth_image_descriptor,
+                                                                custom_image_data,
+                                                                custom_image_descriptor,
+                                                                transformed_depth_image_data,
+                                                                transformed_depth_image_descriptor,
+                                                                transformed_custom_image_data,
+                                                                transformed_custom_image_descriptor,
+                                                                interpolation_type,
+                                                                invalid_custom_value)))
+    {
+        return K4A_RESULT_FAILED;
+    }
+    return K4A_RESULT_SUCCEEDED;
+}
+
 k4a_result_t
 transformation_color_image_to_depth_camera(k4a_transformation_t transformation_handle,
                                            const uint8_t *depth_image_data,
@@ -0,0 +1,782 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <k4ainternal/transformation.h>
+#include <k4ainternal/logging.h>
+
+// Dependent libraries
+#include <azure_c_shared_utility/threadapi.h>
+#include <azure_c_shared_utility/condition.h>
+#include <azure_c_shared_utility/lock.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(__amd64__) || defined(_M_AMD64) || defined(__i386__) || defined(_M_IX86)
+#define K4A_USING_SSE
+#include <emmintrin.h> // SSE2
+#endif
+
+#ifndef UNDISTORTION_THREAD_COUNT
+// Maximum number of threads used to build a map or remap an image, including the calling thread. A map starts its
+// worker threads when it is created and keeps them until it is destroyed.
+#define UNDISTORTION_THREAD_COUNT 4
+#endif
+
+#ifndef UNDISTORTION_PIXELS_PER_THREAD
+// Images smaller than this many pixels per thread are not worth the cost of handing rows to another thread.
+#define UNDISTORTION_PIXELS_PER_THREAD (256 * 1024)
+#endif
+
+// Bilinear weights are stored as 7 bit fixed point fractions, so the product of the x and y weights fits in 14 bits.
+#define UNDISTORTION_WEIGHT_BITS 7
+#define UNDISTORTION_WEIGHT_ONE (1 << UNDISTORTION_WEIGHT_BITS)
+#define UNDISTORTION_WEIGHT_SHIFT (2 * UNDISTORTION_WEIGHT_BITS)
+#define UNDISTORTION_INVALID_COORDINATE (-1)
+
+typedef void (*undistortion_rows_function_t)(void *context, int row_begin, int row_end);
+
+typedef struct _undistortion_rows_t
+{
+    undistortion_rows_function_t function;
+    void *context;
+    int row_begin;
+    int row_end;
+} undistortion_rows_t;
+
+struct _undistortion_pool_t;
+
+// A worker thread of an undistortion map, processing one band of rows per job.
+typedef struct _undistortion_worker_t
+{
+    struct _undistortion_pool_t *pool;
+    THREAD_HANDLE thread;
+    COND_HANDLE condition; // Signaled when has_work is set or the pool is stopping
+    bool has_work;
+    undistortion_rows_t rows;
+} undistortion_worker_t;
+
+// Worker threads owned by an undistortion map. They are started with the map and reused for every remap, so remapping
+// an image does not create and join threads.
+typedef struct _undistortion_pool_t
+{
+    LOCK_HANDLE lock;
+    COND_HANDLE done_condition; // Signaled when a worker finishes its band
+    undistortion_worker_t workers[UNDISTORTION_THREAD_COUNT - 1];
+    int worker_count;  // Number of worker threads running
+    int pending_count; // Bands of the current job that are not finished yet
+    bool busy;         // A caller is using the workers
+    bool stopping;
+} undistortion_pool_t;
+
+typedef struct _undistortion_map_context_t
+{
+    k4a_calibration_camera_t source_calibration;  // Calibration of the distorted source camera
+    k4a_calibration_camera_t pinhole_calibration; // Calibration of the undistorted output image
+    int width;
+    int height;
+
+    // For each output pixel, the top left source pixel used for bilinear interpolation and the x and y weights of the
+    // pixels to its right and below. Nearest neighbor interpolation picks the closest of the four pixels.
+    int16_t *source_xy;
+    uint8_t *weights;
+
+    undistortion_pool_t pool;
+} undistortion_map_context_t;
+
+K4A_DECLARE_CONTEXT(k4a_undistortion_map_t, undistortion_map_context_t);
+
+// Returns the number of bands an image is split into, including the band of the calling thread.
+static int undistortion_band_count(int width, int height)
+{
+    int band_count = (int)(((size_t)width * (size_t)height) / UNDISTORTION_PIXELS_PER_THREAD);
+    if (band_count > UNDISTORTION_THREAD_COUNT)
+    {
+        band_count = UNDISTORTION_THREAD_COUNT;
+    }
+    if (band_count > height)
+    {
+        band_count = height;
+    }
+    return band_count < 1 ? 1 : band_count;
+}
+
+static int undistortion_worker_thread(void *param)
+{
+    undistortion_worker_t *worker = (undistortion_worker_t *)param;
+    undistortion_pool_t *pool = worker->pool;
+
+    Lock(pool->lock);
+    while (!pool->stopping)
+    {
+        if (!worker->has_work)
+        {
+            int infinite_timeout = 0;
+            (void)Condition_Wait(worker->condition, pool->lock, infinite_timeout);
+            continue;
+        }
+
+        undistortion_rows_t rows = worker->rows;
+        Unlock(pool->lock);
+        rows.function(rows.context, rows.row_begin, rows.row_end);
+        Lock(pool->lock);
+
+        worker->has_work = false;
+        pool->pending_count--;
+        Condition_Post(pool->done_condition);
+    }
+    Unlock(pool->lock);
+    return 0;
+}
+
+// Starts up to worker_count threads. If fewer can be started, the remaining bands run on the calling thread.
+static void undistortion_pool_start(undistortion_pool_t *pool, int worker_count)
+{
+    pool->lock = Lock_Init();
+    pool->done_condition = Condition_Init();
+    if (pool->lock == NULL || pool->done_condition == NULL)
+    {
+        return;
+    }
+
+    for (int i = 0; i < worker_count && i < UNDISTORTION_THREAD_COUNT - 1; i++)
+    {
+        undistortion_worker_t *worker = &pool->workers[i];
+        worker->pool = pool;
+        worker->condition = Condition_Init();
+        if (worker->condition == NULL)
+        {
+            break;
+        }
+        if (ThreadAPI_Create(&worker->thread, undistortion_worker_thread, worker) != THREADAPI_OK)
+        {
+            Condition_Deinit(worker->condition);
+            worker->condition = NULL;
+            break;
+        }
+        pool->worker_count++;
+    }
+}
+
+static void undistortion_pool_stop(undistortion_pool_t *pool)
+{
+    if (pool->lock != NULL)
+    {
+        Lock(pool->lock);
+        pool->stopping = true;
+        for (int i = 0; i < pool->worker_count; i++)
+        {
+            Condition_Post(pool->workers[i].condition);
+        }
+        Unlock(pool->lock);
+    }
+
+    for (int i = 0; i < pool->worker_count; i++)
+    {
+        int thread_result;
+        ThreadAPI_Join(pool->workers[i].thread, &thread_result);
+        Condition_Deinit(pool->workers[i].condition);
+    }
+    pool->worker_count = 0;
+
+    if (pool->done_condition != NULL)
+    {
+        Condition_Deinit(pool->done_condition);
+        pool->done_condition = NULL;
+    }
+    if (pool->lock != NULL)
+    {
+        Lock_Deinit(pool->lock);
+        pool->lock = NULL;
+    }
+}
+
+// Splits the rows of an image into bands that are processed concurrently by the calling thread and the workers of the
+// pool. If another thread is already using the workers, the calling thread processes all the rows itself.
+static void undistortion_parallel_rows(undistortion_pool_t *pool,
+                                       int width,
+                                       int height,
+                                       undistortion_rows_function_t function,
+                                       void *context)
+{
+    int band_count = undistortion_band_count(width, height);
+    if (band_count > pool->worker_count + 1)
+    {
+        band_count = pool->worker_count + 1;
+    }
+
+    bool use_workers = false;
+    if (band_count > 1)
+    {
+        Lock(pool->lock);
+        use_workers = !pool->busy;
+        if (use_workers)
+        {
+            pool->busy = true;
+            pool->pending_count = band_count - 1;
+            for (int i = 1; i < band_count; i++)
+            {
+                undistortion_worker_t *worker = &pool->workers[i - 1];
+                worker->rows.function = function;
+                worker->rows.context = context;
+                worker->rows.row_begin = height * i / band_count;
+                worker->rows.row_end = height * (i + 1) / band_count;
+                worker->has_work = true;
+                Condition_Post(worker->condition);
+            }
+        }
+        Unlock(pool->lock);
+    }
+
+    if (!use_workers)
+    {
+        function(context, 0, height);
+        return;
+    }
+
+    function(context, 0, height / band_count);
+
+    Lock(pool->lock);
+    while (pool->pending_count > 0)
+    {
+        int infinite_timeout = 0;
+        (void)Condition_Wait(pool->done_condition, pool->lock, infinite_timeout);
+    }
+    pool->busy = false;
+    Unlock(pool->lock);
+}
+
+// Compute a conservative bounding box on the unit plane in which all the points have valid projections, by stepping
+// outward from the center of the image along the horizontal and vertical axes.
+static void undistortion_compute_xy_range(const k4a_calibration_camera_t *calibration, float range[4])
+{
+    const float step = 0.25f;
+    const float max_uv[2] = { (float)calibration->resolution_width - 1, (float)calibration->resolution_height - 1 };
+    const float center[2] = { 0.5f * (float)calibration->resolution_width,
+                              0.5f * (float)calibration->resolution_height };
+
+    // range is { x_min, x_max, y_min, y_max }
+    for (int axis = 0; axis < 2; axis++)
+    {
+        for (int direction = 0; direction < 2; direction++)
+        {
+            float *bound = &range[axis * 2 + direction];
+            *bound = 0.f;
+            for (float uv[2] = { center[0], center[1] }; uv[axis] >= 0 && uv[axis] <= max_uv[axis];
+                 uv[axis] += direction ? step : -step)
+            {
+                float ray[3];
+                int valid = 0;
+                if (K4A_FAILED(transformation_unproject(calibration, uv, 1.f, ray, &valid)) || !valid)
+                {
+                    break;
+                }
+                *bound = ray[axis];
+            }
+        }
+    }
+}
+
+static k4a_result_t undistortion_create_pinhole(const k4a_calibration_camera_t *source_calibration,
+                                                const k4a_transformation_pinhole_type_t pinhole_type,
+                                                k4a_calibration_camera_t *pinhole_calibration)
+{
+    const k4a_calibration_intrinsic_parameters_t *source_params = &source_calibration->intrinsics.parameters;
+    float cx, cy, fx, fy;
+
+    if (pinhole_type == K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION)
+    {
+        cx = source_params->param.cx;
+        cy = source_params->param.cy;
+        fx = source_params->param.fx;
+        fy = source_params->param.fy;
+    }
+    else if (pinhole_type == K4A_TRANSFORMATION_PINHOLE_TYPE_FULL_FOV)
+    {
+        float range[4];
+        undistortion_compute_xy_range(source_calibration, range);
+        if (range[1] <= range[0] || range[3] <= range[2])
+        {
+            LOG_ERROR("Unable to find the valid field of view of the camera.", 0);
+            return K4A_RESULT_FAILED;
+        }
+        fx = (float)source_calibration->resolution_width / (range[1] - range[0]);
+        fy = (float)source_calibration->resolution_height / (range[3] - range[2]);
+        cx = -range[0] * fx;
+        cy = -range[2] * fy;
+    }
+    else
+    {
+        LOG_ERROR("Unexpected pinhole type %d.", pinhole_type);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The output camera keeps the extrinsics and resolution of the source camera, with a distortion free model.
+    *pinhole_calibration = *source_calibration;
+    memset(&pinhole_calibration->intrinsics.parameters, 0, sizeof(pinhole_calibration->intrinsics.parameters));
+    pinhole_calibration->intrinsics.type = K4A_CALIBRATION_LENS_DISTORTION_MODEL_BROWN_CONRADY;
+    pinhole_calibration->intrinsics.parameter_count = 14;
+    pinhole_calibration->intrinsics.parameters.param.cx = cx;
+    pinhole_calibration->intrinsics.parameters.param.cy = cy;
+    pinhole_calibration->intrinsics.parameters.param.fx = fx;
+    pinhole_calibration->intrinsics.parameters.param.fy = fy;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+static void undistortion_build_rows(void *param, int row_begin, int row_end)
+{
+    undistortion_map_context_t *map = (undistortion_map_context_t *)param;
+    const k4a_calibration_intrinsic_parameters_t *pinhole = &map->pinhole_calibration.intrinsics.parameters;
+    const int source_width = map->source_calibration.resolution_width;
+    const int source_height = map->source_calibration.resolution_height;
+
+    for (int y = row_begin; y < row_end; y++)
+    {
+        float ray[3];
+        ray[1] = ((float)y - pinhole->param.cy) / pinhole->param.fy;
+        ray[2] = 1.f;
+
+        for (int x = 0; x < map->width; x++)
+        {
+            size_t index = (size_t)y * (size_t)map->width + (size_t)x;
+            int16_t *source_xy = &map->source_xy[2 * index];
+            uint8_t *weights = &map->weights[2 * index];
+            ray[0] = ((float)x - pinhole->param.cx) / pinhole->param.fx;
+
+            float distorted[2];
+            int valid = 0;
+            if (K4A_FAILED(transformation_project(&map->source_calibration, ray, distorted, &valid)) || !valid ||
+                !(distorted[0] >= 0.f && distorted[0] <= (float)(source_width - 1) && distorted[1] >= 0.f &&
+                  distorted[1] <= (float)(source_height - 1)))
+            {
+                source_xy[0] = UNDISTORTION_INVALID_COORDINATE;
+                source_xy[1] = UNDISTORTION_INVALID_COORDINATE;
+                weights[0] = 0;
+                weights[1] = 0;
+                continue;
+            }
+
+            for (int i = 0; i < 2; i++)
+            {
+                const int limit = i == 0 ? source_width : source_height;
+                int coordinate = (int)floorf(distorted[i]);
+                int weight = (int)floorf((distorted[i] - (float)coordinate) * UNDISTORTION_WEIGHT_ONE + 0.5f);
+                if (weight >= UNDISTORTION_WEIGHT_ONE)
+                {
+                    coordinate++;
+                    weight = 0;
+                }
+                // Keep the 2x2 neighborhood inside the image, on the last row or column the whole weight goes to the
+                // second pixel instead.
+                if (coordinate >= limit - 1)
+                {
+                    coordinate = limit - 2;
+                    weight = UNDISTORTION_WEIGHT_ONE;
+                }
+                source_xy[i] = (int16_t)coordinate;
+                weights[i] = (uint8_t)weight;
+            }
+        }
+    }
+}
+
+k4a_result_t undistortion_map_create(const k4a_calibration_t *calibration,
+                                     const k4a_calibration_type_t camera,
+                                     const k4a_transformation_pinhole_type_t pinhole_type,
+                                     k4a_undistortion_map_t *undistortion_map_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, undistortion_map_handle == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        camera != K4A_CALIBRATION_TYPE_DEPTH && camera != K4A_CALIBRATION_TYPE_COLOR);
+
+    const k4a_calibration_camera_t *source_calibration = camera == K4A_CALIBRATION_TYPE_DEPTH ?
+                                                             &calibration->depth_camera_calibration :
+                                                             &calibration->color_camera_calibration;
+    if (source_calibration->resolution_width < 2 || source_calibration->resolution_height < 2 ||
+        source_calibration->resolution_width > INT16_MAX || source_calibration->resolution_height > INT16_MAX)
+    {
+        LOG_ERROR("Unexpected camera resolution %dx%d, is the camera enabled in the calibration?",
+                  source_calibration->resolution_width,
+                  source_calibration->resolution_height);
+        return K4A_RESULT_FAILED;
+    }
+
+    k4a_undistortion_map_t handle = NULL;
+    undistortion_map_context_t *map = k4a_undistortion_map_t_create(&handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(map != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        map->source_calibration = *source_calibration;
+        map->width = source_calibration->resolution_width;
+        map->height = source_calibration->resolution_height;
+        result = TRACE_CALL(undistortion_create_pinhole(source_calibration, pinhole_type, &map->pinhole_calibration));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        size_t pixel_count = (size_t)map->width * (size_t)map->height;
+        map->source_xy = (int16_t *)malloc(2 * pixel_count * sizeof(int16_t));
+        map->weights = (uint8_t *)malloc(2 * pixel_count * sizeof(uint8_t));
+        result = K4A_RESULT_FROM_BOOL(map->source_xy != NULL && map->weights != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        undistortion_pool_start(&map->pool, undistortion_band_count(map->width, map->height) - 1);
+        undistortion_parallel_rows(&map->pool, map->width, map->height, undistortion_build_rows, map);
+        *undistortion_map_handle = handle;
+    }
+    else if (handle != NULL)
+    {
+        undistortion_map_destroy(handle);
+    }
+
+    return result;
+}
+
+void undistortion_map_destroy(k4a_undistortion_map_t undistortion_map_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, k4a_undistortion_map_t, undistortion_map_handle);
+    undistortion_map_context_t *map = k4a_undistortion_map_t_get_context(undistortion_map_handle);
+
+    undistortion_pool_stop(&map->pool);
+    free(map->source_xy);
+    free(map->weights);
+    k4a_undistortion_map_t_destroy(undistortion_map_handle);
+}
+
+k4a_result_t undistortion_map_get_camera_calibration(k4a_undistortion_map_t undistortion_map_handle,
+                                                     k4a_calibration_camera_t *pinhole_calibration)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_undistortion_map_t, undistortion_map_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, pinhole_calibration == NULL);
+    undistortion_map_context_t *map = k4a_undistortion_map_t_get_context(undistortion_map_handle);
+
+    *pinhole_calibration = map->pinhole_calibration;
+    return K4A_RESULT_SUCCEEDED;
+}
+
+typedef struct _undistortion_remap_t
+{
+    const undistortion_map_context_t *map;
+    const uint8_t *source;
+    int source_stride;
+    uint8_t *destination;
+    int destination_stride;
+    k4a_image_format_t format;
+} undistortion_remap_t;
+
+// Returns 0 for formats that can't be remapped.
+static int undistortion_bytes_per_pixel(const k4a_image_format_t format)
+{
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        return 4;
+    case K4A_IMAGE_FORMAT_DEPTH16:
+    case K4A_IMAGE_FORMAT_IR16:
+    case K4A_IMAGE_FORMAT_CUSTOM16:
+        return 2;
+    case K4A_IMAGE_FORMAT_CUSTOM8:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static inline const uint8_t *undistortion_source_pixel(const undistortion_remap_t *remap, int x, int y, int bpp)
+{
+    return remap->source + (size_t)y * (size_t)remap->source_stride + (size_t)x * (size_t)bpp;
+}
+
+static inline void undistortion_bilinear_weights(const uint8_t weights[2], uint32_t w[4])
+{
+    uint32_t wx = weights[0];
+    uint32_t wy = weights[1];
+    w[0] = (UNDISTORTION_WEIGHT_ONE - wx) * (UNDISTORTION_WEIGHT_ONE - wy);
+    w[1] = wx * (UNDISTORTION_WEIGHT_ONE - wy);
+    w[2] = (UNDISTORTION_WEIGHT_ONE - wx) * wy;
+    w[3] = wx * wy;
+}
+
+static inline uint32_t undistortion_bilinear(const uint32_t neighbors[4], const uint32_t w[4])
+{
+    return (neighbors[0] * w[0] + neighbors[1] * w[1] + neighbors[2] * w[2] + neighbors[3] * w[3] +
+            (1u << (UNDISTORTION_WEIGHT_SHIFT - 1))) >>
+           UNDISTORTION_WEIGHT_SHIFT;
+}
+
+static void undistortion_remap_nearest_rows(void *param, int row_begin, int row_end)
+{
+    const undistortion_remap_t *remap = (const undistortion_remap_t *)param;
+    const undistortion_map_context_t *map = remap->map;
+    const int bpp = undistortion_bytes_per_pixel(remap->format);
+    const int half = UNDISTORTION_WEIGHT_ONE / 2;
+
+    for (int y = row_begin; y < row_end; y++)
+    {
+        const int16_t *source_xy = &map->source_xy[2 * (size_t)y * (size_t)map->width];
+        const uint8_t *weights = &map->weights[2 * (size_t)y * (size_t)map->width];
+        uint8_t *destination = remap->destination + (size_t)y * (size_t)remap->destination_stride;
+
+        for (int x = 0; x < map->width; x++, source_xy += 2, weights += 2, destination += bpp)
+        {
+            if (source_xy[0] == UNDISTORTION_INVALID_COORDINATE)
+            {
+                memset(destination, 0, (size_t)bpp);
+                continue;
+            }
+            const uint8_t *source = undistortion_source_pixel(remap,
+                                                              source_xy[0] + (weights[0] >= half),
+                                                              source_xy[1] + (weights[1] >= half),
+                                                              bpp);
+            switch (bpp)
+            {
+            case 4:
+                memcpy(destination, source, 4);
+                break;
+            case 2:
+                memcpy(destination, source, 2);
+                break;
+            default:
+                *destination = *source;
+                break;
+            }
+        }
+    }
+}
+
+static void undistortion_remap_linear_8_rows(void *param, int row_begin, int row_end)
+{
+    const undistortion_remap_t *remap = (const undistortion_remap_t *)param;
+    const undistortion_map_context_t *map = remap->map;
+
+    for (int y = row_begin; y < row_end; y++)
+    {
+        const int16_t *source_xy = &map->source_xy[2 * (size_t)y * (size_t)map->width];
+        const uint8_t *weights = &map->weights[2 * (size_t)y * (size_t)map->width];
+        uint8_t *destination = remap->destination + (size_t)y * (size_t)remap->destination_stride;
+
+        for (int x = 0; x < map->width; x++, source_xy += 2, weights += 2)
+        {
+            if (source_xy[0] == UNDISTORTION_INVALID_COORDINATE)
+            {
+                destination[x] = 0;
+                continue;
+            }
+            const uint8_t *top = undistortion_source_pixel(remap, source_xy[0], source_xy[1], 1);
+            const uint8_t *bottom = top + remap->source_stride;
+            uint32_t neighbors[4] = { top[0], top[1], bottom[0], bottom[1] };
+            uint32_t w[4];
+            undistortion_bilinear_weights(weights, w);
+            destination[x] = (uint8_t)undistortion_bilinear(neighbors, w);
+        }
+    }
+}
+
+static void undistortion_remap_linear_16_rows(void *param, int row_begin, int row_end)
+{
+    const undistortion_remap_t *remap = (const undistortion_remap_t *)param;
+    const undistortion_map_context_t *map = remap->map;
+    const bool depth = remap->format == K4A_IMAGE_FORMAT_DEPTH16;
+
+    for (int y = row_begin; y < row_end; y++)
+    {
+        const int16_t *source_xy = &map->source_xy[2 * (size_t)y * (size_t)map->width];
+        const uint8_t *weights = &map->weights[2 * (size_t)y * (size_t)map->width];
+        uint16_t *destination = (uint16_t *)(void *)(remap->destination +
+                                                     (size_t)y * (size_t)remap->destination_stride);
+
+        for (int x = 0; x < map->width; x++, source_xy += 2, weights += 2)
+        {
+            destination[x] = 0;
+            if (source_xy[0] == UNDISTORTION_INVALID_COORDINATE)
+            {
+                continue;
+            }
+            const uint16_t *top = (const uint16_t *)(const void *)undistortion_source_pixel(remap,
+                                                                                            source_xy[0],
+                                                                                            source_xy[1],
+                                                                                            2);
+            const uint16_t *bottom = (const uint16_t *)(const void *)((const uint8_t *)top + remap->source_stride);
+            uint32_t neighbors[4] = { top[0], top[1], bottom[0], bottom[1] };
+
+            if (depth)
+            {
+                // Invalid depth is 0, don't blend it into valid neighbors.
+                if (neighbors[0] == 0 || neighbors[1] == 0 || neighbors[2] == 0 || neighbors[3] == 0)
+                {
+                    continue;
+                }
+
+                // Don't interpolate across depth discontinuities, which would create points floating between the
+                // foreground and background. The threshold allows the depth difference of a surface slanted at 85
+                // degrees between two neighboring pixels of a binned depth mode.
+                const float skip_interpolation_ratio = 0.04693441759f;
+                uint32_t depth_min = neighbors[0], depth_max = neighbors[0];
+                for (int i = 1; i < 4; i++)
+                {
+                    depth_min = neighbors[i] < depth_min ? neighbors[i] : depth_min;
+                    depth_max = neighbors[i] > depth_max ? neighbors[i] : depth_max;
+                }
+                if ((float)(depth_max - depth_min) > skip_interpolation_ratio * (float)depth_min)
+                {
+                    continue;
+                }
+            }
+
+            uint32_t w[4];
+            undistortion_bilinear_weights(weights, w);
+            destination[x] = (uint16_t)undistortion_bilinear(neighbors, w);
+        }
+    }
+}
+
+static void undistortion_remap_linear_bgra_rows(void *param, int row_begin, int row_end)
+{
+    const undistortion_remap_t *remap = (const undistortion_remap_t *)param;
+    const undistortion_map_context_t *map = remap->map;
+#if defined(K4A_USING_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi32(1 << (UNDISTORTION_WEIGHT_SHIFT - 1));
+#endif
+
+    for (int y = row_begin; y < row_end; y++)
+    {
+        const int16_t *source_xy = &map->source_xy[2 * (size_t)y * (size_t)map->width];
+        const uint8_t *weights = &map->weights[2 * (size_t)y * (size_t)map->width];
+        uint8_t *destination = remap->destination + (size_t)y * (size_t)remap->destination_stride;
+
+        for (int x = 0; x < map->width; x++, source_xy += 2, weights += 2, destination += 4)
+        {
+            if (source_xy[0] == UNDISTORTION_INVALID_COORDINATE)
+            {
+                memset(destination, 0, 4);
+                continue;
+            }
+            const uint8_t *top = undistortion_source_pixel(remap, source_xy[0], source_xy[1], 4);
+            const uint8_t *bottom = top + remap->source_stride;
+            uint32_t w[4];
+            undistortion_bilinear_weights(weights, w);
+
+#if defined(K4A_USING_SSE)
+            // Interleave the channels of the left and right pixels as 16 bit values, so that one multiply-add per row
+            // computes the weighted sum of all four channels.
+            int32_t pixels[4];
+            memcpy(&pixels[0], top, 4);
+            memcpy(&pixels[1], top + 4, 4);
+            memcpy(&pixels[2], bottom, 4);
+            memcpy(&pixels[3], bottom + 4, 4);
+            __m128i top_pixels = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(pixels[0]),
+                                                                     _mm_cvtsi32_si128(pixels[1])),
+                                                   zero);
+            __m128i bottom_pixels = _mm_unpacklo_epi8(_mm_unpacklo_epi8(_mm_cvtsi32_si128(pixels[2]),
+                                                                        _mm_cvtsi32_si128(pixels[3])),
+                                                      zero);
+            __m128i top_weights = _mm_set1_epi32((int)(w[0] | (w[1] << 16)));
+            __m128i bottom_weights = _mm_set1_epi32((int)(w[2] | (w[3] << 16)));
+            __m128i sum = _mm_add_epi32(_mm_madd_epi16(top_pixels, top_weights),
+                                        _mm_madd_epi16(bottom_pixels, bottom_weights));
+            sum = _mm_srli_epi32(_mm_add_epi32(sum, round), UNDISTORTION_WEIGHT_SHIFT);
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(sum, zero), zero);
+            int32_t result = _mm_cvtsi128_si32(packed);
+            memcpy(destination, &result, 4);
+#else
+            for (int c = 0; c < 4; c++)
+            {
+                uint32_t neighbors[4] = { top[c], top[4 + c], bottom[c], bottom[4 + c] };
+                destination[c] = (uint8_t)undistortion_bilinear(neighbors, w);
+            }
+#endif
+        }
+    }
+}
+
+k4a_result_t undistortion_map_remap(k4a_undistortion_map_t undistortion_map_handle,
+                                    const uint8_t *source_image_data,
+                                    const k4a_transformation_image_descriptor_t *source_image_descriptor,
+                                    uint8_t *destination_image_data,
+                                    const k4a_transformation_image_descriptor_t *destination_image_descriptor,
+                                    const k4a_transformation_interpolation_type_t interpolation_type)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, k4a_undistortion_map_t, undistortion_map_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source_image_data == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, source_image_descriptor == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, destination_image_data == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, destination_image_descriptor == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED,
+                        interpolation_type != K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST &&
+                            interpolation_type != K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR);
+    undistortion_map_context_t *map = k4a_undistortion_map_t_get_context(undistortion_map_handle);
+
+    int bpp = undistortion_bytes_per_pixel(source_image_descriptor->format);
+    if (bpp == 0)
+    {
+        LOG_ERROR("Unsupported image format %d, remap supports BGRA32, DEPTH16, IR16, CUSTOM16 and CUSTOM8 images.",
+                  source_image_descriptor->format);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (destination_image_descriptor->format != source_image_descriptor->format)
+    {
+        LOG_ERROR("Destination image format %d does not match source image format %d.",
+                  destination_image_descriptor->format,
+                  source_image_descriptor->format);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (source_image_descriptor->width_pixels != map->source_calibration.resolution_width ||
+        source_image_descriptor->height_pixels != map->source_calibration.resolution_height ||
+        source_image_descriptor->stride_bytes < source_image_descriptor->width_pixels * bpp)
+    {
+        LOG_ERROR("Unexpected source image size %dx%d (stride %d), the undistortion map expects %dx%d.",
+                  source_image_descriptor->width_pixels,
+                  source_image_descriptor->height_pixels,
+                  source_image_descriptor->stride_bytes,
+                  map->source_calibration.resolution_width,
+                  map->source_calibration.resolution_height);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (destination_image_descriptor->width_pixels != map->width ||
+        destination_image_descriptor->height_pixels != map->height ||
+        destination_image_descriptor->stride_bytes < destination_image_descriptor->width_pixels * bpp)
+    {
+        LOG_ERROR("Unexpected destination image size %dx%d (stride %d), the undistortion map produces %dx%d.",
+                  destination_image_descriptor->width_pixels,
+                  destination_image_descriptor->height_pixels,
+                  destination_image_descriptor->stride_bytes,
+                  map->width,
+                  map->height);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (source_image_data == destination_image_data)
+    {
+        LOG_ERROR("Remap can not be done in place.", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    undistortion_remap_t remap;
+    remap.map = map;
+    remap.source = source_image_data;
+    remap.source_stride = source_image_descriptor->stride_bytes;
+    remap.destination = destination_image_data;
+    remap.destination_stride = destination_image_descriptor->stride_bytes;
+    remap.format = source_image_descriptor->format;
+
+    undistortion_rows_function_t function = undistortion_remap_nearest_rows;
+    if (interpolation_type == K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR)
+    {
+        function = bpp == 4 ? undistortion_remap_linear_bgra_rows :
+                              (bpp == 2 ? undistortion_remap_linear_16_rows : undistortion_remap_linear_8_rows);
+    }
+    undistortion_parallel_rows(&map->pool, map->width, map->height, function, &remap);
+
+    return K4A_RESULT_SUCCEEDED;
+}
@@ -16,6 +16,7 @@
 
 // Dependent libraries
 #include <k4ainternal/allocator.h>
+#include <k4ainternal/virtual_device.h>
 #include <azure_c_shared_utility/lock.h>
 #include <azure_c_shared_utility/threadapi.h>
 
@@ -96,6 +97,9 @@ typedef struct _usbcmd_context_t
     size_t stream_size;
     LOCK_HANDLE lock;
     THREAD_HANDLE stream_handle;
+
+    // Set when this instance replays a virtual device instead of talking to libusb
+    virtual_device_t virtual_device;
 } usbcmd_context_t;
 
 K4A_DECLARE_CONTEXT(usbcmd_t, usbcmd_context_t);
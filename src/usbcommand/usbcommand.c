@@ -378,6 +378,43 @@ static k4a_result_t find_libusb_device(uint32_t device_index,
     return result;
 }
 
+// Opens the virtual device standing in for the physical one. The color half of a device is found by container ID like
+// find_libusb_device() does, the depth half by index.
+static k4a_result_t open_virtual_device(usb_command_device_type_t device_type,
+                                        uint32_t device_index,
+                                        const guid_t *container_id,
+                                        usbcmd_context_t *usbcmd)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    if (container_id != NULL && !virtual_device_find_container_id(container_id, &device_index))
+    {
+        LOG_ERROR("Container ID does not belong to a virtual device", 0);
+        result = K4A_RESULT_FAILED;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(virtual_device_create(device_index,
+                                                  device_type == USB_DEVICE_DEPTH_PROCESSOR ?
+                                                      VIRTUAL_DEVICE_STREAM_DEPTH :
+                                                      VIRTUAL_DEVICE_STREAM_IMU,
+                                                  &usbcmd->virtual_device));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        const virtual_device_file_header_t *header = virtual_device_get_file_header(usbcmd->virtual_device);
+
+        usbcmd->index = (uint8_t)device_index;
+        virtual_device_get_container_id(device_index, &usbcmd->container_id);
+        memset(usbcmd->serial_number, 0, sizeof(usbcmd->serial_number));
+        memcpy(usbcmd->serial_number, header->serial_number, strlen(header->serial_number));
+    }
+
+    return result;
+}
+
 k4a_result_t usb_cmd_create(usb_command_device_type_t device_type,
                             uint32_t device_index,
                             const guid_t *container_id,
@@ -419,26 +456,34 @@ k4a_result_t usb_cmd_create(usb_command_device_type_t device_type,
             usbcmd->stream_endpoint = USB_CMD_IMU_STREAM_ENDPOINT;
             usbcmd->source = ALLOCATION_SOURCE_USB_IMU;
         }
-        result = find_libusb_device(device_index, container_id, &desc, usbcmd);
+
+        if (virtual_device_get_count() > 0)
+        {
+            result = TRACE_CALL(open_virtual_device(device_type, device_index, container_id, usbcmd));
+        }
+        else
+        {
+            result = find_libusb_device(device_index, container_id, &desc, usbcmd);
+        }
     }
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && usbcmd->virtual_device == NULL)
     {
         result = populate_serialnumber(usbcmd, &desc);
     }
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && usbcmd->virtual_device == NULL)
     {
         // Set up the configuration and interfaces based on known descriptor definition
         result = K4A_RESULT_FROM_LIBUSB(libusb_get_configuration(usbcmd->libusb, &activeConfig));
     }
 
-    if (K4A_SUCCEEDED(result) && (activeConfig != USB_CMD_DEFAULT_CONFIG))
+    if (K4A_SUCCEEDED(result) && usbcmd->virtual_device == NULL && (activeConfig != USB_CMD_DEFAULT_CONFIG))
     {
         result = K4A_RESULT_FROM_LIBUSB(libusb_set_configuration(usbcmd->libusb, USB_CMD_DEFAULT_CONFIG));
     }
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && usbcmd->virtual_device == NULL)
     {
         // Try to force detach kernel driver if on our interface
         if ((libusb_kernel_driver_active(usbcmd->libusb, usbcmd->interface) == 1))
@@ -447,7 +492,7 @@ k4a_result_t usb_cmd_create(usb_command_device_type_t device_type,
         }
     }
 
-    if (K4A_SUCCEEDED(result))
+    if (K4A_SUCCEEDED(result) && usbcmd->virtual_device == NULL)
     {
         // claim interface
         result = K4A_RESULT_FROM_LIBUSB(libusb_claim_interface(usbcmd->libusb, usbcmd->interface));
@@ -489,6 +534,12 @@ void usb_cmd_destroy(usbcmd_t usbcmd_handle)
         Unlock(usbcmd->lock);
     }
 
+    if (usbcmd->virtual_device)
+    {
+        virtual_device_destroy(usbcmd->virtual_device);
+        usbcmd->virtual_device = NULL;
+    }
+
     if (usbcmd->libusb)
     {
         // Release interface(s)
@@ -654,6 +705,21 @@ static k4a_result_t usb_cmd_io(usbcmd_t usbcmd_handle,
         }
 
         Lock(usbcmd->lock);
+
+        if (usbcmd->virtual_device != NULL)
+        {
+            result = TRACE_CALL(virtual_device_command(usbcmd->virtual_device,
+                                                       cmd,
+                                                       p_cmd_data,
+                                                       cmd_data_size,
+                                                       p_rx_data,
+                                                       p_rx_data != NULL ? payload_size : 0,
+                                                       transfer_count,
+                                                       cmd_status));
+            Unlock(usbcmd->lock);
+            return result;
+        }
+
         // format up request and send command
         usb_cmd_pkt.header.command = cmd;
         usb_cmd_pkt.header.packet_type = USB_CMD_PACKET_TYPE;
@@ -1015,6 +1081,14 @@ k4a_result_t usb_cmd_get_device_count(uint32_t *p_device_count)
     }
 
     *p_device_count = 0;
+
+    // Virtual devices replace the physical ones
+    if (virtual_device_get_count() > 0)
+    {
+        *p_device_count = virtual_device_get_count();
+        return K4A_RESULT_SUCCEEDED;
+    }
+
     // initialize library
     if ((err = libusb_init(&libusb_ctx)) < 0)
     {
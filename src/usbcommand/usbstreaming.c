@@ -5,6 +5,7 @@
 // This library
 #include <k4ainternal/usbcommand.h>
 #include "usb_cmd_priv.h"
+#include <k4ainternal/perf_trace.h>
 
 // System dependencies
 #include <assert.h>
@@ -63,6 +64,8 @@ void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer)
     usbcmd_context_t *usbcmd = transfer->usbcmd;
     k4a_result_t result = K4A_RESULT_FAILED;
 
+    PERF_TRACE_BEGIN("usb_cmd_libusb_cb");
+
     result = image_apply_system_timestamp(transfer->image);
     if (K4A_SUCCEEDED(result))
     {
@@ -142,6 +145,8 @@ void LIBUSB_CALL usb_cmd_libusb_cb(struct libusb_transfer *bulk_transfer)
         // release resource for phy related changes or transfer stopped
         usb_cmd_release_xfr(bulk_transfer);
     }
+
+    PERF_TRACE_END("usb_cmd_libusb_cb");
 }
 
 /**
@@ -328,6 +333,16 @@ k4a_result_t usb_cmd_stream_start(usbcmd_t usbcmd_handle, size_t payload_size)
             // Steam already going (Error?)
             LOG_INFO("Stream already in progress", 0);
         }
+        else if (usbcmd->virtual_device != NULL)
+        {
+            usbcmd->stream_size = payload_size;
+            result = TRACE_CALL(virtual_device_stream_start(usbcmd->virtual_device,
+                                                            usbcmd->source,
+                                                            payload_size,
+                                                            usbcmd->callback,
+                                                            usbcmd->stream_context));
+            usbcmd->stream_going = K4A_SUCCEEDED(result);
+        }
         else
         {
             usbcmd->stream_size = payload_size;
@@ -378,6 +393,11 @@ k4a_result_t usb_cmd_stream_stop(usbcmd_t usbcmd_handle)
         Lock(usbcmd->lock);
         usbcmd->stream_going = false;
 
+        if (usbcmd->virtual_device != NULL)
+        {
+            virtual_device_stream_stop(usbcmd->virtual_device);
+        }
+
         // This function is the only place that kills the thread so this should be safe
         if (usbcmd->stream_handle != NULL) // check if the thread has already stopped
         {
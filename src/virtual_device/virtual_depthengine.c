@@ -0,0 +1,595 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Stand-in depth engine plugin for virtual devices. Instead of computing depth from the phase images of a physical
+// sensor, it unpacks the depth and IR images a virtual device stores in its raw payload (see
+// virtual_device_raw_depth_header_t), so the depth pipeline runs without a GPU or the proprietary depth engine.
+//
+// It is also the CPU depth engine the wrapper tests and benchmarks load. The VIRTUAL_DEPTH_ENGINE_ENV_* variables add
+// a synthetic cost and failures to each frame, and register a transform engine. That transform engine maps between the
+// depth and color geometries by nearest neighbor scaling of the image resolutions, ignoring the intrinsics and
+// extrinsics, so its output has the right size and layout but is not a geometrically correct transformation.
+
+//************************ Includes *****************************
+#include <k4ainternal/k4aplugin.h>
+#include <k4ainternal/transformation.h>
+#include <k4ainternal/virtual_device.h>
+
+// System dependencies
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#define VIRTUAL_DEPTHENGINE_EXPORT __declspec(dllexport)
+#else
+#include <time.h>
+#define VIRTUAL_DEPTHENGINE_EXPORT __attribute__((visibility("default")))
+#endif
+
+//************************ Typedefs *****************************
+typedef struct
+{
+    uint64_t cost_usec;
+    size_t output_size; // 0 when not overridden
+    uint64_t fail_every;
+    k4a_depth_engine_result_code_t fail_code;
+} virtual_engine_config_t;
+
+struct k4a_depth_engine_context_t
+{
+    virtual_engine_config_t config;
+    k4a_depth_engine_mode_t mode;
+    uint16_t width;
+    uint16_t height;
+    bool depth_present;
+    uint64_t frame_count;
+};
+
+struct k4a_transform_engine_context_t
+{
+    virtual_engine_config_t config;
+    uint32_t depth_width;
+    uint32_t depth_height;
+    uint32_t color_width;
+    uint32_t color_height;
+    uint64_t frame_count;
+};
+
+//*********************** Functions *****************************
+
+static uint64_t virtual_engine_get_env_uint64(const char *name, uint64_t default_value)
+{
+    const char *value = getenv(name);
+    if (value == NULL || value[0] == '\0')
+    {
+        return default_value;
+    }
+    return (uint64_t)strtoull(value, NULL, 10);
+}
+
+static void virtual_engine_read_config(virtual_engine_config_t *config)
+{
+    config->cost_usec = virtual_engine_get_env_uint64(VIRTUAL_DEPTH_ENGINE_ENV_COST_USEC, 0);
+    config->output_size = (size_t)virtual_engine_get_env_uint64(VIRTUAL_DEPTH_ENGINE_ENV_OUTPUT_SIZE, 0);
+    config->fail_every = virtual_engine_get_env_uint64(VIRTUAL_DEPTH_ENGINE_ENV_FAIL_EVERY, 0);
+    config->fail_code = (k4a_depth_engine_result_code_t)
+        virtual_engine_get_env_uint64(VIRTUAL_DEPTH_ENGINE_ENV_FAIL_CODE,
+                                      K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT);
+}
+
+static uint64_t virtual_engine_get_time_usec(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart * 1000000 +
+                      counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+#endif
+}
+
+// Counts a process_frame call and returns the failure to inject for it, if any. The synthetic cost spins instead of
+// sleeping, so it is accurate to microseconds and occupies the calling thread the way a blocking wait for the GPU does.
+static k4a_depth_engine_result_code_t virtual_engine_next_frame(const virtual_engine_config_t *config,
+                                                                uint64_t *frame_count)
+{
+    (*frame_count)++;
+
+    if (config->cost_usec != 0)
+    {
+        uint64_t stop = virtual_engine_get_time_usec() + config->cost_usec;
+        while (virtual_engine_get_time_usec() < stop)
+        {
+        }
+    }
+
+    if (config->fail_every != 0 && *frame_count % config->fail_every == 0)
+    {
+        return config->fail_code;
+    }
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+static k4a_depth_engine_result_code_t __stdcall
+virtual_de_create_and_initialize(k4a_depth_engine_context_t **context,
+                                 size_t cal_block_size_in_bytes,
+                                 void *cal_block,
+                                 k4a_depth_engine_mode_t mode,
+                                 k4a_depth_engine_input_type_t input_format,
+                                 void *camera_calibration,
+                                 k4a_processing_complete_cb_t *callback,
+                                 void *callback_context)
+{
+    (void)cal_block_size_in_bytes;
+    (void)cal_block;
+    (void)input_format;
+    (void)camera_calibration;
+    (void)callback;
+    (void)callback_context;
+
+    if (context == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_NULL_ENGINE_POINTER;
+    }
+
+    k4a_depth_engine_context_t *engine = (k4a_depth_engine_context_t *)calloc(1, sizeof(*engine));
+    if (engine == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_INITIALIZE_ENGINE_FAILED;
+    }
+
+    virtual_engine_read_config(&engine->config);
+    engine->mode = mode;
+    engine->depth_present = true;
+    switch (mode)
+    {
+    case K4A_DEPTH_ENGINE_MODE_LT_SW_BINNING:
+        engine->width = 320;
+        engine->height = 288;
+        break;
+    case K4A_DEPTH_ENGINE_MODE_LT_NATIVE:
+        engine->width = 640;
+        engine->height = 576;
+        break;
+    case K4A_DEPTH_ENGINE_MODE_QUARTER_MEGA_PIXEL:
+        engine->width = 512;
+        engine->height = 512;
+        break;
+    case K4A_DEPTH_ENGINE_MODE_MEGA_PIXEL:
+        engine->width = 1024;
+        engine->height = 1024;
+        break;
+    case K4A_DEPTH_ENGINE_MODE_PCM:
+        engine->width = 1024;
+        engine->height = 1024;
+        engine->depth_present = false;
+        break;
+    default:
+        free(engine);
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_INITIALIZE_ENGINE_FAILED;
+    }
+
+    *context = engine;
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+// Size of the depth (when present) and IR images the engine writes
+static size_t virtual_de_get_image_size(const k4a_depth_engine_context_t *context)
+{
+    size_t image_size = (size_t)context->width * context->height * sizeof(uint16_t);
+    return context->depth_present ? 2 * image_size : image_size;
+}
+
+static size_t __stdcall virtual_de_get_output_frame_size(k4a_depth_engine_context_t *context)
+{
+    if (context == NULL)
+    {
+        return 0;
+    }
+
+    return context->config.output_size != 0 ? context->config.output_size : virtual_de_get_image_size(context);
+}
+
+// Copies a stored image into the output, 2x2 binning it when the payload holds the unbinned image of a binned mode
+static void virtual_de_copy_image(const uint16_t *src,
+                                  uint32_t src_width,
+                                  uint32_t src_height,
+                                  uint16_t *dst,
+                                  uint32_t dst_width,
+                                  uint32_t dst_height)
+{
+    if (src_width == dst_width && src_height == dst_height)
+    {
+        memcpy(dst, src, (size_t)dst_width * dst_height * sizeof(uint16_t));
+        return;
+    }
+
+    for (uint32_t y = 0; y < dst_height; y++)
+    {
+        const uint16_t *row0 = src + (size_t)(2 * y) * src_width;
+        const uint16_t *row1 = row0 + src_width;
+        for (uint32_t x = 0; x < dst_width; x++)
+        {
+            // Invalid (zero) depth pixels are excluded from the average
+            uint32_t sum = 0;
+            uint32_t count = 0;
+            uint16_t values[4] = { row0[2 * x], row0[2 * x + 1], row1[2 * x], row1[2 * x + 1] };
+            for (int i = 0; i < 4; i++)
+            {
+                if (values[i] != 0)
+                {
+                    sum += values[i];
+                    count++;
+                }
+            }
+            dst[(size_t)y * dst_width + x] = count ? (uint16_t)(sum / count) : 0;
+        }
+    }
+}
+
+static k4a_depth_engine_result_code_t __stdcall
+virtual_de_process_frame(k4a_depth_engine_context_t *context,
+                         void *input_frame,
+                         size_t input_frame_size,
+                         k4a_depth_engine_output_type_t output_type,
+                         void *output_frame,
+                         size_t output_frame_size,
+                         k4a_depth_engine_output_frame_info_t *output_frame_info,
+                         k4a_depth_engine_input_frame_info_t *input_frame_info)
+{
+    (void)output_type;
+    (void)input_frame_info;
+
+    if (context == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_NULL_ENGINE_POINTER;
+    }
+    if (input_frame == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_NULL_INPUT_BUFFER;
+    }
+    if (output_frame == NULL || output_frame_info == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_NULL_OUTPUT_BUFFER;
+    }
+
+    k4a_depth_engine_result_code_t result = virtual_engine_next_frame(&context->config, &context->frame_count);
+    if (result != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+    {
+        return result;
+    }
+    if (output_frame_size < virtual_de_get_image_size(context))
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_OUTPUT_BUFFER_SIZE;
+    }
+    if (input_frame_size < sizeof(virtual_device_raw_depth_header_t))
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_INPUT_BUFFER_SIZE;
+    }
+
+    const virtual_device_raw_depth_header_t *raw = (const virtual_device_raw_depth_header_t *)input_frame;
+    bool stored_depth = (raw->flags & VIRTUAL_DEVICE_RAW_DEPTH_FLAG_DEPTH) != 0;
+    bool binned = raw->width == 2 * context->width && raw->height == 2 * context->height;
+    size_t stored_image_size = (size_t)raw->width * raw->height * sizeof(uint16_t);
+
+    if (raw->magic != VIRTUAL_DEVICE_RAW_DEPTH_MAGIC || (stored_depth != context->depth_present) ||
+        !((raw->width == context->width && raw->height == context->height) || binned))
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_CAPTURE_SEQUENCE;
+    }
+    if (input_frame_size < sizeof(*raw) + (stored_depth ? 2 : 1) * stored_image_size)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_INPUT_BUFFER_SIZE;
+    }
+
+    const uint16_t *src = (const uint16_t *)(raw + 1);
+    uint16_t *dst = (uint16_t *)output_frame;
+    size_t pixels = (size_t)context->width * context->height;
+
+    if (context->depth_present)
+    {
+        virtual_de_copy_image(src, raw->width, raw->height, dst, context->width, context->height);
+        src += (size_t)raw->width * raw->height;
+        dst += pixels;
+    }
+    virtual_de_copy_image(src, raw->width, raw->height, dst, context->width, context->height);
+
+    memset(output_frame_info, 0, sizeof(*output_frame_info));
+    output_frame_info->output_width = context->width;
+    output_frame_info->output_height = context->height;
+    output_frame_info->sensor_temp = raw->sensor_temp;
+    output_frame_info->center_of_exposure_in_ticks = raw->center_of_exposure_in_ticks;
+
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+static void __stdcall virtual_de_destroy(k4a_depth_engine_context_t **context)
+{
+    if (context != NULL && *context != NULL)
+    {
+        free(*context);
+        *context = NULL;
+    }
+}
+
+static k4a_depth_engine_result_code_t __stdcall
+virtual_te_create_and_initialize(k4a_transform_engine_context_t **context,
+                                 void *camera_calibration,
+                                 k4a_processing_complete_cb_t *callback,
+                                 void *callback_context)
+{
+    (void)callback;
+    (void)callback_context;
+
+    if (context == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_NULL_ENGINE_POINTER;
+    }
+    if (camera_calibration == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_NULL_CAMERA_CALIBRATION_POINTER;
+    }
+
+    const k4a_transform_engine_calibration_t *calibration = (const k4a_transform_engine_calibration_t *)
+        camera_calibration;
+    if (calibration->depth_camera_calibration.resolution_width <= 0 ||
+        calibration->depth_camera_calibration.resolution_height <= 0 ||
+        calibration->color_camera_calibration.resolution_width <= 0 ||
+        calibration->color_camera_calibration.resolution_height <= 0)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_INITIALIZE_ENGINE_FAILED;
+    }
+
+    k4a_transform_engine_context_t *engine = (k4a_transform_engine_context_t *)calloc(1, sizeof(*engine));
+    if (engine == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_INITIALIZE_ENGINE_FAILED;
+    }
+
+    virtual_engine_read_config(&engine->config);
+    engine->depth_width = (uint32_t)calibration->depth_camera_calibration.resolution_width;
+    engine->depth_height = (uint32_t)calibration->depth_camera_calibration.resolution_height;
+    engine->color_width = (uint32_t)calibration->color_camera_calibration.resolution_width;
+    engine->color_height = (uint32_t)calibration->color_camera_calibration.resolution_height;
+
+    *context = engine;
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+static size_t __stdcall virtual_te_get_output_frame_size(k4a_transform_engine_context_t *context,
+                                                         k4a_transform_engine_type_t type)
+{
+    if (context == NULL)
+    {
+        return 0;
+    }
+
+    size_t color_pixels = (size_t)context->color_width * context->color_height;
+    switch (type)
+    {
+    case K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH:
+        // BGRA32 image in the depth geometry
+        return (size_t)context->depth_width * context->depth_height * 4 * sizeof(uint8_t);
+    case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR:
+        return color_pixels * sizeof(uint16_t);
+    case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR:
+        // Size of the custom output; the depth output is sized as for K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR
+        return color_pixels * sizeof(uint8_t);
+    case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR:
+        return color_pixels * sizeof(uint16_t);
+    default:
+        return 0;
+    }
+}
+
+// Nearest neighbor scaling of an image with 1, 2 or 4 bytes per pixel. Pixels whose depth (when depth is given, at
+// the destination resolution) is zero are set to invalid_value.
+static void virtual_te_scale_image(const uint8_t *src,
+                                   uint32_t src_width,
+                                   uint32_t src_height,
+                                   uint8_t *dst,
+                                   uint32_t dst_width,
+                                   uint32_t dst_height,
+                                   size_t pixel_size,
+                                   const uint16_t *depth,
+                                   uint32_t invalid_value)
+{
+    // Source column in 16.16 fixed point, advanced per destination pixel instead of dividing for every pixel
+    uint64_t x_step = ((uint64_t)src_width << 16) / dst_width;
+
+    for (uint32_t y = 0; y < dst_height; y++)
+    {
+        const uint8_t *src_row = src + (size_t)((uint64_t)y * src_height / dst_height) * src_width * pixel_size;
+        const uint16_t *depth_row = depth != NULL ? depth + (size_t)y * dst_width : NULL;
+        uint8_t *dst_row = dst + (size_t)y * dst_width * pixel_size;
+        uint64_t src_x = 0;
+
+        for (uint32_t x = 0; x < dst_width; x++, src_x += x_step)
+        {
+            const uint8_t *src_pixel = src_row + (size_t)(src_x >> 16) * pixel_size;
+            bool invalid = depth_row != NULL && depth_row[x] == 0;
+            switch (pixel_size)
+            {
+            case sizeof(uint8_t):
+                dst_row[x] = invalid ? (uint8_t)invalid_value : *src_pixel;
+                break;
+            case sizeof(uint16_t):
+                ((uint16_t *)dst_row)[x] = invalid ? (uint16_t)invalid_value : *(const uint16_t *)src_pixel;
+                break;
+            default:
+                // BGRA32 color has no invalid value and is zeroed instead
+                ((uint32_t *)dst_row)[x] = invalid ? 0 : *(const uint32_t *)src_pixel;
+                break;
+            }
+        }
+    }
+}
+
+static k4a_depth_engine_result_code_t __stdcall
+virtual_te_process_frame(k4a_transform_engine_context_t *context,
+                         k4a_transform_engine_type_t type,
+                         k4a_transform_engine_interpolation_t interp,
+                         uint32_t invalid_value,
+                         const void *depth_frame,
+                         size_t depth_frame_size,
+                         const void *frame2,
+                         size_t frame2_size,
+                         void *output_frame,
+                         size_t output_frame_size,
+                         void *output_frame2,
+                         size_t output_frame2_size)
+{
+    // Nearest neighbor is used for all data, which is also what the depth engine does for depth
+    (void)interp;
+
+    if (context == NULL)
+    {
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_NULL_ENGINE_POINTER;
+    }
+    if (depth_frame == NULL || (type != K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR && frame2 == NULL))
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_NULL_INPUT_BUFFER;
+    }
+    if (output_frame == NULL || ((type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR ||
+                                  type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR) &&
+                                 output_frame2 == NULL))
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_NULL_OUTPUT_BUFFER;
+    }
+
+    size_t depth_pixels = (size_t)context->depth_width * context->depth_height;
+    size_t color_pixels = (size_t)context->color_width * context->color_height;
+    if (depth_frame_size < depth_pixels * sizeof(uint16_t))
+    {
+        return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_INPUT_BUFFER_SIZE;
+    }
+
+    k4a_depth_engine_result_code_t result = virtual_engine_next_frame(&context->config, &context->frame_count);
+    if (result != K4A_DEPTH_ENGINE_RESULT_SUCCEEDED)
+    {
+        return result;
+    }
+
+    switch (type)
+    {
+    case K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH:
+        if (frame2_size < color_pixels * 4)
+        {
+            return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_INPUT_BUFFER_SIZE;
+        }
+        if (output_frame_size < virtual_te_get_output_frame_size(context, type))
+        {
+            return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_OUTPUT_BUFFER_SIZE;
+        }
+        virtual_te_scale_image((const uint8_t *)frame2,
+                               context->color_width,
+                               context->color_height,
+                               (uint8_t *)output_frame,
+                               context->depth_width,
+                               context->depth_height,
+                               sizeof(uint32_t),
+                               (const uint16_t *)depth_frame,
+                               0);
+        break;
+
+    case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR:
+    case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR:
+    case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR:
+    {
+        size_t custom_pixel_size = type == K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR ? sizeof(uint8_t) :
+                                                                                               sizeof(uint16_t);
+        if (output_frame_size < virtual_te_get_output_frame_size(context, K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR))
+        {
+            return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_OUTPUT_BUFFER_SIZE;
+        }
+        if (type != K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR)
+        {
+            if (frame2_size < depth_pixels * custom_pixel_size)
+            {
+                return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_INPUT_BUFFER_SIZE;
+            }
+            if (output_frame2_size < virtual_te_get_output_frame_size(context, type))
+            {
+                return K4A_DEPTH_ENGINE_RESULT_DATA_ERROR_INVALID_OUTPUT_BUFFER_SIZE;
+            }
+        }
+
+        virtual_te_scale_image((const uint8_t *)depth_frame,
+                               context->depth_width,
+                               context->depth_height,
+                               (uint8_t *)output_frame,
+                               context->color_width,
+                               context->color_height,
+                               sizeof(uint16_t),
+                               NULL,
+                               0);
+        if (type != K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR)
+        {
+            virtual_te_scale_image((const uint8_t *)frame2,
+                                   context->depth_width,
+                                   context->depth_height,
+                                   (uint8_t *)output_frame2,
+                                   context->color_width,
+                                   context->color_height,
+                                   custom_pixel_size,
+                                   (const uint16_t *)output_frame,
+                                   invalid_value);
+        }
+        break;
+    }
+
+    default:
+        return K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_INVALID_PARAMETER;
+    }
+
+    return K4A_DEPTH_ENGINE_RESULT_SUCCEEDED;
+}
+
+static void __stdcall virtual_te_destroy(k4a_transform_engine_context_t **context)
+{
+    if (context != NULL && *context != NULL)
+    {
+        free(*context);
+        *context = NULL;
+    }
+}
+
+VIRTUAL_DEPTHENGINE_EXPORT bool __cdecl k4a_register_plugin(k4a_plugin_t *plugin)
+{
+    if (plugin == NULL)
+    {
+        return false;
+    }
+
+    plugin->version.major = K4A_PLUGIN_VERSION;
+    plugin->version.minor = 0;
+    plugin->version.patch = 0;
+    plugin->depth_engine_create_and_initialize = virtual_de_create_and_initialize;
+    plugin->depth_engine_process_frame = virtual_de_process_frame;
+    plugin->depth_engine_get_output_frame_size = virtual_de_get_output_frame_size;
+    plugin->depth_engine_destroy = virtual_de_destroy;
+
+    // The transform engine is not geometrically correct, so it is only registered for the wrapper tests. Otherwise
+    // transformations created while the virtual depth engine is loaded run on the CPU.
+    if (virtual_engine_get_env_uint64(VIRTUAL_DEPTH_ENGINE_ENV_TRANSFORM, 0) != 0)
+    {
+        plugin->transform_engine_create_and_initialize = virtual_te_create_and_initialize;
+        plugin->transform_engine_process_frame = virtual_te_process_frame;
+        plugin->transform_engine_get_output_frame_size = virtual_te_get_output_frame_size;
+        plugin->transform_engine_destroy = virtual_te_destroy;
+    }
+    else
+    {
+        plugin->transform_engine_create_and_initialize = NULL;
+        plugin->transform_engine_process_frame = NULL;
+        plugin->transform_engine_get_output_frame_size = NULL;
+        plugin->transform_engine_destroy = NULL;
+    }
+    return true;
+}
@@ -0,0 +1,774 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64 // fseeko() on replay files larger than 2GB
+#define _GNU_SOURCE
+#endif
+
+//************************ Includes *****************************
+// This library
+#include <k4ainternal/virtual_device.h>
+
+// Dependent libraries
+#include <k4ainternal/color_mcu.h>
+#include <k4ainternal/depth_mcu.h>
+#include <k4ainternal/image.h>
+#include <k4ainternal/logging.h>
+#include <azure_c_shared_utility/envvariable.h>
+#include <azure_c_shared_utility/threadapi.h>
+#include <azure_c_shared_utility/tickcounter.h>
+
+// Private command definitions of the firmware being emulated. colorcommands.h redefines DEV_CMD_RESET, so it must be
+// included after depthcommands.h.
+#include "../depth_mcu/depthcommands.h"
+#include "../color_mcu/colorcommands.h"
+
+// System dependencies
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define virtual_device_fseek _fseeki64
+#else
+#define virtual_device_fseek fseeko
+#endif
+
+//**************Symbolic Constant Macros (defines)  *************
+// Device timestamp of the first record in the replay file. Non zero because zero timestamps are dropped at startup.
+#define VIRTUAL_DEVICE_START_TIMESTAMP_USEC 100000
+
+// Longest sleep of the replay thread, bounds how long virtual_device_stream_stop() waits
+#define VIRTUAL_DEVICE_MAX_SLEEP_MS 10
+
+// Container ID of virtual device N is this prefix followed by N, so it can never match a physical device
+static const uint8_t g_virtual_container_id_prefix[15] = { 'K', '4', 'A', '_', 'V', 'I', 'R', 'T',
+                                                           'U', 'A', 'L', '_', 'D', 'E', 'V' };
+
+//************************ Typedefs *****************************
+typedef struct _virtual_device_context_t
+{
+    uint32_t device_index;
+    virtual_device_stream_t stream;
+
+    FILE *file;
+    virtual_device_file_header_t header;
+    uint8_t *calibration; // Raw calibration JSON, header.calibration_size bytes
+    int64_t data_offset;  // Offset of the first record
+    uint64_t first_timestamp_usec;
+    uint64_t frame_period_usec;
+
+    double rate;
+    bool loop;
+
+    TICK_COUNTER_HANDLE tick;
+    THREAD_HANDLE thread;
+    volatile bool stream_going;
+    allocation_source_t source;
+    size_t payload_size;
+    virtual_device_stream_cb_t *callback;
+    void *callback_context;
+} virtual_device_context_t;
+
+K4A_DECLARE_CONTEXT(virtual_device_t, virtual_device_context_t);
+
+//*********************** Functions *****************************
+
+// Copies the path of virtual device device_index out of the ';' separated VIRTUAL_DEVICE_ENV_FILES list. Returns the
+// number of files in the list.
+static uint32_t virtual_device_get_path(uint32_t device_index, char *path, size_t path_size)
+{
+    const char *files = environment_get_variable(VIRTUAL_DEVICE_ENV_FILES);
+    uint32_t count = 0;
+
+    if (files == NULL)
+    {
+        return 0;
+    }
+
+    while (*files != '\0' && count < VIRTUAL_DEVICE_MAX_COUNT)
+    {
+        const char *end = strchr(files, ';');
+        size_t length = end ? (size_t)(end - files) : strlen(files);
+
+        if (length > 0)
+        {
+            if (count == device_index && path != NULL && path_size > 0)
+            {
+                size_t copy = length < path_size - 1 ? length : path_size - 1;
+                memcpy(path, files, copy);
+                path[copy] = '\0';
+            }
+            count++;
+        }
+
+        files += length;
+        if (*files == ';')
+        {
+            files++;
+        }
+    }
+
+    return count;
+}
+
+uint32_t virtual_device_get_count(void)
+{
+    return virtual_device_get_path(0, NULL, 0);
+}
+
+void virtual_device_get_container_id(uint32_t device_index, guid_t *container_id)
+{
+    RETURN_VALUE_IF_ARG(VOID_VALUE, container_id == NULL);
+    RETURN_VALUE_IF_ARG(VOID_VALUE, device_index >= VIRTUAL_DEVICE_MAX_COUNT);
+
+    memcpy(container_id->id, g_virtual_container_id_prefix, sizeof(g_virtual_container_id_prefix));
+    container_id->id[sizeof(g_virtual_container_id_prefix)] = (uint8_t)device_index;
+}
+
+bool virtual_device_find_container_id(const guid_t *container_id, uint32_t *device_index)
+{
+    if (container_id == NULL ||
+        memcmp(container_id->id, g_virtual_container_id_prefix, sizeof(g_virtual_container_id_prefix)) != 0)
+    {
+        return false;
+    }
+
+    uint32_t index = container_id->id[sizeof(g_virtual_container_id_prefix)];
+    if (index >= virtual_device_get_count())
+    {
+        return false;
+    }
+
+    if (device_index != NULL)
+    {
+        *device_index = index;
+    }
+    return true;
+}
+
+size_t virtual_device_get_raw_depth_size(k4a_depth_mode_t depth_mode)
+{
+    switch (depth_mode)
+    {
+    case K4A_DEPTH_MODE_NFOV_2X2BINNED:
+    case K4A_DEPTH_MODE_NFOV_UNBINNED:
+        return SENSOR_MODE_LONG_THROW_NATIVE_SIZE;
+    case K4A_DEPTH_MODE_WFOV_2X2BINNED:
+        return SENSOR_MODE_QUARTER_MEGA_PIXEL_SIZE;
+    case K4A_DEPTH_MODE_WFOV_UNBINNED:
+        return SENSOR_MODE_MEGA_PIXEL_SIZE;
+    case K4A_DEPTH_MODE_PASSIVE_IR:
+        return SENSOR_MODE_PSEUDO_COMMON_SIZE;
+    default:
+        return 0;
+    }
+}
+
+static uint64_t virtual_device_get_frame_period_usec(k4a_fps_t camera_fps)
+{
+    switch (camera_fps)
+    {
+    case K4A_FRAMES_PER_SECOND_5:
+        return HZ_TO_PERIOD_US(5);
+    case K4A_FRAMES_PER_SECOND_15:
+        return HZ_TO_PERIOD_US(15);
+    default:
+        return HZ_TO_PERIOD_US(30);
+    }
+}
+
+static k4a_result_t virtual_device_read_header(virtual_device_context_t *vd)
+{
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(fread(&vd->header, 1, sizeof(vd->header), vd->file) ==
+                                               sizeof(vd->header));
+
+    if (K4A_SUCCEEDED(result) && (memcmp(vd->header.magic, VIRTUAL_DEVICE_FILE_MAGIC, sizeof(vd->header.magic)) != 0 ||
+                                  vd->header.version != VIRTUAL_DEVICE_FILE_VERSION ||
+                                  vd->header.header_size < sizeof(vd->header)))
+    {
+        LOG_ERROR("Virtual device %u is not a version %u replay file", vd->device_index, VIRTUAL_DEVICE_FILE_VERSION);
+        result = K4A_RESULT_FAILED;
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        // Newer writers may append fields to the header
+        vd->header.serial_number[sizeof(vd->header.serial_number) - 1] = '\0';
+        result = K4A_RESULT_FROM_BOOL(virtual_device_fseek(vd->file, vd->header.header_size, SEEK_SET) == 0);
+    }
+
+    if (K4A_SUCCEEDED(result) && vd->header.calibration_size > 0)
+    {
+        vd->calibration = (uint8_t *)malloc(vd->header.calibration_size);
+        result = K4A_RESULT_FROM_BOOL(vd->calibration != NULL);
+        if (K4A_SUCCEEDED(result))
+        {
+            result = K4A_RESULT_FROM_BOOL(fread(vd->calibration, 1, vd->header.calibration_size, vd->file) ==
+                                          vd->header.calibration_size);
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        virtual_device_record_header_t record;
+
+        vd->data_offset = (int64_t)vd->header.header_size + (int64_t)vd->header.calibration_size;
+        vd->frame_period_usec = virtual_device_get_frame_period_usec((k4a_fps_t)vd->header.camera_fps);
+
+        // Records are sorted by timestamp, so the first one defines the start of the device clock
+        if (fread(&record, 1, sizeof(record), vd->file) == sizeof(record))
+        {
+            vd->first_timestamp_usec = record.device_timestamp_usec;
+        }
+    }
+
+    return result;
+}
+
+k4a_result_t virtual_device_create(uint32_t device_index,
+                                   virtual_device_stream_t stream,
+                                   virtual_device_t *virtual_device_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, stream >= VIRTUAL_DEVICE_STREAM_COUNT);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, virtual_device_handle == NULL);
+
+    char path[1024];
+    uint32_t device_count = virtual_device_get_path(device_index, path, sizeof(path));
+    if (device_index >= device_count)
+    {
+        LOG_ERROR("Virtual device %u does not exist, %s lists %u devices",
+                  device_index,
+                  VIRTUAL_DEVICE_ENV_FILES,
+                  device_count);
+        return K4A_RESULT_FAILED;
+    }
+
+    virtual_device_context_t *vd = virtual_device_t_create(virtual_device_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(vd != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        vd->device_index = device_index;
+        vd->stream = stream;
+        vd->rate = 1.0;
+        vd->loop = true;
+
+        const char *rate = environment_get_variable(VIRTUAL_DEVICE_ENV_RATE);
+        if (rate != NULL && rate[0] != '\0')
+        {
+            vd->rate = strtod(rate, NULL);
+            if (vd->rate < 0)
+            {
+                LOG_WARNING("Ignoring negative %s, replaying in real time", VIRTUAL_DEVICE_ENV_RATE);
+                vd->rate = 1.0;
+            }
+        }
+
+        const char *loop = environment_get_variable(VIRTUAL_DEVICE_ENV_LOOP);
+        if (loop != NULL && loop[0] == '0')
+        {
+            vd->loop = false;
+        }
+
+        result = K4A_RESULT_FROM_BOOL((vd->tick = tickcounter_create()) != NULL);
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        vd->file = fopen(path, "rb");
+        if (vd->file == NULL)
+        {
+            LOG_ERROR("Failed to open virtual device replay file %s", path);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(virtual_device_read_header(vd));
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        LOG_INFO("Virtual device %u (%s) replaying %s", device_index, vd->header.serial_number, path);
+    }
+
+    if (K4A_FAILED(result))
+    {
+        virtual_device_destroy(*virtual_device_handle);
+        *virtual_device_handle = NULL;
+    }
+
+    return result;
+}
+
+void virtual_device_destroy(virtual_device_t virtual_device_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, virtual_device_t, virtual_device_handle);
+    virtual_device_context_t *vd = virtual_device_t_get_context(virtual_device_handle);
+
+    virtual_device_stream_stop(virtual_device_handle);
+
+    if (vd->file)
+    {
+        fclose(vd->file);
+    }
+
+    if (vd->calibration)
+    {
+        free(vd->calibration);
+    }
+
+    if (vd->tick)
+    {
+        tickcounter_destroy(vd->tick);
+    }
+
+    virtual_device_t_destroy(virtual_device_handle);
+}
+
+const virtual_device_file_header_t *virtual_device_get_file_header(virtual_device_t virtual_device_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(NULL, virtual_device_t, virtual_device_handle);
+    virtual_device_context_t *vd = virtual_device_t_get_context(virtual_device_handle);
+
+    return &vd->header;
+}
+
+// Copies a read response into the caller's buffer, truncating it like a bulk transfer into a short buffer would
+static size_t virtual_device_respond(void *p_rx_data, size_t rx_data_size, const void *response, size_t response_size)
+{
+    size_t size = response_size < rx_data_size ? response_size : rx_data_size;
+    if (size > 0)
+    {
+        memcpy(p_rx_data, response, size);
+    }
+    return size;
+}
+
+k4a_result_t virtual_device_command(virtual_device_t virtual_device_handle,
+                                    uint32_t cmd,
+                                    const void *p_cmd_data,
+                                    size_t cmd_data_size,
+                                    void *p_rx_data,
+                                    size_t rx_data_size,
+                                    size_t *transfer_count,
+                                    uint32_t *cmd_status)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, virtual_device_t, virtual_device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, cmd_status == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, p_rx_data == NULL && rx_data_size != 0);
+    virtual_device_context_t *vd = virtual_device_t_get_context(virtual_device_handle);
+    size_t transferred = 0;
+
+    *cmd_status = DEV_CMD_STATUS_SUCCESS;
+
+    if (p_rx_data != NULL)
+    {
+        switch (cmd)
+        {
+        case DEV_CMD_DEPTH_READ_PRODUCT_SN:
+            transferred = virtual_device_respond(p_rx_data,
+                                                 rx_data_size,
+                                                 vd->header.serial_number,
+                                                 strlen(vd->header.serial_number));
+            break;
+
+        case DEV_CMD_COMPONENT_VERSION_GET:
+        {
+            // Report the firmware the SDK suggests, so no compatibility warnings are logged
+            depthmcu_firmware_versions_t version = { 0 };
+            version.rgb_major = 1;
+            version.rgb_minor = 6;
+            version.rgb_build = 110;
+            version.depth_major = 1;
+            version.depth_minor = 6;
+            version.depth_build = 79;
+            version.audio_major = 1;
+            version.audio_minor = 6;
+            version.audio_build = 14;
+            version.depth_sensor_cfg_major = 6109;
+            version.depth_sensor_cfg_minor = 7;
+            transferred = virtual_device_respond(p_rx_data, rx_data_size, &version, sizeof(version));
+            break;
+        }
+
+        case DEV_CMD_NV_DATA_GET:
+        {
+            // The IR sensor calibration block is only consumed by the depth engine. The virtual depth engine does not
+            // need one, so report a minimal block identifying the payload format.
+            uint32_t block = VIRTUAL_DEVICE_RAW_DEPTH_MAGIC;
+            transferred = virtual_device_respond(p_rx_data, rx_data_size, &block, sizeof(block));
+            break;
+        }
+
+        case DEV_CMD_DEPTH_READ_CALIBRATION_DATA:
+            transferred = virtual_device_respond(p_rx_data,
+                                                 rx_data_size,
+                                                 vd->calibration,
+                                                 vd->header.calibration_size);
+            break;
+
+        case DEV_CMD_GET_JACK_STATE:
+        {
+            // No sync cables connected
+            uint8_t state = 0;
+            transferred = virtual_device_respond(p_rx_data, rx_data_size, &state, sizeof(state));
+            break;
+        }
+
+        default:
+            *cmd_status = DEV_CMD_STATUS_NOT_IMPLEMENTED;
+            break;
+        }
+    }
+    else
+    {
+        switch (cmd)
+        {
+        case DEV_CMD_DOWNLOAD_FIRMWARE:
+            LOG_ERROR("Firmware can not be updated on a virtual device", 0);
+            *cmd_status = DEV_CMD_STATUS_NOT_IMPLEMENTED;
+            break;
+
+        default:
+            // Mode, frame rate, sync configuration, start, stop and reset all just succeed. The replay file dictates
+            // what is streamed, mismatches are reported by virtual_device_stream_start().
+            (void)p_cmd_data;
+            (void)cmd_data_size;
+            break;
+        }
+    }
+
+    if (transfer_count != NULL)
+    {
+        *transfer_count = transferred;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+// Maps a timestamp in the replay file to the virtual device clock
+static uint64_t virtual_device_rebase_usec(const virtual_device_context_t *vd,
+                                           uint64_t timestamp_usec,
+                                           uint64_t loop_offset_usec)
+{
+    uint64_t elapsed = timestamp_usec > vd->first_timestamp_usec ? timestamp_usec - vd->first_timestamp_usec : 0;
+    return VIRTUAL_DEVICE_START_TIMESTAMP_USEC + loop_offset_usec + elapsed;
+}
+
+// Sleeps until a payload with a rebased timestamp of replay_usec is due. Returns false if the stream was stopped.
+static bool virtual_device_wait_until_due(virtual_device_context_t *vd, tickcounter_ms_t start_ms, uint64_t replay_usec)
+{
+    if (vd->rate <= 0)
+    {
+        return vd->stream_going;
+    }
+
+    double elapsed_usec = (double)(replay_usec - VIRTUAL_DEVICE_START_TIMESTAMP_USEC) / vd->rate;
+    tickcounter_ms_t due_ms = start_ms + (tickcounter_ms_t)(elapsed_usec / 1000);
+
+    while (vd->stream_going)
+    {
+        tickcounter_ms_t now_ms = 0;
+        if (tickcounter_get_current_ms(vd->tick, &now_ms) != 0 || now_ms >= due_ms)
+        {
+            break;
+        }
+
+        tickcounter_ms_t sleep_ms = due_ms - now_ms;
+        if (sleep_ms > VIRTUAL_DEVICE_MAX_SLEEP_MS)
+        {
+            sleep_ms = VIRTUAL_DEVICE_MAX_SLEEP_MS;
+        }
+        ThreadAPI_Sleep((unsigned int)sleep_ms);
+    }
+
+    return vd->stream_going;
+}
+
+static void virtual_device_free_color_buffer(void *buffer, void *context)
+{
+    (void)context;
+    allocator_free(buffer);
+}
+
+// Reads the payload of the current record into an image, moving its timestamps onto the virtual device clock
+static k4a_result_t virtual_device_read_payload(virtual_device_context_t *vd,
+                                                const virtual_device_record_header_t *record,
+                                                uint64_t loop_offset_usec,
+                                                k4a_image_t *image)
+{
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    uint64_t replay_usec = virtual_device_rebase_usec(vd, record->device_timestamp_usec, loop_offset_usec);
+    uint8_t *buffer = NULL;
+
+    *image = NULL;
+
+    if (vd->stream == VIRTUAL_DEVICE_STREAM_COLOR)
+    {
+        virtual_device_color_header_t color;
+        size_t data_size = 0;
+
+        result = K4A_RESULT_FROM_BOOL(record->payload_size >= sizeof(color) &&
+                                      fread(&color, 1, sizeof(color), vd->file) == sizeof(color));
+
+        if (K4A_SUCCEEDED(result))
+        {
+            data_size = record->payload_size - sizeof(color);
+            buffer = allocator_alloc(vd->source, data_size);
+            result = K4A_RESULT_FROM_BOOL(buffer != NULL);
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            result = K4A_RESULT_FROM_BOOL(fread(buffer, 1, data_size, vd->file) == data_size);
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            result = TRACE_CALL(image_create_from_buffer((k4a_image_format_t)color.format,
+                                                         (int)color.width,
+                                                         (int)color.height,
+                                                         (int)color.stride,
+                                                         buffer,
+                                                         data_size,
+                                                         virtual_device_free_color_buffer,
+                                                         NULL,
+                                                         image));
+        }
+
+        if (K4A_SUCCEEDED(result))
+        {
+            image_set_device_timestamp_usec(*image, replay_usec);
+        }
+        else if (buffer)
+        {
+            allocator_free(buffer);
+        }
+    }
+    else
+    {
+        result = TRACE_CALL(image_create_empty_internal(vd->source, record->payload_size, image));
+
+        if (K4A_SUCCEEDED(result))
+        {
+            buffer = image_get_buffer(*image);
+            result = K4A_RESULT_FROM_BOOL(fread(buffer, 1, record->payload_size, vd->file) == record->payload_size);
+        }
+
+        if (K4A_SUCCEEDED(result) && vd->stream == VIRTUAL_DEVICE_STREAM_DEPTH &&
+            record->payload_size >= sizeof(virtual_device_raw_depth_header_t))
+        {
+            virtual_device_raw_depth_header_t *raw = (virtual_device_raw_depth_header_t *)buffer;
+            raw->center_of_exposure_in_ticks = K4A_USEC_TO_90K_HZ_TICK(replay_usec);
+        }
+
+        if (K4A_SUCCEEDED(result) && vd->stream == VIRTUAL_DEVICE_STREAM_IMU)
+        {
+            imu_payload_metadata_t *metadata = (imu_payload_metadata_t *)buffer;
+            size_t sample_count = 0;
+
+            if (record->payload_size >= sizeof(imu_payload_metadata_t))
+            {
+                sample_count = (size_t)metadata->gyro.sample_count + (size_t)metadata->accel.sample_count;
+            }
+
+            result = K4A_RESULT_FROM_BOOL(record->payload_size >=
+                                          sizeof(imu_payload_metadata_t) + sample_count * sizeof(xyz_vector_t));
+
+            xyz_vector_t *samples = (xyz_vector_t *)(buffer + sizeof(imu_payload_metadata_t));
+            for (size_t i = 0; K4A_SUCCEEDED(result) && i < sample_count; i++)
+            {
+                uint64_t sample_usec = virtual_device_rebase_usec(vd,
+                                                                  K4A_90K_HZ_TICK_TO_USEC(samples[i].pts),
+                                                                  loop_offset_usec);
+                samples[i].pts = K4A_USEC_TO_90K_HZ_TICK(sample_usec);
+            }
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(image_apply_system_timestamp(*image));
+    }
+
+    if (K4A_FAILED(result))
+    {
+        LOG_ERROR("Virtual device %u failed to read a record of %u bytes", vd->device_index, record->payload_size);
+        if (*image)
+        {
+            image_dec_ref(*image);
+            *image = NULL;
+        }
+    }
+
+    return result;
+}
+
+static int virtual_device_stream_thread(void *param)
+{
+    virtual_device_context_t *vd = (virtual_device_context_t *)param;
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+    uint64_t loop_offset_usec = 0;
+    uint64_t last_timestamp_usec = vd->first_timestamp_usec;
+    uint32_t delivered_this_pass = 0;
+    tickcounter_ms_t start_ms = 0;
+
+    result = K4A_RESULT_FROM_BOOL(tickcounter_get_current_ms(vd->tick, &start_ms) == 0);
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(virtual_device_fseek(vd->file, vd->data_offset, SEEK_SET) == 0);
+    }
+
+    while (K4A_SUCCEEDED(result) && vd->stream_going)
+    {
+        virtual_device_record_header_t record;
+
+        if (fread(&record, 1, sizeof(record), vd->file) != sizeof(record))
+        {
+            if (delivered_this_pass == 0)
+            {
+                LOG_WARNING("Virtual device %u has no records for stream %d", vd->device_index, vd->stream);
+                break;
+            }
+
+            if (!vd->loop)
+            {
+                LOG_INFO("Virtual device %u reached the end of the replay file", vd->device_index);
+                break;
+            }
+
+            // Continue the device clock one frame after the last record of the previous pass
+            loop_offset_usec += last_timestamp_usec - vd->first_timestamp_usec + vd->frame_period_usec;
+            delivered_this_pass = 0;
+            result = K4A_RESULT_FROM_BOOL(virtual_device_fseek(vd->file, vd->data_offset, SEEK_SET) == 0);
+            continue;
+        }
+
+        if (record.device_timestamp_usec > last_timestamp_usec)
+        {
+            last_timestamp_usec = record.device_timestamp_usec;
+        }
+
+        if (record.stream != (uint32_t)vd->stream)
+        {
+            result = K4A_RESULT_FROM_BOOL(virtual_device_fseek(vd->file, record.payload_size, SEEK_CUR) == 0);
+            continue;
+        }
+
+        if (vd->payload_size != 0 && record.payload_size > vd->payload_size)
+        {
+            LOG_WARNING("Virtual device %u skipping a %u byte record larger than the %zu byte stream payload",
+                        vd->device_index,
+                        record.payload_size,
+                        vd->payload_size);
+            result = K4A_RESULT_FROM_BOOL(virtual_device_fseek(vd->file, record.payload_size, SEEK_CUR) == 0);
+            continue;
+        }
+
+        uint64_t replay_usec = virtual_device_rebase_usec(vd, record.device_timestamp_usec, loop_offset_usec);
+        if (!virtual_device_wait_until_due(vd, start_ms, replay_usec))
+        {
+            break;
+        }
+
+        k4a_image_t image = NULL;
+        result = TRACE_CALL(virtual_device_read_payload(vd, &record, loop_offset_usec, &image));
+
+        if (K4A_SUCCEEDED(result))
+        {
+            delivered_this_pass++;
+            if (vd->stream_going && vd->callback != NULL)
+            {
+                // Like the USB stream, the image is only guaranteed to be valid during the callback
+                vd->callback(K4A_RESULT_SUCCEEDED, image, vd->callback_context);
+            }
+            image_dec_ref(image);
+        }
+    }
+
+    if (K4A_FAILED(result))
+    {
+        LOG_ERROR("Virtual device %u stopped streaming stream %d", vd->device_index, vd->stream);
+
+        // Like a failed USB transfer, so the consumers stop waiting for payloads that will not come
+        if (vd->stream_going && vd->callback != NULL)
+        {
+            vd->callback(K4A_RESULT_FAILED, NULL, vd->callback_context);
+        }
+    }
+
+    // The replay ended on its own at the end of the file or on an error, so the stream can be started again. The
+    // thread handle is joined by the next start or stop.
+    vd->stream_going = false;
+
+    ThreadAPI_Exit((int)result);
+    return 0;
+}
+
+k4a_result_t virtual_device_stream_start(virtual_device_t virtual_device_handle,
+                                         allocation_source_t source,
+                                         size_t payload_size,
+                                         virtual_device_stream_cb_t *callback,
+                                         void *callback_context)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, virtual_device_t, virtual_device_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, callback == NULL);
+    virtual_device_context_t *vd = virtual_device_t_get_context(virtual_device_handle);
+
+    if (vd->stream_going)
+    {
+        LOG_INFO("Stream already in progress", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    if (vd->stream == VIRTUAL_DEVICE_STREAM_DEPTH &&
+        ROUND_UP(virtual_device_get_raw_depth_size((k4a_depth_mode_t)vd->header.depth_mode), 1024) != payload_size)
+    {
+        // depthmcu would drop every payload of the wrong size
+        LOG_ERROR("Virtual device %u was captured in depth mode %u, which does not match the requested mode",
+                  vd->device_index,
+                  vd->header.depth_mode);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Join the thread of a replay that already ended
+    if (vd->thread != NULL)
+    {
+        ThreadAPI_Join(vd->thread, NULL);
+        vd->thread = NULL;
+    }
+
+    vd->source = source;
+    vd->payload_size = payload_size;
+    vd->callback = callback;
+    vd->callback_context = callback_context;
+    vd->stream_going = true;
+
+    if (ThreadAPI_Create(&vd->thread, virtual_device_stream_thread, vd) != THREADAPI_OK)
+    {
+        vd->stream_going = false;
+        vd->thread = NULL;
+        LOG_ERROR("Could not start virtual device stream thread", 0);
+        return K4A_RESULT_FAILED;
+    }
+
+    return K4A_RESULT_SUCCEEDED;
+}
+
+void virtual_device_stream_stop(virtual_device_t virtual_device_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(VOID_VALUE, virtual_device_t, virtual_device_handle);
+    virtual_device_context_t *vd = virtual_device_t_get_context(virtual_device_handle);
+
+    vd->stream_going = false;
+
+    if (vd->thread != NULL)
+    {
+        ThreadAPI_Join(vd->thread, NULL);
+        vd->thread = NULL;
+    }
+}
@@ -0,0 +1,405 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+//************************ Includes *****************************
+// This library
+#include <k4ainternal/virtual_device.h>
+
+// Dependent libraries
+#include <k4ainternal/color_mcu.h>
+#include <k4ainternal/logging.h>
+
+// System dependencies
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//**************Symbolic Constant Macros (defines)  *************
+#define VIRTUAL_DEVICE_PI 3.14159265358979323846f
+
+// Sensitivities written into the IMU payloads, in the units the color mcu reports them. They match the ±2000dps and
+// ±16g ranges of the physical IMU, so replayed samples have the resolution of the original ones.
+#define VIRTUAL_DEVICE_GYRO_SENSITIVITY 61035 // micro degrees per second per LSB
+#define VIRTUAL_DEVICE_ACCEL_SENSITIVITY 488  // micro g per LSB
+#define VIRTUAL_DEVICE_IMU_SAMPLE_RATE_US 625 // 1.6kHz
+#define VIRTUAL_DEVICE_IMU_TEMPERATURE_REPORTING_RATE_US 19230
+
+// Samples per IMU payload. The physical device sends 8 samples of each sensor per payload at 1.6kHz.
+#define VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD 8
+
+//************************ Typedefs *****************************
+typedef struct _virtual_device_writer_context_t
+{
+    FILE *file;
+    virtual_device_file_header_t header;
+    size_t raw_depth_size;
+    uint8_t *depth_payload;
+} virtual_device_writer_context_t;
+
+K4A_DECLARE_CONTEXT(virtual_device_writer_t, virtual_device_writer_context_t);
+
+//*********************** Functions *****************************
+
+static k4a_result_t virtual_device_writer_write_record(virtual_device_writer_context_t *writer,
+                                                       virtual_device_stream_t stream,
+                                                       uint64_t device_timestamp_usec,
+                                                       const void *prefix,
+                                                       size_t prefix_size,
+                                                       const void *payload,
+                                                       size_t payload_size)
+{
+    virtual_device_record_header_t record;
+    record.stream = (uint32_t)stream;
+    record.payload_size = (uint32_t)(prefix_size + payload_size);
+    record.device_timestamp_usec = device_timestamp_usec;
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(fwrite(&record, 1, sizeof(record), writer->file) == sizeof(record));
+    if (K4A_SUCCEEDED(result) && prefix_size > 0)
+    {
+        result = K4A_RESULT_FROM_BOOL(fwrite(prefix, 1, prefix_size, writer->file) == prefix_size);
+    }
+    if (K4A_SUCCEEDED(result) && payload_size > 0)
+    {
+        result = K4A_RESULT_FROM_BOOL(fwrite(payload, 1, payload_size, writer->file) == payload_size);
+    }
+
+    if (K4A_FAILED(result))
+    {
+        LOG_ERROR("Failed to write a %u byte virtual device record", record.payload_size);
+    }
+    return result;
+}
+
+k4a_result_t virtual_device_writer_create(const char *path,
+                                          const k4a_device_configuration_t *config,
+                                          const char *serial_number,
+                                          const uint8_t *calibration,
+                                          size_t calibration_size,
+                                          virtual_device_writer_t *writer_handle)
+{
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, path == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, config == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, serial_number == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, calibration == NULL && calibration_size > 0);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, writer_handle == NULL);
+
+    virtual_device_writer_context_t *writer = virtual_device_writer_t_create(writer_handle);
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(writer != NULL);
+
+    if (K4A_SUCCEEDED(result))
+    {
+        memcpy(writer->header.magic, VIRTUAL_DEVICE_FILE_MAGIC, sizeof(VIRTUAL_DEVICE_FILE_MAGIC));
+        writer->header.version = VIRTUAL_DEVICE_FILE_VERSION;
+        writer->header.header_size = sizeof(writer->header);
+        writer->header.depth_mode = (uint32_t)config->depth_mode;
+        writer->header.color_format = (uint32_t)config->color_format;
+        writer->header.color_resolution = (uint32_t)config->color_resolution;
+        writer->header.camera_fps = (uint32_t)config->camera_fps;
+        strncpy(writer->header.serial_number, serial_number, sizeof(writer->header.serial_number) - 1);
+        writer->header.calibration_size = (uint32_t)calibration_size;
+
+        writer->raw_depth_size = virtual_device_get_raw_depth_size(config->depth_mode);
+        if (writer->raw_depth_size > 0)
+        {
+            writer->depth_payload = (uint8_t *)calloc(1, writer->raw_depth_size);
+            result = K4A_RESULT_FROM_BOOL(writer->depth_payload != NULL);
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        writer->file = fopen(path, "wb");
+        if (writer->file == NULL)
+        {
+            LOG_ERROR("Failed to create virtual device replay file %s", path);
+            result = K4A_RESULT_FAILED;
+        }
+    }
+
+    if (K4A_SUCCEEDED(result))
+    {
+        result = K4A_RESULT_FROM_BOOL(fwrite(&writer->header, 1, sizeof(writer->header), writer->file) ==
+                                      sizeof(writer->header));
+    }
+
+    if (K4A_SUCCEEDED(result) && calibration_size > 0)
+    {
+        result = K4A_RESULT_FROM_BOOL(fwrite(calibration, 1, calibration_size, writer->file) == calibration_size);
+    }
+
+    if (K4A_FAILED(result) && writer != NULL)
+    {
+        if (writer->file)
+        {
+            fclose(writer->file);
+        }
+        free(writer->depth_payload);
+        virtual_device_writer_t_destroy(*writer_handle);
+        *writer_handle = NULL;
+    }
+
+    return result;
+}
+
+k4a_result_t virtual_device_writer_write_depth(virtual_device_writer_t writer_handle,
+                                               uint64_t device_timestamp_usec,
+                                               const uint16_t *depth,
+                                               const uint16_t *ir,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               float sensor_temp)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, virtual_device_writer_t, writer_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, ir == NULL);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, width == 0 || height == 0 || width > UINT16_MAX || height > UINT16_MAX);
+    virtual_device_writer_context_t *writer = virtual_device_writer_t_get_context(writer_handle);
+
+    // Reject frames the virtual depth engine would fail on replay. It accepts images of the mode's size, or twice that
+    // size which it bins down, and expects a depth image in every mode except passive IR.
+    k4a_depth_mode_t depth_mode = (k4a_depth_mode_t)writer->header.depth_mode;
+    uint32_t mode_width = 0;
+    uint32_t mode_height = 0;
+    if (!k4a_convert_depth_mode_to_width_height(depth_mode, &mode_width, &mode_height))
+    {
+        LOG_ERROR("Depth frames can't be written to a replay file created with depth mode %u", depth_mode);
+        return K4A_RESULT_FAILED;
+    }
+    if (!((width == mode_width && height == mode_height) || (width == 2 * mode_width && height == 2 * mode_height)))
+    {
+        LOG_ERROR("A %ux%u depth frame does not match depth mode %u (%ux%u)",
+                  width,
+                  height,
+                  depth_mode,
+                  mode_width,
+                  mode_height);
+        return K4A_RESULT_FAILED;
+    }
+    if ((depth == NULL) != (depth_mode == K4A_DEPTH_MODE_PASSIVE_IR))
+    {
+        LOG_ERROR("Depth mode %u %s a depth image",
+                  depth_mode,
+                  depth_mode == K4A_DEPTH_MODE_PASSIVE_IR ? "does not have" : "requires");
+        return K4A_RESULT_FAILED;
+    }
+
+    size_t image_size = (size_t)width * height * sizeof(uint16_t);
+    size_t payload_size = sizeof(virtual_device_raw_depth_header_t) + (depth ? 2 : 1) * image_size;
+    if (payload_size > writer->raw_depth_size)
+    {
+        LOG_ERROR("A %ux%u depth frame does not fit the %zu byte raw payload of depth mode %u",
+                  width,
+                  height,
+                  writer->raw_depth_size,
+                  writer->header.depth_mode);
+        return K4A_RESULT_FAILED;
+    }
+
+    // The record is padded to the full raw payload size, which is what the depth mcu expects to receive
+    virtual_device_raw_depth_header_t *raw = (virtual_device_raw_depth_header_t *)writer->depth_payload;
+    raw->magic = VIRTUAL_DEVICE_RAW_DEPTH_MAGIC;
+    raw->width = (uint16_t)width;
+    raw->height = (uint16_t)height;
+    raw->flags = depth ? VIRTUAL_DEVICE_RAW_DEPTH_FLAG_DEPTH : 0;
+    raw->sensor_temp = sensor_temp;
+    raw->center_of_exposure_in_ticks = K4A_USEC_TO_90K_HZ_TICK(device_timestamp_usec);
+
+    uint8_t *data = writer->depth_payload + sizeof(virtual_device_raw_depth_header_t);
+    if (depth)
+    {
+        memcpy(data, depth, image_size);
+        data += image_size;
+    }
+    memcpy(data, ir, image_size);
+
+    return TRACE_CALL(virtual_device_writer_write_record(writer,
+                                                         VIRTUAL_DEVICE_STREAM_DEPTH,
+                                                         device_timestamp_usec,
+                                                         NULL,
+                                                         0,
+                                                         writer->depth_payload,
+                                                         writer->raw_depth_size));
+}
+
+k4a_result_t virtual_device_writer_write_color(virtual_device_writer_t writer_handle,
+                                               uint64_t device_timestamp_usec,
+                                               uint32_t width,
+                                               uint32_t height,
+                                               uint32_t stride,
+                                               const uint8_t *data,
+                                               size_t data_size)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, virtual_device_writer_t, writer_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, data == NULL || data_size == 0);
+    virtual_device_writer_context_t *writer = virtual_device_writer_t_get_context(writer_handle);
+
+    uint32_t resolution_width = 0;
+    uint32_t resolution_height = 0;
+    if (!k4a_convert_resolution_to_width_height((k4a_color_resolution_t)writer->header.color_resolution,
+                                                &resolution_width,
+                                                &resolution_height))
+    {
+        LOG_ERROR("Color frames can't be written to a replay file created with color resolution %u",
+                  writer->header.color_resolution);
+        return K4A_RESULT_FAILED;
+    }
+    if (width != resolution_width || height != resolution_height)
+    {
+        LOG_ERROR("A %ux%u color frame does not match color resolution %u (%ux%u)",
+                  width,
+                  height,
+                  writer->header.color_resolution,
+                  resolution_width,
+                  resolution_height);
+        return K4A_RESULT_FAILED;
+    }
+
+    // Uncompressed images are wrapped by image_create_from_buffer on replay, which needs a stride that holds a row and
+    // enough data for every row
+    size_t min_stride = 0;
+    size_t rows = height;
+    switch ((k4a_image_format_t)writer->header.color_format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_MJPG:
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        min_stride = width;
+        rows = (size_t)height * 3 / 2;
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        min_stride = (size_t)width * 2;
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        min_stride = (size_t)width * 4;
+        break;
+    default:
+        LOG_ERROR("Color format %u can't be written to a replay file", writer->header.color_format);
+        return K4A_RESULT_FAILED;
+    }
+    if (min_stride > 0 && (stride < min_stride || data_size < (size_t)stride * rows))
+    {
+        LOG_ERROR("A color frame with stride %u and %zu bytes does not hold a %ux%u image of format %u",
+                  stride,
+                  data_size,
+                  width,
+                  height,
+                  writer->header.color_format);
+        return K4A_RESULT_FAILED;
+    }
+
+    virtual_device_color_header_t color;
+    color.format = writer->header.color_format;
+    color.width = width;
+    color.height = height;
+    color.stride = stride;
+
+    return TRACE_CALL(virtual_device_writer_write_record(writer,
+                                                         VIRTUAL_DEVICE_STREAM_COLOR,
+                                                         device_timestamp_usec,
+                                                         &color,
+                                                         sizeof(color),
+                                                         data,
+                                                         data_size));
+}
+
+static int16_t virtual_device_writer_quantize(float value, float lsb)
+{
+    float raw = roundf(value / lsb);
+    if (raw > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+    if (raw < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+    return (int16_t)raw;
+}
+
+k4a_result_t virtual_device_writer_write_imu(virtual_device_writer_t writer_handle,
+                                             const k4a_imu_sample_t *samples,
+                                             size_t sample_count)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, virtual_device_writer_t, writer_handle);
+    RETURN_VALUE_IF_ARG(K4A_RESULT_FAILED, samples == NULL && sample_count > 0);
+    virtual_device_writer_context_t *writer = virtual_device_writer_t_get_context(writer_handle);
+    k4a_result_t result = K4A_RESULT_SUCCEEDED;
+
+    // Inverse of the conversion the imu module applies to the raw payload
+    const float gyro_lsb = VIRTUAL_DEVICE_GYRO_SENSITIVITY * (VIRTUAL_DEVICE_PI / 180.0f) / 1000000.0f;
+    const float accel_lsb = VIRTUAL_DEVICE_ACCEL_SENSITIVITY * 9.81f / 1000000.0f;
+
+    for (size_t first = 0; K4A_SUCCEEDED(result) && first < sample_count;
+         first += VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD)
+    {
+        struct
+        {
+            imu_payload_metadata_t metadata;
+            xyz_vector_t gyro[VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD];
+            xyz_vector_t accel[VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD];
+        } payload;
+        size_t count = sample_count - first;
+        if (count > VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD)
+        {
+            count = VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD;
+        }
+
+        memset(&payload, 0, sizeof(payload));
+        payload.metadata.temperature.reporting_rate_in_us = VIRTUAL_DEVICE_IMU_TEMPERATURE_REPORTING_RATE_US;
+        payload.metadata.temperature.value = (int16_t)lroundf((samples[first].temperature - 15.0f) * 256.0f);
+        payload.metadata.gyro.sensitivity = VIRTUAL_DEVICE_GYRO_SENSITIVITY;
+        payload.metadata.gyro.sample_rate_in_us = VIRTUAL_DEVICE_IMU_SAMPLE_RATE_US;
+        payload.metadata.gyro.sample_count = (uint32_t)count;
+        payload.metadata.accel.sensitivity = VIRTUAL_DEVICE_ACCEL_SENSITIVITY;
+        payload.metadata.accel.sample_rate_in_us = VIRTUAL_DEVICE_IMU_SAMPLE_RATE_US;
+        payload.metadata.accel.sample_count = (uint32_t)count;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            const k4a_imu_sample_t *sample = &samples[first + i];
+
+            payload.gyro[i].pts = K4A_USEC_TO_90K_HZ_TICK(sample->gyro_timestamp_usec);
+            payload.gyro[i].rx = virtual_device_writer_quantize(sample->gyro_sample.xyz.x, gyro_lsb);
+            payload.gyro[i].ry = virtual_device_writer_quantize(sample->gyro_sample.xyz.y, gyro_lsb);
+            payload.gyro[i].rz = virtual_device_writer_quantize(sample->gyro_sample.xyz.z, gyro_lsb);
+
+            payload.accel[i].pts = K4A_USEC_TO_90K_HZ_TICK(sample->acc_timestamp_usec);
+            payload.accel[i].rx = virtual_device_writer_quantize(sample->acc_sample.xyz.x, accel_lsb);
+            payload.accel[i].ry = virtual_device_writer_quantize(sample->acc_sample.xyz.y, accel_lsb);
+            payload.accel[i].rz = virtual_device_writer_quantize(sample->acc_sample.xyz.z, accel_lsb);
+        }
+
+        // Accelerometer samples follow the gyro samples directly, so close the gap left by a partial payload
+        if (count < VIRTUAL_DEVICE_IMU_SAMPLES_PER_PAYLOAD)
+        {
+            memmove(&payload.gyro[count], payload.accel, count * sizeof(xyz_vector_t));
+        }
+
+        size_t payload_size = sizeof(imu_payload_metadata_t) + 2 * count * sizeof(xyz_vector_t);
+        result = TRACE_CALL(virtual_device_writer_write_record(writer,
+                                                             VIRTUAL_DEVICE_STREAM_IMU,
+                                                             samples[first].acc_timestamp_usec,
+                                                             NULL,
+                                                             0,
+                                                             &payload,
+                                                             payload_size));
+    }
+
+    return result;
+}
+
+k4a_result_t virtual_device_writer_close(virtual_device_writer_t writer_handle)
+{
+    RETURN_VALUE_IF_HANDLE_INVALID(K4A_RESULT_FAILED, virtual_device_writer_t, writer_handle);
+    virtual_device_writer_context_t *writer = virtual_device_writer_t_get_context(writer_handle);
+
+    k4a_result_t result = K4A_RESULT_FROM_BOOL(fclose(writer->file) == 0);
+    if (K4A_FAILED(result))
+    {
+        LOG_ERROR("Failed to close virtual device replay file", 0);
+    }
+
+    free(writer->depth_payload);
+    virtual_device_writer_t_destroy(writer_handle);
+    return result;
+}
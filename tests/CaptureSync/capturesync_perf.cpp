@@ -0,0 +1,432 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_perf_helpers.h>
+
+#include <gtest/gtest.h>
+
+// Module being tested
+#include <k4ainternal/capturesync.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string.h>
+#include <vector>
+
+using namespace testing;
+
+static uint32_t g_frame_count = 1000000;
+static uint64_t g_seed = 1;
+
+// Synthetic stream behavior. Timestamps model the device clock; arrival times model when the capture reaches
+// capturesync_add_capture and decide the order the captures are delivered in.
+struct capturesync_perf_parameters
+{
+    const char *name;
+    k4a_fps_t fps;
+    int32_t depth_delay_off_color_usec;
+    uint32_t timestamp_jitter_usec; // Uniform +/- noise on the device timestamps
+    uint32_t arrival_jitter_usec;   // Uniform extra delivery delay; each stream is still delivered in order
+    uint32_t depth_latency_usec;    // Delivery delay of depth captures, e.g. the depth engine, relative to color
+    double drop_rate;               // Fraction of the frames of each stream that are never delivered
+    uint32_t drop_burst;            // Consecutive frames lost per drop
+    double stall_rate;              // Probability per frame that a stream stalls
+    uint32_t stall_frames;          // Frames held back by a stall and then delivered at once
+
+    friend std::ostream &operator<<(std::ostream &os, const capturesync_perf_parameters &obj)
+    {
+        return os << obj.name;
+    }
+};
+
+static std::vector<capturesync_perf_parameters> get_perf_parameters()
+{
+    return {
+        { "ideal", K4A_FRAMES_PER_SECOND_30, 0, 0, 0, 33333, 0, 0, 0, 0 },
+        { "timestamp_jitter", K4A_FRAMES_PER_SECOND_30, 0, 2000, 0, 33333, 0, 0, 0, 0 },
+        { "timestamp_jitter_near_window", K4A_FRAMES_PER_SECOND_30, 0, 8000, 0, 33333, 0, 0, 0, 0 },
+        { "arrival_jitter", K4A_FRAMES_PER_SECOND_30, 0, 0, 50000, 33333, 0, 0, 0, 0 },
+        { "drops", K4A_FRAMES_PER_SECOND_30, 0, 0, 0, 33333, 0.01, 1, 0, 0 },
+        { "bursty_drops", K4A_FRAMES_PER_SECOND_30, 0, 0, 0, 33333, 0.01, 8, 0, 0 },
+        { "stalls", K4A_FRAMES_PER_SECOND_30, 0, 0, 0, 33333, 0, 0, 0.001, 10 },
+        { "depth_after_color", K4A_FRAMES_PER_SECOND_30, 8000, 1000, 0, 33333, 0, 0, 0, 0 },
+        { "depth_before_color", K4A_FRAMES_PER_SECOND_30, -8000, 1000, 0, 33333, 0, 0, 0, 0 },
+        { "combined", K4A_FRAMES_PER_SECOND_30, -4000, 2000, 5000, 33333, 0.01, 4, 0.001, 6 },
+        { "combined_5fps", K4A_FRAMES_PER_SECOND_5, -4000, 2000, 5000, 33333, 0.01, 4, 0.001, 6 },
+    };
+}
+
+struct synthetic_capture
+{
+    uint64_t arrival_usec;
+    uint64_t timestamp_usec;
+    uint32_t frame;
+    bool color;
+};
+
+struct capturesync_perf_result
+{
+    uint64_t color_delivered = 0;
+    uint64_t depth_delivered = 0;
+    uint64_t frame_pairs = 0;     // Frames whose color and depth captures were both delivered
+    uint64_t optimal_matches = 0; // Offline maximum matching within the synchronizer's window
+    uint64_t matched = 0;
+    uint64_t matched_correctly = 0; // Matches of the color and depth capture of the same frame
+    uint64_t color_only = 0;
+    uint64_t depth_only = 0;
+    uint64_t signature = 14695981039346656037ull; // FNV-1a of the published frame numbers, in order
+    std::vector<int64_t> added_latency_usec;      // Matched captures, from the first image arriving to publication
+    std::vector<int64_t> add_capture_nsec;
+};
+
+// Generates one stream in frame order, applying drops, timestamp noise, delivery delay and stalls
+static void generate_stream(const capturesync_perf_parameters &params,
+                            bool color,
+                            std::mt19937_64 &rng,
+                            std::vector<synthetic_capture> &captures,
+                            std::vector<uint64_t> &arrival_usec)
+{
+    const uint64_t period_usec = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(params.fps));
+    const int64_t delay_usec = color ? 0 : params.depth_delay_off_color_usec;
+    const int64_t jitter = params.timestamp_jitter_usec;
+
+    // Keeps the first timestamps positive while staying inside the window in which capturesync accepts depth after
+    // the timestamp reset at start
+    const uint64_t base_usec = period_usec + (uint64_t)std::abs(params.depth_delay_off_color_usec) + (uint64_t)jitter;
+
+    std::uniform_int_distribution<int64_t> timestamp_noise(-jitter, jitter);
+    std::uniform_int_distribution<uint32_t> arrival_noise(0, params.arrival_jitter_usec);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    arrival_usec.assign(g_frame_count, UINT64_MAX);
+    size_t first = captures.size();
+    uint64_t previous_arrival_usec = 0;
+    uint32_t dropping = 0;
+    for (uint32_t frame = 0; frame < g_frame_count; frame++)
+    {
+        // Drops start with a probability that keeps the overall drop rate near params.drop_rate
+        if (dropping == 0 && params.drop_burst != 0 && chance(rng) < params.drop_rate / params.drop_burst)
+        {
+            dropping = params.drop_burst;
+        }
+        if (dropping != 0)
+        {
+            dropping--;
+            continue;
+        }
+
+        synthetic_capture capture;
+        uint64_t nominal_usec = base_usec + (uint64_t)frame * period_usec;
+        capture.timestamp_usec = (uint64_t)((int64_t)nominal_usec + delay_usec + timestamp_noise(rng));
+        capture.arrival_usec = nominal_usec + (uint64_t)std::max<int64_t>(delay_usec, 0) +
+                               (color ? 0 : params.depth_latency_usec) + arrival_noise(rng);
+        capture.arrival_usec = std::max(capture.arrival_usec, previous_arrival_usec);
+        previous_arrival_usec = capture.arrival_usec;
+        capture.frame = frame;
+        capture.color = color;
+        captures.push_back(capture);
+    }
+
+    // A stall holds back the next stall_frames captures and delivers them together with the last one
+    for (size_t i = first; i < captures.size(); i++)
+    {
+        if (params.stall_frames != 0 && chance(rng) < params.stall_rate)
+        {
+            size_t last = std::min(i + params.stall_frames, captures.size()) - 1;
+            for (size_t j = i; j < last; j++)
+            {
+                captures[j].arrival_usec = std::max(captures[j].arrival_usec, captures[last].arrival_usec);
+            }
+            i = last;
+        }
+    }
+
+    for (size_t i = first; i < captures.size(); i++)
+    {
+        arrival_usec[captures[i].frame] = captures[i].arrival_usec;
+    }
+}
+
+// Computes the maximum number of color and depth captures that can be paired, using the timestamp window of
+// capturesync_add_capture. Every color capture accepts depth within a window of the same length, so matching each
+// color capture to the earliest remaining depth capture in its window is optimal.
+static uint64_t compute_optimal_matches(const capturesync_perf_parameters &params,
+                                        const std::vector<synthetic_capture> &captures)
+{
+    std::vector<int64_t> color_usec, depth_usec;
+    for (const synthetic_capture &capture : captures)
+    {
+        (capture.color ? color_usec : depth_usec).push_back((int64_t)capture.timestamp_usec);
+    }
+    std::sort(color_usec.begin(), color_usec.end());
+    std::sort(depth_usec.begin(), depth_usec.end());
+
+    // Window of depth_ts - color_ts - depth_delay_off_color_usec accepted by capturesync_add_capture
+    const int64_t period_usec = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(params.fps));
+    const int64_t quarter_usec = period_usec / 4;
+    int64_t low_usec = params.depth_delay_off_color_usec < 0 ? quarter_usec - period_usec : -quarter_usec;
+    int64_t high_usec = low_usec + period_usec;
+
+    uint64_t matches = 0;
+    size_t depth = 0;
+    for (int64_t color : color_usec)
+    {
+        int64_t expected_usec = color + params.depth_delay_off_color_usec;
+        while (depth < depth_usec.size() && depth_usec[depth] < expected_usec + low_usec)
+        {
+            depth++;
+        }
+        if (depth < depth_usec.size() && depth_usec[depth] <= expected_usec + high_usec)
+        {
+            matches++;
+            depth++;
+        }
+    }
+    return matches;
+}
+
+static bool create_capture(const synthetic_capture &synthetic, k4a_capture_t *capture)
+{
+    k4a_image_t image = NULL;
+    if (K4A_FAILED(capture_create(capture)))
+    {
+        return false;
+    }
+    allocation_source_t source = synthetic.color ? ALLOCATION_SOURCE_COLOR : ALLOCATION_SOURCE_DEPTH;
+    if (K4A_FAILED(image_create_empty_internal(source, sizeof(synthetic.frame), &image)))
+    {
+        capture_dec_ref(*capture);
+        return false;
+    }
+
+    // The frame number identifies the capture when it is published
+    memcpy(image_get_buffer(image), &synthetic.frame, sizeof(synthetic.frame));
+    image_set_device_timestamp_usec(image, synthetic.timestamp_usec);
+    if (synthetic.color)
+    {
+        capture_set_color_image(*capture, image);
+    }
+    else
+    {
+        capture_set_ir_image(*capture, image);
+        capture_set_depth_image(*capture, image);
+    }
+    image_dec_ref(image);
+    return true;
+}
+
+static bool get_frame(k4a_image_t image, uint32_t *frame)
+{
+    if (image == NULL)
+    {
+        return false;
+    }
+    memcpy(frame, image_get_buffer(image), sizeof(*frame));
+    image_dec_ref(image);
+    return true;
+}
+
+static void signature_add(uint64_t *signature, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        *signature = (*signature ^ ((value >> (i * 8)) & 0xff)) * 1099511628211ull;
+    }
+}
+
+static void run_capturesync(const capturesync_perf_parameters &params, capturesync_perf_result *result)
+{
+    // std::mt19937_64 produces the same sequence everywhere; the distributions may differ between standard libraries
+    std::mt19937_64 rng(g_seed);
+    std::vector<synthetic_capture> captures;
+    std::vector<uint64_t> color_arrival_usec, depth_arrival_usec;
+    captures.reserve((size_t)g_frame_count * 2);
+    generate_stream(params, true, rng, captures, color_arrival_usec);
+    generate_stream(params, false, rng, captures, depth_arrival_usec);
+    std::stable_sort(captures.begin(), captures.end(), [](const synthetic_capture &a, const synthetic_capture &b) {
+        return a.arrival_usec < b.arrival_usec;
+    });
+
+    for (uint32_t frame = 0; frame < g_frame_count; frame++)
+    {
+        bool color = color_arrival_usec[frame] != UINT64_MAX;
+        bool depth = depth_arrival_usec[frame] != UINT64_MAX;
+        result->color_delivered += color ? 1 : 0;
+        result->depth_delivered += depth ? 1 : 0;
+        result->frame_pairs += color && depth ? 1 : 0;
+    }
+    result->optimal_matches = compute_optimal_matches(params, captures);
+
+    capturesync_t sync = NULL;
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_1080P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+    config.camera_fps = params.fps;
+    config.depth_delay_off_color_usec = params.depth_delay_off_color_usec;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_create(&sync));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capturesync_start(sync, &config));
+
+    result->add_capture_nsec.reserve(captures.size());
+    for (const synthetic_capture &synthetic : captures)
+    {
+        k4a_capture_t capture = NULL;
+        ASSERT_TRUE(create_capture(synthetic, &capture));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        capturesync_add_capture(sync, K4A_RESULT_SUCCEEDED, capture, synthetic.color);
+        auto stop = std::chrono::high_resolution_clock::now();
+        result->add_capture_nsec.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        capture_dec_ref(capture);
+
+        // Drain the output so the queue for the user never overflows; captures are published at the simulated
+        // arrival time of the capture that released them
+        k4a_capture_t published = NULL;
+        while (capturesync_get_capture(sync, &published, 0) == K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            uint32_t color_frame = 0, depth_frame = 0;
+            bool color = get_frame(capture_get_color_image(published), &color_frame);
+            bool depth = get_frame(capture_get_ir_image(published), &depth_frame);
+            capture_dec_ref(published);
+
+            signature_add(&result->signature, color ? color_frame : UINT32_MAX);
+            signature_add(&result->signature, depth ? depth_frame : UINT32_MAX);
+            if (color && depth)
+            {
+                result->matched++;
+                result->matched_correctly += color_frame == depth_frame ? 1 : 0;
+                uint64_t first_arrival_usec = std::min(color_arrival_usec[color_frame],
+                                                       depth_arrival_usec[depth_frame]);
+                result->added_latency_usec.push_back((int64_t)(synthetic.arrival_usec - first_arrival_usec));
+            }
+            else if (color)
+            {
+                result->color_only++;
+            }
+            else if (depth)
+            {
+                result->depth_only++;
+            }
+        }
+    }
+
+    capturesync_stop(sync);
+    capturesync_destroy(sync);
+}
+
+static double percent(uint64_t value, uint64_t total)
+{
+    return total == 0 ? 0.0 : 100.0 * (double)value / (double)total;
+}
+
+class capturesync_perf : public ::testing::Test, public ::testing::WithParamInterface<capturesync_perf_parameters>
+{
+};
+
+TEST_P(capturesync_perf, synthetic_streams)
+{
+    const capturesync_perf_parameters &params = GetParam();
+    capturesync_perf_result result;
+    run_capturesync(params, &result);
+    if (HasFatalFailure())
+    {
+        return;
+    }
+
+    double add_capture_mean_nsec = 0;
+    for (int64_t nsec : result.add_capture_nsec)
+    {
+        add_capture_mean_nsec += (double)nsec / (double)result.add_capture_nsec.size();
+    }
+
+    printf("%-30s %u fps, delay %6d usec, %llu color + %llu depth captures delivered\n",
+           params.name,
+           k4a_convert_fps_to_uint(params.fps),
+           params.depth_delay_off_color_usec,
+           (unsigned long long)result.color_delivered,
+           (unsigned long long)result.depth_delivered);
+    printf("    matched %llu, offline optimal %llu, lost vs optimal %llu\n",
+           (unsigned long long)result.matched,
+           (unsigned long long)result.optimal_matches,
+           (unsigned long long)(result.optimal_matches > result.matched ? result.optimal_matches - result.matched
+                                                                         : 0));
+    printf("    same frame %6.2f%% of frame pairs (%llu of %llu), mismatched frames %llu\n",
+           percent(result.matched_correctly, result.frame_pairs),
+           (unsigned long long)result.matched_correctly,
+           (unsigned long long)result.frame_pairs,
+           (unsigned long long)(result.matched - result.matched_correctly));
+    printf("    unmatched published: %llu color, %llu depth\n",
+           (unsigned long long)result.color_only,
+           (unsigned long long)result.depth_only);
+    printf("    added latency p50 %6lld usec  p99 %6lld usec  max %6lld usec\n",
+           (long long)ut_perf_get_percentile(result.added_latency_usec, 0.50),
+           (long long)ut_perf_get_percentile(result.added_latency_usec, 0.99),
+           (long long)ut_perf_get_percentile(result.added_latency_usec, 1.0));
+    printf("    capturesync_add_capture mean %6.0f ns  p99 %6lld ns per capture\n",
+           add_capture_mean_nsec,
+           (long long)ut_perf_get_percentile(result.add_capture_nsec, 0.99));
+
+    // A synchronizer can never pair more captures than the offline optimum
+    EXPECT_LE(result.matched, result.optimal_matches);
+    if (params.timestamp_jitter_usec == 0 && params.arrival_jitter_usec == 0 && params.drop_rate == 0 &&
+        params.stall_rate == 0)
+    {
+        EXPECT_EQ(result.frame_pairs, result.matched_correctly);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(capturesync_perf, capturesync_perf, ValuesIn(get_perf_parameters()));
+
+// The same input must be synchronized the same way every time, so results of different runs can be compared
+TEST(capturesync_perf_determinism, same_seed_same_result)
+{
+    capturesync_perf_parameters params = get_perf_parameters().back();
+    capturesync_perf_result first, second;
+    run_capturesync(params, &first);
+    run_capturesync(params, &second);
+
+    EXPECT_EQ(first.signature, second.signature);
+    EXPECT_EQ(first.matched, second.matched);
+    EXPECT_EQ(first.color_only, second.color_only);
+    EXPECT_EQ(first.depth_only, second.depth_only);
+}
+
+int main(int argc, char **argv)
+{
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            g_frame_count = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            g_seed = (uint64_t)strtoull(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: capturesync_perf [gtest options] [--frames <frames per stream>] [--seed <seed>]\n");
+            return 1;
+        }
+    }
+
+    if (g_frame_count < 1)
+    {
+        printf("--frames must be at least 1\n");
+        return 1;
+    }
+
+    printf("%u frames per stream, seed %llu\n", g_frame_count, (unsigned long long)g_seed);
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
@@ -0,0 +1,579 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_perf_helpers.h>
+
+#include <gtest/gtest.h>
+
+// Modules being tested
+#include <k4ainternal/dewrapper.h>
+#include <k4ainternal/tewrapper.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/image.h>
+#include <k4ainternal/latency_histogram.h>
+#include <k4ainternal/virtual_device.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
+// Both wrappers load the virtual depth engine plugin (VIRTUAL_DEVICE_DEPTH_ENGINE_NAME) with its transform engine
+// registered, configured through its VIRTUAL_DEPTH_ENGINE_ENV_* test hooks
+#define DEPTH_ENGINE_ENV_PLUGIN_NAME "K4A_DEPTH_ENGINE_PLUGIN"
+
+// Time to wait for the depth engine thread to finish the frames posted to it
+#define DEWRAPPER_DRAIN_TIMEOUT_MS 30000
+
+using namespace testing;
+
+static int g_frame_count = 300;
+static int g_transform_count = 200;
+
+static void configure_engine(uint32_t cost_usec, size_t output_size, uint32_t fail_every, int fail_code)
+{
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_COST_USEC, std::to_string(cost_usec).c_str());
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_OUTPUT_SIZE, std::to_string(output_size).c_str());
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_FAIL_EVERY, std::to_string(fail_every).c_str());
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_FAIL_CODE, std::to_string(fail_code).c_str());
+}
+
+struct dewrapper_perf_parameters
+{
+    const char *name;
+    k4a_depth_mode_t depth_mode;
+    size_t raw_size; // Size of the raw depth payload the device sends in this mode
+    int width;
+    int height;
+    uint32_t cost_usec;
+    uint32_t output_size_scale; // Multiple of the image size the engine reports as output size, 0 for half the size
+    uint32_t fail_every;
+    k4a_depth_engine_result_code_t fail_code;
+
+    friend std::ostream &operator<<(std::ostream &os, const dewrapper_perf_parameters &obj)
+    {
+        return os << obj.name;
+    }
+};
+
+static std::vector<dewrapper_perf_parameters> get_dewrapper_perf_parameters()
+{
+    // Raw sizes match the SENSOR_MODE_*_SIZE payloads of the depth MCU
+    const k4a_depth_engine_result_code_t timeout = K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT;
+    const k4a_depth_engine_result_code_t internal = K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_INTERNAL;
+    return {
+        { "nfov_binned", K4A_DEPTH_MODE_NFOV_2X2BINNED, 5310760, 320, 288, 0, 1, 0, timeout },
+        { "nfov_unbinned", K4A_DEPTH_MODE_NFOV_UNBINNED, 5310760, 640, 576, 0, 1, 0, timeout },
+        { "wfov_binned", K4A_DEPTH_MODE_WFOV_2X2BINNED, 3777232, 512, 512, 0, 1, 0, timeout },
+        { "wfov_unbinned", K4A_DEPTH_MODE_WFOV_UNBINNED, 9438664, 1024, 1024, 0, 1, 0, timeout },
+        { "passive_ir", K4A_DEPTH_MODE_PASSIVE_IR, 1678024, 1024, 1024, 0, 1, 0, timeout },
+        { "nfov_unbinned_cost_5ms", K4A_DEPTH_MODE_NFOV_UNBINNED, 5310760, 640, 576, 5000, 1, 0, timeout },
+        { "wfov_unbinned_cost_20ms", K4A_DEPTH_MODE_WFOV_UNBINNED, 9438664, 1024, 1024, 20000, 1, 0, timeout },
+        { "nfov_unbinned_oversized_output", K4A_DEPTH_MODE_NFOV_UNBINNED, 5310760, 640, 576, 0, 4, 0, timeout },
+        { "nfov_unbinned_timeout_every_10", K4A_DEPTH_MODE_NFOV_UNBINNED, 5310760, 640, 576, 0, 1, 10, timeout },
+        { "nfov_unbinned_fatal_at_10", K4A_DEPTH_MODE_NFOV_UNBINNED, 5310760, 640, 576, 0, 1, 10, internal },
+        { "nfov_unbinned_undersized_output", K4A_DEPTH_MODE_NFOV_UNBINNED, 5310760, 640, 576, 0, 0, 0, timeout },
+    };
+}
+
+// State shared with the capture ready callback of dewrapper
+struct dewrapper_perf_context
+{
+    std::mutex lock;
+    const dewrapper_perf_parameters *params = nullptr;
+    std::atomic<uint64_t> delivered{ 0 };
+    std::atomic<uint64_t> errors{ 0 };
+    std::vector<uint64_t> latency_usec; // Raw frame posted until the capture is delivered
+    uint64_t last_device_timestamp_usec = 0;
+    uint64_t bad_captures = 0;
+};
+
+static void capture_ready(k4a_result_t result, k4a_capture_t capture, void *callback_context)
+{
+    dewrapper_perf_context *context = (dewrapper_perf_context *)callback_context;
+    uint64_t now_nsec = latency_histogram_get_time_nsec();
+
+    if (K4A_FAILED(result) || capture == NULL)
+    {
+        context->errors++;
+        return;
+    }
+
+    bool depth_present = context->params->depth_mode != K4A_DEPTH_MODE_PASSIVE_IR;
+    k4a_image_t ir = capture_get_ir_image(capture);
+    k4a_image_t depth = capture_get_depth_image(capture);
+
+    std::lock_guard<std::mutex> guard(context->lock);
+    bool good = ir != NULL && (depth != NULL) == depth_present &&
+                image_get_width_pixels(ir) == context->params->width &&
+                image_get_height_pixels(ir) == context->params->height &&
+                image_get_device_timestamp_usec(ir) > context->last_device_timestamp_usec;
+    if (ir != NULL)
+    {
+        context->latency_usec.push_back((now_nsec - image_get_system_timestamp_nsec(ir)) / 1000);
+        context->last_device_timestamp_usec = image_get_device_timestamp_usec(ir);
+        image_dec_ref(ir);
+    }
+    if (depth != NULL)
+    {
+        image_dec_ref(depth);
+    }
+    context->bad_captures += good ? 0 : 1;
+    context->delivered++;
+}
+
+// Builds the raw payload of frame the way a virtual device stores it, wraps it in a capture the way
+// depth_capture_available() does and hands it to dewrapper
+static void post_raw_frame(dewrapper_t dewrapper, const dewrapper_perf_parameters &params, uint64_t frame)
+{
+    bool depth_present = params.depth_mode != K4A_DEPTH_MODE_PASSIVE_IR;
+    size_t pixels = (size_t)params.width * (size_t)params.height;
+    size_t payload_size = sizeof(virtual_device_raw_depth_header_t) +
+                          (depth_present ? 2 : 1) * pixels * sizeof(uint16_t);
+
+    // The passive IR image does not fit the raw payload size of the mode, dewrapper does not check the size
+    k4a_image_t image_raw = NULL;
+    k4a_capture_t capture_raw = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              image_create_empty_internal(ALLOCATION_SOURCE_USB_DEPTH,
+                                          std::max(params.raw_size, payload_size),
+                                          &image_raw));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, capture_create(&capture_raw));
+
+    // A depth ramp and an IR pattern that move with every frame. The center of exposure advances by one 30 FPS frame
+    // period of the 90 kHz device clock per frame.
+    virtual_device_raw_depth_header_t *raw = (virtual_device_raw_depth_header_t *)image_get_buffer(image_raw);
+    memset(raw, 0, sizeof(*raw));
+    raw->magic = VIRTUAL_DEVICE_RAW_DEPTH_MAGIC;
+    raw->width = (uint16_t)params.width;
+    raw->height = (uint16_t)params.height;
+    raw->flags = depth_present ? VIRTUAL_DEVICE_RAW_DEPTH_FLAG_DEPTH : 0;
+    raw->sensor_temp = 30.0f;
+    raw->center_of_exposure_in_ticks = frame * (90000 / 30);
+    uint16_t *data = (uint16_t *)(raw + 1);
+    for (size_t i = 0; i < pixels; i++)
+    {
+        if (depth_present)
+        {
+            data[i] = (uint16_t)(500 + (i + frame) % 4000);
+        }
+        data[(depth_present ? pixels : 0) + i] = (uint16_t)((i + frame) & 0x3ff);
+    }
+
+    image_set_system_timestamp_nsec(image_raw, latency_histogram_get_time_nsec());
+    capture_set_ir_image(capture_raw, image_raw);
+    dewrapper_post_capture(K4A_RESULT_SUCCEEDED, capture_raw, dewrapper);
+    capture_dec_ref(capture_raw);
+    image_dec_ref(image_raw);
+}
+
+class dewrapper_perf : public ::testing::Test, public ::testing::WithParamInterface<dewrapper_perf_parameters>
+{
+protected:
+    void SetUp() override
+    {
+        const dewrapper_perf_parameters &params = GetParam();
+        size_t image_size = (size_t)params.width * (size_t)params.height * sizeof(uint16_t) *
+                            (params.depth_mode == K4A_DEPTH_MODE_PASSIVE_IR ? 1 : 2);
+        size_t output_size = params.output_size_scale == 0 ? image_size / 2 : image_size * params.output_size_scale;
+        configure_engine(params.cost_usec, output_size, params.fail_every, params.fail_code);
+
+        m_context.params = &params;
+        memset(&m_calibration, 0, sizeof(m_calibration));
+        m_dewrapper = dewrapper_create(&m_calibration, capture_ready, &m_context);
+        ASSERT_NE(m_dewrapper, (dewrapper_t)NULL);
+
+        k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+        config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+        config.depth_mode = params.depth_mode;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  dewrapper_start(m_dewrapper, &config, m_calibration_memory, sizeof(m_calibration_memory)));
+    }
+
+    void TearDown() override
+    {
+        if (m_dewrapper != NULL)
+        {
+            dewrapper_stop(m_dewrapper);
+            dewrapper_destroy(m_dewrapper);
+        }
+    }
+
+    // Frames the depth engine thread has finished with: delivered, dropped by the queue or dropped by the engine
+    uint64_t get_completed()
+    {
+        k4a_pipeline_stats_t stats;
+        memset(&stats, 0, sizeof(stats));
+        dewrapper_get_stats(m_dewrapper, &stats);
+        return m_context.delivered.load() + stats.depth_engine_queue.dropped_count + stats.depth_engine_dropped_count;
+    }
+
+    // Waits for the depth engine thread to finish with the posted frames, or to report an error
+    bool wait_for_completed(uint64_t posted)
+    {
+        auto start = std::chrono::steady_clock::now();
+        while (get_completed() < posted && m_context.errors.load() == 0)
+        {
+            if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(DEWRAPPER_DRAIN_TIMEOUT_MS))
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    void print_results(const char *test, uint64_t posted, double seconds)
+    {
+        const dewrapper_perf_parameters &params = GetParam();
+        k4a_pipeline_stats_t stats;
+        memset(&stats, 0, sizeof(stats));
+        dewrapper_get_stats(m_dewrapper, &stats);
+
+        std::lock_guard<std::mutex> guard(m_context.lock);
+        double mean_usec = ut_perf_get_mean(m_context.latency_usec);
+        printf("%-32s %-8s %5llu posted %5llu delivered %5llu queue drops %5llu engine drops %llu errors  %7.1f fps  "
+               "post to capture p50 %6llu p99 %6llu max %6llu us  engine p50 %6llu p99 %6llu us  "
+               "overhead %6.0f us\n",
+               params.name,
+               test,
+               (unsigned long long)posted,
+               (unsigned long long)m_context.delivered.load(),
+               (unsigned long long)stats.depth_engine_queue.dropped_count,
+               (unsigned long long)stats.depth_engine_dropped_count,
+               (unsigned long long)m_context.errors.load(),
+               seconds > 0 ? (double)m_context.delivered.load() / seconds : 0.0,
+               (unsigned long long)ut_perf_get_percentile(m_context.latency_usec, 0.50),
+               (unsigned long long)ut_perf_get_percentile(m_context.latency_usec, 0.99),
+               (unsigned long long)ut_perf_get_percentile(m_context.latency_usec, 1.0),
+               (unsigned long long)stats.depth_engine.p50_usec,
+               (unsigned long long)stats.depth_engine.p99_usec,
+               std::max(0.0, mean_usec - (double)params.cost_usec));
+    }
+
+    dewrapper_perf_context m_context;
+    dewrapper_t m_dewrapper = NULL;
+    k4a_calibration_camera_t m_calibration;
+    uint8_t m_calibration_memory[64] = {}; // The virtual depth engine ignores the calibration
+};
+
+// Posts each frame once the previous one is done, so no frame waits in the queue and the results are deterministic.
+// The overhead is the post to capture latency the wrapper adds on top of the synthetic engine cost.
+TEST_P(dewrapper_perf, lockstep)
+{
+    const dewrapper_perf_parameters &params = GetParam();
+
+    uint64_t posted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < g_frame_count && m_context.errors.load() == 0; i++)
+    {
+        posted++;
+        post_raw_frame(m_dewrapper, params, posted);
+        ASSERT_TRUE(wait_for_completed(posted)) << "Depth engine thread stopped processing frames";
+    }
+    auto stop = std::chrono::steady_clock::now();
+    print_results("lockstep", posted, std::chrono::duration<double>(stop - start).count());
+
+    k4a_pipeline_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    dewrapper_get_stats(m_dewrapper, &stats);
+    EXPECT_EQ(stats.depth_engine_queue.dropped_count, 0u);
+    EXPECT_EQ(m_context.bad_captures, 0u);
+
+    if (params.output_size_scale == 0)
+    {
+        // The output buffer cannot hold the images, which stops the stream on the first frame
+        EXPECT_EQ(m_context.delivered.load(), 0u);
+        EXPECT_EQ(m_context.errors.load(), 1u);
+    }
+    else if (params.fail_every != 0 && params.fail_code != K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT)
+    {
+        // Other failures than timeouts stop the stream
+        EXPECT_EQ(m_context.delivered.load(), (uint64_t)params.fail_every - 1);
+        EXPECT_EQ(m_context.errors.load(), 1u);
+    }
+    else
+    {
+        // Timeouts drop the frame and the stream continues
+        uint64_t expected_drops = params.fail_every != 0 ? posted / params.fail_every : 0;
+        EXPECT_EQ(stats.depth_engine_dropped_count, expected_drops);
+        EXPECT_EQ(m_context.delivered.load(), posted - expected_drops);
+        EXPECT_EQ(m_context.errors.load(), 0u);
+    }
+}
+
+// Posts all frames as fast as possible. Frames the depth engine thread cannot keep up with are dropped by its queue,
+// so this measures the throughput of the thread and the cost of its handoffs under overload.
+TEST_P(dewrapper_perf, burst)
+{
+    const dewrapper_perf_parameters &params = GetParam();
+
+    uint64_t posted = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < g_frame_count && m_context.errors.load() == 0; i++)
+    {
+        posted++;
+        post_raw_frame(m_dewrapper, params, posted);
+    }
+    ASSERT_TRUE(wait_for_completed(posted)) << "Depth engine thread stopped processing frames";
+    auto stop = std::chrono::steady_clock::now();
+    print_results("burst", posted, std::chrono::duration<double>(stop - start).count());
+
+    EXPECT_EQ(m_context.bad_captures, 0u);
+}
+
+INSTANTIATE_TEST_CASE_P(dewrapper_perf, dewrapper_perf, ValuesIn(get_dewrapper_perf_parameters()));
+
+struct tewrapper_perf_parameters
+{
+    const char *name;
+    k4a_transform_engine_type_t type;
+    int color_width;
+    int color_height;
+    uint32_t cost_usec;
+    int thread_count;
+    uint32_t fail_every;
+
+    friend std::ostream &operator<<(std::ostream &os, const tewrapper_perf_parameters &obj)
+    {
+        return os << obj.name;
+    }
+};
+
+static std::vector<tewrapper_perf_parameters> get_tewrapper_perf_parameters()
+{
+    const k4a_transform_engine_type_t d2c = K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR;
+    const k4a_transform_engine_type_t c2d = K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH;
+    const k4a_transform_engine_type_t custom8 = K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR;
+    const k4a_transform_engine_type_t custom16 = K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR;
+    return {
+        { "depth_to_color_720p", d2c, 1280, 720, 0, 1, 0 },
+        { "depth_to_color_2160p", d2c, 3840, 2160, 0, 1, 0 },
+        { "color_to_depth_720p", c2d, 1280, 720, 0, 1, 0 },
+        { "color_to_depth_2160p", c2d, 3840, 2160, 0, 1, 0 },
+        { "custom8_to_color_720p", custom8, 1280, 720, 0, 1, 0 },
+        { "custom16_to_color_720p", custom16, 1280, 720, 0, 1, 0 },
+        { "depth_to_color_720p_cost_2ms", d2c, 1280, 720, 2000, 1, 0 },
+        { "depth_to_color_720p_4_threads", d2c, 1280, 720, 0, 4, 0 },
+        { "depth_to_color_720p_cost_2ms_4_threads", d2c, 1280, 720, 2000, 4, 0 },
+        { "depth_to_color_720p_fail_at_5", d2c, 1280, 720, 0, 1, 5 },
+    };
+}
+
+// Input and output buffers of one caller of tewrapper_process_frame
+struct tewrapper_buffers
+{
+    std::vector<uint16_t> depth;
+    std::vector<uint8_t> image2;
+    std::vector<uint8_t> transformed;
+    std::vector<uint8_t> transformed2;
+};
+
+class tewrapper_perf : public ::testing::Test, public ::testing::WithParamInterface<tewrapper_perf_parameters>
+{
+protected:
+    void SetUp() override
+    {
+        const tewrapper_perf_parameters &params = GetParam();
+        configure_engine(params.cost_usec, 0, params.fail_every, K4A_DEPTH_ENGINE_RESULT_FATAL_ERROR_GPU_TIMEOUT);
+
+        // NFOV unbinned depth; the virtual transform engine only uses the resolutions of the calibration
+        memset(&m_calibration, 0, sizeof(m_calibration));
+        m_calibration.depth_camera_calibration.resolution_width = DEPTH_WIDTH;
+        m_calibration.depth_camera_calibration.resolution_height = DEPTH_HEIGHT;
+        m_calibration.color_camera_calibration.resolution_width = params.color_width;
+        m_calibration.color_camera_calibration.resolution_height = params.color_height;
+        m_tewrapper = tewrapper_create(&m_calibration);
+        ASSERT_NE(m_tewrapper, (tewrapper_t)NULL);
+    }
+
+    void TearDown() override
+    {
+        if (m_tewrapper != NULL)
+        {
+            tewrapper_destroy(m_tewrapper);
+        }
+    }
+
+    void allocate_buffers(tewrapper_buffers *buffers)
+    {
+        const tewrapper_perf_parameters &params = GetParam();
+        size_t depth_pixels = (size_t)DEPTH_WIDTH * DEPTH_HEIGHT;
+        size_t color_pixels = (size_t)params.color_width * (size_t)params.color_height;
+
+        buffers->depth.resize(depth_pixels);
+        for (size_t i = 0; i < depth_pixels; i++)
+        {
+            buffers->depth[i] = (uint16_t)(i % 7 == 0 ? 0 : 500 + i % 4000);
+        }
+
+        switch (params.type)
+        {
+        case K4A_TRANSFORM_ENGINE_TYPE_COLOR_TO_DEPTH:
+            buffers->image2.resize(color_pixels * 4, 0x80);
+            buffers->transformed.resize(depth_pixels * 4);
+            break;
+        case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM8_TO_COLOR:
+            buffers->image2.resize(depth_pixels, 0x40);
+            buffers->transformed.resize(color_pixels * sizeof(uint16_t));
+            buffers->transformed2.resize(color_pixels);
+            break;
+        case K4A_TRANSFORM_ENGINE_TYPE_DEPTH_CUSTOM16_TO_COLOR:
+            buffers->image2.resize(depth_pixels * sizeof(uint16_t), 0x40);
+            buffers->transformed.resize(color_pixels * sizeof(uint16_t));
+            buffers->transformed2.resize(color_pixels * sizeof(uint16_t));
+            break;
+        default:
+            buffers->transformed.resize(color_pixels * sizeof(uint16_t));
+            break;
+        }
+    }
+
+    k4a_result_t process_frame(tewrapper_buffers *buffers)
+    {
+        return tewrapper_process_frame(m_tewrapper,
+                                       GetParam().type,
+                                       buffers->depth.data(),
+                                       buffers->depth.size() * sizeof(uint16_t),
+                                       buffers->image2.empty() ? NULL : buffers->image2.data(),
+                                       buffers->image2.size(),
+                                       buffers->transformed.data(),
+                                       buffers->transformed.size(),
+                                       buffers->transformed2.empty() ? NULL : buffers->transformed2.data(),
+                                       buffers->transformed2.size(),
+                                       K4A_TRANSFORM_ENGINE_INTERPOLATION_NEAREST,
+                                       0);
+    }
+
+    static const int DEPTH_WIDTH = 640;
+    static const int DEPTH_HEIGHT = 576;
+
+    tewrapper_t m_tewrapper = NULL;
+    k4a_transform_engine_calibration_t m_calibration;
+};
+
+// Calls tewrapper_process_frame from several threads at once, like applications sharing a k4a_transformation_t.
+// The wrapper serializes the callers, so the overhead is the mean call latency above the synthetic engine cost of
+// one call per thread.
+TEST_P(tewrapper_perf, process_frame)
+{
+    const tewrapper_perf_parameters &params = GetParam();
+
+    std::vector<tewrapper_buffers> buffers((size_t)params.thread_count);
+    std::vector<std::vector<uint64_t>> latency_usec((size_t)params.thread_count);
+    for (tewrapper_buffers &b : buffers)
+    {
+        allocate_buffers(&b);
+    }
+
+    if (params.fail_every != 0)
+    {
+        // The transform engine thread exits on a failure, so the frames after the failing one fail too
+        for (uint32_t i = 1; i < params.fail_every; i++)
+        {
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED, process_frame(&buffers[0]));
+        }
+        ASSERT_EQ(K4A_RESULT_FAILED, process_frame(&buffers[0]));
+        ASSERT_EQ(K4A_RESULT_FAILED, process_frame(&buffers[0]));
+        printf("%-40s failed on frame %u as injected\n", params.name, params.fail_every);
+        return;
+    }
+
+    std::atomic<int> failures(0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < params.thread_count; t++)
+    {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < g_transform_count; i++)
+            {
+                auto call_start = std::chrono::steady_clock::now();
+                k4a_result_t result = process_frame(&buffers[(size_t)t]);
+                auto call_stop = std::chrono::steady_clock::now();
+                latency_usec[(size_t)t].push_back(
+                    (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(call_stop - call_start).count());
+                failures += K4A_FAILED(result) ? 1 : 0;
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(stop - start).count();
+
+    std::vector<uint64_t> merged;
+    for (std::vector<uint64_t> &values : latency_usec)
+    {
+        merged.insert(merged.end(), values.begin(), values.end());
+    }
+    double mean_usec = ut_perf_get_mean(merged);
+
+    printf("%-40s %d threads: %8.1f transforms/s  call p50 %6llu p99 %6llu max %6llu us  overhead %6.0f us\n",
+           params.name,
+           params.thread_count,
+           seconds > 0 ? (double)merged.size() / seconds : 0.0,
+           (unsigned long long)ut_perf_get_percentile(merged, 0.50),
+           (unsigned long long)ut_perf_get_percentile(merged, 0.99),
+           (unsigned long long)ut_perf_get_percentile(merged, 1.0),
+           std::max(0.0, mean_usec - (double)params.cost_usec * params.thread_count));
+
+    EXPECT_EQ(failures.load(), 0);
+}
+
+INSTANTIATE_TEST_CASE_P(tewrapper_perf, tewrapper_perf, ValuesIn(get_tewrapper_perf_parameters()));
+
+int main(int argc, char **argv)
+{
+    // Must be set before the first depth or transform engine is created, which loads the plugin
+    SETENV(DEPTH_ENGINE_ENV_PLUGIN_NAME, VIRTUAL_DEVICE_DEPTH_ENGINE_NAME);
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_TRANSFORM, "1");
+
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            g_frame_count = (int)strtol(argv[++i], NULL, 10);
+        }
+        else if (strcmp(argv[i], "--transforms") == 0 && i + 1 < argc)
+        {
+            g_transform_count = (int)strtol(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: depthengine_perf [gtest options] [--frames <raw depth frames per test>] "
+                   "[--transforms <transforms per thread>]\n");
+            return 1;
+        }
+    }
+
+    if (g_frame_count < 1 || g_transform_count < 1)
+    {
+        printf("--frames and --transforms must be at least 1\n");
+        return 1;
+    }
+
+    printf("%d raw depth frames per dewrapper test, %d transforms per tewrapper thread. Overhead is the mean latency "
+           "above the synthetic engine cost, including the engine writing its outputs.\n",
+           g_frame_count,
+           g_transform_count);
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
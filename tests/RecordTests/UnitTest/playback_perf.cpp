@@ -351,6 +351,55 @@ TEST_F(playback_perf, test_read_latency_30fps_bgra_conversion)
     k4a_playback_close(handle);
 }
 
+TEST_F(playback_perf, test_depth_byteswap)
+{
+    // WFOV unbinned is the largest depth frame that gets byte swapped on record and playback.
+    uint32_t width = 0, height = 0;
+    ASSERT_TRUE(k4a_convert_depth_mode_to_width_height(K4A_DEPTH_MODE_WFOV_UNBINNED, &width, &height));
+    size_t count = (size_t)(width * height);
+    const int iterations = 1000;
+
+    std::vector<uint16_t> source(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        source[i] = (uint16_t)(i * 7919);
+    }
+    std::vector<uint16_t> scalar_output(count);
+    std::vector<uint16_t> vector_output(count);
+
+    std::cout << "Byte swap instruction type: " << copy_swap_bytes_16_get_instruction_type() << std::endl;
+    {
+        Timer t("Scalar copy + byte swap x1000");
+        for (int n = 0; n < iterations; n++)
+        {
+            memcpy(scalar_output.data(), source.data(), count * sizeof(uint16_t));
+            for (size_t i = 0; i < count; i++)
+            {
+                scalar_output[i] = swap_bytes_16(scalar_output[i]);
+            }
+        }
+    }
+    {
+        Timer t("Fused copy + byte swap x1000");
+        for (int n = 0; n < iterations; n++)
+        {
+            copy_swap_bytes_16(vector_output.data(), source.data(), count);
+        }
+    }
+    ASSERT_EQ(scalar_output, vector_output);
+
+    // Unaligned tail lengths must also match the scalar result.
+    for (size_t tail = 0; tail < 40; tail++)
+    {
+        std::fill(vector_output.begin(), vector_output.end(), 0);
+        copy_swap_bytes_16(vector_output.data(), source.data(), tail);
+        for (size_t i = 0; i < tail; i++)
+        {
+            ASSERT_EQ(vector_output[i], swap_bytes_16(source[i]));
+        }
+    }
+}
+
 int main(int argc, char **argv)
 {
     k4a_unittest_init();
@@ -0,0 +1,383 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <k4a/k4a.h>
+#include <k4ainternal/common.h>
+
+#include "test_helpers.h"
+#include <ut_perf_helpers.h>
+
+// Module being tested
+#include <k4arecord/playback.h>
+#include <k4arecord/record.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string.h>
+#include <vector>
+
+using namespace testing;
+
+static std::string g_output_path = ".";
+static int g_seek_count = 100;
+
+static const char *const custom_track_name = "PERF_CUSTOM_TRACK";
+
+// The IMU reports at 1.6kHz on a device
+static const uint64_t imu_period_usec = 625;
+
+struct playback_throughput_parameters
+{
+    k4a_image_format_t color_format;
+    k4a_depth_mode_t depth_mode;
+    uint32_t duration_sec;
+
+    friend std::ostream &operator<<(std::ostream &os, const playback_throughput_parameters &obj)
+    {
+        return os << format_names[obj.color_format] << " " << depth_names[obj.depth_mode] << " " << obj.duration_sec
+                  << "s";
+    }
+};
+
+static std::vector<playback_throughput_parameters> get_perf_parameters()
+{
+    const k4a_image_format_t color_formats[] = { K4A_IMAGE_FORMAT_COLOR_MJPG,
+                                                 K4A_IMAGE_FORMAT_COLOR_NV12,
+                                                 K4A_IMAGE_FORMAT_COLOR_YUY2,
+                                                 K4A_IMAGE_FORMAT_COLOR_BGRA32 };
+    const k4a_depth_mode_t depth_modes[] = { K4A_DEPTH_MODE_NFOV_2X2BINNED, K4A_DEPTH_MODE_NFOV_UNBINNED,
+                                             K4A_DEPTH_MODE_WFOV_2X2BINNED, K4A_DEPTH_MODE_WFOV_UNBINNED,
+                                             K4A_DEPTH_MODE_PASSIVE_IR };
+    const uint32_t durations_sec[] = { 1, 10 };
+
+    std::vector<playback_throughput_parameters> parameters;
+    for (uint32_t duration_sec : durations_sec)
+    {
+        for (k4a_image_format_t color_format : color_formats)
+        {
+            for (k4a_depth_mode_t depth_mode : depth_modes)
+            {
+                parameters.push_back({ color_format, depth_mode, duration_sec });
+            }
+        }
+    }
+    return parameters;
+}
+
+class playback_throughput_perf : public ::testing::Test,
+                                 public ::testing::WithParamInterface<playback_throughput_parameters>
+{
+protected:
+    void SetUp() override
+    {
+        const playback_throughput_parameters &parameters = GetParam();
+        m_path = g_output_path + "/playback_throughput_perf_" + std::to_string((int)parameters.color_format) + "_" +
+                 std::to_string((int)parameters.depth_mode) + "_" + std::to_string(parameters.duration_sec) + ".mkv";
+
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_NO_FATAL_FAILURE(create_recording(parameters));
+        auto stop = std::chrono::steady_clock::now();
+
+        FILE *file = fopen(m_path.c_str(), "rb");
+        ASSERT_NE(file, nullptr);
+        fseek(file, 0, SEEK_END);
+        m_file_size = (uint64_t)ftell(file);
+        fclose(file);
+
+        printf("%s: %u captures, %.1f MB, generated in %.1f ms\n",
+               m_path.c_str(),
+               m_capture_count,
+               (double)m_file_size / 1000000.0,
+               (double)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() / 1000.0);
+    }
+
+    void TearDown() override
+    {
+        std::remove(m_path.c_str());
+    }
+
+    void create_recording(const playback_throughput_parameters &parameters)
+    {
+        k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+        config.color_format = parameters.color_format;
+        config.color_resolution = K4A_COLOR_RESOLUTION_720P;
+        config.depth_mode = parameters.depth_mode;
+        config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+        uint32_t color_width = 0, color_height = 0, depth_width = 0, depth_height = 0;
+        ASSERT_TRUE(k4a_convert_resolution_to_width_height(config.color_resolution, &color_width, &color_height));
+        ASSERT_TRUE(k4a_convert_depth_mode_to_width_height(config.depth_mode, &depth_width, &depth_height));
+
+        k4a_record_t recording = NULL;
+        ASSERT_EQ(k4a_record_create(m_path.c_str(), NULL, config, &recording), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_record_add_imu_track(recording), K4A_RESULT_SUCCEEDED);
+
+        k4a_record_subtitle_settings_t subtitle_settings = {};
+        ASSERT_EQ(k4a_record_add_custom_subtitle_track(
+                      recording, custom_track_name, "S_K4A/CUSTOM_TRACK", nullptr, 0, &subtitle_settings),
+                  K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_record_write_header(recording), K4A_RESULT_SUCCEEDED);
+
+        uint32_t frame_period_usec = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+        m_capture_count = parameters.duration_sec * 1000000 / frame_period_usec;
+
+        uint64_t imu_timestamp_usec = 0;
+        for (uint32_t i = 0; i < m_capture_count; i++)
+        {
+            uint64_t timestamp_usec = (uint64_t)i * frame_period_usec;
+            uint8_t fill = (uint8_t)i;
+
+            k4a_capture_t capture = NULL;
+            ASSERT_EQ(k4a_capture_create(&capture), K4A_RESULT_SUCCEEDED);
+
+            k4a_image_t image =
+                create_full_size_image(timestamp_usec, config.color_format, color_width, color_height, fill);
+            ASSERT_NE(image, nullptr);
+            k4a_capture_set_color_image(capture, image);
+            k4a_image_release(image);
+
+            if (config.depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+            {
+                image = create_full_size_image(
+                    timestamp_usec, K4A_IMAGE_FORMAT_DEPTH16, depth_width, depth_height, fill);
+                ASSERT_NE(image, nullptr);
+                k4a_capture_set_depth_image(capture, image);
+                k4a_image_release(image);
+            }
+
+            image = create_full_size_image(timestamp_usec, K4A_IMAGE_FORMAT_IR16, depth_width, depth_height, fill);
+            ASSERT_NE(image, nullptr);
+            k4a_capture_set_ir_image(capture, image);
+            k4a_image_release(image);
+
+            ASSERT_EQ(k4a_record_write_capture(recording, capture), K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+
+            for (; imu_timestamp_usec < timestamp_usec + frame_period_usec; imu_timestamp_usec += imu_period_usec)
+            {
+                ASSERT_EQ(k4a_record_write_imu_sample(recording, create_test_imu_sample(imu_timestamp_usec)),
+                          K4A_RESULT_SUCCEEDED);
+            }
+
+            std::vector<uint8_t> block = create_test_custom_track_block(timestamp_usec);
+            ASSERT_EQ(k4a_record_write_custom_track_data(
+                          recording, custom_track_name, timestamp_usec, block.data(), block.size()),
+                      K4A_RESULT_SUCCEEDED);
+        }
+
+        ASSERT_EQ(k4a_record_flush(recording), K4A_RESULT_SUCCEEDED);
+        k4a_record_close(recording);
+    }
+
+    static uint64_t get_capture_size(k4a_capture_t capture)
+    {
+        uint64_t size = 0;
+        k4a_image_t images[] = { k4a_capture_get_color_image(capture),
+                                 k4a_capture_get_depth_image(capture),
+                                 k4a_capture_get_ir_image(capture) };
+        for (k4a_image_t image : images)
+        {
+            if (image)
+            {
+                size += k4a_image_get_size(image);
+                k4a_image_release(image);
+            }
+        }
+        return size;
+    }
+
+    // Drops the recording from the page cache before each measurement when measuring uncached reads
+    void prepare_cache(bool cached)
+    {
+        if (!cached)
+        {
+            ASSERT_TRUE(drop_file_from_page_cache(m_path.c_str()));
+        }
+    }
+
+    void measure(bool cached)
+    {
+        const char *cache_name = cached ? "cached" : "uncached";
+        bool peak_rss_reset = reset_peak_rss();
+
+        // Open
+        k4a_playback_t playback = NULL;
+        prepare_cache(cached);
+        auto start = std::chrono::steady_clock::now();
+        ASSERT_EQ(k4a_playback_open(m_path.c_str(), &playback), K4A_RESULT_SUCCEEDED);
+        auto stop = std::chrono::steady_clock::now();
+        print_result(cache_name, "open", stop - start, 0, 0, "");
+
+        // Sequential reads
+        prepare_cache(cached);
+        uint64_t bytes = 0;
+        uint32_t count = 0;
+        k4a_capture_t capture = NULL;
+        start = std::chrono::steady_clock::now();
+        while (k4a_playback_get_next_capture(playback, &capture) == K4A_STREAM_RESULT_SUCCEEDED)
+        {
+            bytes += get_capture_size(capture);
+            k4a_capture_release(capture);
+            count++;
+        }
+        stop = std::chrono::steady_clock::now();
+        ASSERT_EQ(count, m_capture_count);
+        print_result(cache_name, "sequential forward", stop - start, bytes, count, "captures");
+
+        // Backward iteration
+        prepare_cache(cached);
+        ASSERT_EQ(k4a_playback_seek_timestamp(playback, 0, K4A_PLAYBACK_SEEK_END), K4A_RESULT_SUCCEEDED);
+        bytes = 0;
+        count = 0;
+        start = std::chrono::steady_clock::now();
+        while (k4a_playback_get_previous_capture(playback, &capture) == K4A_STREAM_RESULT_SUCCEEDED)
+        {
+            bytes += get_capture_size(capture);
+            k4a_capture_release(capture);
+            count++;
+        }
+        stop = std::chrono::steady_clock::now();
+        ASSERT_EQ(count, m_capture_count);
+        print_result(cache_name, "sequential backward", stop - start, bytes, count, "captures");
+
+        // Random seeks, each followed by reading the capture at the new position
+        prepare_cache(cached);
+        uint64_t length_usec = k4a_playback_get_recording_length_usec(playback);
+        std::mt19937 random(0);
+        std::uniform_int_distribution<uint64_t> distribution(0, length_usec);
+        std::vector<int64_t> seek_latencies_usec;
+        for (int i = 0; i < g_seek_count; i++)
+        {
+            int64_t offset_usec = (int64_t)distribution(random);
+            start = std::chrono::steady_clock::now();
+            ASSERT_EQ(k4a_playback_seek_timestamp(playback, offset_usec, K4A_PLAYBACK_SEEK_BEGIN),
+                      K4A_RESULT_SUCCEEDED);
+            k4a_stream_result_t result = k4a_playback_get_next_capture(playback, &capture);
+            stop = std::chrono::steady_clock::now();
+            ASSERT_NE(result, K4A_STREAM_RESULT_FAILED);
+            if (result == K4A_STREAM_RESULT_SUCCEEDED)
+            {
+                k4a_capture_release(capture);
+            }
+            seek_latencies_usec.push_back(std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count());
+        }
+        printf("    %-8s %-20s p50 %8lld usec  p90 %8lld usec  p99 %8lld usec  max %8lld usec\n",
+               cache_name,
+               "random seek + read",
+               (long long)ut_perf_get_percentile(seek_latencies_usec, 0.50),
+               (long long)ut_perf_get_percentile(seek_latencies_usec, 0.90),
+               (long long)ut_perf_get_percentile(seek_latencies_usec, 0.99),
+               (long long)ut_perf_get_percentile(seek_latencies_usec, 1.0));
+
+        // IMU samples
+        prepare_cache(cached);
+        ASSERT_EQ(k4a_playback_seek_timestamp(playback, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+        k4a_imu_sample_t imu_sample;
+        count = 0;
+        start = std::chrono::steady_clock::now();
+        while (k4a_playback_get_next_imu_sample(playback, &imu_sample) == K4A_STREAM_RESULT_SUCCEEDED)
+        {
+            count++;
+        }
+        stop = std::chrono::steady_clock::now();
+        ASSERT_GT(count, 0u);
+        print_result(cache_name, "IMU samples", stop - start, count * sizeof(k4a_imu_sample_t), count, "samples");
+
+        // Custom track blocks
+        prepare_cache(cached);
+        ASSERT_EQ(k4a_playback_seek_timestamp(playback, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+        k4a_playback_data_block_t block = NULL;
+        bytes = 0;
+        count = 0;
+        start = std::chrono::steady_clock::now();
+        while (k4a_playback_get_next_data_block(playback, custom_track_name, &block) == K4A_STREAM_RESULT_SUCCEEDED)
+        {
+            bytes += k4a_playback_data_block_get_buffer_size(block);
+            k4a_playback_data_block_release(block);
+            count++;
+        }
+        stop = std::chrono::steady_clock::now();
+        ASSERT_EQ(count, m_capture_count);
+        print_result(cache_name, "custom track blocks", stop - start, bytes, count, "blocks");
+
+        k4a_playback_close(playback);
+
+        printf("    %-8s %-20s %.1f MB%s\n",
+               cache_name,
+               "peak RSS",
+               (double)get_peak_rss_bytes() / 1000000.0,
+               peak_rss_reset ? "" : " (since process start)");
+    }
+
+    void print_result(const char *cache_name,
+                      const char *name,
+                      std::chrono::steady_clock::duration duration,
+                      uint64_t bytes,
+                      uint32_t count,
+                      const char *unit)
+    {
+        double seconds = (double)std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000000.0;
+        if (count == 0)
+        {
+            printf("    %-8s %-20s %10.3f ms\n", cache_name, name, seconds * 1000.0);
+            return;
+        }
+
+        printf("    %-8s %-20s %10.3f ms  %9.1f MB/s  %10.1f %s/s\n",
+               cache_name,
+               name,
+               seconds * 1000.0,
+               seconds > 0 ? (double)bytes / 1000000.0 / seconds : 0.0,
+               seconds > 0 ? count / seconds : 0.0,
+               unit);
+    }
+
+    std::string m_path;
+    uint64_t m_file_size = 0;
+    uint32_t m_capture_count = 0;
+};
+
+TEST_P(playback_throughput_perf, read_throughput)
+{
+    // The file was just written, so the first pass reads it from the page cache
+    ASSERT_NO_FATAL_FAILURE(measure(true));
+    ASSERT_NO_FATAL_FAILURE(measure(false));
+}
+
+INSTANTIATE_TEST_CASE_P(playback_throughput_perf, playback_throughput_perf, ValuesIn(get_perf_parameters()));
+
+int main(int argc, char **argv)
+{
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--path") == 0 && i + 1 < argc)
+        {
+            g_output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--seeks") == 0 && i + 1 < argc)
+        {
+            g_seek_count = (int)strtol(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: playback_throughput_perf [gtest options] [--path <directory>] [--seeks <count>]\n");
+            return 1;
+        }
+    }
+
+    if (g_seek_count < 1)
+    {
+        printf("--seeks must be at least 1\n");
+        return 1;
+    }
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
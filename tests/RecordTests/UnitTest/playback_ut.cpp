@@ -10,6 +10,12 @@
 #include <fstream>
 #include <thread>
 #include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <turbojpeg.h>
+#include <libyuv.h>
+#include <k4arecord/record.h>
 
 // Module being tested
 #include <k4arecord/playback.h>
@@ -255,6 +261,70 @@ TEST_F(playback_ut, open_subordinate_delay_file)
     k4a_playback_close(handle);
 }
 
+TEST_F(playback_ut, open_playback_group)
+{
+    // Standalone recordings can't be aligned with the master.
+    const char *standalone_paths[] = { "record_test_master.mkv", "record_test_full.mkv" };
+    k4a_playback_group_t group = NULL;
+    ASSERT_EQ(k4a_playback_group_open(standalone_paths, arraysize(standalone_paths), &group), K4A_RESULT_FAILED);
+    ASSERT_EQ(group, (k4a_playback_group_t)NULL);
+
+    const char *paths[] = { "record_test_sub.mkv", "record_test_master.mkv" };
+    k4a_result_t result = k4a_playback_group_open(paths, arraysize(paths), &group);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_group_get_count(group), arraysize(paths));
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_group_get_record_configuration(group, 0, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(config.wired_sync_mode, K4A_WIRED_SYNC_MODE_SUBORDINATE);
+    uint64_t sub_delay = config.subordinate_delay_off_master_usec;
+
+    result = k4a_playback_group_get_record_configuration(group, 1, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(config.wired_sync_mode, K4A_WIRED_SYNC_MODE_MASTER);
+    ASSERT_EQ(k4a_playback_group_get_record_configuration(group, 2, &config), K4A_RESULT_FAILED);
+
+    uint64_t timestamps[3] = { 0, 0, 0 };
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    // The single subordinate capture is aligned with the first master capture, ties are returned in index order.
+    k4a_capture_t capture = NULL;
+    size_t index = 0;
+    k4a_stream_result_t stream_result = k4a_playback_group_get_next_capture(group, &capture, &index);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_EQ(index, (size_t)0);
+    uint64_t sub_timestamps[3] = { sub_delay, sub_delay, sub_delay };
+    ASSERT_TRUE(validate_test_capture(capture,
+                                      sub_timestamps,
+                                      config.color_format,
+                                      config.color_resolution,
+                                      config.depth_mode));
+    k4a_capture_release(capture);
+
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        stream_result = k4a_playback_group_get_next_capture(group, &capture, &index);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_EQ(index, (size_t)1);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+
+    stream_result = k4a_playback_group_get_next_capture(group, &capture, NULL);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    k4a_playback_group_close(group);
+}
+
 TEST_F(playback_ut, playback_seek_test)
 {
     k4a_playback_t handle = NULL;
@@ -703,6 +773,234 @@ TEST_F(playback_ut, open_skipped_frames_file)
     k4a_playback_close(handle);
 }
 
+static void validate_capture_info(k4a_playback_image_info_t *info, k4a_image_t image)
+{
+    if (image == NULL)
+    {
+        ASSERT_FALSE(info->present);
+    }
+    else
+    {
+        ASSERT_TRUE(info->present);
+        ASSERT_EQ(info->device_timestamp_usec, k4a_image_get_device_timestamp_usec(image));
+        ASSERT_EQ(info->size, k4a_image_get_size(image));
+        k4a_image_release(image);
+    }
+}
+
+TEST_F(playback_ut, capture_info_matches_captures)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_skips.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // The capture info position is independent of the capture position, so reading both in lockstep should return the
+    // same sequence, including the captures with dropped images.
+    k4a_capture_t capture = NULL;
+    k4a_playback_capture_info_t info;
+    size_t capture_count = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        while (true)
+        {
+            k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+            k4a_stream_result_t info_result = k4a_playback_get_next_capture_info(handle, &info);
+            ASSERT_EQ(stream_result, info_result);
+            if (stream_result == K4A_STREAM_RESULT_EOF)
+            {
+                break;
+            }
+            ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+
+            validate_capture_info(&info.color, k4a_capture_get_color_image(capture));
+            validate_capture_info(&info.depth, k4a_capture_get_depth_image(capture));
+            validate_capture_info(&info.ir, k4a_capture_get_ir_image(capture));
+            k4a_capture_release(capture);
+            capture_count++;
+        }
+
+        // Seeking moves both positions, check the second half of the recording again.
+        result = k4a_playback_seek_timestamp(handle,
+                                             (int64_t)k4a_playback_get_recording_length_usec(handle) / 2,
+                                             K4A_PLAYBACK_SEEK_BEGIN);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    }
+    ASSERT_GT(capture_count, test_frame_count);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_disabled_tracks)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    ASSERT_EQ(k4a_playback_set_track_enabled(handle, "UNKNOWN_TRACK", false), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_set_track_enabled(handle, K4A_TRACK_NAME_COLOR, false), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_track_enabled(handle, K4A_TRACK_NAME_IMU, false), K4A_RESULT_SUCCEEDED);
+
+    // Captures should only contain depth and IR images.
+    k4a_capture_t capture = NULL;
+    k4a_stream_result_t stream_result = K4A_STREAM_RESULT_FAILED;
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+    size_t half = test_frame_count / 2;
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        if (i == half)
+        {
+            // Enabling a track continues from the current playback position, with images of the enabled track.
+            ASSERT_EQ(k4a_playback_set_track_enabled(handle, K4A_TRACK_NAME_COLOR, true), K4A_RESULT_SUCCEEDED);
+        }
+
+        stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          i < half ? K4A_COLOR_RESOLUTION_OFF : config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+    stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    k4a_imu_sample_t imu_sample = { 0 };
+    stream_result = k4a_playback_get_next_imu_sample(handle, &imu_sample);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    // Enabling a track at the end of the recording stays at the end.
+    ASSERT_EQ(k4a_playback_set_track_enabled(handle, K4A_TRACK_NAME_COLOR, false), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_track_enabled(handle, K4A_TRACK_NAME_COLOR, true), K4A_RESULT_SUCCEEDED);
+    stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_cursors)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    k4a_playback_cursor_t cursors[2] = { NULL, NULL };
+    ASSERT_EQ(k4a_playback_cursor_create(handle, &cursors[0]), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_cursor_create(handle, &cursors[1]), K4A_RESULT_SUCCEEDED);
+
+    size_t half = test_frame_count / 2;
+    result = k4a_playback_cursor_seek_timestamp(cursors[1], (int64_t)(half * timestamp_delta), K4A_PLAYBACK_SEEK_BEGIN);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    // Returns the number of captures read from the cursor that match the expected timestamps.
+    auto read_range = [&](k4a_playback_cursor_t cursor, size_t first, size_t count) {
+        size_t valid = 0;
+        uint64_t timestamps[3] = { first * timestamp_delta,
+                                   first * timestamp_delta + 1000,
+                                   first * timestamp_delta + 1000 };
+        for (size_t i = 0; i < count; i++)
+        {
+            k4a_capture_t capture = NULL;
+            if (k4a_playback_cursor_get_next_capture(cursor, &capture) != K4A_STREAM_RESULT_SUCCEEDED)
+            {
+                break;
+            }
+            if (validate_test_capture(capture,
+                                      timestamps,
+                                      config.color_format,
+                                      config.color_resolution,
+                                      config.depth_mode))
+            {
+                valid++;
+            }
+            k4a_capture_release(capture);
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+        return valid;
+    };
+
+    // Each cursor reads half of the recording on its own thread.
+    size_t valid_counts[2] = { 0, 0 };
+    std::thread first_half([&] { valid_counts[0] = read_range(cursors[0], 0, half); });
+    std::thread second_half([&] { valid_counts[1] = read_range(cursors[1], half, test_frame_count - half); });
+
+    // The playback handle's position is not affected by the cursors. Check the result after joining, a failed assert
+    // must not return while the threads are still running.
+    uint64_t timestamps[3] = { 0, 1000, 1000 };
+    k4a_capture_t capture = NULL;
+    k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+    bool handle_valid = stream_result == K4A_STREAM_RESULT_SUCCEEDED &&
+                        validate_test_capture(
+                            capture, timestamps, config.color_format, config.color_resolution, config.depth_mode);
+    if (capture != NULL)
+    {
+        k4a_capture_release(capture);
+    }
+
+    first_half.join();
+    second_half.join();
+    ASSERT_TRUE(handle_valid);
+    ASSERT_EQ(valid_counts[0], half);
+    ASSERT_EQ(valid_counts[1], test_frame_count - half);
+
+    stream_result = k4a_playback_cursor_get_next_capture(cursors[1], &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    ASSERT_EQ(k4a_playback_cursor_seek_timestamp(cursors[1], 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+    k4a_imu_sample_t imu_sample = { 0 };
+    stream_result = k4a_playback_cursor_get_next_imu_sample(cursors[1], &imu_sample);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(validate_imu_sample(imu_sample, 1150));
+
+    k4a_playback_cursor_destroy(cursors[0]);
+    k4a_playback_cursor_destroy(cursors[1]);
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, playback_close_with_open_cursor)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 2), K4A_RESULT_SUCCEEDED);
+
+    k4a_playback_cursor_t cursor = NULL;
+    ASSERT_EQ(k4a_playback_cursor_create(handle, &cursor), K4A_RESULT_SUCCEEDED);
+
+    k4a_capture_t capture = NULL;
+    ASSERT_EQ(k4a_playback_cursor_get_next_capture(cursor, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    k4a_capture_release(capture);
+
+    // The open cursor keeps the recording open after the playback handle is closed, until the cursor is destroyed.
+    k4a_playback_close(handle);
+
+    capture = NULL;
+    ASSERT_EQ(k4a_playback_cursor_get_next_capture(cursor, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_NE(capture, nullptr);
+    k4a_capture_release(capture);
+    ASSERT_EQ(k4a_playback_cursor_seek_timestamp(cursor, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+    k4a_imu_sample_t imu_sample = {};
+    ASSERT_EQ(k4a_playback_cursor_get_next_imu_sample(cursor, &imu_sample), K4A_STREAM_RESULT_SUCCEEDED);
+
+    k4a_playback_cursor_destroy(cursor);
+}
+
 TEST_F(playback_ut, open_imu_playback_file)
 {
     k4a_playback_t handle = NULL;
@@ -789,6 +1087,66 @@ TEST_F(playback_ut, open_imu_playback_file)
     k4a_playback_close(handle);
 }
 
+TEST_F(playback_ut, playback_get_imu_samples)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_full.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    uint64_t recording_length = k4a_playback_get_recording_length_usec(handle);
+    ASSERT_EQ(recording_length, 3333150);
+
+    // Use a buffer smaller than an IMU block so that batches start and end within blocks.
+    k4a_imu_sample_t imu_samples[7];
+    size_t sample_count = 0;
+    k4a_stream_result_t stream_result = k4a_playback_get_imu_samples(handle, 0, 0, imu_samples, 0, &sample_count);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_FAILED);
+    stream_result = k4a_playback_get_imu_samples(handle, 10, 5, imu_samples, arraysize(imu_samples), &sample_count);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_FAILED);
+
+    // Read the whole recording in batches.
+    uint64_t imu_timestamp = 1150;
+    uint64_t start_timestamp = 0;
+    do
+    {
+        stream_result = k4a_playback_get_imu_samples(
+            handle, start_timestamp, UINT64_MAX, imu_samples, arraysize(imu_samples), &sample_count);
+        ASSERT_NE(stream_result, K4A_STREAM_RESULT_FAILED);
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            ASSERT_TRUE(validate_imu_sample(imu_samples[i], imu_timestamp));
+            imu_timestamp += 1000;
+        }
+        if (sample_count > 0)
+        {
+            start_timestamp = imu_samples[sample_count - 1].acc_timestamp_usec + 1;
+        }
+    } while (sample_count == arraysize(imu_samples));
+    ASSERT_GT(imu_timestamp, recording_length);
+
+    // Read a range within the recording, the end timestamp is exclusive.
+    stream_result =
+        k4a_playback_get_imu_samples(handle, 5000, 8150, imu_samples, arraysize(imu_samples), &sample_count);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_EQ(sample_count, (size_t)3);
+    ASSERT_TRUE(validate_imu_sample(imu_samples[0], 5150));
+    ASSERT_TRUE(validate_imu_sample(imu_samples[2], 7150));
+
+    // A range past the end of the recording has no samples.
+    stream_result = k4a_playback_get_imu_samples(
+        handle, recording_length + 1000, UINT64_MAX, imu_samples, arraysize(imu_samples), &sample_count);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+    ASSERT_EQ(sample_count, (size_t)0);
+
+    // The bulk read does not affect the playback position.
+    k4a_imu_sample_t imu_sample = { 0 };
+    stream_result = k4a_playback_get_next_imu_sample(handle, &imu_sample);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+    ASSERT_TRUE(validate_imu_sample(imu_sample, 1150));
+
+    k4a_playback_close(handle);
+}
+
 TEST_F(playback_ut, open_start_offset_file)
 {
     k4a_playback_t handle = NULL;
@@ -987,6 +1345,143 @@ TEST_F(playback_ut, open_depth_only_file)
     k4a_playback_close(handle);
 }
 
+TEST_F(playback_ut, open_rvl_depth_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_rvl_depth.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(config.depth_mode, K4A_DEPTH_MODE_NFOV_UNBINNED);
+    ASSERT_TRUE(config.depth_track_enabled);
+    ASSERT_TRUE(config.ir_track_enabled);
+
+    char codec_id[32];
+    size_t codec_id_size = sizeof(codec_id);
+    ASSERT_EQ(k4a_playback_track_get_codec_id(handle, K4A_TRACK_NAME_DEPTH, codec_id, &codec_id_size),
+              K4A_BUFFER_RESULT_SUCCEEDED);
+    ASSERT_STREQ(codec_id, "V_K4A/RVL");
+
+    uint64_t timestamps[3] = { 0, 0, 0 };
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    k4a_capture_t capture = NULL;
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+
+    k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+    ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, open_rvl_depth_file_decode_ahead)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_rvl_depth.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, PLAYBACK_MAX_DECODE_AHEAD_COUNT + 1), K4A_RESULT_FAILED);
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 4), K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    // Read the file twice, the seek must discard any images that were already decoded ahead.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        uint64_t timestamps[3] = { 0, 0, 0 };
+        k4a_capture_t capture = NULL;
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+            ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+            ASSERT_TRUE(validate_test_capture(capture,
+                                              timestamps,
+                                              config.color_format,
+                                              config.color_resolution,
+                                              config.depth_mode));
+            k4a_capture_release(capture);
+
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+
+            if (pass == 1 && i == test_frame_count / 2)
+            {
+                // Turning decode ahead off while images are queued must not leak or reorder them.
+                ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 0), K4A_RESULT_SUCCEEDED);
+            }
+        }
+
+        k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_EOF);
+
+        ASSERT_EQ(k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_BEGIN), K4A_RESULT_SUCCEEDED);
+    }
+
+    k4a_playback_close(handle);
+}
+
+TEST_F(playback_ut, open_zero_copy_file)
+{
+    k4a_playback_t handle = NULL;
+    k4a_result_t result = k4a_playback_open("record_test_zero_copy.mkv", &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_configuration_t config;
+    result = k4a_playback_get_record_configuration(handle, &config);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    ASSERT_TRUE(config.color_track_enabled);
+    ASSERT_TRUE(config.depth_track_enabled);
+    ASSERT_TRUE(config.ir_track_enabled);
+
+    // Zero-copy recordings use the same b16g format as regular recordings.
+    char codec_id[32];
+    size_t codec_id_size = sizeof(codec_id);
+    ASSERT_EQ(k4a_playback_track_get_codec_id(handle, K4A_TRACK_NAME_DEPTH, codec_id, &codec_id_size),
+              K4A_BUFFER_RESULT_SUCCEEDED);
+    ASSERT_STREQ(codec_id, "V_MS/VFW/FOURCC");
+
+    uint64_t timestamps[3] = { 0, 0, 0 };
+    uint64_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+
+    k4a_capture_t capture = NULL;
+    for (size_t i = 0; i < test_frame_count; i++)
+    {
+        k4a_stream_result_t stream_result = k4a_playback_get_next_capture(handle, &capture);
+        ASSERT_EQ(stream_result, K4A_STREAM_RESULT_SUCCEEDED);
+        ASSERT_TRUE(validate_test_capture(capture,
+                                          timestamps,
+                                          config.color_format,
+                                          config.color_resolution,
+                                          config.depth_mode));
+        k4a_capture_release(capture);
+
+        timestamps[0] += timestamp_delta;
+        timestamps[1] += timestamp_delta;
+        timestamps[2] += timestamp_delta;
+    }
+
+    k4a_playback_close(handle);
+}
+
 TEST_F(playback_ut, open_bgra_color_file)
 {
     k4a_playback_t handle = NULL;
@@ -1022,6 +1517,315 @@ TEST_F(playback_ut, open_bgra_color_file)
     k4a_playback_close(handle);
 }
 
+static const char *const mjpeg_test_file = "record_test_mjpeg_decode.mkv";
+static const int mjpeg_test_width = 1280;
+static const int mjpeg_test_height = 720;
+static const size_t mjpeg_test_frame_count = 6;
+
+// Decoded NV12 and YUY2 images are compared to the BGRA decode after converting them back to BGRA. This covers
+// the rounding of the colorspace conversions and the different chroma upsampling of each path.
+static const int mjpeg_test_tolerance = 8;
+
+// Writes a color only recording with real jpeg data. Frames cycle through 4:2:2 (the color camera's subsampling),
+// 4:2:0, and 4:4:4, which can't be decoded straight to NV12 or YUY2 and falls back to the BGRA path.
+static void create_mjpeg_test_recording()
+{
+    static const int subsamplings[] = { TJSAMP_422, TJSAMP_420, TJSAMP_444 };
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+    config.color_resolution = K4A_COLOR_RESOLUTION_720P;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    k4a_record_t handle = NULL;
+    ASSERT_EQ(k4a_record_create(mjpeg_test_file, NULL, config, &handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_record_write_header(handle), K4A_RESULT_SUCCEEDED);
+
+    tjhandle encoder = tjInitCompress();
+    ASSERT_NE(encoder, nullptr);
+
+    std::vector<uint8_t> bgra((size_t)(mjpeg_test_width * mjpeg_test_height * 4));
+    for (size_t i = 0; i < mjpeg_test_frame_count; i++)
+    {
+        // A smooth pattern that moves each frame, so images can't be mixed up between frames.
+        for (int y = 0; y < mjpeg_test_height; y++)
+        {
+            for (int x = 0; x < mjpeg_test_width; x++)
+            {
+                uint8_t *pixel = &bgra[(size_t)((y * mjpeg_test_width + x) * 4)];
+                pixel[0] = (uint8_t)(x * 255 / (mjpeg_test_width - 1));
+                pixel[1] = (uint8_t)(y * 255 / (mjpeg_test_height - 1));
+                pixel[2] = (uint8_t)(128 + 100 * std::sin((x + 37 * (int)i) / 40.0) * std::cos(y / 30.0));
+                pixel[3] = 0xFF;
+            }
+        }
+
+        unsigned char *jpeg = NULL;
+        unsigned long jpeg_size = 0;
+        ASSERT_EQ(tjCompress2(encoder,
+                              bgra.data(),
+                              mjpeg_test_width,
+                              0, // pitch
+                              mjpeg_test_height,
+                              TJPF_BGRA,
+                              &jpeg,
+                              &jpeg_size,
+                              subsamplings[i % arraysize(subsamplings)],
+                              90,
+                              0),
+                  0);
+
+        k4a_image_t image = NULL;
+        ASSERT_EQ(k4a_image_create_from_buffer(K4A_IMAGE_FORMAT_COLOR_MJPG,
+                                               mjpeg_test_width,
+                                               mjpeg_test_height,
+                                               0,
+                                               jpeg,
+                                               jpeg_size,
+                                               [](void *_buffer, void *context) {
+                                                   tjFree((unsigned char *)_buffer);
+                                                   (void)context;
+                                               },
+                                               NULL,
+                                               &image),
+                  K4A_RESULT_SUCCEEDED);
+        k4a_image_set_device_timestamp_usec(image, i * test_timestamp_delta_usec);
+
+        k4a_capture_t capture = NULL;
+        ASSERT_EQ(k4a_capture_create(&capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_set_color_image(capture, image);
+        k4a_image_release(image);
+
+        ASSERT_EQ(k4a_record_write_capture(handle, capture), K4A_RESULT_SUCCEEDED);
+        k4a_capture_release(capture);
+    }
+
+    tjDestroy(encoder);
+    ASSERT_EQ(k4a_record_flush(handle), K4A_RESULT_SUCCEEDED);
+    k4a_record_close(handle);
+}
+
+// Returns the largest difference of any B, G or R value between a color image and the BGRA reference, or -1 if the
+// image has the wrong format or size. NV12 and YUY2 are converted with libyuv, like k4a_playback does for recordings
+// stored in those formats.
+static int get_max_color_difference(k4a_image_t image, k4a_image_format_t format, const std::vector<uint8_t> &reference)
+{
+    if (image == NULL || k4a_image_get_format(image) != format ||
+        k4a_image_get_width_pixels(image) != mjpeg_test_width ||
+        k4a_image_get_height_pixels(image) != mjpeg_test_height)
+    {
+        return -1;
+    }
+
+    const uint8_t *buffer = k4a_image_get_buffer(image);
+    int stride = k4a_image_get_stride_bytes(image);
+    std::vector<uint8_t> bgra((size_t)(mjpeg_test_width * mjpeg_test_height * 4));
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        if (stride != mjpeg_test_width * 4)
+        {
+            return -1;
+        }
+        memcpy(bgra.data(), buffer, bgra.size());
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        if (stride != mjpeg_test_width ||
+            k4a_image_get_size(image) != (size_t)(mjpeg_test_width * mjpeg_test_height * 3 / 2) ||
+            libyuv::NV12ToARGB(buffer,
+                               stride,
+                               buffer + stride * mjpeg_test_height,
+                               stride,
+                               bgra.data(),
+                               mjpeg_test_width * 4,
+                               mjpeg_test_width,
+                               mjpeg_test_height) != 0)
+        {
+            return -1;
+        }
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        if (stride != mjpeg_test_width * 2 ||
+            k4a_image_get_size(image) != (size_t)(mjpeg_test_width * mjpeg_test_height * 2) ||
+            libyuv::YUY2ToARGB(
+                buffer, stride, bgra.data(), mjpeg_test_width * 4, mjpeg_test_width, mjpeg_test_height) != 0)
+        {
+            return -1;
+        }
+        break;
+    default:
+        return -1;
+    }
+
+    int max_difference = 0;
+    for (size_t i = 0; i < bgra.size(); i++)
+    {
+        // Skip alpha
+        if (i % 4 != 3)
+        {
+            max_difference = std::max(max_difference, std::abs((int)bgra[i] - (int)reference[i]));
+        }
+    }
+    return max_difference;
+}
+
+// Reads the BGRA decode of every frame in the MJPG test recording.
+static std::vector<std::vector<uint8_t>> read_mjpeg_reference_frames()
+{
+    std::vector<std::vector<uint8_t>> frames;
+    k4a_playback_t handle = NULL;
+    if (k4a_playback_open(mjpeg_test_file, &handle) != K4A_RESULT_SUCCEEDED)
+    {
+        return frames;
+    }
+
+    if (k4a_playback_set_color_conversion(handle, K4A_IMAGE_FORMAT_COLOR_BGRA32) == K4A_RESULT_SUCCEEDED)
+    {
+        k4a_capture_t capture = NULL;
+        while (k4a_playback_get_next_capture(handle, &capture) == K4A_STREAM_RESULT_SUCCEEDED)
+        {
+            k4a_image_t image = k4a_capture_get_color_image(capture);
+            if (image != NULL)
+            {
+                uint8_t *buffer = k4a_image_get_buffer(image);
+                frames.emplace_back(buffer, buffer + k4a_image_get_size(image));
+                k4a_image_release(image);
+            }
+            k4a_capture_release(capture);
+        }
+    }
+
+    k4a_playback_close(handle);
+    return frames;
+}
+
+TEST_F(playback_ut, mjpeg_color_conversion)
+{
+    create_mjpeg_test_recording();
+    if (HasFatalFailure())
+    {
+        return;
+    }
+
+    std::vector<std::vector<uint8_t>> reference = read_mjpeg_reference_frames();
+    ASSERT_EQ(reference.size(), mjpeg_test_frame_count);
+
+    const k4a_image_format_t formats[] = { K4A_IMAGE_FORMAT_COLOR_NV12, K4A_IMAGE_FORMAT_COLOR_YUY2 };
+    for (k4a_image_format_t format : formats)
+    {
+        k4a_playback_t handle = NULL;
+        ASSERT_EQ(k4a_playback_open(mjpeg_test_file, &handle), K4A_RESULT_SUCCEEDED);
+        ASSERT_EQ(k4a_playback_set_color_conversion(handle, format), K4A_RESULT_SUCCEEDED);
+
+        for (size_t i = 0; i < mjpeg_test_frame_count; i++)
+        {
+            k4a_capture_t capture = NULL;
+            ASSERT_EQ(k4a_playback_get_next_capture(handle, &capture), K4A_STREAM_RESULT_SUCCEEDED);
+            k4a_image_t image = k4a_capture_get_color_image(capture);
+            ASSERT_NE(image, nullptr);
+            EXPECT_EQ(k4a_image_get_device_timestamp_usec(image), i * test_timestamp_delta_usec);
+
+            int difference = get_max_color_difference(image, format, reference[i]);
+            EXPECT_GE(difference, 0) << format_names[format] << " frame " << i;
+            EXPECT_LE(difference, mjpeg_test_tolerance) << format_names[format] << " frame " << i;
+
+            k4a_image_release(image);
+            k4a_capture_release(capture);
+        }
+
+        k4a_playback_close(handle);
+    }
+
+    ASSERT_EQ(std::remove(mjpeg_test_file), 0);
+}
+
+TEST_F(playback_ut, mjpeg_decoder_reuse)
+{
+    create_mjpeg_test_recording();
+    if (HasFatalFailure())
+    {
+        return;
+    }
+
+    std::vector<std::vector<uint8_t>> reference = read_mjpeg_reference_frames();
+    ASSERT_EQ(reference.size(), mjpeg_test_frame_count);
+
+    k4a_playback_t handle = NULL;
+    ASSERT_EQ(k4a_playback_open(mjpeg_test_file, &handle), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_color_conversion(handle, K4A_IMAGE_FORMAT_COLOR_NV12), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(k4a_playback_set_decode_ahead(handle, 2), K4A_RESULT_SUCCEEDED);
+
+    const size_t cursor_count = 2;
+    const int pass_count = 3;
+    k4a_playback_cursor_t cursors[cursor_count] = { NULL, NULL };
+    for (size_t c = 0; c < cursor_count; c++)
+    {
+        ASSERT_EQ(k4a_playback_cursor_create(handle, &cursors[c]), K4A_RESULT_SUCCEEDED);
+    }
+
+    // The playback handle and each cursor decode every frame several times on their own threads, sharing the idle
+    // decoders of the playback handle. Each thread returns the number of frames that matched the reference.
+    auto read_passes = [&](k4a_playback_cursor_t cursor) {
+        size_t matched = 0;
+        for (int pass = 0; pass < pass_count; pass++)
+        {
+            k4a_result_t result = cursor ? k4a_playback_cursor_seek_timestamp(cursor, 0, K4A_PLAYBACK_SEEK_BEGIN) :
+                                           k4a_playback_seek_timestamp(handle, 0, K4A_PLAYBACK_SEEK_BEGIN);
+            if (K4A_FAILED(result))
+            {
+                break;
+            }
+
+            for (size_t i = 0; i < mjpeg_test_frame_count; i++)
+            {
+                k4a_capture_t capture = NULL;
+                k4a_stream_result_t stream_result = cursor ? k4a_playback_cursor_get_next_capture(cursor, &capture) :
+                                                             k4a_playback_get_next_capture(handle, &capture);
+                if (stream_result != K4A_STREAM_RESULT_SUCCEEDED)
+                {
+                    break;
+                }
+
+                k4a_image_t image = k4a_capture_get_color_image(capture);
+                int difference = get_max_color_difference(image, K4A_IMAGE_FORMAT_COLOR_NV12, reference[i]);
+                if (difference >= 0 && difference <= mjpeg_test_tolerance &&
+                    k4a_image_get_device_timestamp_usec(image) == i * test_timestamp_delta_usec)
+                {
+                    matched++;
+                }
+                if (image != NULL)
+                {
+                    k4a_image_release(image);
+                }
+                k4a_capture_release(capture);
+            }
+        }
+        return matched;
+    };
+
+    size_t matched_counts[cursor_count] = { 0, 0 };
+    std::thread threads[cursor_count];
+    for (size_t c = 0; c < cursor_count; c++)
+    {
+        threads[c] = std::thread([&, c] { matched_counts[c] = read_passes(cursors[c]); });
+    }
+    size_t handle_matched = read_passes(NULL);
+    for (size_t c = 0; c < cursor_count; c++)
+    {
+        threads[c].join();
+    }
+
+    EXPECT_EQ(handle_matched, pass_count * mjpeg_test_frame_count);
+    for (size_t c = 0; c < cursor_count; c++)
+    {
+        EXPECT_EQ(matched_counts[c], pass_count * mjpeg_test_frame_count) << "cursor " << c;
+        k4a_playback_cursor_destroy(cursors[c]);
+    }
+    k4a_playback_close(handle);
+
+    ASSERT_EQ(std::remove(mjpeg_test_file), 0);
+}
+
 int main(int argc, char **argv)
 {
     k4a_unittest_init();
@@ -0,0 +1,415 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <k4a/k4a.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/matroska_common.h>
+
+#include "test_helpers.h"
+#include <ut_perf_helpers.h>
+
+// Module being tested
+#include <k4arecord/record.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+static std::string g_output_path = ".";
+static int g_camera_count = 1;
+static int g_duration_sec = 10;
+static k4a_fps_t g_camera_fps = K4A_FRAMES_PER_SECOND_30;
+static k4a_image_format_t g_color_format = K4A_IMAGE_FORMAT_COLOR_MJPG;
+static k4a_color_resolution_t g_color_resolution = K4A_COLOR_RESOLUTION_2160P;
+static k4a_depth_mode_t g_depth_mode = K4A_DEPTH_MODE_NFOV_UNBINNED;
+static uint64_t g_memory_budget = 0;
+
+// The IMU reports at 1.6kHz on a device
+static const uint64_t imu_period_usec = 625;
+
+// Clusters older than this trigger the "Disk write speed is too low" error in matroska_writer_thread
+static const uint64_t queue_warning_usec = (uint64_t)(CLUSTER_WRITE_QUEUE_WARNING_NS) / 1000;
+
+struct camera_result
+{
+    bool succeeded = false;
+    uint64_t bytes_written = 0;
+    uint64_t file_size = 0;
+    uint32_t capture_count = 0;
+    double write_seconds = 0;
+    double flush_seconds = 0;
+    uint64_t max_queue_age_usec = 0;
+    uint64_t max_pending_bytes = 0;
+    uint32_t queue_warning_count = 0;
+    uint64_t dropped_count = 0;
+    uint64_t budget_blocked_usec = 0;
+    uint64_t render_usec = 0;
+    uint64_t file_flush_usec = 0;
+    std::vector<int64_t> write_latencies_usec;
+};
+
+// Creates one capture that every frame of a camera reuses. The recording copies the image data on each write, so
+// only the timestamps need to change between frames.
+static k4a_capture_t create_camera_capture(const k4a_device_configuration_t &config)
+{
+    k4a_capture_t capture = NULL;
+    if (K4A_FAILED(k4a_capture_create(&capture)))
+    {
+        return NULL;
+    }
+
+    uint32_t width = 0, height = 0;
+    bool succeeded = true;
+    if (config.color_resolution != K4A_COLOR_RESOLUTION_OFF)
+    {
+        succeeded = k4a_convert_resolution_to_width_height(config.color_resolution, &width, &height);
+        k4a_image_t image = succeeded ? create_full_size_image(0, config.color_format, width, height, 0xAA) : NULL;
+        succeeded = succeeded && image != NULL;
+        k4a_capture_set_color_image(capture, image);
+        k4a_image_release(image);
+    }
+
+    if (succeeded && config.depth_mode != K4A_DEPTH_MODE_OFF)
+    {
+        succeeded = k4a_convert_depth_mode_to_width_height(config.depth_mode, &width, &height);
+        if (succeeded && config.depth_mode != K4A_DEPTH_MODE_PASSIVE_IR)
+        {
+            k4a_image_t image = create_full_size_image(0, K4A_IMAGE_FORMAT_DEPTH16, width, height, 0xAA);
+            succeeded = image != NULL;
+            k4a_capture_set_depth_image(capture, image);
+            k4a_image_release(image);
+        }
+        if (succeeded)
+        {
+            k4a_image_t image = create_full_size_image(0, K4A_IMAGE_FORMAT_IR16, width, height, 0xAA);
+            succeeded = image != NULL;
+            k4a_capture_set_ir_image(capture, image);
+            k4a_image_release(image);
+        }
+    }
+
+    if (!succeeded)
+    {
+        k4a_capture_release(capture);
+        return NULL;
+    }
+    return capture;
+}
+
+static void set_capture_timestamp(k4a_capture_t capture, uint64_t timestamp_usec)
+{
+    k4a_image_t images[] = { k4a_capture_get_color_image(capture),
+                             k4a_capture_get_depth_image(capture),
+                             k4a_capture_get_ir_image(capture) };
+    for (k4a_image_t image : images)
+    {
+        if (image)
+        {
+            k4a_image_set_device_timestamp_usec(image, timestamp_usec);
+            k4a_image_release(image);
+        }
+    }
+}
+
+// Records g_duration_sec of data as one synthetic camera. When paced, captures are written at the camera frame rate
+// like a device would deliver them, otherwise as fast as the recording accepts them.
+static void run_camera(int index, bool paced, camera_result *result)
+{
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.color_format = g_color_format;
+    config.color_resolution = g_color_resolution;
+    config.depth_mode = g_depth_mode;
+    config.camera_fps = g_camera_fps;
+
+    std::string path = g_output_path + "/record_throughput_perf_" + std::to_string(index) + ".mkv";
+
+    k4a_capture_t capture = create_camera_capture(config);
+    if (capture == NULL)
+    {
+        return;
+    }
+
+    k4a_record_t recording = NULL;
+    if (K4A_FAILED(k4a_record_create(path.c_str(), NULL, config, &recording)) ||
+        K4A_FAILED(k4a_record_add_imu_track(recording)) ||
+        (g_memory_budget != 0 &&
+         K4A_FAILED(k4a_record_set_memory_budget(recording, g_memory_budget, K4A_RECORD_MEMORY_POLICY_BLOCK))) ||
+        K4A_FAILED(k4a_record_write_header(recording)))
+    {
+        if (recording)
+        {
+            k4a_record_close(recording);
+        }
+        k4a_capture_release(capture);
+        return;
+    }
+
+    uint32_t frame_period_usec = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(config.camera_fps));
+    result->capture_count = (uint32_t)g_duration_sec * 1000000 / frame_period_usec;
+    result->write_latencies_usec.reserve(result->capture_count);
+
+    bool succeeded = true;
+    uint64_t imu_timestamp_usec = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < result->capture_count && succeeded; i++)
+    {
+        uint64_t timestamp_usec = (uint64_t)i * frame_period_usec;
+        if (paced)
+        {
+            std::this_thread::sleep_until(start + std::chrono::microseconds(timestamp_usec));
+        }
+
+        set_capture_timestamp(capture, timestamp_usec);
+
+        // The time the capture thread is held up by the recording, including any wait for the memory budget
+        auto write_start = std::chrono::steady_clock::now();
+        succeeded = K4A_SUCCEEDED(k4a_record_write_capture(recording, capture));
+        auto write_stop = std::chrono::steady_clock::now();
+        result->write_latencies_usec.push_back(
+            std::chrono::duration_cast<std::chrono::microseconds>(write_stop - write_start).count());
+
+        for (; succeeded && imu_timestamp_usec < timestamp_usec + frame_period_usec;
+             imu_timestamp_usec += imu_period_usec)
+        {
+            k4a_imu_sample_t imu_sample = create_test_imu_sample(imu_timestamp_usec);
+            succeeded = K4A_SUCCEEDED(k4a_record_write_imu_sample(recording, imu_sample));
+        }
+
+        k4a_record_stats_t stats;
+        if (succeeded && K4A_SUCCEEDED(k4a_record_get_stats(recording, &stats)))
+        {
+            result->max_queue_age_usec = std::max(result->max_queue_age_usec, stats.pending_duration_usec);
+            result->max_pending_bytes = std::max(result->max_pending_bytes, stats.pending_bytes);
+            if (stats.pending_duration_usec > queue_warning_usec)
+            {
+                result->queue_warning_count++;
+            }
+        }
+    }
+    auto write_stop = std::chrono::steady_clock::now();
+
+    succeeded = succeeded && K4A_SUCCEEDED(k4a_record_flush(recording));
+    auto flush_stop = std::chrono::steady_clock::now();
+
+    k4a_record_stats_t stats;
+    if (succeeded && K4A_SUCCEEDED(k4a_record_get_stats(recording, &stats)))
+    {
+        result->bytes_written = stats.bytes_written;
+        result->dropped_count = stats.dropped_count;
+        result->budget_blocked_usec = stats.blocked_time_usec;
+        result->render_usec = stats.render_time_usec;
+        result->file_flush_usec = stats.flush_time_usec;
+    }
+
+    k4a_record_close(recording);
+    k4a_capture_release(capture);
+
+    result->write_seconds =
+        (double)std::chrono::duration_cast<std::chrono::microseconds>(write_stop - start).count() / 1000000.0;
+    result->flush_seconds =
+        (double)std::chrono::duration_cast<std::chrono::microseconds>(flush_stop - write_stop).count() / 1000000.0;
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if (file != NULL)
+    {
+        fseek(file, 0, SEEK_END);
+        result->file_size = (uint64_t)ftell(file);
+        fclose(file);
+    }
+    std::remove(path.c_str());
+
+    result->succeeded = succeeded;
+}
+
+class record_throughput_perf : public ::testing::Test
+{
+protected:
+    void run(bool paced)
+    {
+        bool peak_rss_reset = reset_peak_rss();
+
+        std::vector<camera_result> results((size_t)g_camera_count);
+        std::vector<std::thread> cameras;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < g_camera_count; i++)
+        {
+            cameras.emplace_back(run_camera, i, paced, &results[(size_t)i]);
+        }
+        for (std::thread &camera : cameras)
+        {
+            camera.join();
+        }
+        auto stop = std::chrono::steady_clock::now();
+        double seconds =
+            (double)std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() / 1000000.0;
+
+        printf("%d camera(s), %s %s, %s, %u fps, %d s, %s\n",
+               g_camera_count,
+               format_names[g_color_format],
+               resolution_names[g_color_resolution],
+               depth_names[g_depth_mode],
+               k4a_convert_fps_to_uint(g_camera_fps),
+               g_duration_sec,
+               paced ? "paced at the frame rate" : "unpaced");
+
+        uint64_t total_bytes = 0;
+        std::vector<int64_t> all_latencies_usec;
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            const camera_result &result = results[i];
+            ASSERT_TRUE(result.succeeded) << "camera " << i << " failed to record";
+
+            std::vector<int64_t> latencies_usec = result.write_latencies_usec;
+            all_latencies_usec.insert(all_latencies_usec.end(), latencies_usec.begin(), latencies_usec.end());
+            total_bytes += result.bytes_written;
+
+            double total_seconds = result.write_seconds + result.flush_seconds;
+            printf("    camera %zu: %9.1f MB/s  %u captures  flush %8.1f ms  file %8.1f MB\n",
+                   i,
+                   total_seconds > 0 ? (double)result.bytes_written / 1000000.0 / total_seconds : 0.0,
+                   result.capture_count,
+                   result.flush_seconds * 1000.0,
+                   (double)result.file_size / 1000000.0);
+            printf("              write_capture p50 %6lld usec  p99 %6lld usec  max %8lld usec  "
+                   "budget blocked %lld ms\n",
+                   (long long)ut_perf_get_percentile(latencies_usec, 0.50),
+                   (long long)ut_perf_get_percentile(latencies_usec, 0.99),
+                   (long long)ut_perf_get_percentile(latencies_usec, 1.0),
+                   (long long)(result.budget_blocked_usec / 1000));
+            printf("              cluster render %8.1f ms  file flush %8.1f ms\n",
+                   (double)result.render_usec / 1000.0,
+                   (double)result.file_flush_usec / 1000.0);
+            printf("              queue age max %6llu ms  pending max %8.1f MB  over %llu ms: %u captures  "
+                   "dropped %llu\n",
+                   (unsigned long long)(result.max_queue_age_usec / 1000),
+                   (double)result.max_pending_bytes / 1000000.0,
+                   (unsigned long long)(queue_warning_usec / 1000),
+                   result.queue_warning_count,
+                   (unsigned long long)result.dropped_count);
+        }
+
+        printf("    total:    %9.1f MB/s  write_capture p99 %lld usec  peak RSS %.1f MB%s\n",
+               seconds > 0 ? (double)total_bytes / 1000000.0 / seconds : 0.0,
+               (long long)ut_perf_get_percentile(all_latencies_usec, 0.99),
+               (double)get_peak_rss_bytes() / 1000000.0,
+               peak_rss_reset ? "" : " (since process start)");
+    }
+};
+
+TEST_F(record_throughput_perf, paced)
+{
+    run(true);
+}
+
+TEST_F(record_throughput_perf, unpaced)
+{
+    run(false);
+}
+
+static bool parse_fps(const char *value)
+{
+    switch (strtol(value, NULL, 10))
+    {
+    case 5:
+        g_camera_fps = K4A_FRAMES_PER_SECOND_5;
+        return true;
+    case 15:
+        g_camera_fps = K4A_FRAMES_PER_SECOND_15;
+        return true;
+    case 30:
+        g_camera_fps = K4A_FRAMES_PER_SECOND_30;
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Looks up value in a table of names such as format_names, accepting the name without its common prefix
+template<size_t count, typename T>
+static bool parse_name(const char *value, const char *const (&names)[count], const char *prefix, T *result)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strcmp(names[i], value) == 0 ||
+            (strncmp(names[i], prefix, strlen(prefix)) == 0 && strcmp(names[i] + strlen(prefix), value) == 0))
+        {
+            *result = (T)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    bool valid = true;
+    for (int i = 1; i < argc && valid; ++i)
+    {
+        if (i + 1 >= argc)
+        {
+            valid = false;
+        }
+        else if (strcmp(argv[i], "--path") == 0)
+        {
+            g_output_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--cameras") == 0)
+        {
+            g_camera_count = (int)strtol(argv[++i], NULL, 10);
+            valid = g_camera_count >= 1;
+        }
+        else if (strcmp(argv[i], "--duration") == 0)
+        {
+            g_duration_sec = (int)strtol(argv[++i], NULL, 10);
+            valid = g_duration_sec >= 1;
+        }
+        else if (strcmp(argv[i], "--fps") == 0)
+        {
+            valid = parse_fps(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--color-format") == 0)
+        {
+            valid = parse_name(argv[++i], format_names, "K4A_IMAGE_FORMAT_COLOR_", &g_color_format) &&
+                    g_color_format <= K4A_IMAGE_FORMAT_COLOR_BGRA32;
+        }
+        else if (strcmp(argv[i], "--color-resolution") == 0)
+        {
+            valid = parse_name(argv[++i], resolution_names, "K4A_COLOR_RESOLUTION_", &g_color_resolution);
+        }
+        else if (strcmp(argv[i], "--depth-mode") == 0)
+        {
+            valid = parse_name(argv[++i], depth_names, "K4A_DEPTH_MODE_", &g_depth_mode);
+        }
+        else if (strcmp(argv[i], "--memory-budget-mb") == 0)
+        {
+            g_memory_budget = (uint64_t)strtoull(argv[++i], NULL, 10) * 1000000;
+        }
+        else
+        {
+            valid = false;
+        }
+    }
+
+    if (!valid)
+    {
+        printf("Usage: record_throughput_perf [gtest options] [--path <directory>] [--cameras <count>]\n"
+               "                              [--duration <seconds>] [--fps <5|15|30>] [--color-format <MJPG|...>]\n"
+               "                              [--color-resolution <OFF|720P|...>]\n"
+               "                              [--depth-mode <OFF|NFOV_UNBINNED|...>]\n"
+               "                              [--memory-budget-mb <size>]\n");
+        return 1;
+    }
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
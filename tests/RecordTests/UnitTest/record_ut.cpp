@@ -3,10 +3,13 @@
 
 #include <utcommon.h>
 #include <iostream>
+#include <algorithm>
+#include <vector>
 
 // Module being tested
 #include <k4ainternal/matroska_write.h>
 #include <k4arecord/record.h>
+#include <k4arecord/playback.h>
 #include <k4a/k4a.h>
 
 #include <ebml/MemIOCallback.h>
@@ -207,6 +210,224 @@ TEST_F(record_ut, DISABLED_bgra_color_max_disk_write)
     ASSERT_EQ(std::remove("record_test_bgra_color.mkv"), 0);
 }
 
+TEST_F(record_ut, record_stats)
+{
+    k4a_record_t handle = NULL;
+    k4a_result_t result = k4a_record_create("record_test_stats.mkv", NULL, K4A_DEVICE_CONFIG_INIT_DISABLE_ALL, &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    result = k4a_record_add_imu_track(handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    result = k4a_record_write_header(handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    k4a_record_stats_t stats;
+    ASSERT_EQ(k4a_record_get_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.pending_cluster_count, 0u);
+    ASSERT_EQ(stats.pending_bytes, 0u);
+
+    // Write less than CLUSTER_WRITE_DELAY_NS of data so nothing is written by the writer thread before the flush.
+    const size_t sample_count = 500;
+    static_assert(sample_count * 1_ms < CLUSTER_WRITE_DELAY_NS, "Samples would be written before the flush");
+    for (size_t i = 0; i < sample_count; i++)
+    {
+        k4a_imu_sample_t imu_sample = {};
+        imu_sample.acc_timestamp_usec = i * 1000;
+        imu_sample.gyro_timestamp_usec = i * 1000;
+        result = k4a_record_write_imu_sample(handle, imu_sample);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+    }
+
+    ASSERT_EQ(k4a_record_get_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_GT(stats.pending_cluster_count, 0u);
+    ASSERT_EQ(stats.pending_bytes, sample_count * sizeof(matroska_imu_sample_t));
+    ASSERT_EQ(stats.pending_duration_usec, (sample_count - 1) * 1000);
+
+    result = k4a_record_flush(handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    ASSERT_EQ(k4a_record_get_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats.pending_cluster_count, 0u);
+    ASSERT_EQ(stats.pending_bytes, 0u);
+    ASSERT_GT(stats.bytes_written, sample_count * sizeof(matroska_imu_sample_t));
+    ASSERT_GT(stats.write_bytes_per_second, 0u);
+
+    k4a_record_close(handle);
+
+    ASSERT_EQ(std::remove("record_test_stats.mkv"), 0);
+}
+
+static void write_imu_with_budget(const char *path,
+                                  uint64_t budget,
+                                  k4a_record_memory_policy_t policy,
+                                  size_t sample_count,
+                                  k4a_record_stats_t *stats_out)
+{
+    k4a_record_t handle = NULL;
+    k4a_result_t result = k4a_record_create(path, NULL, K4A_DEVICE_CONFIG_INIT_DISABLE_ALL, &handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    result = k4a_record_add_imu_track(handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    result = k4a_record_set_memory_budget(handle, budget, policy);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    result = k4a_record_write_header(handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    for (size_t i = 0; i < sample_count; i++)
+    {
+        k4a_imu_sample_t imu_sample = {};
+        imu_sample.acc_timestamp_usec = i * 1000;
+        imu_sample.gyro_timestamp_usec = i * 1000;
+        result = k4a_record_write_imu_sample(handle, imu_sample);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_stats_t stats;
+        ASSERT_EQ(k4a_record_get_stats(handle, &stats), K4A_RESULT_SUCCEEDED);
+        ASSERT_LE(stats.pending_bytes, budget);
+    }
+
+    result = k4a_record_flush(handle);
+    ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+    ASSERT_EQ(k4a_record_get_stats(handle, stats_out), K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(stats_out->memory_budget, budget);
+
+    k4a_record_close(handle);
+}
+
+static size_t count_imu_samples(const char *path)
+{
+    k4a_playback_t handle = NULL;
+    if (K4A_FAILED(k4a_playback_open(path, &handle)))
+    {
+        return 0;
+    }
+
+    size_t count = 0;
+    k4a_imu_sample_t imu_sample;
+    while (k4a_playback_get_next_imu_sample(handle, &imu_sample) == K4A_STREAM_RESULT_SUCCEEDED)
+    {
+        count++;
+    }
+    k4a_playback_close(handle);
+    return count;
+}
+
+TEST_F(record_ut, memory_budget_policies)
+{
+    // Budget fits a few clusters of IMU data, much less than the 2 second write delay.
+    const uint64_t budget = 100 * sizeof(matroska_imu_sample_t);
+    const size_t sample_count = 1000;
+    k4a_record_stats_t stats;
+
+    // Blocking should record every sample while staying within the budget.
+    write_imu_with_budget("record_test_budget.mkv", budget, K4A_RECORD_MEMORY_POLICY_BLOCK, sample_count, &stats);
+    ASSERT_EQ(stats.dropped_count, 0u);
+    ASSERT_EQ(count_imu_samples("record_test_budget.mkv"), sample_count);
+    ASSERT_EQ(std::remove("record_test_budget.mkv"), 0);
+
+    // Dropping should account for every sample that is not in the file.
+    write_imu_with_budget("record_test_budget.mkv", budget, K4A_RECORD_MEMORY_POLICY_DROP, sample_count, &stats);
+    ASSERT_EQ(stats.blocked_time_usec, 0u);
+    ASSERT_EQ(count_imu_samples("record_test_budget.mkv") + stats.dropped_count, sample_count);
+    ASSERT_EQ(std::remove("record_test_budget.mkv"), 0);
+}
+
+TEST_F(record_ut, rvl_compression_round_trip)
+{
+    // Mix of zero runs, small deltas, and full range jumps to cover every run and VLE length.
+    std::vector<uint16_t> input(640 * 576);
+    for (size_t i = 0; i < input.size(); i++)
+    {
+        if ((i / 97) % 3 == 0)
+        {
+            input[i] = 0;
+        }
+        else if (i % 211 == 0)
+        {
+            input[i] = (i % 2) ? 0xFFFF : 1;
+        }
+        else
+        {
+            input[i] = (uint16_t)(1000 + (i % 640));
+        }
+    }
+
+    for (size_t count : { (size_t)0, (size_t)1, (size_t)7, (size_t)97, input.size() })
+    {
+        std::vector<uint8_t> compressed(rvl_max_compressed_size(count));
+        size_t compressed_size = rvl_compress(input.data(), count, compressed.data());
+        ASSERT_LE(compressed_size, compressed.size());
+        ASSERT_EQ(compressed_size % 4, 0u);
+
+        std::vector<uint16_t> output(count + 1, 0xAAAA);
+        ASSERT_TRUE(rvl_decompress(compressed.data(), compressed_size, output.data(), count));
+        ASSERT_TRUE(std::equal(input.begin(), input.begin() + (ptrdiff_t)count, output.begin()));
+        ASSERT_EQ(output[count], 0xAAAA); // Decoder must not write past the end
+
+        if (compressed_size > 0)
+        {
+            // Truncated data must be rejected rather than read past the end of the buffer.
+            ASSERT_FALSE(rvl_decompress(compressed.data(), compressed_size - 4, output.data(), count));
+        }
+    }
+
+    // Worst case input: every value is non-zero with a maximum delta from the previous value.
+    std::vector<uint16_t> worst_case(1024);
+    for (size_t i = 0; i < worst_case.size(); i++)
+    {
+        worst_case[i] = (i % 2) ? 0xFFFF : 1;
+    }
+    std::vector<uint8_t> compressed(rvl_max_compressed_size(worst_case.size()));
+    size_t compressed_size = rvl_compress(worst_case.data(), worst_case.size(), compressed.data());
+    ASSERT_LE(compressed_size, compressed.size());
+}
+
+TEST_F(record_ut, copy_swap_bytes_16_matches_scalar)
+{
+    std::cout << "Byte swap instruction type: " << copy_swap_bytes_16_get_instruction_type() << std::endl;
+
+    // One WFOV unbinned frame plus an odd tail, so every vector loop and the scalar tail are used.
+    const size_t max_count = 1024 * 1024 + 37;
+    std::vector<uint16_t> source(max_count + 1);
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        source[i] = (uint16_t)(i * 7919);
+    }
+
+    // Offsetting by one value leaves src and dst off the 16 byte alignment of the vector registers.
+    for (size_t offset : { (size_t)0, (size_t)1 })
+    {
+        for (size_t count : { (size_t)0, (size_t)1, (size_t)7, (size_t)8, (size_t)9, (size_t)31, (size_t)33,
+                              (size_t)71, max_count })
+        {
+            std::vector<uint16_t> output(count + offset + 1, 0xAAAA);
+            copy_swap_bytes_16(output.data() + offset, source.data() + offset, count);
+            for (size_t i = 0; i < count; i++)
+            {
+                ASSERT_EQ(output[i + offset], swap_bytes_16(source[i + offset])) << "count " << count << " at " << i;
+            }
+            ASSERT_EQ(output[count + offset], 0xAAAA); // Must not write past the end
+            if (offset > 0)
+            {
+                ASSERT_EQ(output[0], 0xAAAA); // Must not write before the start
+            }
+        }
+    }
+
+    // In place swapping is supported.
+    std::vector<uint16_t> in_place(source.begin() + 1, source.end());
+    copy_swap_bytes_16(in_place.data(), in_place.data(), in_place.size());
+    for (size_t i = 0; i < in_place.size(); i++)
+    {
+        ASSERT_EQ(in_place[i], swap_bytes_16(source[i + 1]));
+    }
+}
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
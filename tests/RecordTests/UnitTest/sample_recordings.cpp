@@ -29,6 +29,9 @@ void SampleRecordings::SetUp()
     record_config_sub.wired_sync_mode = K4A_WIRED_SYNC_MODE_SUBORDINATE;
     record_config_sub.subordinate_delay_off_master_usec = 10000; // 10ms
 
+    k4a_device_configuration_t record_config_master = record_config_full;
+    record_config_master.wired_sync_mode = K4A_WIRED_SYNC_MODE_MASTER;
+
     k4a_device_configuration_t record_config_color_only = record_config_full;
     record_config_color_only.depth_mode = K4A_DEPTH_MODE_OFF;
 
@@ -154,6 +157,37 @@ void SampleRecordings::SetUp()
 
         k4a_record_close(handle);
     }
+    { // Create a master recording file to play back together with the subordinate recording
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_master.mkv", NULL, record_config_master, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        uint64_t timestamps[3] = { 0, 0, 0 };
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_master.camera_fps));
+        k4a_capture_t capture = NULL;
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            capture = create_test_capture(timestamps,
+                                          record_config_master.color_format,
+                                          record_config_master.color_resolution,
+                                          record_config_master.depth_mode);
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_close(handle);
+    }
     { // Create a recording file with time skips and missing frames
         k4a_record_t handle = NULL;
         k4a_result_t result = k4a_record_create("record_test_skips.mkv", NULL, record_config_full, &handle);
@@ -331,6 +365,76 @@ void SampleRecordings::SetUp()
         result = k4a_record_flush(handle);
         ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
 
+        k4a_record_close(handle);
+    }
+    { // Create a recording file using zero-copy captures
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_zero_copy.mkv", NULL, record_config_full, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_enable_zero_copy(handle, true);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        uint64_t timestamps[3] = { 0, 0, 0 };
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_full.camera_fps));
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            // The capture is released right away, the recording keeps its own reference to each image.
+            k4a_capture_t capture = create_test_capture(timestamps,
+                                                        record_config_full.color_format,
+                                                        record_config_full.color_resolution,
+                                                        record_config_full.depth_mode);
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+
+            timestamps[0] += timestamp_delta;
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        k4a_record_close(handle);
+    }
+    { // Create a depth only recording file using the RVL depth codec
+        k4a_record_t handle = NULL;
+        k4a_result_t result = k4a_record_create("record_test_rvl_depth.mkv", NULL, record_config_depth_only, &handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_set_depth_codec(handle, K4A_RECORD_DEPTH_CODEC_RVL);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        result = k4a_record_write_header(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
+        // The codec can't be changed once the header is written.
+        result = k4a_record_set_depth_codec(handle, K4A_RECORD_DEPTH_CODEC_B16G);
+        ASSERT_EQ(result, K4A_RESULT_FAILED);
+
+        uint64_t timestamps[3] = { 0, 0, 0 };
+        uint32_t timestamp_delta = HZ_TO_PERIOD_US(k4a_convert_fps_to_uint(record_config_depth_only.camera_fps));
+        for (size_t i = 0; i < test_frame_count; i++)
+        {
+            k4a_capture_t capture = create_test_capture(timestamps,
+                                                        record_config_depth_only.color_format,
+                                                        record_config_depth_only.color_resolution,
+                                                        record_config_depth_only.depth_mode);
+            result = k4a_record_write_capture(handle, capture);
+            ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+            k4a_capture_release(capture);
+
+            timestamps[1] += timestamp_delta;
+            timestamps[2] += timestamp_delta;
+        }
+
+        result = k4a_record_flush(handle);
+        ASSERT_EQ(result, K4A_RESULT_SUCCEEDED);
+
         k4a_record_close(handle);
     }
 }
@@ -342,10 +446,13 @@ void SampleRecordings::TearDown()
     ASSERT_EQ(std::remove("record_test_delay.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_skips.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_sub.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_master.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_offset.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_color_only.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_depth_only.mkv"), 0);
     ASSERT_EQ(std::remove("record_test_bgra_color.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_rvl_depth.mkv"), 0);
+    ASSERT_EQ(std::remove("record_test_zero_copy.mkv"), 0);
 }
 
 void CustomTrackRecordings::SetUp()
@@ -7,6 +7,21 @@
 #include <k4ainternal/logging.h>
 #include <k4ainternal/matroska_common.h>
 
+#include <fstream>
+#include <string.h>
+#include <string>
+
+#ifdef _WIN32
+// Resolve GetProcessMemoryInfo from kernel32 so psapi.lib is not needed
+#define PSAPI_VERSION 2
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
 #define EXIT_IF_FALSE(x)                                                                                               \
     {                                                                                                                  \
         if (!(x))                                                                                                      \
@@ -338,3 +353,129 @@ bool validate_custom_track_block(const uint8_t *block, size_t block_size, uint64
 
     return true;
 }
+
+static void free_test_buffer(void *buffer, void *context)
+{
+    (void)context;
+    delete[] static_cast<uint8_t *>(buffer);
+}
+
+k4a_image_t create_full_size_image(uint64_t timestamp_us,
+                                   k4a_image_format_t format,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   uint8_t fill)
+{
+    uint32_t stride = 0;
+    size_t size = 0;
+    switch (format)
+    {
+    case K4A_IMAGE_FORMAT_COLOR_MJPG:
+        // Roughly the compressed size of a typical MJPG frame
+        size = (size_t)width * height / 8;
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_NV12:
+        stride = width;
+        size = (size_t)width * height * 3 / 2;
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_YUY2:
+        stride = width * 2;
+        size = (size_t)stride * height;
+        break;
+    case K4A_IMAGE_FORMAT_COLOR_BGRA32:
+        stride = width * 4;
+        size = (size_t)stride * height;
+        break;
+    default:
+        stride = width * (uint32_t)sizeof(uint16_t);
+        size = (size_t)stride * height;
+        break;
+    }
+
+    uint8_t *buffer = new uint8_t[size];
+    memset(buffer, fill, size);
+
+    k4a_image_t image = NULL;
+    if (K4A_FAILED(k4a_image_create_from_buffer(
+            format, (int)width, (int)height, (int)stride, buffer, size, free_test_buffer, NULL, &image)))
+    {
+        delete[] buffer;
+        return NULL;
+    }
+    k4a_image_set_device_timestamp_usec(image, timestamp_us);
+    return image;
+}
+
+uint64_t get_peak_rss_bytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return 0;
+    }
+    return (uint64_t)counters.PeakWorkingSetSize;
+#else
+    // VmHWM is reset by reset_peak_rss(), ru_maxrss is not
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+
+    struct rusage usage = {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+    return (uint64_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+bool reset_peak_rss()
+{
+#ifdef _WIN32
+    return false;
+#else
+    // Writing 5 to clear_refs resets VmHWM to the current RSS (Linux 4.0+)
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+    clear_refs.flush();
+    return clear_refs.good();
+#endif
+}
+
+bool drop_file_from_page_cache(const char *path)
+{
+#ifdef _WIN32
+    // Opening a file without buffering makes the cache manager flush and purge the pages it holds for the file
+    HANDLE file = CreateFileA(path,
+                              GENERIC_READ,
+                              FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              NULL,
+                              OPEN_EXISTING,
+                              FILE_FLAG_NO_BUFFERING,
+                              NULL);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    CloseHandle(file);
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    // Dirty pages are not dropped, so write them back first
+    bool result = fdatasync(fd) == 0 && posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    close(fd);
+    return result;
+#endif
+}
@@ -65,6 +65,27 @@ struct custom_track_test_data
 std::vector<uint8_t> create_test_custom_track_block(uint64_t timestamp_us);
 bool validate_custom_track_block(const uint8_t *block, size_t block_size, uint64_t timestamp_us);
 
+// Helpers for the performance tests
+
+// Creates an image of the size the device produces, unlike create_test_image() which uses a fixed 8KB buffer. Every
+// byte is set to fill. Returns NULL on failure.
+k4a_image_t create_full_size_image(uint64_t timestamp_us,
+                                   k4a_image_format_t format,
+                                   uint32_t width,
+                                   uint32_t height,
+                                   uint8_t fill);
+
+// Returns the peak resident memory of the process in bytes, or 0 if it is unknown.
+uint64_t get_peak_rss_bytes();
+
+// Restarts the peak resident memory measurement from the current usage. Returns false if the OS does not support it,
+// in which case get_peak_rss_bytes() keeps reporting the peak since the process started.
+bool reset_peak_rss();
+
+// Writes back and evicts the file from the OS page cache so the next read comes from disk. Returns false if the OS
+// does not support it.
+bool drop_file_from_page_cache(const char *path);
+
 class SampleRecordings : public ::testing::Environment
 {
 public:
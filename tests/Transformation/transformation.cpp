@@ -10,6 +10,9 @@
 #include <k4ainternal/common.h>
 #include <k4ainternal/image.h>
 
+#include <thread>
+#include <vector>
+
 using namespace testing;
 
 class transformation_ut : public ::testing::Test
@@ -700,6 +703,447 @@ TEST_F(transformation_ut, transformation_all_image_functions_with_failure_cases)
     image_dec_ref(xyz_depth_image);
 }
 
+TEST_F(transformation_ut, transformation_scaled_color_camera)
+{
+    k4a_calibration_t scaled_calibration;
+    const k4a_calibration_camera_t &color_calibration = m_calibration.color_camera_calibration;
+    int scaled_width = color_calibration.resolution_width / 4;
+    int scaled_height = color_calibration.resolution_height / 4;
+    ASSERT_EQ(k4a_calibration_scale_color_camera(&m_calibration, scaled_width, scaled_height, &scaled_calibration),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(scaled_calibration.color_camera_calibration.resolution_width, scaled_width);
+    ASSERT_EQ(scaled_calibration.color_camera_calibration.resolution_height, scaled_height);
+    ASSERT_EQ_FLT(scaled_calibration.color_camera_calibration.intrinsics.parameters.param.k1,
+                  color_calibration.intrinsics.parameters.param.k1);
+    ASSERT_EQ(k4a_calibration_scale_color_camera(&m_calibration, 0, scaled_height, &scaled_calibration),
+              K4A_RESULT_FAILED);
+
+    // The same 3d point lands on the same spot of the scaled image, measured from the top left corner of the image.
+    float point2d[2] = { 0.f, 0.f };
+    int valid = 0;
+    ASSERT_EQ(transformation_3d_to_2d(&scaled_calibration,
+                                      m_depth_point3d_reference,
+                                      K4A_CALIBRATION_TYPE_DEPTH,
+                                      K4A_CALIBRATION_TYPE_COLOR,
+                                      point2d,
+                                      &valid),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(valid, 1);
+    ASSERT_EQ_FLT(point2d[0], (m_color_point2d_reference[0] + 0.5f) / 4 - 0.5f);
+    ASSERT_EQ_FLT(point2d[1], (m_color_point2d_reference[1] + 0.5f) / 4 - 0.5f);
+
+    // A transformation created from the scaled calibration renders depth at the scaled resolution.
+    k4a_transformation_t transformation_handle = transformation_create(&scaled_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    int depth_width = m_calibration.depth_camera_calibration.resolution_width;
+    int depth_height = m_calibration.depth_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    k4a_image_t transformed_image = NULL;
+    k4a_image_t full_size_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           depth_width,
+                           depth_height,
+                           depth_width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           scaled_width,
+                           scaled_height,
+                           scaled_width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &transformed_image),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           color_calibration.resolution_width,
+                           color_calibration.resolution_height,
+                           color_calibration.resolution_width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &full_size_image),
+              K4A_RESULT_SUCCEEDED);
+
+    uint16_t *depth_data = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int i = 0; i < depth_width * depth_height; i++)
+    {
+        depth_data[i] = 1000;
+    }
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t transformed_descriptor = image_get_descriptor(transformed_image);
+    k4a_transformation_image_descriptor_t full_size_descriptor = image_get_descriptor(full_size_image);
+    k4a_transformation_image_descriptor_t dummy_descriptor = {};
+    ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                image_get_buffer(depth_image),
+                                                                &depth_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                image_get_buffer(transformed_image),
+                                                                &transformed_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                0),
+              K4A_RESULT_SUCCEEDED);
+
+    const uint16_t *transformed_data = (const uint16_t *)(const void *)image_get_buffer(transformed_image);
+    int u = (int)(point2d[0] + 0.5f);
+    int v = (int)(point2d[1] + 0.5f);
+    ASSERT_NE(transformed_data[v * scaled_width + u], 0);
+
+    ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                image_get_buffer(depth_image),
+                                                                &depth_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                image_get_buffer(full_size_image),
+                                                                &full_size_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                0),
+              K4A_RESULT_FAILED);
+
+    image_dec_ref(depth_image);
+    image_dec_ref(transformed_image);
+    image_dec_ref(full_size_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_undistortion_map)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    k4a_undistortion_map_t map = NULL;
+    ASSERT_EQ(transformation_create_undistortion_map(transformation_handle,
+                                                     K4A_CALIBRATION_TYPE_GYRO,
+                                                     K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION,
+                                                     &map),
+              K4A_RESULT_FAILED);
+    ASSERT_EQ(transformation_create_undistortion_map(transformation_handle,
+                                                     K4A_CALIBRATION_TYPE_DEPTH,
+                                                     K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION,
+                                                     &map),
+              K4A_RESULT_SUCCEEDED);
+
+    // The undistorted camera keeps the focal length and principal point, and has no distortion.
+    k4a_calibration_camera_t pinhole;
+    ASSERT_EQ(undistortion_map_get_camera_calibration(map, &pinhole), K4A_RESULT_SUCCEEDED);
+    const k4a_calibration_camera_t &depth_calibration = m_calibration.depth_camera_calibration;
+    ASSERT_EQ(pinhole.resolution_width, depth_calibration.resolution_width);
+    ASSERT_EQ(pinhole.resolution_height, depth_calibration.resolution_height);
+    ASSERT_EQ_FLT(pinhole.intrinsics.parameters.param.fx, depth_calibration.intrinsics.parameters.param.fx);
+    ASSERT_EQ_FLT(pinhole.intrinsics.parameters.param.cy, depth_calibration.intrinsics.parameters.param.cy);
+    ASSERT_EQ_FLT(pinhole.intrinsics.parameters.param.k1, 0.f);
+
+    int width = depth_calibration.resolution_width;
+    int height = depth_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    k4a_image_t undistorted_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           width,
+                           height,
+                           width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &undistorted_image),
+              K4A_RESULT_SUCCEEDED);
+
+    uint16_t *depth_data = (uint16_t *)(void *)image_get_buffer(depth_image);
+    uint16_t *undistorted_data = (uint16_t *)(void *)image_get_buffer(undistorted_image);
+    for (int i = 0; i < width * height; i++)
+    {
+        depth_data[i] = 1000;
+    }
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t undistorted_descriptor = image_get_descriptor(undistorted_image);
+
+    // A constant image stays constant wherever there is a valid source pixel, with both interpolation types.
+    for (int interpolation = 0; interpolation < 2; interpolation++)
+    {
+        ASSERT_EQ(undistortion_map_remap(map,
+                                         image_get_buffer(depth_image),
+                                         &depth_descriptor,
+                                         image_get_buffer(undistorted_image),
+                                         &undistorted_descriptor,
+                                         (k4a_transformation_interpolation_type_t)interpolation),
+                  K4A_RESULT_SUCCEEDED);
+
+        int valid_count = 0;
+        for (int i = 0; i < width * height; i++)
+        {
+            ASSERT_TRUE(undistorted_data[i] == 0 || undistorted_data[i] == 1000);
+            valid_count += undistorted_data[i] != 0;
+        }
+        ASSERT_GT(valid_count, width * height / 2);
+        ASSERT_EQ(undistorted_data[(height / 2) * width + width / 2], 1000);
+    }
+
+    // Linear interpolation of depth does not blend in invalid pixels.
+    depth_data[(height / 2) * width + width / 2] = 0;
+    ASSERT_EQ(undistortion_map_remap(map,
+                                     image_get_buffer(depth_image),
+                                     &depth_descriptor,
+                                     image_get_buffer(undistorted_image),
+                                     &undistorted_descriptor,
+                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR),
+              K4A_RESULT_SUCCEEDED);
+    for (int i = 0; i < width * height; i++)
+    {
+        ASSERT_TRUE(undistorted_data[i] == 0 || undistorted_data[i] == 1000);
+    }
+
+    // The images must match the format and resolution of the map.
+    k4a_transformation_image_descriptor_t wrong_descriptor = depth_descriptor;
+    wrong_descriptor.width_pixels /= 2;
+    ASSERT_EQ(undistortion_map_remap(map,
+                                     image_get_buffer(depth_image),
+                                     &wrong_descriptor,
+                                     image_get_buffer(undistorted_image),
+                                     &undistorted_descriptor,
+                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST),
+              K4A_RESULT_FAILED);
+    wrong_descriptor = undistorted_descriptor;
+    wrong_descriptor.format = K4A_IMAGE_FORMAT_IR16;
+    ASSERT_EQ(undistortion_map_remap(map,
+                                     image_get_buffer(depth_image),
+                                     &depth_descriptor,
+                                     image_get_buffer(undistorted_image),
+                                     &wrong_descriptor,
+                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST),
+              K4A_RESULT_FAILED);
+    undistortion_map_destroy(map);
+
+    // The full field of view pinhole fits more of the image, so it has a shorter focal length.
+    ASSERT_EQ(transformation_create_undistortion_map(transformation_handle,
+                                                     K4A_CALIBRATION_TYPE_DEPTH,
+                                                     K4A_TRANSFORMATION_PINHOLE_TYPE_FULL_FOV,
+                                                     &map),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(undistortion_map_get_camera_calibration(map, &pinhole), K4A_RESULT_SUCCEEDED);
+    ASSERT_LT(pinhole.intrinsics.parameters.param.fx, depth_calibration.intrinsics.parameters.param.fx);
+    undistortion_map_destroy(map);
+
+    image_dec_ref(depth_image);
+    image_dec_ref(undistorted_image);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_undistortion_map_concurrent_remap)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    // The 2160P color map is large enough to be split over the worker threads of the map.
+    k4a_undistortion_map_t map = NULL;
+    ASSERT_EQ(transformation_create_undistortion_map(transformation_handle,
+                                                     K4A_CALIBRATION_TYPE_COLOR,
+                                                     K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION,
+                                                     &map),
+              K4A_RESULT_SUCCEEDED);
+
+    int width = m_calibration.color_camera_calibration.resolution_width;
+    int height = m_calibration.color_camera_calibration.resolution_height;
+    k4a_transformation_image_descriptor_t descriptor = {};
+    descriptor.width_pixels = width;
+    descriptor.height_pixels = height;
+    descriptor.stride_bytes = width * 4;
+    descriptor.format = K4A_IMAGE_FORMAT_COLOR_BGRA32;
+
+    std::vector<uint8_t> source((size_t)(width * height * 4));
+    for (size_t i = 0; i < source.size(); i++)
+    {
+        source[i] = (uint8_t)((i * 2654435761u) >> 24);
+    }
+    std::vector<uint8_t> reference(source.size());
+    ASSERT_EQ(undistortion_map_remap(map,
+                                     source.data(),
+                                     &descriptor,
+                                     reference.data(),
+                                     &descriptor,
+                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR),
+              K4A_RESULT_SUCCEEDED);
+
+    // Remaps on several threads share the map's workers, or run on the calling thread while they are busy. Every
+    // result must match the first remap.
+    const int thread_count = 4;
+    const int remap_count = 8;
+    int mismatch_counts[thread_count] = { 0 };
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_count; t++)
+    {
+        threads.emplace_back([&, t] {
+            std::vector<uint8_t> undistorted(source.size());
+            for (int i = 0; i < remap_count; i++)
+            {
+                if (undistortion_map_remap(map,
+                                           source.data(),
+                                           &descriptor,
+                                           undistorted.data(),
+                                           &descriptor,
+                                           K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR) != K4A_RESULT_SUCCEEDED ||
+                    undistorted != reference)
+                {
+                    mismatch_counts[t]++;
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for (int t = 0; t < thread_count; t++)
+    {
+        ASSERT_EQ(mismatch_counts[t], 0) << "thread " << t;
+    }
+
+    undistortion_map_destroy(map);
+    transformation_destroy(transformation_handle);
+}
+
+TEST_F(transformation_ut, transformation_depth_image_to_undistorted_color_camera)
+{
+    k4a_transformation_t transformation_handle = transformation_create(&m_calibration, false);
+    ASSERT_NE(transformation_handle, (k4a_transformation_t)NULL);
+
+    k4a_undistortion_map_t color_map = NULL;
+    k4a_undistortion_map_t depth_map = NULL;
+    ASSERT_EQ(transformation_create_undistortion_map(transformation_handle,
+                                                     K4A_CALIBRATION_TYPE_COLOR,
+                                                     K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION,
+                                                     &color_map),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(transformation_create_undistortion_map(transformation_handle,
+                                                     K4A_CALIBRATION_TYPE_DEPTH,
+                                                     K4A_TRANSFORMATION_PINHOLE_TYPE_CALIBRATION,
+                                                     &depth_map),
+              K4A_RESULT_SUCCEEDED);
+
+    int depth_width = m_calibration.depth_camera_calibration.resolution_width;
+    int depth_height = m_calibration.depth_camera_calibration.resolution_height;
+    int color_width = m_calibration.color_camera_calibration.resolution_width;
+    int color_height = m_calibration.color_camera_calibration.resolution_height;
+    k4a_image_t depth_image = NULL;
+    k4a_image_t distorted_image = NULL;
+    k4a_image_t two_pass_image = NULL;
+    k4a_image_t fused_image = NULL;
+    ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                           depth_width,
+                           depth_height,
+                           depth_width * (int)sizeof(uint16_t),
+                           ALLOCATION_SOURCE_USER,
+                           &depth_image),
+              K4A_RESULT_SUCCEEDED);
+    k4a_image_t *color_images[] = { &distorted_image, &two_pass_image, &fused_image };
+    for (k4a_image_t *image : color_images)
+    {
+        ASSERT_EQ(image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               color_width,
+                               color_height,
+                               color_width * (int)sizeof(uint16_t),
+                               ALLOCATION_SOURCE_USER,
+                               image),
+                  K4A_RESULT_SUCCEEDED);
+    }
+
+    // A slanted plane, so that interpolation errors would show up as depth differences.
+    uint16_t *depth_data = (uint16_t *)(void *)image_get_buffer(depth_image);
+    for (int y = 0; y < depth_height; y++)
+    {
+        for (int x = 0; x < depth_width; x++)
+        {
+            depth_data[y * depth_width + x] = (uint16_t)(1000 + x / 4);
+        }
+    }
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth_image);
+    k4a_transformation_image_descriptor_t color_descriptor = image_get_descriptor(fused_image);
+    k4a_transformation_image_descriptor_t dummy_descriptor = {};
+
+    // Two passes: transform to the distorted color camera, then undistort the result.
+    ASSERT_EQ(transformation_depth_image_to_color_camera_custom(transformation_handle,
+                                                                image_get_buffer(depth_image),
+                                                                &depth_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                image_get_buffer(distorted_image),
+                                                                &color_descriptor,
+                                                                NULL,
+                                                                &dummy_descriptor,
+                                                                K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                0),
+              K4A_RESULT_SUCCEEDED);
+    ASSERT_EQ(undistortion_map_remap(color_map,
+                                     image_get_buffer(distorted_image),
+                                     &color_descriptor,
+                                     image_get_buffer(two_pass_image),
+                                     &color_descriptor,
+                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST),
+              K4A_RESULT_SUCCEEDED);
+
+    // One pass straight into the undistorted color camera.
+    ASSERT_EQ(transformation_depth_image_to_undistorted_color_camera(transformation_handle,
+                                                                     color_map,
+                                                                     image_get_buffer(depth_image),
+                                                                     &depth_descriptor,
+                                                                     NULL,
+                                                                     &dummy_descriptor,
+                                                                     image_get_buffer(fused_image),
+                                                                     &color_descriptor,
+                                                                     NULL,
+                                                                     &dummy_descriptor,
+                                                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                     0),
+              K4A_RESULT_SUCCEEDED);
+
+    const uint16_t *two_pass_data = (const uint16_t *)(const void *)image_get_buffer(two_pass_image);
+    const uint16_t *fused_data = (const uint16_t *)(const void *)image_get_buffer(fused_image);
+    int both_valid = 0;
+    int fused_valid = 0;
+    for (int i = 0; i < color_width * color_height; i++)
+    {
+        fused_valid += fused_data[i] != 0;
+        if (fused_data[i] != 0 && two_pass_data[i] != 0)
+        {
+            both_valid++;
+            ASSERT_LE(abs((int)fused_data[i] - (int)two_pass_data[i]), 2);
+        }
+    }
+    ASSERT_GT(both_valid, fused_valid * 9 / 10);
+
+    // The map must belong to the color camera.
+    ASSERT_EQ(transformation_depth_image_to_undistorted_color_camera(transformation_handle,
+                                                                     depth_map,
+                                                                     image_get_buffer(depth_image),
+                                                                     &depth_descriptor,
+                                                                     NULL,
+                                                                     &dummy_descriptor,
+                                                                     image_get_buffer(fused_image),
+                                                                     &color_descriptor,
+                                                                     NULL,
+                                                                     &dummy_descriptor,
+                                                                     K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                     0),
+              K4A_RESULT_FAILED);
+
+    undistortion_map_destroy(color_map);
+    undistortion_map_destroy(depth_map);
+    image_dec_ref(depth_image);
+    for (k4a_image_t *image : color_images)
+    {
+        image_dec_ref(*image);
+    }
+    transformation_destroy(transformation_handle);
+}
+
 int main(int argc, char **argv)
 {
     return k4a_test_common_main(argc, argv);
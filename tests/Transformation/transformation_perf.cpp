@@ -0,0 +1,368 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_calibration_data.h>
+
+// Module being tested
+#include <k4a/k4a.h>
+#include <k4ainternal/transformation.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/image.h>
+
+#include <chrono>
+#include <string.h>
+#include <vector>
+
+using namespace testing;
+
+// Export function from transformation.c to snoop on the compiler setting used.
+extern "C" char *transformation_get_instruction_type();
+
+static int g_iterations = 10;
+
+struct transformation_perf_parameters
+{
+    k4a_depth_mode_t depth_mode;
+    k4a_color_resolution_t color_resolution;
+
+    friend std::ostream &operator<<(std::ostream &os, const transformation_perf_parameters &obj)
+    {
+        return os << "depth mode " << (int)obj.depth_mode << " color resolution " << (int)obj.color_resolution;
+    }
+};
+
+static std::vector<transformation_perf_parameters> get_perf_parameters()
+{
+    const k4a_depth_mode_t depth_modes[] = { K4A_DEPTH_MODE_NFOV_2X2BINNED, K4A_DEPTH_MODE_NFOV_UNBINNED,
+                                             K4A_DEPTH_MODE_WFOV_2X2BINNED, K4A_DEPTH_MODE_WFOV_UNBINNED,
+                                             K4A_DEPTH_MODE_PASSIVE_IR };
+    const k4a_color_resolution_t color_resolutions[] = { K4A_COLOR_RESOLUTION_720P,  K4A_COLOR_RESOLUTION_1080P,
+                                                         K4A_COLOR_RESOLUTION_1440P, K4A_COLOR_RESOLUTION_1536P,
+                                                         K4A_COLOR_RESOLUTION_2160P, K4A_COLOR_RESOLUTION_3072P };
+
+    std::vector<transformation_perf_parameters> parameters;
+    for (k4a_depth_mode_t depth_mode : depth_modes)
+    {
+        for (k4a_color_resolution_t color_resolution : color_resolutions)
+        {
+            parameters.push_back({ depth_mode, color_resolution });
+        }
+    }
+    return parameters;
+}
+
+static const char *get_depth_mode_name(k4a_depth_mode_t depth_mode)
+{
+    switch (depth_mode)
+    {
+    case K4A_DEPTH_MODE_NFOV_2X2BINNED:
+        return "NFOV_2X2BINNED";
+    case K4A_DEPTH_MODE_NFOV_UNBINNED:
+        return "NFOV_UNBINNED";
+    case K4A_DEPTH_MODE_WFOV_2X2BINNED:
+        return "WFOV_2X2BINNED";
+    case K4A_DEPTH_MODE_WFOV_UNBINNED:
+        return "WFOV_UNBINNED";
+    case K4A_DEPTH_MODE_PASSIVE_IR:
+        return "PASSIVE_IR";
+    default:
+        return "OFF";
+    }
+}
+
+static k4a_transformation_image_descriptor_t image_get_descriptor(const k4a_image_t image)
+{
+    k4a_transformation_image_descriptor_t descriptor;
+    descriptor.width_pixels = image_get_width_pixels(image);
+    descriptor.height_pixels = image_get_height_pixels(image);
+    descriptor.stride_bytes = image_get_stride_bytes(image);
+    descriptor.format = image_get_format(image);
+    return descriptor;
+}
+
+class transformation_perf : public ::testing::Test, public ::testing::WithParamInterface<transformation_perf_parameters>
+{
+protected:
+    void SetUp() override
+    {
+        const transformation_perf_parameters &parameters = GetParam();
+        ASSERT_EQ(k4a_calibration_get_from_raw(g_test_json,
+                                               sizeof(g_test_json),
+                                               parameters.depth_mode,
+                                               parameters.color_resolution,
+                                               &m_calibration),
+                  K4A_RESULT_SUCCEEDED);
+
+        m_transformation = transformation_create(&m_calibration, false);
+        ASSERT_NE(m_transformation, (k4a_transformation_t)NULL);
+
+        m_depth_width = m_calibration.depth_camera_calibration.resolution_width;
+        m_depth_height = m_calibration.depth_camera_calibration.resolution_height;
+        m_color_width = m_calibration.color_camera_calibration.resolution_width;
+        m_color_height = m_calibration.color_camera_calibration.resolution_height;
+    }
+
+    void TearDown() override
+    {
+        for (k4a_image_t image : m_images)
+        {
+            image_dec_ref(image);
+        }
+        m_images.clear();
+
+        if (m_transformation)
+        {
+            transformation_destroy(m_transformation);
+            m_transformation = NULL;
+        }
+    }
+
+    k4a_image_t create_image(k4a_image_format_t format, int width, int height, int bytes_per_pixel)
+    {
+        k4a_image_t image = NULL;
+        EXPECT_EQ(image_create(format, width, height, width * bytes_per_pixel, ALLOCATION_SOURCE_USER, &image),
+                  K4A_RESULT_SUCCEEDED);
+        if (image)
+        {
+            m_images.push_back(image);
+        }
+        return image;
+    }
+
+    // Fills the depth image with a tilted plane between 0.5m and 4m, so every depth pixel lands in the color camera
+    // and the rasterization runs over realistic triangle sizes
+    void fill_depth(k4a_image_t depth_image)
+    {
+        uint16_t *depth = (uint16_t *)(void *)image_get_buffer(depth_image);
+        for (int y = 0; y < m_depth_height; y++)
+        {
+            for (int x = 0; x < m_depth_width; x++)
+            {
+                depth[y * m_depth_width + x] = (uint16_t)(500 + (3500 * (x + y)) / (m_depth_width + m_depth_height));
+            }
+        }
+    }
+
+    static void fill_pattern(k4a_image_t image)
+    {
+        uint8_t *buffer = image_get_buffer(image);
+        size_t size = image_get_size(image);
+        for (size_t i = 0; i < size; i++)
+        {
+            buffer[i] = (uint8_t)(i * 31);
+        }
+    }
+
+    // Runs operation g_iterations times after one warm up call and prints the average cost per output pixel
+    template<typename Operation> void measure(const char *name, int output_pixels, Operation operation)
+    {
+        ASSERT_EQ(operation(), K4A_RESULT_SUCCEEDED) << name << " failed";
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < g_iterations; i++)
+        {
+            ASSERT_EQ(operation(), K4A_RESULT_SUCCEEDED) << name << " failed";
+        }
+        auto stop = std::chrono::steady_clock::now();
+
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / g_iterations;
+        printf("%-16s %4dx%-4d -> %4dx%-4d %-28s %9.3f ms/frame %8.3f ns/pixel (%s)\n",
+               get_depth_mode_name(GetParam().depth_mode),
+               m_depth_width,
+               m_depth_height,
+               m_color_width,
+               m_color_height,
+               name,
+               ns / 1000000.0,
+               ns / output_pixels,
+               transformation_get_instruction_type());
+    }
+
+    k4a_calibration_t m_calibration;
+    k4a_transformation_t m_transformation = NULL;
+    int m_depth_width = 0;
+    int m_depth_height = 0;
+    int m_color_width = 0;
+    int m_color_height = 0;
+    std::vector<k4a_image_t> m_images;
+};
+
+TEST_P(transformation_perf, depth_image_to_color_camera)
+{
+    k4a_image_t depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_depth_width, m_depth_height, 2);
+    k4a_image_t transformed_depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_color_width, m_color_height, 2);
+    ASSERT_TRUE(depth && transformed_depth);
+    fill_depth(depth);
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth);
+    k4a_transformation_image_descriptor_t transformed_depth_descriptor = image_get_descriptor(transformed_depth);
+    k4a_transformation_image_descriptor_t dummy_descriptor = { 0 };
+
+    measure("depth_image_to_color_camera", m_color_width * m_color_height, [&]() {
+        return transformation_depth_image_to_color_camera_custom(m_transformation,
+                                                                 image_get_buffer(depth),
+                                                                 &depth_descriptor,
+                                                                 NULL,
+                                                                 &dummy_descriptor,
+                                                                 image_get_buffer(transformed_depth),
+                                                                 &transformed_depth_descriptor,
+                                                                 NULL,
+                                                                 &dummy_descriptor,
+                                                                 K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR,
+                                                                 0);
+    });
+}
+
+TEST_P(transformation_perf, depth_image_to_color_camera_custom8)
+{
+    k4a_image_t depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_depth_width, m_depth_height, 2);
+    k4a_image_t custom = create_image(K4A_IMAGE_FORMAT_CUSTOM8, m_depth_width, m_depth_height, 1);
+    k4a_image_t transformed_depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_color_width, m_color_height, 2);
+    k4a_image_t transformed_custom = create_image(K4A_IMAGE_FORMAT_CUSTOM8, m_color_width, m_color_height, 1);
+    ASSERT_TRUE(depth && custom && transformed_depth && transformed_custom);
+    fill_depth(depth);
+    fill_pattern(custom);
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth);
+    k4a_transformation_image_descriptor_t custom_descriptor = image_get_descriptor(custom);
+    k4a_transformation_image_descriptor_t transformed_depth_descriptor = image_get_descriptor(transformed_depth);
+    k4a_transformation_image_descriptor_t transformed_custom_descriptor = image_get_descriptor(transformed_custom);
+
+    for (k4a_transformation_interpolation_type_t interpolation :
+         { K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST, K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR })
+    {
+        measure(interpolation == K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST ? "custom8_to_color (nearest)" :
+                                                                                 "custom8_to_color (linear)",
+                m_color_width * m_color_height,
+                [&]() {
+                    return transformation_depth_image_to_color_camera_custom(m_transformation,
+                                                                             image_get_buffer(depth),
+                                                                             &depth_descriptor,
+                                                                             image_get_buffer(custom),
+                                                                             &custom_descriptor,
+                                                                             image_get_buffer(transformed_depth),
+                                                                             &transformed_depth_descriptor,
+                                                                             image_get_buffer(transformed_custom),
+                                                                             &transformed_custom_descriptor,
+                                                                             interpolation,
+                                                                             0);
+                });
+    }
+}
+
+TEST_P(transformation_perf, depth_image_to_color_camera_custom16)
+{
+    k4a_image_t depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_depth_width, m_depth_height, 2);
+    k4a_image_t custom = create_image(K4A_IMAGE_FORMAT_CUSTOM16, m_depth_width, m_depth_height, 2);
+    k4a_image_t transformed_depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_color_width, m_color_height, 2);
+    k4a_image_t transformed_custom = create_image(K4A_IMAGE_FORMAT_CUSTOM16, m_color_width, m_color_height, 2);
+    ASSERT_TRUE(depth && custom && transformed_depth && transformed_custom);
+    fill_depth(depth);
+    fill_pattern(custom);
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth);
+    k4a_transformation_image_descriptor_t custom_descriptor = image_get_descriptor(custom);
+    k4a_transformation_image_descriptor_t transformed_depth_descriptor = image_get_descriptor(transformed_depth);
+    k4a_transformation_image_descriptor_t transformed_custom_descriptor = image_get_descriptor(transformed_custom);
+
+    for (k4a_transformation_interpolation_type_t interpolation :
+         { K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST, K4A_TRANSFORMATION_INTERPOLATION_TYPE_LINEAR })
+    {
+        measure(interpolation == K4A_TRANSFORMATION_INTERPOLATION_TYPE_NEAREST ? "custom16_to_color (nearest)" :
+                                                                                 "custom16_to_color (linear)",
+                m_color_width * m_color_height,
+                [&]() {
+                    return transformation_depth_image_to_color_camera_custom(m_transformation,
+                                                                             image_get_buffer(depth),
+                                                                             &depth_descriptor,
+                                                                             image_get_buffer(custom),
+                                                                             &custom_descriptor,
+                                                                             image_get_buffer(transformed_depth),
+                                                                             &transformed_depth_descriptor,
+                                                                             image_get_buffer(transformed_custom),
+                                                                             &transformed_custom_descriptor,
+                                                                             interpolation,
+                                                                             0);
+                });
+    }
+}
+
+TEST_P(transformation_perf, color_image_to_depth_camera)
+{
+    k4a_image_t depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_depth_width, m_depth_height, 2);
+    k4a_image_t color = create_image(K4A_IMAGE_FORMAT_COLOR_BGRA32, m_color_width, m_color_height, 4);
+    k4a_image_t transformed_color = create_image(K4A_IMAGE_FORMAT_COLOR_BGRA32, m_depth_width, m_depth_height, 4);
+    ASSERT_TRUE(depth && color && transformed_color);
+    fill_depth(depth);
+    fill_pattern(color);
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth);
+    k4a_transformation_image_descriptor_t color_descriptor = image_get_descriptor(color);
+    k4a_transformation_image_descriptor_t transformed_color_descriptor = image_get_descriptor(transformed_color);
+
+    measure("color_image_to_depth_camera", m_depth_width * m_depth_height, [&]() {
+        return transformation_color_image_to_depth_camera(m_transformation,
+                                                          image_get_buffer(depth),
+                                                          &depth_descriptor,
+                                                          image_get_buffer(color),
+                                                          &color_descriptor,
+                                                          image_get_buffer(transformed_color),
+                                                          &transformed_color_descriptor);
+    });
+}
+
+TEST_P(transformation_perf, depth_image_to_point_cloud)
+{
+    k4a_image_t depth = create_image(K4A_IMAGE_FORMAT_DEPTH16, m_depth_width, m_depth_height, 2);
+    k4a_image_t xyz = create_image(K4A_IMAGE_FORMAT_CUSTOM, m_depth_width, m_depth_height, 3 * (int)sizeof(int16_t));
+    ASSERT_TRUE(depth && xyz);
+    fill_depth(depth);
+
+    k4a_transformation_image_descriptor_t depth_descriptor = image_get_descriptor(depth);
+    k4a_transformation_image_descriptor_t xyz_descriptor = image_get_descriptor(xyz);
+
+    measure("depth_image_to_point_cloud", m_depth_width * m_depth_height, [&]() {
+        return transformation_depth_image_to_point_cloud(m_transformation,
+                                                         image_get_buffer(depth),
+                                                         &depth_descriptor,
+                                                         K4A_CALIBRATION_TYPE_DEPTH,
+                                                         image_get_buffer(xyz),
+                                                         &xyz_descriptor);
+    });
+}
+
+INSTANTIATE_TEST_CASE_P(transformation_perf, transformation_perf, ValuesIn(get_perf_parameters()));
+
+int main(int argc, char **argv)
+{
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+        {
+            g_iterations = (int)strtol(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: transformation_perf [gtest options] [--iterations <count>]\n");
+            return 1;
+        }
+    }
+
+    if (g_iterations < 1)
+    {
+        printf("--iterations must be at least 1\n");
+        return 1;
+    }
+
+    printf("Transformation kernels compiled for %s, %d iterations per measurement\n",
+           transformation_get_instruction_type(),
+           g_iterations);
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
@@ -0,0 +1,253 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_perf_helpers.h>
+#include <ut_pool_allocator.h>
+
+#include <gtest/gtest.h>
+
+// Module being tested
+#include <k4ainternal/allocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+static int g_operations = 20000;
+
+// Buffers each thread holds before freeing the oldest, like frames waiting in the capture pipeline
+#define FRAMES_IN_FLIGHT 4
+
+struct allocator_perf_parameters
+{
+    int thread_count;
+    const char *frame_name;
+    size_t frame_size;
+    allocation_source_t source;
+    bool user_allocator;
+
+    friend std::ostream &operator<<(std::ostream &os, const allocator_perf_parameters &obj)
+    {
+        return os << obj.thread_count << " threads " << obj.frame_name << " "
+                  << (obj.user_allocator ? "user allocator" : "default allocator");
+    }
+};
+
+static std::vector<allocator_perf_parameters> get_perf_parameters()
+{
+    struct frame
+    {
+        const char *name;
+        size_t size;
+        allocation_source_t source;
+    };
+    const frame frames[] = {
+        { "IMU sample", sizeof(k4a_imu_sample_t), ALLOCATION_SOURCE_IMU },
+        { "depth NFOV unbinned", 640 * 576 * sizeof(uint16_t), ALLOCATION_SOURCE_DEPTH },
+        { "color MJPG 2160p", 3840 * 2160 / 8, ALLOCATION_SOURCE_COLOR },
+        { "color BGRA32 1080p", 1920 * 1080 * 4, ALLOCATION_SOURCE_COLOR },
+    };
+    const int thread_counts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    std::vector<allocator_perf_parameters> parameters;
+    for (bool user_allocator : { false, true })
+    {
+        for (const frame &f : frames)
+        {
+            for (int thread_count : thread_counts)
+            {
+                parameters.push_back({ thread_count, f.name, f.size, f.source, user_allocator });
+            }
+        }
+    }
+    return parameters;
+}
+
+struct allocator_thread_result
+{
+    std::vector<int64_t> alloc_nsec;
+    std::vector<int64_t> free_nsec;
+    bool failed = false;
+};
+
+static void allocator_thread(const allocator_perf_parameters &params,
+                             std::atomic<int> *ready_count,
+                             allocator_thread_result *result)
+{
+    uint8_t *in_flight[FRAMES_IN_FLIGHT] = {};
+    result->alloc_nsec.reserve((size_t)g_operations);
+    result->free_nsec.reserve((size_t)g_operations);
+
+    ut_perf_wait_for_start(*ready_count);
+
+    for (int i = 0; i < g_operations; i++)
+    {
+        uint8_t *&slot = in_flight[i % FRAMES_IN_FLIGHT];
+        if (slot != NULL)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            allocator_free(slot);
+            auto stop = std::chrono::high_resolution_clock::now();
+            result->free_nsec.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        slot = allocator_alloc(params.source, params.frame_size);
+        auto stop = std::chrono::high_resolution_clock::now();
+        result->alloc_nsec.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        if (slot == NULL)
+        {
+            result->failed = true;
+            break;
+        }
+    }
+
+    for (uint8_t *buffer : in_flight)
+    {
+        if (buffer != NULL)
+        {
+            allocator_free(buffer);
+        }
+    }
+}
+
+class allocator_perf : public ::testing::Test, public ::testing::WithParamInterface<allocator_perf_parameters>
+{
+protected:
+    void SetUp() override
+    {
+        if (GetParam().user_allocator)
+        {
+            ut_pool_allocator_reset();
+            // k4a_set_allocator() forwards to allocator_set_allocator()
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                      allocator_set_allocator(ut_pool_allocator_allocate, ut_pool_allocator_free));
+        }
+    }
+
+    void TearDown() override
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, allocator_set_allocator(NULL, NULL));
+        ut_pool_allocator_reset();
+        ASSERT_EQ(allocator_test_for_leaks(), 0);
+    }
+
+    // Runs the workload with thread_count threads and merges the latencies of all threads
+    bool run(const allocator_perf_parameters &params,
+             int thread_count,
+             allocator_thread_result *merged,
+             double *seconds)
+    {
+        std::vector<allocator_thread_result> results((size_t)thread_count);
+        std::vector<std::thread> threads;
+        std::atomic<int> ready_count(thread_count);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < thread_count; i++)
+        {
+            threads.emplace_back(allocator_thread, params, &ready_count, &results[(size_t)i]);
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        *seconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1e9;
+
+        bool succeeded = true;
+        for (allocator_thread_result &result : results)
+        {
+            succeeded = succeeded && !result.failed;
+            merged->alloc_nsec.insert(merged->alloc_nsec.end(), result.alloc_nsec.begin(), result.alloc_nsec.end());
+            merged->free_nsec.insert(merged->free_nsec.end(), result.free_nsec.begin(), result.free_nsec.end());
+        }
+        return succeeded;
+    }
+};
+
+TEST_P(allocator_perf, alloc_free)
+{
+    const allocator_perf_parameters &params = GetParam();
+
+    // Uncontended cost of the same workload on one thread, so the extra cost under contention can be estimated
+    allocator_thread_result baseline;
+    double baseline_seconds = 0;
+    ASSERT_TRUE(run(params, 1, &baseline, &baseline_seconds));
+    double baseline_nsec = ut_perf_get_mean(baseline.alloc_nsec) + ut_perf_get_mean(baseline.free_nsec);
+
+    ut_pool_allocator_t &pool = ut_pool_allocator_get();
+    uint64_t pool_wait_start_nsec = pool.lock_wait_nsec.load();
+    uint64_t pool_contended_start = pool.contended_count.load();
+    uint64_t pool_operations_start = pool.operation_count.load();
+
+    allocator_thread_result result;
+    double seconds = 0;
+    ASSERT_TRUE(run(params, params.thread_count, &result, &seconds));
+    double operation_nsec = ut_perf_get_mean(result.alloc_nsec) + ut_perf_get_mean(result.free_nsec);
+
+    printf("%-20s %-7s %2d threads: %11.0f alloc+free/s  alloc p50 %6lld p99 %8lld max %9lld ns  "
+           "free p50 %6lld p99 %8lld max %9lld ns  contention %6.0f ns per alloc+free",
+           params.frame_name,
+           params.user_allocator ? "user" : "default",
+           params.thread_count,
+           seconds > 0 ? (double)result.alloc_nsec.size() / seconds : 0.0,
+           (long long)ut_perf_get_percentile(result.alloc_nsec, 0.50),
+           (long long)ut_perf_get_percentile(result.alloc_nsec, 0.99),
+           (long long)ut_perf_get_percentile(result.alloc_nsec, 1.0),
+           (long long)ut_perf_get_percentile(result.free_nsec, 0.50),
+           (long long)ut_perf_get_percentile(result.free_nsec, 0.99),
+           (long long)ut_perf_get_percentile(result.free_nsec, 1.0),
+           std::max(0.0, operation_nsec - baseline_nsec));
+    if (params.user_allocator)
+    {
+        uint64_t pool_operations = pool.operation_count.load() - pool_operations_start;
+        printf("  pool lock wait %6.0f ns/op, %5.1f%% contended",
+               pool_operations ? (double)(pool.lock_wait_nsec.load() - pool_wait_start_nsec) / pool_operations : 0.0,
+               pool_operations ? 100.0 * (double)(pool.contended_count.load() - pool_contended_start) /
+                                     (double)pool_operations :
+                                 0.0);
+    }
+    printf("\n");
+}
+
+INSTANTIATE_TEST_CASE_P(allocator_perf, allocator_perf, ValuesIn(get_perf_parameters()));
+
+int main(int argc, char **argv)
+{
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--operations") == 0 && i + 1 < argc)
+        {
+            g_operations = (int)strtol(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: allocator_perf [gtest options] [--operations <allocations per thread>]\n");
+            return 1;
+        }
+    }
+
+    if (g_operations < 1)
+    {
+        printf("--operations must be at least 1\n");
+        return 1;
+    }
+
+    printf("%d allocations per thread, %d frames in flight per thread. Contention is the mean alloc+free time "
+           "above the same workload on one thread.\n",
+           g_operations,
+           FRAMES_IN_FLIGHT);
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
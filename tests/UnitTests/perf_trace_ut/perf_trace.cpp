@@ -0,0 +1,276 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+
+#include <gtest/gtest.h>
+
+// Module being tested
+#include <k4ainternal/perf_trace.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
+#define TRACE_FILE_NAME "perf_trace_ut.json"
+
+// Events per thread ring, PERF_TRACE_RING_SIZE in perf_trace.cpp
+#define RING_SIZE (1 << 16)
+
+using namespace testing;
+
+typedef struct
+{
+    std::string name;
+    char phase;
+    uint64_t pid;
+    uint64_t tid;
+    uint64_t ts_nsec;
+} trace_event_t;
+
+static void record_nested_spans(int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        PERF_TRACE_SCOPE("outer");
+        {
+            PERF_TRACE_SCOPE("inner");
+        }
+        {
+            PERF_TRACE_SCOPE("inner");
+        }
+    }
+}
+
+// Exports the events recorded by earlier tests and deletes the file, so the next flush starts a new trace
+static void start_trace()
+{
+    perf_trace_flush();
+    std::remove(TRACE_FILE_NAME);
+}
+
+// Parses the trace file, which must be a JSON array opening line followed by one event object per line
+static void read_trace(std::vector<trace_event_t> &events)
+{
+    FILE *file = fopen(TRACE_FILE_NAME, "r");
+    ASSERT_NE(file, nullptr);
+
+    char line[512];
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    ASSERT_STREQ("[\n", line);
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char name[256];
+        char phase[8];
+        unsigned long long pid, tid, ts_usec;
+        unsigned int ts_fraction;
+        int length = 0;
+        int fields = sscanf(line,
+                            "{\"name\":\"%255[^\"]\",\"ph\":\"%7[^\"]\",\"pid\":%llu,\"tid\":%llu,\"ts\":%llu.%3u},%n",
+                            name,
+                            phase,
+                            &pid,
+                            &tid,
+                            &ts_usec,
+                            &ts_fraction,
+                            &length);
+        ASSERT_EQ(6, fields) << line;
+        ASSERT_EQ('\n', line[length]) << line;
+        ASSERT_TRUE(std::string(phase) == "B" || std::string(phase) == "E") << line;
+
+        trace_event_t event;
+        event.name = name;
+        event.phase = phase[0];
+        event.pid = pid;
+        event.tid = tid;
+        event.ts_nsec = ts_usec * 1000 + ts_fraction;
+        events.push_back(event);
+    }
+    fclose(file);
+}
+
+// Groups the events by thread, checking they are in time order and that every end event closes the innermost open
+// duration of the same name. Durations may be left open, their end was not recorded yet.
+static void check_threads(const std::vector<trace_event_t> &events,
+                          std::map<uint64_t, std::vector<trace_event_t>> &threads)
+{
+    for (const trace_event_t &event : events)
+    {
+        ASSERT_EQ(events[0].pid, event.pid);
+        threads[event.tid].push_back(event);
+    }
+
+    for (auto &thread : threads)
+    {
+        std::vector<std::string> open;
+        uint64_t last_nsec = 0;
+        for (const trace_event_t &event : thread.second)
+        {
+            ASSERT_GE(event.ts_nsec, last_nsec) << "tid " << thread.first;
+            last_nsec = event.ts_nsec;
+
+            if (event.phase == 'B')
+            {
+                open.push_back(event.name);
+            }
+            else
+            {
+                ASSERT_FALSE(open.empty()) << "tid " << thread.first << " ends " << event.name << " before starting it";
+                ASSERT_EQ(open.back(), event.name) << "tid " << thread.first;
+                open.pop_back();
+            }
+        }
+    }
+}
+
+TEST(perf_trace_ut, nested_and_threaded_spans)
+{
+    start_trace();
+
+    const int thread_count = 4;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < thread_count; i++)
+    {
+        threads.emplace_back(record_nested_spans, 100);
+    }
+    record_nested_spans(10);
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    perf_trace_flush();
+
+    std::vector<trace_event_t> events;
+    ASSERT_NO_FATAL_FAILURE(read_trace(events));
+    std::map<uint64_t, std::vector<trace_event_t>> thread_events;
+    ASSERT_NO_FATAL_FAILURE(check_threads(events, thread_events));
+
+    // Each span is one outer and two inner durations, all of them closed
+    ASSERT_EQ((size_t)thread_count + 1, thread_events.size());
+    size_t main_thread_count = 0;
+    for (auto &thread : thread_events)
+    {
+        ASSERT_TRUE(thread.second.size() == 6 * 100 || thread.second.size() == 6 * 10);
+        main_thread_count += thread.second.size() == 6 * 10 ? 1 : 0;
+        ASSERT_EQ("outer", thread.second.front().name);
+        ASSERT_EQ('B', thread.second.front().phase);
+        ASSERT_EQ("outer", thread.second.back().name);
+        ASSERT_EQ('E', thread.second.back().phase);
+    }
+    ASSERT_EQ(1u, main_thread_count);
+}
+
+TEST(perf_trace_ut, flush_writes_each_event_once)
+{
+    start_trace();
+
+    record_nested_spans(1);
+    perf_trace_flush();
+    record_nested_spans(2);
+    perf_trace_flush();
+    perf_trace_flush();
+
+    std::vector<trace_event_t> events;
+    ASSERT_NO_FATAL_FAILURE(read_trace(events));
+    std::map<uint64_t, std::vector<trace_event_t>> thread_events;
+    ASSERT_NO_FATAL_FAILURE(check_threads(events, thread_events));
+    ASSERT_EQ(6u * 3, events.size());
+}
+
+TEST(perf_trace_ut, wrapped_ring_exports_complete_durations)
+{
+    start_trace();
+
+    // Three times the ring size, so the oldest events and the starts of some durations are overwritten
+    std::thread thread(record_nested_spans, RING_SIZE / 2);
+    thread.join();
+    perf_trace_flush();
+
+    std::vector<trace_event_t> events;
+    ASSERT_NO_FATAL_FAILURE(read_trace(events));
+    std::map<uint64_t, std::vector<trace_event_t>> thread_events;
+    ASSERT_NO_FATAL_FAILURE(check_threads(events, thread_events));
+    ASSERT_EQ(1u, thread_events.size());
+    ASSERT_LE(events.size(), (size_t)RING_SIZE);
+    ASSERT_GT(events.size(), (size_t)RING_SIZE - 6);
+    ASSERT_EQ("outer", events.back().name);
+    ASSERT_EQ('E', events.back().phase);
+}
+
+TEST(perf_trace_ut, flush_while_recording)
+{
+    start_trace();
+
+    // The writers wrap their rings many times while the events are exported
+    std::atomic<bool> stop(false);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; i++)
+    {
+        threads.emplace_back([&stop]() {
+            while (!stop)
+            {
+                record_nested_spans(100);
+            }
+        });
+    }
+
+    for (int i = 0; i < 10; i++)
+    {
+        perf_trace_flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    stop = true;
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    perf_trace_flush();
+
+    std::vector<trace_event_t> events;
+    ASSERT_NO_FATAL_FAILURE(read_trace(events));
+    std::map<uint64_t, std::vector<trace_event_t>> thread_events;
+    ASSERT_NO_FATAL_FAILURE(check_threads(events, thread_events));
+    ASSERT_EQ(2u, thread_events.size());
+}
+
+TEST(perf_trace_ut, exited_thread_rings_are_reused)
+{
+    start_trace();
+
+    // More threads than the ring table holds, PERF_TRACE_MAX_THREADS in perf_trace.cpp. Each one exits before the
+    // next starts, so their rings are exported and reused and every thread is traced.
+    const int thread_count = 3 * 64;
+    for (int i = 0; i < thread_count; i++)
+    {
+        std::thread thread(record_nested_spans, 1);
+        thread.join();
+    }
+    perf_trace_flush();
+
+    std::vector<trace_event_t> events;
+    ASSERT_NO_FATAL_FAILURE(read_trace(events));
+    std::map<uint64_t, std::vector<trace_event_t>> thread_events;
+    ASSERT_NO_FATAL_FAILURE(check_threads(events, thread_events));
+    ASSERT_EQ(6u * thread_count, events.size());
+}
+
+int main(int argc, char **argv)
+{
+    // Tracing is configured when the first event is recorded
+    std::remove(TRACE_FILE_NAME);
+    SETENV(K4A_ENV_VAR_TRACE_FILE, TRACE_FILE_NAME);
+
+    return k4a_test_common_main(argc, argv);
+}
@@ -415,6 +415,63 @@ TEST(queue_ut, test_queue_push_w_dropped)
     ASSERT_EQ(allocator_test_for_leaks(), 0);
 }
 
+TEST(queue_ut, test_queue_get_stats)
+{
+    queue_t queue;
+    k4a_capture_t captures[3];
+    k4a_capture_t capture;
+    k4a_queue_stats_t stats;
+    k4a_latency_histogram_t wait_latency;
+
+    ASSERT_EQ(queue_create(2, "queue_test", &queue), K4A_RESULT_SUCCEEDED);
+    queue_enable(queue);
+    for (int x = 0; x < 3; x++)
+    {
+        captures[x] = capture_manufacture(10);
+        ASSERT_NE(captures[x], (k4a_capture_t)NULL);
+    }
+
+    queue_get_stats(queue, &stats, &wait_latency);
+    ASSERT_EQ(stats.depth, 0u);
+    ASSERT_EQ(stats.capacity, 2u);
+    ASSERT_EQ(stats.dropped_count, 0u);
+    ASSERT_EQ(wait_latency.count, 0u);
+
+    // The third push drops the oldest capture
+    for (int x = 0; x < 3; x++)
+    {
+        queue_push(queue, captures[x]);
+    }
+    queue_get_stats(queue, &stats, NULL);
+    ASSERT_EQ(stats.depth, 2u);
+    ASSERT_EQ(stats.dropped_count, 1u);
+
+    ThreadAPI_Sleep(10);
+    ASSERT_EQ(queue_pop(queue, 0, &capture), K4A_WAIT_RESULT_SUCCEEDED);
+    ASSERT_EQ(capture, captures[1]);
+    capture_dec_ref(capture);
+
+    queue_get_stats(queue, &stats, &wait_latency);
+    ASSERT_EQ(stats.depth, 1u);
+    ASSERT_EQ(wait_latency.count, 1u);
+    ASSERT_GE(wait_latency.max_usec, 10000u);
+    ASSERT_EQ(wait_latency.p50_usec, wait_latency.max_usec);
+
+    // Captures flushed by disabling the queue are not counted as waits or drops
+    queue_disable(queue);
+    queue_get_stats(queue, &stats, &wait_latency);
+    ASSERT_EQ(stats.depth, 0u);
+    ASSERT_EQ(stats.dropped_count, 1u);
+    ASSERT_EQ(wait_latency.count, 1u);
+
+    for (int x = 0; x < 3; x++)
+    {
+        capture_dec_ref(captures[x]);
+    }
+    queue_destroy(queue);
+    ASSERT_EQ(allocator_test_for_leaks(), 0);
+}
+
 TEST(queue_ut, queue_multiple_queues)
 {
     queue_t queue1, queue2, queue3;
@@ -0,0 +1,345 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_perf_helpers.h>
+#include <ut_pool_allocator.h>
+
+#include <gtest/gtest.h>
+
+// Module being tested
+#include <k4ainternal/allocator.h>
+#include <k4ainternal/capture.h>
+#include <k4ainternal/common.h>
+#include <k4ainternal/image.h>
+#include <k4ainternal/queue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+static int g_operations = 20000;
+
+struct queue_perf_parameters
+{
+    int thread_count; // Split evenly between producers and consumers
+    const char *frame_name;
+    size_t frame_size;
+    allocation_source_t source;
+    bool user_allocator;
+
+    friend std::ostream &operator<<(std::ostream &os, const queue_perf_parameters &obj)
+    {
+        return os << obj.thread_count << " threads " << obj.frame_name << " "
+                  << (obj.user_allocator ? "user allocator" : "default allocator");
+    }
+};
+
+static std::vector<queue_perf_parameters> get_perf_parameters()
+{
+    struct frame
+    {
+        const char *name;
+        size_t size;
+        allocation_source_t source;
+    };
+    const frame frames[] = {
+        { "IMU sample", sizeof(k4a_imu_sample_t), ALLOCATION_SOURCE_IMU },
+        { "depth NFOV unbinned", 640 * 576 * sizeof(uint16_t), ALLOCATION_SOURCE_DEPTH },
+        { "color MJPG 2160p", 3840 * 2160 / 8, ALLOCATION_SOURCE_COLOR },
+        { "color BGRA32 1080p", 1920 * 1080 * 4, ALLOCATION_SOURCE_COLOR },
+    };
+    const int thread_counts[] = { 2, 4, 8, 16, 32, 64 };
+
+    std::vector<queue_perf_parameters> parameters;
+    for (bool user_allocator : { false, true })
+    {
+        for (const frame &f : frames)
+        {
+            for (int thread_count : thread_counts)
+            {
+                parameters.push_back({ thread_count, f.name, f.size, f.source, user_allocator });
+            }
+        }
+    }
+    return parameters;
+}
+
+static k4a_capture_t capture_manufacture(const queue_perf_parameters &params)
+{
+    k4a_capture_t capture = NULL;
+    k4a_image_t image = NULL;
+    k4a_result_t result = TRACE_CALL(capture_create(&capture));
+    if (K4A_SUCCEEDED(result))
+    {
+        result = TRACE_CALL(image_create_empty_internal(params.source, params.frame_size, &image));
+    }
+    if (K4A_SUCCEEDED(result))
+    {
+        capture_set_color_image(capture, image);
+        image_dec_ref(image);
+    }
+    else if (capture != NULL)
+    {
+        capture_dec_ref(capture);
+        capture = NULL;
+    }
+    return capture;
+}
+
+struct queue_thread_result
+{
+    std::vector<int64_t> push_nsec;
+    std::vector<int64_t> pop_nsec;
+    bool failed = false;
+};
+
+struct queue_perf_context
+{
+    queue_t queue;
+    int queue_size;
+    std::atomic<int> ready_count;
+    std::atomic<int> producers_running;
+    std::atomic<int> in_flight; // Captures pushed, or about to be, and not popped yet
+};
+
+static void producer_thread(const queue_perf_parameters &params,
+                            queue_perf_context *context,
+                            queue_thread_result *result)
+{
+    result->push_nsec.reserve((size_t)g_operations);
+    ut_perf_wait_for_start(context->ready_count);
+
+    for (int i = 0; i < g_operations; i++)
+    {
+        k4a_capture_t capture = capture_manufacture(params);
+        if (capture == NULL)
+        {
+            result->failed = true;
+            break;
+        }
+
+        // Wait for room in the queue, like a producer whose consumers keep up. Pushes then contend with pops for the
+        // queue lock instead of dropping the oldest capture.
+        while (context->in_flight.fetch_add(1) >= context->queue_size)
+        {
+            context->in_flight--;
+            std::this_thread::yield();
+        }
+
+        auto start = std::chrono::high_resolution_clock::now();
+        queue_push(context->queue, capture);
+        auto stop = std::chrono::high_resolution_clock::now();
+        result->push_nsec.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+        capture_dec_ref(capture);
+    }
+
+    context->producers_running--;
+}
+
+// Consumers poll instead of blocking in queue_pop so the latency measures the queue operation, not the wait for
+// the next capture
+static void consumer_thread(queue_perf_context *context, queue_thread_result *result)
+{
+    result->pop_nsec.reserve((size_t)g_operations);
+    ut_perf_wait_for_start(context->ready_count);
+
+    for (;;)
+    {
+        bool producers_done = context->producers_running.load() == 0;
+
+        k4a_capture_t capture = NULL;
+        auto start = std::chrono::high_resolution_clock::now();
+        k4a_wait_result_t wresult = queue_pop(context->queue, 0, &capture);
+        auto stop = std::chrono::high_resolution_clock::now();
+
+        if (wresult == K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            result->pop_nsec.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+            capture_dec_ref(capture);
+            context->in_flight--;
+        }
+        else if (wresult == K4A_WAIT_RESULT_FAILED || producers_done)
+        {
+            // The queue was empty after the last push
+            result->failed = wresult == K4A_WAIT_RESULT_FAILED;
+            break;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+class queue_perf : public ::testing::Test, public ::testing::WithParamInterface<queue_perf_parameters>
+{
+protected:
+    void SetUp() override
+    {
+        if (GetParam().user_allocator)
+        {
+            ut_pool_allocator_reset();
+            // k4a_set_allocator() forwards to allocator_set_allocator()
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                      allocator_set_allocator(ut_pool_allocator_allocate, ut_pool_allocator_free));
+        }
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, queue_create(QUEUE_DEFAULT_SIZE, "queue_perf", &m_queue));
+        queue_enable(m_queue);
+    }
+
+    void TearDown() override
+    {
+        if (m_queue != NULL)
+        {
+            queue_destroy(m_queue);
+        }
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, allocator_set_allocator(NULL, NULL));
+        ut_pool_allocator_reset();
+        ASSERT_EQ(allocator_test_for_leaks(), 0);
+    }
+
+    queue_t m_queue = NULL;
+};
+
+TEST_P(queue_perf, push_pop)
+{
+    const queue_perf_parameters &params = GetParam();
+    int producer_count = std::max(1, params.thread_count / 2);
+    int consumer_count = std::max(1, params.thread_count - producer_count);
+
+    // Uncontended cost of a push and a pop on one thread, so the extra cost under contention can be estimated
+    std::vector<int64_t> baseline_nsec;
+    baseline_nsec.reserve((size_t)g_operations);
+    for (int i = 0; i < g_operations; i++)
+    {
+        k4a_capture_t capture = capture_manufacture(params);
+        ASSERT_NE(capture, (k4a_capture_t)NULL);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        queue_push(m_queue, capture);
+        k4a_capture_t popped = NULL;
+        k4a_wait_result_t wresult = queue_pop(m_queue, 0, &popped);
+        auto stop = std::chrono::high_resolution_clock::now();
+        baseline_nsec.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+
+        capture_dec_ref(capture);
+        ASSERT_EQ(wresult, K4A_WAIT_RESULT_SUCCEEDED);
+        capture_dec_ref(popped);
+    }
+
+    ut_pool_allocator_t &pool = ut_pool_allocator_get();
+    uint64_t pool_wait_start_nsec = pool.lock_wait_nsec.load();
+    uint64_t pool_operations_start = pool.operation_count.load();
+    k4a_queue_stats_t stats_start = {};
+    queue_get_stats(m_queue, &stats_start, NULL);
+
+    queue_perf_context context;
+    context.queue = m_queue;
+    context.queue_size = (int)QUEUE_DEFAULT_SIZE;
+    context.in_flight = 0;
+    context.ready_count = producer_count + consumer_count;
+    context.producers_running = producer_count;
+
+    std::vector<queue_thread_result> results((size_t)(producer_count + consumer_count));
+    std::vector<std::thread> threads;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < producer_count; i++)
+    {
+        threads.emplace_back(producer_thread, params, &context, &results[(size_t)i]);
+    }
+    for (int i = 0; i < consumer_count; i++)
+    {
+        threads.emplace_back(consumer_thread, &context, &results[(size_t)(producer_count + i)]);
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    auto stop = std::chrono::high_resolution_clock::now();
+    double seconds = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1e9;
+
+    queue_thread_result merged;
+    for (queue_thread_result &result : results)
+    {
+        ASSERT_FALSE(result.failed);
+        merged.push_nsec.insert(merged.push_nsec.end(), result.push_nsec.begin(), result.push_nsec.end());
+        merged.pop_nsec.insert(merged.pop_nsec.end(), result.pop_nsec.begin(), result.pop_nsec.end());
+    }
+
+    k4a_queue_stats_t stats = {};
+    k4a_latency_histogram_t wait_latency = {};
+    queue_get_stats(m_queue, &stats, &wait_latency);
+
+    uint64_t dropped = stats.dropped_count - stats_start.dropped_count;
+    double operation_nsec = ut_perf_get_mean(merged.push_nsec) + ut_perf_get_mean(merged.pop_nsec);
+    printf("%-20s %-7s %2dP/%2dC: %10.0f push/s %10.0f pop/s %8.0f drop/s  push p50 %6lld p99 %8lld max %9lld ns  "
+           "pop p50 %6lld p99 %8lld max %9lld ns  contention %6.0f ns/op  queued p99 %llu usec",
+           params.frame_name,
+           params.user_allocator ? "user" : "default",
+           producer_count,
+           consumer_count,
+           seconds > 0 ? (double)merged.push_nsec.size() / seconds : 0.0,
+           seconds > 0 ? (double)merged.pop_nsec.size() / seconds : 0.0,
+           seconds > 0 ? (double)dropped / seconds : 0.0,
+           (long long)ut_perf_get_percentile(merged.push_nsec, 0.50),
+           (long long)ut_perf_get_percentile(merged.push_nsec, 0.99),
+           (long long)ut_perf_get_percentile(merged.push_nsec, 1.0),
+           (long long)ut_perf_get_percentile(merged.pop_nsec, 0.50),
+           (long long)ut_perf_get_percentile(merged.pop_nsec, 0.99),
+           (long long)ut_perf_get_percentile(merged.pop_nsec, 1.0),
+           std::max(0.0, (operation_nsec - ut_perf_get_mean(baseline_nsec)) / 2),
+           (unsigned long long)wait_latency.p99_usec);
+    if (params.user_allocator)
+    {
+        uint64_t pool_operations = pool.operation_count.load() - pool_operations_start;
+        printf("  pool lock wait %6.0f ns/op",
+               pool_operations ? (double)(pool.lock_wait_nsec.load() - pool_wait_start_nsec) / pool_operations : 0.0);
+    }
+    printf("\n");
+
+    // Producers never push into a full queue, so every capture is popped
+    EXPECT_EQ(0u, dropped);
+    EXPECT_EQ(merged.push_nsec.size(), merged.pop_nsec.size());
+}
+
+INSTANTIATE_TEST_CASE_P(queue_perf, queue_perf, ValuesIn(get_perf_parameters()));
+
+int main(int argc, char **argv)
+{
+    k4a_unittest_init();
+    ::testing::InitGoogleTest(&argc, argv);
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--operations") == 0 && i + 1 < argc)
+        {
+            g_operations = (int)strtol(argv[++i], NULL, 10);
+        }
+        else
+        {
+            printf("Usage: queue_perf [gtest options] [--operations <pushes per producer>]\n");
+            return 1;
+        }
+    }
+
+    if (g_operations < 1)
+    {
+        printf("--operations must be at least 1\n");
+        return 1;
+    }
+
+    printf("%d pushes per producer into a queue of %u captures, producers wait while it is full. Contention is the "
+           "mean push and pop time above the same operations on one thread.\n",
+           g_operations,
+           (uint32_t)QUEUE_DEFAULT_SIZE);
+
+    int ret = RUN_ALL_TESTS();
+    k4a_unittest_deinit();
+    return ret;
+}
@@ -0,0 +1,154 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_perf_helpers.h>
+
+#include <gtest/gtest.h>
+
+// Module being tested
+#include <k4ainternal/tewrapper.h>
+#include <k4ainternal/virtual_device.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
+// The virtual depth engine registers its transform engine when VIRTUAL_DEPTH_ENGINE_ENV_TRANSFORM is set, which
+// scales depth to the color resolution so each output pixel is a copy of an input pixel
+#define DEPTH_ENGINE_ENV_PLUGIN_NAME "K4A_DEPTH_ENGINE_PLUGIN"
+
+#define DEPTH_WIDTH 64
+#define DEPTH_HEIGHT 64
+#define COLOR_WIDTH 128
+#define COLOR_HEIGHT 128
+
+#define CONTENTION_THREADS 4
+#define CONTENTION_FRAMES_PER_THREAD 2000
+
+using namespace testing;
+
+class tewrapper_ut : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        memset(&m_calibration, 0, sizeof(m_calibration));
+        m_calibration.depth_camera_calibration.resolution_width = DEPTH_WIDTH;
+        m_calibration.depth_camera_calibration.resolution_height = DEPTH_HEIGHT;
+        m_calibration.color_camera_calibration.resolution_width = COLOR_WIDTH;
+        m_calibration.color_camera_calibration.resolution_height = COLOR_HEIGHT;
+    }
+
+    void TearDown() override
+    {
+        SETENV(VIRTUAL_DEPTH_ENGINE_ENV_FAIL_EVERY, "");
+    }
+
+    k4a_transform_engine_calibration_t m_calibration;
+};
+
+// Transforms a depth image filled with value and returns the result. A result left over from another frame, or
+// returned before the transform engine thread wrote the output, has other values.
+static k4a_result_t transform_depth(tewrapper_t tewrapper, uint16_t value, bool *output_matches)
+{
+    std::vector<uint16_t> depth(DEPTH_WIDTH * DEPTH_HEIGHT, value);
+    std::vector<uint16_t> transformed(COLOR_WIDTH * COLOR_HEIGHT, 0);
+
+    k4a_result_t result = tewrapper_process_frame(tewrapper,
+                                                  K4A_TRANSFORM_ENGINE_TYPE_DEPTH_TO_COLOR,
+                                                  depth.data(),
+                                                  depth.size() * sizeof(uint16_t),
+                                                  NULL,
+                                                  0,
+                                                  transformed.data(),
+                                                  transformed.size() * sizeof(uint16_t),
+                                                  NULL,
+                                                  0,
+                                                  K4A_TRANSFORM_ENGINE_INTERPOLATION_NEAREST,
+                                                  0);
+
+    *output_matches = std::all_of(transformed.begin(), transformed.end(), [value](uint16_t pixel) {
+        return pixel == value;
+    });
+    return result;
+}
+
+TEST_F(tewrapper_ut, concurrent_frames_get_their_own_result)
+{
+    tewrapper_t tewrapper = tewrapper_create(&m_calibration);
+    ASSERT_NE(tewrapper, (tewrapper_t)NULL);
+
+    std::atomic<int> ready_count(CONTENTION_THREADS);
+    std::atomic<int> failed_count(0);
+    std::atomic<int> mismatched_count(0);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < CONTENTION_THREADS; t++)
+    {
+        threads.emplace_back([&, t]() {
+            ut_perf_wait_for_start(ready_count);
+            for (int i = 0; i < CONTENTION_FRAMES_PER_THREAD; i++)
+            {
+                // Unique non-zero value per frame across all threads
+                uint16_t value = (uint16_t)(1 + t + CONTENTION_THREADS * (i % (UINT16_MAX / CONTENTION_THREADS)));
+                bool output_matches = false;
+                if (K4A_FAILED(transform_depth(tewrapper, value, &output_matches)))
+                {
+                    failed_count++;
+                }
+                else if (!output_matches)
+                {
+                    mismatched_count++;
+                }
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(0, failed_count.load());
+    EXPECT_EQ(0, mismatched_count.load());
+
+    tewrapper_destroy(tewrapper);
+}
+
+TEST_F(tewrapper_ut, frames_fail_after_transform_engine_failure)
+{
+    // The virtual transform engine reads its configuration when it is created
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_FAIL_EVERY, "3");
+    tewrapper_t tewrapper = tewrapper_create(&m_calibration);
+    ASSERT_NE(tewrapper, (tewrapper_t)NULL);
+
+    bool output_matches = false;
+    EXPECT_EQ(K4A_RESULT_SUCCEEDED, transform_depth(tewrapper, 1, &output_matches));
+    EXPECT_TRUE(output_matches);
+    EXPECT_EQ(K4A_RESULT_SUCCEEDED, transform_depth(tewrapper, 2, &output_matches));
+    EXPECT_TRUE(output_matches);
+
+    // The injected failure stops the transform engine thread, so the frames after it fail instead of waiting for it
+    EXPECT_EQ(K4A_RESULT_FAILED, transform_depth(tewrapper, 3, &output_matches));
+    EXPECT_EQ(K4A_RESULT_FAILED, transform_depth(tewrapper, 4, &output_matches));
+    EXPECT_EQ(K4A_RESULT_FAILED, transform_depth(tewrapper, 5, &output_matches));
+
+    tewrapper_destroy(tewrapper);
+}
+
+int main(int argc, char **argv)
+{
+    // The depth engine plugin is loaded when the first transform engine is created
+    SETENV(DEPTH_ENGINE_ENV_PLUGIN_NAME, VIRTUAL_DEVICE_DEPTH_ENGINE_NAME);
+    SETENV(VIRTUAL_DEPTH_ENGINE_ENV_TRANSFORM, "1");
+
+    return k4a_test_common_main(argc, argv);
+}
@@ -0,0 +1,47 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef UT_PERF_HELPERS_H
+#define UT_PERF_HELPERS_H
+
+#include <algorithm>
+#include <atomic>
+#include <stddef.h>
+#include <thread>
+#include <vector>
+
+// Returns the value at percentile (0.0 - 1.0) of values, the rank is rounded down. values does not need to be sorted
+// and is reordered.
+template<typename T> T ut_perf_get_percentile(std::vector<T> &values, double percentile)
+{
+    if (values.empty())
+    {
+        return 0;
+    }
+    size_t index = (size_t)(percentile * (double)(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + (ptrdiff_t)index, values.end());
+    return values[index];
+}
+
+template<typename T> double ut_perf_get_mean(const std::vector<T> &values)
+{
+    double sum = 0;
+    for (T value : values)
+    {
+        sum += (double)value;
+    }
+    return values.empty() ? 0.0 : sum / (double)values.size();
+}
+
+// Called by each thread of a contention test before its first operation. Returns once all ready_count threads have
+// called it, so they contend from the first operation instead of the first threads running alone.
+inline void ut_perf_wait_for_start(std::atomic<int> &ready_count)
+{
+    ready_count--;
+    while (ready_count.load() > 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+#endif /* UT_PERF_HELPERS_H */
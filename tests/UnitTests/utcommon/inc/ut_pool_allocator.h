@@ -0,0 +1,94 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef UT_POOL_ALLOCATOR_H
+#define UT_POOL_ALLOCATOR_H
+
+#include <k4a/k4atypes.h>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <stdlib.h>
+#include <vector>
+
+// A user allocator for the perf tests, installed with k4a_set_allocator(). Like the allocators applications use to
+// avoid reallocating frame buffers, it keeps freed buffers in a free list per size guarded by a single mutex, and
+// it measures how long callers wait for that mutex.
+struct ut_pool_allocator_t
+{
+    std::mutex lock;
+    std::map<int, std::vector<uint8_t *>> free_buffers;
+    std::atomic<uint64_t> lock_wait_nsec{ 0 };
+    std::atomic<uint64_t> contended_count{ 0 };
+    std::atomic<uint64_t> operation_count{ 0 };
+};
+
+inline ut_pool_allocator_t &ut_pool_allocator_get()
+{
+    static ut_pool_allocator_t pool;
+    return pool;
+}
+
+// Takes the pool lock, counting the time spent waiting when another thread holds it
+inline std::unique_lock<std::mutex> ut_pool_allocator_lock(ut_pool_allocator_t &pool)
+{
+    pool.operation_count++;
+    std::unique_lock<std::mutex> guard(pool.lock, std::try_to_lock);
+    if (!guard.owns_lock())
+    {
+        auto start = std::chrono::steady_clock::now();
+        guard.lock();
+        auto stop = std::chrono::steady_clock::now();
+        pool.contended_count++;
+        pool.lock_wait_nsec += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+    }
+    return guard;
+}
+
+// Matches k4a_memory_allocate_cb_t; the size is kept in the context so the buffer returns to its free list
+inline uint8_t *ut_pool_allocator_allocate(int size, void **context)
+{
+    ut_pool_allocator_t &pool = ut_pool_allocator_get();
+    *context = (void *)(intptr_t)size;
+    {
+        std::unique_lock<std::mutex> guard = ut_pool_allocator_lock(pool);
+        std::vector<uint8_t *> &buffers = pool.free_buffers[size];
+        if (!buffers.empty())
+        {
+            uint8_t *buffer = buffers.back();
+            buffers.pop_back();
+            return buffer;
+        }
+    }
+    return (uint8_t *)malloc((size_t)size);
+}
+
+// Matches k4a_memory_destroy_cb_t
+inline void ut_pool_allocator_free(void *buffer, void *context)
+{
+    ut_pool_allocator_t &pool = ut_pool_allocator_get();
+    std::unique_lock<std::mutex> guard = ut_pool_allocator_lock(pool);
+    pool.free_buffers[(int)(intptr_t)context].push_back((uint8_t *)buffer);
+}
+
+// Releases the cached buffers and clears the counters. Call it while the allocator is not in use.
+inline void ut_pool_allocator_reset()
+{
+    ut_pool_allocator_t &pool = ut_pool_allocator_get();
+    std::lock_guard<std::mutex> guard(pool.lock);
+    for (auto &buffers : pool.free_buffers)
+    {
+        for (uint8_t *buffer : buffers.second)
+        {
+            free(buffer);
+        }
+    }
+    pool.free_buffers.clear();
+    pool.lock_wait_nsec = 0;
+    pool.contended_count = 0;
+    pool.operation_count = 0;
+}
+
+#endif
@@ -0,0 +1,577 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#include <utcommon.h>
+#include <ut_calibration_data.h>
+
+#include <gtest/gtest.h>
+
+// Module being tested
+#include <k4a/k4a.h>
+#include <k4ainternal/virtual_device.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define SETENV(env, value) _putenv_s(env, value)
+#else
+#define SETENV(env, value) setenv(env, value, 1)
+#endif
+
+#define REPLAY_FILE_NAME "virtual_device_ut.k4avirt"
+
+// Record timestamps are multiples of 100us, so they survive the round trip through the 90kHz device clock exactly
+#define FIRST_RECORD_USEC 1000000
+#define FRAME_PERIOD_USEC 33300
+#define IMU_SAMPLES_PER_FRAME 8
+#define IMU_SAMPLE_PERIOD_USEC 4100
+
+// Device timestamp the first record of a replay file is rebased to, VIRTUAL_DEVICE_START_TIMESTAMP_USEC
+#define REPLAY_START_USEC 100000
+
+#define DEPTH_WIDTH 320
+#define DEPTH_HEIGHT 288
+#define COLOR_WIDTH 1280
+#define COLOR_HEIGHT 720
+
+#define CAPTURE_TIMEOUT_MS 1000
+
+using namespace testing;
+
+// Pixel values identifying the frame an image was replayed from
+static uint16_t depth_value(int frame)
+{
+    return (uint16_t)(1000 + frame);
+}
+
+static uint16_t ir_value(int frame)
+{
+    return (uint16_t)(2000 + frame);
+}
+
+static uint8_t color_value(int frame)
+{
+    return (uint8_t)(1 + frame);
+}
+
+static uint64_t replayed_frame_usec(int frame)
+{
+    return REPLAY_START_USEC + (uint64_t)frame * FRAME_PERIOD_USEC;
+}
+
+// Returns the frame a replayed device timestamp belongs to, -1 if it is not the timestamp of any frame
+static int replayed_frame_index(uint64_t device_timestamp_usec)
+{
+    if (device_timestamp_usec < REPLAY_START_USEC || (device_timestamp_usec - REPLAY_START_USEC) % FRAME_PERIOD_USEC)
+    {
+        return -1;
+    }
+    return (int)((device_timestamp_usec - REPLAY_START_USEC) / FRAME_PERIOD_USEC);
+}
+
+static k4a_device_configuration_t get_replay_configuration()
+{
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_NV12;
+    config.color_resolution = K4A_COLOR_RESOLUTION_720P;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+    return config;
+}
+
+// Writes frame_count frames of depth, IR and color, each followed by IMU_SAMPLES_PER_FRAME IMU samples when write_imu
+// is set. The last record of the file is the last IMU record, or the last color record without IMU.
+static void write_replay_file(int frame_count, bool write_imu)
+{
+    k4a_device_configuration_t config = get_replay_configuration();
+    virtual_device_writer_t writer = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              virtual_device_writer_create(REPLAY_FILE_NAME,
+                                           &config,
+                                           "virtual_device_ut",
+                                           (const uint8_t *)g_test_json,
+                                           sizeof(g_test_json),
+                                           &writer));
+
+    std::vector<uint16_t> depth(DEPTH_WIDTH * DEPTH_HEIGHT);
+    std::vector<uint16_t> ir(DEPTH_WIDTH * DEPTH_HEIGHT);
+    std::vector<uint8_t> color(COLOR_WIDTH * COLOR_HEIGHT * 3 / 2);
+
+    for (int frame = 0; frame < frame_count; frame++)
+    {
+        uint64_t timestamp_usec = FIRST_RECORD_USEC + (uint64_t)frame * FRAME_PERIOD_USEC;
+        std::fill(depth.begin(), depth.end(), depth_value(frame));
+        std::fill(ir.begin(), ir.end(), ir_value(frame));
+        std::fill(color.begin(), color.end(), color_value(frame));
+
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  virtual_device_writer_write_depth(
+                      writer, timestamp_usec, depth.data(), ir.data(), DEPTH_WIDTH, DEPTH_HEIGHT, 30.0f));
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  virtual_device_writer_write_color(
+                      writer, timestamp_usec, COLOR_WIDTH, COLOR_HEIGHT, COLOR_WIDTH, color.data(), color.size()));
+
+        if (write_imu)
+        {
+            k4a_imu_sample_t samples[IMU_SAMPLES_PER_FRAME] = {};
+            for (int i = 0; i < IMU_SAMPLES_PER_FRAME; i++)
+            {
+                samples[i].temperature = 30.0f;
+                samples[i].acc_sample.xyz.z = 9.81f;
+                samples[i].acc_timestamp_usec = timestamp_usec + (uint64_t)i * IMU_SAMPLE_PERIOD_USEC;
+                samples[i].gyro_timestamp_usec = samples[i].acc_timestamp_usec;
+            }
+            ASSERT_EQ(K4A_RESULT_SUCCEEDED, virtual_device_writer_write_imu(writer, samples, IMU_SAMPLES_PER_FRAME));
+        }
+    }
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, virtual_device_writer_close(writer));
+}
+
+// Cuts the end off the replay file, leaving its last record incomplete
+static void truncate_replay_file(size_t bytes)
+{
+    FILE *file = fopen(REPLAY_FILE_NAME, "rb");
+    ASSERT_NE(file, nullptr);
+    std::vector<uint8_t> contents;
+    uint8_t buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0)
+    {
+        contents.insert(contents.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    ASSERT_GT(contents.size(), bytes);
+
+    file = fopen(REPLAY_FILE_NAME, "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(contents.size() - bytes, fwrite(contents.data(), 1, contents.size() - bytes, file));
+    fclose(file);
+}
+
+// Reads captures until the last frame of the file arrives, returning the milliseconds since start_time
+static double wait_for_last_frame(k4a_device_t device,
+                                  int frame_count,
+                                  std::chrono::steady_clock::time_point start_time)
+{
+    uint64_t last_frame_usec = replayed_frame_usec(frame_count - 1);
+    uint64_t timestamp_usec = 0;
+
+    while (timestamp_usec < last_frame_usec)
+    {
+        k4a_capture_t capture = NULL;
+        if (k4a_device_get_capture(device, &capture, CAPTURE_TIMEOUT_MS) != K4A_WAIT_RESULT_SUCCEEDED)
+        {
+            ADD_FAILURE() << "The last frame of the replay file was not delivered";
+            break;
+        }
+
+        k4a_image_t depth = k4a_capture_get_depth_image(capture);
+        if (depth)
+        {
+            timestamp_usec = k4a_image_get_device_timestamp_usec(depth);
+            k4a_image_release(depth);
+        }
+        k4a_capture_release(capture);
+    }
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+class virtual_device_ut : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        SETENV(VIRTUAL_DEVICE_ENV_FILES, REPLAY_FILE_NAME);
+        SETENV(VIRTUAL_DEVICE_ENV_RATE, "1");
+        SETENV(VIRTUAL_DEVICE_ENV_LOOP, "0");
+    }
+
+    void TearDown() override
+    {
+        std::remove(REPLAY_FILE_NAME);
+    }
+};
+
+TEST_F(virtual_device_ut, writer_rejects_frames_not_matching_configuration)
+{
+    k4a_device_configuration_t config = get_replay_configuration();
+    virtual_device_writer_t writer = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              virtual_device_writer_create(REPLAY_FILE_NAME, &config, "virtual_device_ut", NULL, 0, &writer));
+
+    std::vector<uint16_t> depth(2 * DEPTH_WIDTH * 2 * DEPTH_HEIGHT);
+    std::vector<uint16_t> ir(2 * DEPTH_WIDTH * 2 * DEPTH_HEIGHT);
+    std::vector<uint8_t> color(COLOR_WIDTH * COLOR_HEIGHT * 3 / 2);
+
+    // Depth mode size, and the unbinned size the virtual depth engine bins on replay
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              virtual_device_writer_write_depth(writer, 0, depth.data(), ir.data(), DEPTH_WIDTH, DEPTH_HEIGHT, 0));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              virtual_device_writer_write_depth(
+                  writer, 1, depth.data(), ir.data(), 2 * DEPTH_WIDTH, 2 * DEPTH_HEIGHT, 0));
+
+    // Sizes of other depth modes, and a missing depth image outside of passive IR
+    ASSERT_EQ(K4A_RESULT_FAILED, virtual_device_writer_write_depth(writer, 2, depth.data(), ir.data(), 512, 512, 0));
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              virtual_device_writer_write_depth(writer, 2, depth.data(), ir.data(), DEPTH_WIDTH, DEPTH_HEIGHT + 1, 0));
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              virtual_device_writer_write_depth(writer, 2, NULL, ir.data(), DEPTH_WIDTH, DEPTH_HEIGHT, 0));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              virtual_device_writer_write_color(
+                  writer, 0, COLOR_WIDTH, COLOR_HEIGHT, COLOR_WIDTH, color.data(), color.size()));
+
+    // Another resolution, a stride shorter than a row, and too little data for the stride
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              virtual_device_writer_write_color(writer, 1, 1920, 1080, 1920, color.data(), color.size()));
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              virtual_device_writer_write_color(
+                  writer, 1, COLOR_WIDTH, COLOR_HEIGHT, COLOR_WIDTH - 1, color.data(), color.size()));
+    ASSERT_EQ(K4A_RESULT_FAILED,
+              virtual_device_writer_write_color(
+                  writer, 1, COLOR_WIDTH, COLOR_HEIGHT, COLOR_WIDTH, color.data(), color.size() - 1));
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, virtual_device_writer_close(writer));
+}
+
+TEST_F(virtual_device_ut, replays_depth_color_and_imu)
+{
+    const int frame_count = 6;
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(frame_count, true));
+    ASSERT_EQ(1u, k4a_device_get_installed_count());
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+
+    k4a_device_configuration_t config = get_replay_configuration();
+    config.synchronized_images_only = true;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_imu(device));
+
+    // Every frame arrives as one synchronized capture, in order and with the timestamp it was recorded at
+    int captures = 0;
+    int last_frame = -1;
+    k4a_capture_t capture = NULL;
+    k4a_wait_result_t wresult;
+    while ((wresult = k4a_device_get_capture(device, &capture, CAPTURE_TIMEOUT_MS)) == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        k4a_image_t depth = k4a_capture_get_depth_image(capture);
+        k4a_image_t ir = k4a_capture_get_ir_image(capture);
+        k4a_image_t color = k4a_capture_get_color_image(capture);
+        ASSERT_NE(depth, nullptr);
+        ASSERT_NE(ir, nullptr);
+        ASSERT_NE(color, nullptr);
+
+        int frame = replayed_frame_index(k4a_image_get_device_timestamp_usec(depth));
+        ASSERT_GT(frame, last_frame);
+        ASSERT_LT(frame, frame_count);
+        ASSERT_EQ(k4a_image_get_device_timestamp_usec(depth), k4a_image_get_device_timestamp_usec(ir));
+        ASSERT_EQ(k4a_image_get_device_timestamp_usec(depth), k4a_image_get_device_timestamp_usec(color));
+
+        ASSERT_EQ(DEPTH_WIDTH, k4a_image_get_width_pixels(depth));
+        ASSERT_EQ(DEPTH_HEIGHT, k4a_image_get_height_pixels(depth));
+        ASSERT_EQ(depth_value(frame), *(uint16_t *)k4a_image_get_buffer(depth));
+        ASSERT_EQ(ir_value(frame), *(uint16_t *)k4a_image_get_buffer(ir));
+        ASSERT_EQ(COLOR_WIDTH, k4a_image_get_width_pixels(color));
+        ASSERT_EQ(color_value(frame), *k4a_image_get_buffer(color));
+
+        k4a_image_release(depth);
+        k4a_image_release(ir);
+        k4a_image_release(color);
+        k4a_capture_release(capture);
+        last_frame = frame;
+        captures++;
+    }
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, wresult);
+    ASSERT_EQ(frame_count, captures);
+
+    // IMU samples keep their spacing relative to the frames
+    int samples = 0;
+    k4a_imu_sample_t sample;
+    while ((wresult = k4a_device_get_imu_sample(device, &sample, CAPTURE_TIMEOUT_MS)) == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        uint64_t expected_usec = replayed_frame_usec(samples / IMU_SAMPLES_PER_FRAME) +
+                                 (uint64_t)(samples % IMU_SAMPLES_PER_FRAME) * IMU_SAMPLE_PERIOD_USEC;
+        ASSERT_EQ(expected_usec, sample.acc_timestamp_usec);
+        ASSERT_EQ(expected_usec, sample.gyro_timestamp_usec);
+        samples++;
+    }
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, wresult);
+    ASSERT_EQ(frame_count * IMU_SAMPLES_PER_FRAME, samples);
+
+    k4a_device_stop_imu(device);
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+}
+
+TEST_F(virtual_device_ut, replay_rate_paces_frames)
+{
+    const int frame_count = 10;
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(frame_count, false));
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    double elapsed_ms[2];
+    const char *rates[2] = { "1", "10" };
+    for (int i = 0; i < 2; i++)
+    {
+        SETENV(VIRTUAL_DEVICE_ENV_RATE, rates[i]);
+
+        k4a_device_t device = NULL;
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+        auto start_time = std::chrono::steady_clock::now();
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+        elapsed_ms[i] = wait_for_last_frame(device, frame_count, start_time);
+        k4a_device_stop_cameras(device);
+        k4a_device_close(device);
+    }
+
+    // Real time replay takes as long as the recording, ten times faster replay takes well under half of that
+    double recording_ms = (frame_count - 1) * FRAME_PERIOD_USEC / 1000.0;
+    std::cout << "Replay of " << recording_ms << "ms took " << elapsed_ms[0] << "ms in real time and "
+              << elapsed_ms[1] << "ms at 10x" << std::endl;
+    ASSERT_GE(elapsed_ms[0], recording_ms * 0.9);
+    ASSERT_LT(elapsed_ms[1], elapsed_ms[0] / 2);
+}
+
+TEST_F(virtual_device_ut, replay_stops_at_end_of_file)
+{
+    const int frame_count = 4;
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(frame_count, false));
+    SETENV(VIRTUAL_DEVICE_ENV_RATE, "10");
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+    wait_for_last_frame(device, frame_count, std::chrono::steady_clock::now());
+
+    // Like a camera that stopped sending frames, the stream goes quiet without an error
+    k4a_capture_t capture = NULL;
+    ASSERT_EQ(K4A_WAIT_RESULT_TIMEOUT, k4a_device_get_capture(device, &capture, 500));
+
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+}
+
+static void count_replayed_image(k4a_result_t result, k4a_image_t image_handle, void *context)
+{
+    (void)image_handle;
+    if (K4A_SUCCEEDED(result))
+    {
+        (*(std::atomic<int> *)context)++;
+    }
+}
+
+TEST_F(virtual_device_ut, stream_restarts_after_end_of_file)
+{
+    const int frame_count = 3;
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(frame_count, false));
+    SETENV(VIRTUAL_DEVICE_ENV_RATE, "0");
+
+    virtual_device_t color = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, virtual_device_create(0, VIRTUAL_DEVICE_STREAM_COLOR, &color));
+
+    // The stream ended without a stop, so a start replays the file again instead of failing as already in progress
+    std::atomic<int> images(0);
+    for (int pass = 1; pass <= 2; pass++)
+    {
+        ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+                  virtual_device_stream_start(color, ALLOCATION_SOURCE_COLOR, 0, count_replayed_image, &images));
+
+        auto start_time = std::chrono::steady_clock::now();
+        while (images.load() < pass * frame_count &&
+               std::chrono::steady_clock::now() - start_time < std::chrono::milliseconds(CAPTURE_TIMEOUT_MS))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ASSERT_EQ(pass * frame_count, images.load());
+    }
+
+    virtual_device_stream_stop(color);
+    virtual_device_destroy(color);
+}
+
+TEST_F(virtual_device_ut, replay_loops_with_increasing_timestamps)
+{
+    const int frame_count = 4;
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(frame_count, false));
+    SETENV(VIRTUAL_DEVICE_ENV_RATE, "10");
+    SETENV(VIRTUAL_DEVICE_ENV_LOOP, "1");
+
+    k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+    config.depth_mode = K4A_DEPTH_MODE_NFOV_2X2BINNED;
+    config.camera_fps = K4A_FRAMES_PER_SECOND_30;
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+
+    // Read until the third pass over the file, frames of later passes continue the device clock
+    uint64_t last_usec = 0;
+    uint64_t end_usec = replayed_frame_usec(2 * frame_count);
+    while (last_usec < end_usec)
+    {
+        k4a_capture_t capture = NULL;
+        ASSERT_EQ(K4A_WAIT_RESULT_SUCCEEDED, k4a_device_get_capture(device, &capture, CAPTURE_TIMEOUT_MS));
+        k4a_image_t depth = k4a_capture_get_depth_image(capture);
+        ASSERT_NE(depth, nullptr);
+        uint64_t timestamp_usec = k4a_image_get_device_timestamp_usec(depth);
+        ASSERT_GT(timestamp_usec, last_usec);
+        last_usec = timestamp_usec;
+        k4a_image_release(depth);
+        k4a_capture_release(capture);
+    }
+
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+}
+
+TEST_F(virtual_device_ut, open_fails_without_valid_replay_file)
+{
+    // The file is listed but does not exist
+    k4a_device_t device = NULL;
+    ASSERT_EQ(1u, k4a_device_get_installed_count());
+    ASSERT_EQ(K4A_RESULT_FAILED, k4a_device_open(0, &device));
+
+    FILE *file = fopen(REPLAY_FILE_NAME, "wb");
+    ASSERT_NE(file, nullptr);
+    const char contents[] = "not a virtual device replay file";
+    ASSERT_EQ(sizeof(contents), fwrite(contents, 1, sizeof(contents), file));
+    fclose(file);
+    ASSERT_EQ(K4A_RESULT_FAILED, k4a_device_open(0, &device));
+
+    // Only one file is listed
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(1, false));
+    ASSERT_EQ(K4A_RESULT_FAILED, k4a_device_open(1, &device));
+}
+
+TEST_F(virtual_device_ut, start_fails_for_configuration_not_recorded)
+{
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(2, false));
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+
+    k4a_device_configuration_t config = get_replay_configuration();
+    config.depth_mode = K4A_DEPTH_MODE_WFOV_2X2BINNED;
+    ASSERT_EQ(K4A_RESULT_FAILED, k4a_device_start_cameras(device, &config));
+
+    config = get_replay_configuration();
+    config.color_format = K4A_IMAGE_FORMAT_COLOR_YUY2;
+    ASSERT_EQ(K4A_RESULT_FAILED, k4a_device_start_cameras(device, &config));
+
+    config = get_replay_configuration();
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+}
+
+TEST_F(virtual_device_ut, truncated_color_record_fails_capture)
+{
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(3, false));
+    ASSERT_NO_FATAL_FAILURE(truncate_replay_file(16));
+    SETENV(VIRTUAL_DEVICE_ENV_RATE, "0");
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+    k4a_device_configuration_t config = get_replay_configuration();
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+
+    // The complete frames may still be delivered, then the read error ends the stream
+    k4a_capture_t capture = NULL;
+    k4a_wait_result_t wresult;
+    while ((wresult = k4a_device_get_capture(device, &capture, CAPTURE_TIMEOUT_MS)) == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+        k4a_capture_release(capture);
+    }
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, wresult);
+
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+}
+
+TEST_F(virtual_device_ut, truncated_imu_record_fails_imu_sample)
+{
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(3, true));
+    ASSERT_NO_FATAL_FAILURE(truncate_replay_file(16));
+    SETENV(VIRTUAL_DEVICE_ENV_RATE, "0");
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+    k4a_device_configuration_t config = get_replay_configuration();
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_cameras(device, &config));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_start_imu(device));
+
+    k4a_imu_sample_t sample;
+    k4a_wait_result_t wresult;
+    while ((wresult = k4a_device_get_imu_sample(device, &sample, CAPTURE_TIMEOUT_MS)) == K4A_WAIT_RESULT_SUCCEEDED)
+    {
+    }
+    ASSERT_EQ(K4A_WAIT_RESULT_FAILED, wresult);
+
+    k4a_device_stop_imu(device);
+    k4a_device_stop_cameras(device);
+    k4a_device_close(device);
+}
+
+TEST_F(virtual_device_ut, transformation_available_with_virtual_depth_engine)
+{
+    ASSERT_NO_FATAL_FAILURE(write_replay_file(1, false));
+
+    k4a_device_t device = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_device_open(0, &device));
+    k4a_calibration_t calibration;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              k4a_device_get_calibration(device,
+                                         K4A_DEPTH_MODE_NFOV_2X2BINNED,
+                                         K4A_COLOR_RESOLUTION_720P,
+                                         &calibration));
+    k4a_device_close(device);
+
+    // The virtual depth engine has no transform engine, so the transformation runs on the CPU
+    k4a_transformation_t transformation = k4a_transformation_create(&calibration);
+    ASSERT_NE(transformation, nullptr);
+
+    k4a_image_t depth = NULL;
+    k4a_image_t transformed = NULL;
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              k4a_image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               DEPTH_WIDTH,
+                               DEPTH_HEIGHT,
+                               DEPTH_WIDTH * (int)sizeof(uint16_t),
+                               &depth));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              k4a_image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                               COLOR_WIDTH,
+                               COLOR_HEIGHT,
+                               COLOR_WIDTH * (int)sizeof(uint16_t),
+                               &transformed));
+    uint16_t *depth_buffer = (uint16_t *)k4a_image_get_buffer(depth);
+    std::fill(depth_buffer, depth_buffer + DEPTH_WIDTH * DEPTH_HEIGHT, (uint16_t)1000);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, k4a_transformation_depth_image_to_color_camera(transformation, depth, transformed));
+
+    k4a_image_release(depth);
+    k4a_image_release(transformed);
+    k4a_transformation_destroy(transformation);
+}
+
+int main(int argc, char **argv)
+{
+    return k4a_test_common_main(argc, argv);
+}
@@ -10,6 +10,14 @@
 #include <azure_c_shared_utility/tickcounter.h>
 #include <azure_c_shared_utility/threadapi.h>
 
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 using namespace testing;
 
 class logging_ut : public ::testing::Test
@@ -109,6 +117,7 @@ TEST_F(logging_ut, callback)
         LOG_WARNING("Test Warning Message", 0);
         LOG_ERROR("Test Error Message", 0);
         LOG_CRITICAL("Test Critical Message", 0);
+        logger_flush();
 
         ASSERT_EQ(info.message_count_critical, 1);
         ASSERT_EQ(info.message_count_error, 1);
@@ -128,6 +137,7 @@ TEST_F(logging_ut, callback)
         LOG_WARNING("Test Warning Message", 0);
         LOG_ERROR("Test Error Message", 0);
         LOG_CRITICAL("Test Critical Message", 0);
+        logger_flush();
 
         ASSERT_EQ(info.message_count_critical, 1);
         ASSERT_EQ(info.message_count_error, 1);
@@ -147,6 +157,7 @@ TEST_F(logging_ut, callback)
         LOG_WARNING("Test Warning Message", 0);
         LOG_ERROR("Test Error Message", 0);
         LOG_CRITICAL("Test Critical Message", 0);
+        logger_flush();
 
         ASSERT_EQ(info.message_count_critical, 0);
         ASSERT_EQ(info.message_count_error, 0);
@@ -170,6 +181,7 @@ TEST_F(logging_ut, callback)
         LOG_WARNING("Test Warning Message", 0);
         LOG_ERROR("Test Error Message", 0);
         LOG_CRITICAL("Test Critical Message", 0);
+        logger_flush();
 
         ASSERT_EQ(info.message_count_critical, 1);
         ASSERT_EQ(info.message_count_error, 1);
@@ -259,7 +271,231 @@ TEST_F(logging_ut, callback_threading)
     tickcounter_destroy(tick);
 }
 
+// Counts the messages and the drops reported by the asynchronous logger
+typedef struct _logger_test_drop_info_t
+{
+    std::mutex lock;
+    int message_count;
+    unsigned int dropped_count;
+} logger_test_drop_info_t;
+
+// Returns true if the message reports dropped messages, and adds their number to dropped_count
+static bool logger_test_count_dropped(logger_test_drop_info_t *info, const char *message)
+{
+    unsigned int dropped = 0;
+    if (sscanf(message, "%u log messages were dropped", &dropped) == 1)
+    {
+        info->dropped_count += dropped;
+        return true;
+    }
+    return false;
+}
+
+typedef struct _logger_test_blocking_info_t
+{
+    logger_test_drop_info_t counts;
+    std::atomic<bool> block;
+    std::atomic<bool> blocked;
+} logger_test_blocking_info_t;
+
+// Blocks delivery of the first message until block is cleared
+static void logging_callback_blocking(void *context,
+                                      k4a_log_level_t level,
+                                      const char *file,
+                                      int line,
+                                      const char *message)
+{
+    (void)level;
+    (void)file;
+    (void)line;
+
+    logger_test_blocking_info_t *info = (logger_test_blocking_info_t *)context;
+    if (info->block && !info->blocked)
+    {
+        info->blocked = true;
+        while (info->block)
+        {
+            ThreadAPI_Sleep(1);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(info->counts.lock);
+    if (!logger_test_count_dropped(&info->counts, message))
+    {
+        info->counts.message_count++;
+    }
+}
+
+#ifdef LOGGING_UT_ASYNC
+TEST_F(logging_ut, async_queue_full_drops_are_reported)
+{
+    logger_test_blocking_info_t info;
+    info.counts.message_count = 0;
+    info.counts.dropped_count = 0;
+    info.block = true;
+    info.blocked = false;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              logger_register_message_callback(logging_callback_blocking, &info, K4A_LOG_LEVEL_INFO));
+
+    // Stall the logging thread in the callback, then log more messages than the queue holds
+    LOG_INFO("Blocking message", 0);
+    while (!info.blocked)
+    {
+        ThreadAPI_Sleep(1);
+    }
+
+    const int message_count = 1000;
+    for (int i = 0; i < message_count; i++)
+    {
+        LOG_INFO("Queued message %d", i);
+    }
+    info.block = false;
+    logger_flush();
+
+    {
+        std::lock_guard<std::mutex> lock(info.counts.lock);
+        ASSERT_GT(info.counts.dropped_count, 0u);
+        ASSERT_LT(info.counts.message_count, message_count);
+        ASSERT_EQ(message_count + 1, info.counts.message_count + (int)info.counts.dropped_count);
+    }
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, logger_register_message_callback(NULL, NULL, K4A_LOG_LEVEL_OFF));
+}
+#endif
+
+#define BURST_THREAD_COUNT (4)
+#define BURST_MESSAGE_COUNT (2000)
+
+// Records the sequence numbers logged by each burst thread
+typedef struct _logger_test_burst_info_t
+{
+    logger_test_drop_info_t counts;
+    std::vector<int> last_sequence;
+    bool in_order;
+} logger_test_burst_info_t;
+
+static void logging_callback_burst(void *context,
+                                   k4a_log_level_t level,
+                                   const char *file,
+                                   int line,
+                                   const char *message)
+{
+    (void)level;
+    (void)file;
+    (void)line;
+
+    logger_test_burst_info_t *info = (logger_test_burst_info_t *)context;
+    std::lock_guard<std::mutex> lock(info->counts.lock);
+    if (logger_test_count_dropped(&info->counts, message))
+    {
+        return;
+    }
+
+    // LOG_INFO prefixes the message with the function name
+    const char *burst = strstr(message, "Burst ");
+    int thread = 0, sequence = 0;
+    if (burst == nullptr || sscanf(burst, "Burst %d %d", &thread, &sequence) != 2 || thread < 0 ||
+        thread >= BURST_THREAD_COUNT)
+    {
+        info->in_order = false;
+        return;
+    }
+
+    // Messages may be dropped, but those from one thread are delivered in the order it logged them
+    if (sequence <= info->last_sequence[(size_t)thread])
+    {
+        info->in_order = false;
+    }
+    info->last_sequence[(size_t)thread] = sequence;
+    info->counts.message_count++;
+}
+
+TEST_F(logging_ut, multithreaded_burst_is_ordered_and_flushed)
+{
+    logger_test_burst_info_t info;
+    info.counts.message_count = 0;
+    info.counts.dropped_count = 0;
+    info.last_sequence.assign(BURST_THREAD_COUNT, -1);
+    info.in_order = true;
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              logger_register_message_callback(logging_callback_burst, &info, K4A_LOG_LEVEL_INFO));
+
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < BURST_THREAD_COUNT; thread++)
+    {
+        threads.emplace_back([thread]() {
+            for (int sequence = 0; sequence < BURST_MESSAGE_COUNT; sequence++)
+            {
+                LOG_INFO("Burst %d %d", thread, sequence);
+            }
+        });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    // Every message logged before the flush has been delivered or reported as dropped once it returns
+    logger_flush();
+    {
+        std::lock_guard<std::mutex> lock(info.counts.lock);
+        ASSERT_TRUE(info.in_order);
+        ASSERT_EQ(BURST_THREAD_COUNT * BURST_MESSAGE_COUNT,
+                  info.counts.message_count + (int)info.counts.dropped_count);
+        if (info.counts.dropped_count == 0)
+        {
+            for (int thread = 0; thread < BURST_THREAD_COUNT; thread++)
+            {
+                ASSERT_EQ(BURST_MESSAGE_COUNT - 1, info.last_sequence[(size_t)thread]);
+            }
+        }
+    }
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, logger_register_message_callback(NULL, NULL, K4A_LOG_LEVEL_OFF));
+}
+
+TEST_F(logging_ut, reregistered_callback_gets_later_messages_only)
+{
+    logger_test_callback_info_t first = { 0 };
+    logger_test_callback_info_t second = { 0 };
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              logger_register_message_callback(logging_callback_function, &first, K4A_LOG_LEVEL_INFO));
+    for (int i = 0; i < 100; i++)
+    {
+        LOG_INFO("First callback message %d", i);
+    }
+
+    // No flush, messages still queued for the first callback must not reach the second
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, logger_register_message_callback(NULL, NULL, K4A_LOG_LEVEL_OFF));
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED,
+              logger_register_message_callback(logging_callback_function, &second, K4A_LOG_LEVEL_INFO));
+    ASSERT_EQ(100, first.message_count_info);
+
+    for (int i = 0; i < 10; i++)
+    {
+        LOG_INFO("Second callback message %d", i);
+    }
+    logger_flush();
+
+    ASSERT_EQ(100, first.message_count_info);
+    ASSERT_EQ(10, second.message_count_info);
+
+    ASSERT_EQ(K4A_RESULT_SUCCEEDED, logger_register_message_callback(NULL, NULL, K4A_LOG_LEVEL_OFF));
+}
+
 int main(int argc, char **argv)
 {
+#ifdef LOGGING_UT_ASYNC
+    // Run the same tests with messages delivered from the asynchronous logging thread. This must be set before the
+    // logger is first used.
+#ifdef _WIN32
+    _putenv_s("K4A_LOG_ASYNC", "1");
+#else
+    setenv("K4A_LOG_ASYNC", "1", 1);
+#endif
+#endif
     return k4a_test_common_main(argc, argv);
 }
@@ -15,313 +15,439 @@
 #include <chrono>
 
 #include <algorithm>
+#include <atomic>
 #include <thread>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "cmdparser.h"
+#include "pipeline.h"
 
-#define MAX_NUMBER_OF_CAPTURES 259200
+// Number of captures between progress reports
 #define CAPTURES_IN_BATCH 256
 
-//From https://stackoverflow.com/questions/36246300/parallel-loops-in-c
-/// @param[in] nb_elements : size of your for loop
-/// @param[in] functor(start, end) :
-/// your function processing a sub chunk of the for loop.
-/// "start" is the first index to process (included) until the index "end"
-/// (excluded)
-/// @code
-///     for(int i = start; i < end; ++i)
-///         computation(i);
-/// @endcode
-/// @param use_threads : enable / disable threads.
-///
-///
-static
-void parallel_for(unsigned nb_elements,
-                  std::function<void (int start, int end)> functor,
-                  bool use_threads = true)
-{
-    // -------
-    unsigned nb_threads_hint = std::thread::hardware_concurrency();
-    unsigned nb_threads = nb_threads_hint == 0 ? 8 : (nb_threads_hint);
-
-    unsigned batch_size = nb_elements / nb_threads;
-    unsigned batch_remainder = nb_elements % nb_threads;
+// Queued items per worker between stages. Enough to absorb jitter, small enough to bound memory use.
+#define QUEUE_ITEMS_PER_WORKER 2
 
-    std::vector< std::thread > my_threads(nb_threads);
+// Output of the transform stage, one file to be written by the encode stage.
+struct encode_job_t
+{
+    std::string filename;
+    cv::Mat image;                   // Image to encode, may point into source_image
+    k4a_image_t source_image = NULL; // Released after the job is written
+    bool write_raw = false;          // Write the buffer of source_image as is
+    bool jpeg = false;
+};
+
+struct extract_options_t
+{
+    const char *output_path;
+    bool undist_project;
+    unsigned transform_threads;
+    unsigned encode_threads;
+};
 
-    if( use_threads )
-    {
-        // Multithread execution
-        for(unsigned i = 0; i < nb_threads; ++i)
-        {
-            int start = i * batch_size;
-            my_threads[i] = std::thread(functor, start, start+batch_size);
-        }
-    }
-    else
+static void release_encode_job(encode_job_t &job)
+{
+    if (job.source_image != NULL)
     {
-        // Single thread execution (for easy debugging)
-        for(unsigned i = 0; i < nb_threads; ++i){
-            int start = i * batch_size;
-            functor( start, start+batch_size );
-        }
+        k4a_image_release(job.source_image);
+        job.source_image = NULL;
     }
-
-    // Deform the elements left
-    int start = nb_threads * batch_size;
-    functor( start, start+batch_remainder);
-
-    // Wait for the other thread to finish their task
-    if( use_threads )
-        std::for_each(my_threads.begin(), my_threads.end(), std::mem_fn(&std::thread::join));
 }
 
-//extract(playback, &capture, output_path, transformation, transformed_depth_image, color_image_width_pixels, color_image_height_pixels, distortion, matrix, compression_params);
-
-bool extract(k4a_capture_t capture, const char * output_path, k4a_transformation_t transformation, k4a_image_t transformed_depth_image,
-    int color_image_width_pixels, int color_image_height_pixels, int depth_image_width_pixels, int depth_image_height_pixels, 
-    cv::Mat distortion, cv::Matx33d matrix, std::vector<int> compression_params, bool undist_project)
+// Shared state of a running extraction pipeline.
+struct extract_pipeline_t
 {
-    k4a_image_t depth_image = NULL;
-    k4a_image_t color_image = NULL;
+    extract_pipeline_t(const extract_options_t &options) :
+        options(options),
+        capture_queue(QUEUE_ITEMS_PER_WORKER * options.transform_threads),
+        encode_queue(QUEUE_ITEMS_PER_WORKER * 2 * options.encode_threads)
+    {
+    }
+
+    const extract_options_t &options;
 
-    uint64_t color_timestamp;
-    uint64_t depth_timestamp;
-    char color_filename [1024];
-    char depth_filename [1024];
+    k4a_calibration_t calibration;
+    int color_image_width_pixels;
+    int color_image_height_pixels;
+    int depth_image_width_pixels;
+    int depth_image_height_pixels;
+    cv::Mat undistort_map1;
+    cv::Mat undistort_map2;
+    std::vector<int> compression_params;
 
-    uint8_t * buffer;
-    uint32_t size;
+    bounded_queue<k4a_capture_t> capture_queue;
+    bounded_queue<encode_job_t> encode_queue;
 
-    cv::Mat img_array;
-    cv::Mat img_array_undistorted;
+    stage_stats read_stats{ "read" };
+    stage_stats transform_stats{ "transform" };
+    stage_stats encode_stats{ "encode" };
 
-    // Fetch color and depth frames
-    color_image = k4a_capture_get_color_image(capture);
-    if (color_image == 0) {
-        k4a_capture_release(capture);
-        return true;
-    }
+    // Failures of a single capture or image are reported and skipped, like the batch extractor did. Only errors that
+    // stop the whole recording from being read set failed.
+    std::atomic<uint64_t> skipped_captures{ 0 };
+    std::atomic<uint64_t> failed_writes{ 0 };
+    std::atomic<bool> failed{ false };
 
-    depth_image = k4a_capture_get_depth_image(capture);
-    if (depth_image == 0) {
-        k4a_image_release(color_image);
-        k4a_capture_release(capture);
-        return true;
+    void fail()
+    {
+        failed = true;
+        capture_queue.close();
+        encode_queue.close();
+        capture_queue.clear([](k4a_capture_t &capture) { k4a_capture_release(capture); });
+        encode_queue.clear(release_encode_job);
     }
+};
 
-    color_timestamp = k4a_image_get_device_timestamp_usec(color_image);
-    sprintf (color_filename, "%s/color/%012ld.jpg", output_path, color_timestamp);
-    depth_timestamp = k4a_image_get_device_timestamp_usec(depth_image);
-    sprintf (depth_filename, "%s/depth/%012ld.png", output_path, depth_timestamp);
+// Reader stage, runs on its own thread so file IO overlaps with the workers.
+static void read_loop(extract_pipeline_t *pipeline, k4a_playback_t playback)
+{
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    while (!pipeline->failed)
+    {
+        k4a_capture_t capture = NULL;
+        k4a_stream_result_t stream_result = K4A_STREAM_RESULT_FAILED;
+        pipeline->read_stats.measure([&] {
+            stream_result = k4a_playback_get_next_capture(playback, &capture);
+            return stream_result == K4A_STREAM_RESULT_SUCCEEDED;
+        });
+        if (stream_result == K4A_STREAM_RESULT_EOF)
+        {
+            break;
+        }
+        else if (stream_result != K4A_STREAM_RESULT_SUCCEEDED || capture == NULL)
+        {
+            printf("Failed to fetch frame\n");
+            pipeline->fail();
+            break;
+        }
 
-    if (!undist_project) {
-        FILE * pFile;
+        if (!pipeline->capture_queue.push(std::move(capture)))
+        {
+            k4a_capture_release(capture);
+            break;
+        }
 
-        buffer = k4a_image_get_buffer(color_image);
-        size = k4a_image_get_size(color_image);
+        uint64_t read_count = pipeline->read_stats.items();
+        if (read_count % CAPTURES_IN_BATCH == 0)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            double elapsed_sec = std::chrono::duration<double>(now - begin).count();
+            printf("%llu captures read, %llu extracted, %f fps.\n",
+                   (unsigned long long)read_count,
+                   (unsigned long long)pipeline->transform_stats.items(),
+                   elapsed_sec > 0 ? (double)pipeline->transform_stats.items() / elapsed_sec : 0.0);
+        }
+    }
+    pipeline->capture_queue.close();
+}
 
-        pFile = fopen (color_filename, "w");
+// Splits a capture into encode jobs, decoding, projecting and undistorting the images when requested.
+static bool transform_capture(extract_pipeline_t *pipeline,
+                              k4a_capture_t capture,
+                              k4a_transformation_t transformation,
+                              k4a_image_t transformed_depth_image)
+{
+    const extract_options_t &options = pipeline->options;
+    char filename[1024];
 
-        if (pFile!=NULL)
+    // Fetch color and depth frames, captures missing either of them are skipped.
+    k4a_image_t color_image = k4a_capture_get_color_image(capture);
+    k4a_image_t depth_image = k4a_capture_get_depth_image(capture);
+    if (color_image == NULL || depth_image == NULL)
+    {
+        if (color_image != NULL)
         {
-            fwrite(buffer, 1, size, pFile);
-            fclose (pFile);
+            k4a_image_release(color_image);
         }
+        if (depth_image != NULL)
+        {
+            k4a_image_release(depth_image);
+        }
+        return true;
+    }
 
-        buffer = k4a_image_get_buffer(depth_image);
-        size = k4a_image_get_size(depth_image);
-
-        img_array = cv::Mat(depth_image_height_pixels, depth_image_width_pixels, CV_16UC1, buffer);
-        cv::imwrite(depth_filename,  img_array);
+    encode_job_t color_job;
+    encode_job_t depth_job;
+    snprintf(filename,
+             sizeof(filename),
+             "%s/color/%012llu.jpg",
+             options.output_path,
+             (unsigned long long)k4a_image_get_device_timestamp_usec(color_image));
+    color_job.filename = filename;
+    color_job.jpeg = true;
+    snprintf(filename,
+             sizeof(filename),
+             "%s/depth/%012llu.png",
+             options.output_path,
+             (unsigned long long)k4a_image_get_device_timestamp_usec(depth_image));
+    depth_job.filename = filename;
+
+    bool result = true;
+    if (!options.undist_project)
+    {
+        // The MJPEG color image is written as is, the depth image is encoded straight from the capture buffer.
+        color_job.source_image = color_image;
+        color_job.write_raw = true;
+        depth_job.image = cv::Mat(pipeline->depth_image_height_pixels,
+                                  pipeline->depth_image_width_pixels,
+                                  CV_16UC1,
+                                  k4a_image_get_buffer(depth_image));
+        depth_job.source_image = depth_image;
     }
-    else {
+    else
+    {
         if (K4A_RESULT_SUCCEEDED !=
             k4a_transformation_depth_image_to_color_camera(transformation, depth_image, transformed_depth_image))
         {
             printf("Failed to compute transformed depth image\n");
-            return false;
+            result = false;
         }
-        try {
-        buffer = k4a_image_get_buffer(color_image);
-        size = k4a_image_get_size(color_image);
-
-        img_array = cv::imdecode(cv::Mat(1, size, CV_8UC1, buffer), cv::IMREAD_UNCHANGED);
-        cv::undistort(img_array, img_array_undistorted, matrix, distortion);
-        cv::imwrite(color_filename, img_array_undistorted, compression_params);
-
-        buffer = k4a_image_get_buffer(transformed_depth_image);
-        size = k4a_image_get_size(transformed_depth_image);
-
-        img_array = cv::Mat(color_image_height_pixels, color_image_width_pixels, CV_16UC1, buffer);
-        cv::undistort(img_array, img_array_undistorted, matrix, distortion);
-        cv::imwrite(depth_filename,  img_array_undistorted);
-        }
-        catch (...) {
-            printf("Problem catched!\n");
+        else
+        {
+            try
+            {
+                cv::Mat color = cv::imdecode(cv::Mat(1,
+                                                     (int)k4a_image_get_size(color_image),
+                                                     CV_8UC1,
+                                                     k4a_image_get_buffer(color_image)),
+                                             cv::IMREAD_UNCHANGED);
+                cv::remap(color,
+                          color_job.image,
+                          pipeline->undistort_map1,
+                          pipeline->undistort_map2,
+                          cv::INTER_LINEAR,
+                          cv::BORDER_CONSTANT);
+
+                cv::Mat depth(pipeline->color_image_height_pixels,
+                              pipeline->color_image_width_pixels,
+                              CV_16UC1,
+                              k4a_image_get_buffer(transformed_depth_image));
+                cv::remap(depth,
+                          depth_job.image,
+                          pipeline->undistort_map1,
+                          pipeline->undistort_map2,
+                          cv::INTER_LINEAR,
+                          cv::BORDER_CONSTANT);
+            }
+            catch (const cv::Exception &e)
+            {
+                printf("Failed to undistort capture: %s\n", e.what());
+                result = false;
+            }
         }
+        k4a_image_release(color_image);
+        k4a_image_release(depth_image);
     }
 
-    if (depth_image != NULL)
+    if (!result)
     {
-        k4a_image_release(depth_image);
+        release_encode_job(color_job);
+        release_encode_job(depth_job);
+        return false;
     }
-    if (color_image != NULL)
+
+    // The encode queue only refuses jobs when the pipeline is shutting down.
+    if (!pipeline->encode_queue.push(std::move(color_job)))
     {
-        k4a_image_release(color_image);
+        release_encode_job(color_job);
+        release_encode_job(depth_job);
+        return true;
     }
-    if (capture != NULL)
+    if (!pipeline->encode_queue.push(std::move(depth_job)))
     {
-        k4a_capture_release(capture);
+        release_encode_job(depth_job);
     }
-
     return true;
 }
 
-
-static int playback(char *input_path, const char * output_path, bool undist_project)
+// Transform stage worker, each worker owns its transformation handle and transformed depth buffer.
+static void transform_loop(extract_pipeline_t *pipeline)
 {
-    k4a_playback_t playback = NULL;
-
-    k4a_calibration_t calibration;
     k4a_transformation_t transformation = NULL;
-    k4a_calibration_camera_t calib_color;
-    k4a_calibration_camera_t calib_depth;
-    struct k4a_calibration_intrinsic_parameters_t::_param param;
-
-    k4a_capture_t array_of_captures[CAPTURES_IN_BATCH];
-    k4a_image_t array_of_transformed_depth_images[CAPTURES_IN_BATCH];
+    k4a_image_t transformed_depth_image = NULL;
+    if (pipeline->options.undist_project)
+    {
+        transformation = k4a_transformation_create(&pipeline->calibration);
+        if (transformation == NULL ||
+            K4A_RESULT_SUCCEEDED != k4a_image_create(K4A_IMAGE_FORMAT_DEPTH16,
+                                                     pipeline->color_image_width_pixels,
+                                                     pipeline->color_image_height_pixels,
+                                                     pipeline->color_image_width_pixels * (int)sizeof(uint16_t),
+                                                     &transformed_depth_image))
+        {
+            printf("Failed to create transformation\n");
+            pipeline->fail();
+        }
+    }
 
-    k4a_result_t result;
-    k4a_stream_result_t stream_result;
+    k4a_capture_t capture = NULL;
+    while (!pipeline->failed && pipeline->capture_queue.pop(&capture))
+    {
+        bool result = pipeline->transform_stats.measure(
+            [&] { return transform_capture(pipeline, capture, transformation, transformed_depth_image); });
+        k4a_capture_release(capture);
+        if (!result)
+        {
+            printf("Extraction failed, skipping capture\n");
+            pipeline->skipped_captures++;
+        }
+    }
 
-    int color_image_width_pixels;
-    int color_image_height_pixels;
+    if (transformed_depth_image != NULL)
+    {
+        k4a_image_release(transformed_depth_image);
+    }
+    if (transformation != NULL)
+    {
+        k4a_transformation_destroy(transformation);
+    }
+}
 
-    int depth_image_width_pixels;
-    int depth_image_height_pixels;
+static bool write_encode_job(extract_pipeline_t *pipeline, const encode_job_t &job)
+{
+    if (job.write_raw)
+    {
+        FILE *file = fopen(job.filename.c_str(), "wb");
+        if (file == NULL)
+        {
+            printf("Failed to open %s\n", job.filename.c_str());
+            return false;
+        }
+        size_t size = k4a_image_get_size(job.source_image);
+        bool written = fwrite(k4a_image_get_buffer(job.source_image), 1, size, file) == size;
+        fclose(file);
+        if (!written)
+        {
+            printf("Failed to write %s\n", job.filename.c_str());
+        }
+        return written;
+    }
 
-    cv::Mat distortion;
-    cv::Matx33d matrix;
-    cv::Mat img_array;
-    cv::Mat img_array_undistorted;
-    std::vector<int> compression_params;
+    try
+    {
+        bool written = job.jpeg ? cv::imwrite(job.filename, job.image, pipeline->compression_params) :
+                                  cv::imwrite(job.filename, job.image);
+        if (!written)
+        {
+            printf("Failed to write %s\n", job.filename.c_str());
+        }
+        return written;
+    }
+    catch (const cv::Exception &e)
+    {
+        printf("Failed to write %s: %s\n", job.filename.c_str(), e.what());
+        return false;
+    }
+}
 
-    compression_params.push_back(cv::IMWRITE_JPEG_QUALITY);
-    compression_params.push_back(96);
+// Encode stage worker, compresses and writes the images produced by the transform stage.
+static void encode_loop(extract_pipeline_t *pipeline)
+{
+    encode_job_t job;
+    while (pipeline->encode_queue.pop(&job))
+    {
+        bool result = pipeline->encode_stats.measure([&] { return write_encode_job(pipeline, job); });
+        release_encode_job(job);
+        job.image.release();
+        if (!result)
+        {
+            pipeline->failed_writes++;
+        }
+    }
+}
 
-    uint32_t i;
-    uint32_t number_of_captures = 0;
-    bool flag_to_finish = false;
-    bool array_of_extraction_results[CAPTURES_IN_BATCH];
+static int playback(char *input_path, const extract_options_t &options)
+{
+    k4a_playback_t playback = NULL;
+    std::unique_ptr<extract_pipeline_t> pipeline(new extract_pipeline_t(options));
 
     // Open recording
-    result = k4a_playback_open(input_path, &playback);
+    k4a_result_t result = k4a_playback_open(input_path, &playback);
     if (result != K4A_RESULT_SUCCEEDED || playback == NULL)
     {
         printf("Failed to open recording %s\n", input_path);
         return 1;
     }
 
-    if (K4A_RESULT_SUCCEEDED != k4a_playback_get_calibration(playback, &calibration))
+    if (K4A_RESULT_SUCCEEDED != k4a_playback_get_calibration(playback, &pipeline->calibration))
     {
         printf("Failed to get calibration\n");
+        k4a_playback_close(playback);
         return 1;
     }
 
-    transformation = k4a_transformation_create(&calibration);
-    
-    calib_color = calibration.color_camera_calibration;
-    color_image_width_pixels = calib_color.resolution_width;
-    color_image_height_pixels = calib_color.resolution_height;
-    calib_depth = calibration.depth_camera_calibration;
-    depth_image_width_pixels = calib_depth.resolution_width;
-    depth_image_height_pixels = calib_depth.resolution_height;
-    param = calib_color.intrinsics.parameters.param;
-    distortion = (cv::Mat_<double>(8,1) << param.k1, param.k2, param.p1, param.p2, param.k3, param.k4, param.k5, param.k6);
-    matrix = cv::Matx33d(param.fx, 0.0, param.cx, 0.0, param.fy, param.cy, 0.0, 0.0, 1.0);
-    
-    // Init depth frame buffer
-    for (i = 0; i < CAPTURES_IN_BATCH; i++) {
-        array_of_captures[i] = NULL;
-        if (K4A_RESULT_SUCCEEDED != k4a_image_create(K4A_IMAGE_FORMAT_DEPTH16,
-                                                     color_image_width_pixels,
-                                                     color_image_height_pixels,
-                                                     color_image_width_pixels * (int)sizeof(uint16_t),
-                                                     &array_of_transformed_depth_images[i]))
-        {
-            printf("Failed to create transformed depth image\n");
-            return 1;
-        }
-    }
-
-    for (uint32_t batch = 0; batch < MAX_NUMBER_OF_CAPTURES / CAPTURES_IN_BATCH; batch++) {
-        if (flag_to_finish == true) {
-            break;
-        }
-        printf("Batch #%d, ", batch + 1);
-
-        number_of_captures = 0;
-        for (i = 0; i < CAPTURES_IN_BATCH; i++) {
-            stream_result = k4a_playback_get_next_capture(playback, &array_of_captures[i]);
-            if (stream_result != K4A_STREAM_RESULT_SUCCEEDED || array_of_captures[i] == NULL)
-            {
-                if (stream_result == K4A_STREAM_RESULT_EOF) {
-                    flag_to_finish = true;
-                }
-                else {
-                    printf("Failed to fetch frame\n");
-                    return 1;
-                }
-                break;
-            }
-        }
-        number_of_captures = i;
-        printf("%d captures, ", number_of_captures);
-
-        //std::this_thread::sleep_for(std::chrono::seconds(10));
-        
-        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
-
-        // The core loop
-        parallel_for(number_of_captures, [&](int start, int end){ 
-            for(int i = start; i < end; ++i) {
-                array_of_extraction_results[i] = extract(array_of_captures[i], 
-                    output_path, transformation, array_of_transformed_depth_images[i], 
-                    color_image_width_pixels, color_image_height_pixels, 
-                    depth_image_width_pixels, depth_image_height_pixels, 
-                    distortion, matrix, compression_params, undist_project);
-                if (array_of_extraction_results[i] == false) {
-                    printf("Extraction failed\n");
-                    // should be proper handling
-                }
-            }
+    const k4a_calibration_camera_t &calib_color = pipeline->calibration.color_camera_calibration;
+    const k4a_calibration_camera_t &calib_depth = pipeline->calibration.depth_camera_calibration;
+    pipeline->color_image_width_pixels = calib_color.resolution_width;
+    pipeline->color_image_height_pixels = calib_color.resolution_height;
+    pipeline->depth_image_width_pixels = calib_depth.resolution_width;
+    pipeline->depth_image_height_pixels = calib_depth.resolution_height;
 
-        });
-
-        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
-        float res = static_cast< float >(number_of_captures) * 1000000.0 / static_cast< float >(std::chrono::duration_cast<std::chrono::microseconds>(end - begin).count());
-        printf("%f fps.\n", res);
-    }
+    pipeline->compression_params.push_back(cv::IMWRITE_JPEG_QUALITY);
+    pipeline->compression_params.push_back(96);
 
-    // Release
-    for (i = 0; i < CAPTURES_IN_BATCH; i++) {
-      if (array_of_transformed_depth_images[i] != NULL)
-      {
-          k4a_image_release(array_of_transformed_depth_images[i]);
-      }   
-    }
-    if (playback != NULL)
+    if (options.undist_project)
     {
-        k4a_playback_close(playback);
+        // Computing the undistortion maps once is what cv::undistort() would otherwise redo for every image.
+        const auto &param = calib_color.intrinsics.parameters.param;
+        cv::Mat distortion = (cv::Mat_<double>(8, 1) << param.k1,
+                              param.k2,
+                              param.p1,
+                              param.p2,
+                              param.k3,
+                              param.k4,
+                              param.k5,
+                              param.k6);
+        cv::Matx33d matrix(param.fx, 0.0, param.cx, 0.0, param.fy, param.cy, 0.0, 0.0, 1.0);
+        cv::initUndistortRectifyMap(matrix,
+                                    distortion,
+                                    cv::Mat(),
+                                    matrix,
+                                    cv::Size(pipeline->color_image_width_pixels, pipeline->color_image_height_pixels),
+                                    CV_16SC2,
+                                    pipeline->undistort_map1,
+                                    pipeline->undistort_map2);
     }
-    if (transformation != NULL)
+
+    printf("Extracting with 1 reader, %u transform and %u encode threads\n",
+           options.transform_threads,
+           options.encode_threads);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+    worker_pool encoders;
+    worker_pool transformers;
+    encoders.start(options.encode_threads, [&](unsigned) { encode_loop(pipeline.get()); });
+    transformers.start(options.transform_threads, [&](unsigned) { transform_loop(pipeline.get()); });
+    std::thread reader(read_loop, pipeline.get(), playback);
+
+    // Drain the stages in order: the reader closes the capture queue at the end of the recording, and once all
+    // transform workers are done no more encode jobs can be added.
+    reader.join();
+    transformers.join();
+    pipeline->encode_queue.close();
+    encoders.join();
+
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    double elapsed_sec = std::chrono::duration<double>(end - begin).count();
+    printf("Extracted %llu captures in %.2f s, %f fps.\n",
+           (unsigned long long)pipeline->transform_stats.items(),
+           elapsed_sec,
+           elapsed_sec > 0 ? (double)pipeline->transform_stats.items() / elapsed_sec : 0.0);
+    if (pipeline->skipped_captures > 0 || pipeline->failed_writes > 0)
     {
-        k4a_transformation_destroy(transformation);
+        printf("Skipped %llu captures that failed to extract, %llu images failed to write.\n",
+               (unsigned long long)pipeline->skipped_captures,
+               (unsigned long long)pipeline->failed_writes);
     }
-    return 0;
+    pipeline->read_stats.print(1, elapsed_sec);
+    pipeline->transform_stats.print(options.transform_threads, elapsed_sec);
+    pipeline->encode_stats.print(options.encode_threads, elapsed_sec);
+
+    k4a_playback_close(playback);
+    return pipeline->failed ? 1 : 0;
 }
 
 int main(int argc, char **argv)
@@ -329,6 +455,16 @@ int main(int argc, char **argv)
     int extraction_mode = 0;
     int return_code = 0;
 
+    // By default a third of the cores transform and undistort, the rest encode, and the reader gets its own thread.
+    unsigned hardware_threads = std::thread::hardware_concurrency();
+    if (hardware_threads == 0)
+    {
+        hardware_threads = 8;
+    }
+    extract_options_t options;
+    options.transform_threads = std::max(1u, hardware_threads / 3);
+    options.encode_threads = std::max(1u, hardware_threads - options.transform_threads - 1);
+
     CmdParser::OptionParser cmd_parser;
     cmd_parser.RegisterOption("-h|--help", "Prints this help", [&]() {
         printf("mrob_images_extractor [options] input.mkv output_path\n");
@@ -349,6 +485,28 @@ int main(int argc, char **argv)
                                   throw std::runtime_error(str.str());
                                   }
                               });
+    cmd_parser.RegisterOption("--transform-threads",
+                              "Number of threads decoding, projecting and undistorting captures.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                                  int threads = std::stoi(args[0]);
+                                  if (threads < 1)
+                                  {
+                                      throw std::runtime_error("Thread count must be at least 1");
+                                  }
+                                  options.transform_threads = (unsigned)threads;
+                              });
+    cmd_parser.RegisterOption("--encode-threads",
+                              "Number of threads encoding and writing PNG/JPEG files.",
+                              1,
+                              [&](const std::vector<char *> &args) {
+                                  int threads = std::stoi(args[0]);
+                                  if (threads < 1)
+                                  {
+                                      throw std::runtime_error("Thread count must be at least 1");
+                                  }
+                                  options.encode_threads = (unsigned)threads;
+                              });
 
     int args_left = 0;
     try
@@ -362,12 +520,9 @@ int main(int argc, char **argv)
     }
     if (args_left == 2)
     {
-        if (extraction_mode == 0) {
-            return_code = playback(argv[argc - 2], argv[argc -1], false);
-        }
-        else if (extraction_mode == 1) {
-            return_code = playback(argv[argc - 2], argv[argc -1], true);
-        }
+        options.output_path = argv[argc - 1];
+        options.undist_project = extraction_mode == 1;
+        return_code = playback(argv[argc - 2], options);
     }
     else
     {
@@ -0,0 +1,167 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed capacity queue connecting two pipeline stages. push() blocks while the queue is full so a fast producer can not
+// run ahead of its consumers, and pop() blocks until an item is available or the queue is closed and drained.
+template<typename T> class bounded_queue
+{
+public:
+    explicit bounded_queue(size_t capacity) : m_capacity(capacity == 0 ? 1 : capacity) {}
+
+    // Returns false if the queue was closed before the item could be added.
+    bool push(T &&item)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_not_full.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+        if (m_closed)
+        {
+            return false;
+        }
+        m_items.push_back(std::move(item));
+        m_not_empty.notify_one();
+        return true;
+    }
+
+    // Returns false once the queue is closed and empty.
+    bool pop(T *item)
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        m_not_empty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+        if (m_items.empty())
+        {
+            return false;
+        }
+        *item = std::move(m_items.front());
+        m_items.pop_front();
+        m_not_full.notify_one();
+        return true;
+    }
+
+    // Wakes up all waiting threads. Items already in the queue can still be popped.
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        m_closed = true;
+        m_not_empty.notify_all();
+        m_not_full.notify_all();
+    }
+
+    // Drops any queued items, used when the pipeline is aborted.
+    void clear(std::function<void(T &)> release)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (T &item : m_items)
+        {
+            release(item);
+        }
+        m_items.clear();
+        m_not_full.notify_all();
+    }
+
+private:
+    const size_t m_capacity;
+    std::deque<T> m_items;
+    std::mutex m_lock;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    bool m_closed = false;
+};
+
+// Per-stage counters. Busy time only includes time spent working on items, not waiting on queues.
+class stage_stats
+{
+public:
+    explicit stage_stats(const char *name) : m_name(name) {}
+
+    // Times work(), which returns false if it did not produce an item (e.g. end of stream).
+    template<typename F> bool measure(F &&work)
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool produced = work();
+        auto busy = std::chrono::steady_clock::now() - start;
+        m_busy_usec += (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(busy).count();
+        if (produced)
+        {
+            m_items++;
+        }
+        return produced;
+    }
+
+    uint64_t items() const
+    {
+        return m_items;
+    }
+
+    void print(unsigned worker_count, double elapsed_sec) const
+    {
+        uint64_t items = m_items;
+        double busy_sec = (double)m_busy_usec / 1000000.0;
+        double utilization = elapsed_sec > 0 ? busy_sec / (elapsed_sec * worker_count) * 100.0 : 0.0;
+        printf("  %-10s %2u threads %8llu items %9.2f items/s %9.2f items/s/thread %5.1f%% busy\n",
+               m_name,
+               worker_count,
+               (unsigned long long)items,
+               elapsed_sec > 0 ? (double)items / elapsed_sec : 0.0,
+               busy_sec > 0 ? (double)items / busy_sec : 0.0,
+               utilization);
+    }
+
+private:
+    const char *m_name;
+    std::atomic<uint64_t> m_items{ 0 };
+    std::atomic<uint64_t> m_busy_usec{ 0 };
+};
+
+// Set of threads created once for the whole run, each running the loop of one pipeline stage until its input queue
+// is closed and drained.
+class worker_pool
+{
+public:
+    worker_pool() = default;
+    worker_pool(const worker_pool &) = delete;
+    worker_pool &operator=(const worker_pool &) = delete;
+
+    ~worker_pool()
+    {
+        join();
+    }
+
+    void start(unsigned count, std::function<void(unsigned index)> loop)
+    {
+        for (unsigned i = 0; i < count; i++)
+        {
+            m_threads.emplace_back(loop, i);
+        }
+    }
+
+    void join()
+    {
+        for (std::thread &thread : m_threads)
+        {
+            if (thread.joinable())
+            {
+                thread.join();
+            }
+        }
+        m_threads.clear();
+    }
+
+private:
+    std::vector<std::thread> m_threads;
+};
+
+#endif /* PIPELINE_H */
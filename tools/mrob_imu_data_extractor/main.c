@@ -6,17 +6,7 @@
 #include <k4a/k4a.h>
 #include <k4arecord/playback.h>
 
-#define min(a,b) \
-   ({ __typeof__ (a) _a = (a); \
-       __typeof__ (b) _b = (b); \
-     _a < _b ? _a : _b; })
-
-#define max(a,b) \
-   ({ __typeof__ (a) _a = (a); \
-       __typeof__ (b) _b = (b); \
-     _a > _b ? _a : _b; })
-
-#define MAX_IMU_SAMPLE_NUMBER (1600 * 3600 * 2) // ( frame rate * seconds in an hour * hours)
+#define IMU_SAMPLE_BATCH_SIZE 4096 // samples decoded per k4a_playback_get_imu_samples() call
 
 int main(int argc, char **argv)
 {
@@ -36,28 +26,55 @@ int main(int argc, char **argv)
     }
 
 
-    k4a_imu_sample_t imu_sample = { 0 };
+    k4a_imu_sample_t *imu_samples = (k4a_imu_sample_t *)malloc(IMU_SAMPLE_BATCH_SIZE * sizeof(k4a_imu_sample_t));
+    if (imu_samples == NULL)
+    {
+        printf("Failed to allocate IMU sample buffer\n");
+        k4a_playback_close(playback_handle);
+        return 1;
+    }
+
     FILE *fpt;
     fpt = fopen(argv[2], "w+");
-    uint64_t last_imu_timestamp = 0;
-
-    //long long int recording_length = k4a_playback_get_last_timestamp_usec(playback_handle);
-    //printf("Recording is %lld useconds long\n", recording_length);
-    k4a_playback_seek_timestamp(playback_handle, 0, K4A_PLAYBACK_SEEK_END);
-    k4a_playback_get_previous_imu_sample(playback_handle, &imu_sample);
-    last_imu_timestamp = min(imu_sample.gyro_timestamp_usec, imu_sample.acc_timestamp_usec);
-    k4a_playback_seek_timestamp(playback_handle, 0, K4A_PLAYBACK_SEEK_BEGIN);
-    
+    if (fpt == NULL)
+    {
+        printf("Failed to open output file\n");
+        free(imu_samples);
+        k4a_playback_close(playback_handle);
+        return 1;
+    }
+
     fprintf(fpt, "ot,ox,oy,oz,at,ax,ay,az\n");
-    for (uint32_t i = 0; i < MAX_IMU_SAMPLE_NUMBER; i++) {
-        k4a_playback_get_next_imu_sample(playback_handle, &imu_sample);
-        fprintf(fpt, "%ld,%f,%f,%f,%ld,%f,%f,%f\n", \
-            imu_sample.gyro_timestamp_usec, imu_sample.gyro_sample.v[0], imu_sample.gyro_sample.v[1], imu_sample.gyro_sample.v[2], \
-            imu_sample.acc_timestamp_usec, imu_sample.acc_sample.v[0], imu_sample.acc_sample.v[1], imu_sample.acc_sample.v[2]);
-        if (max(imu_sample.gyro_timestamp_usec, imu_sample.acc_timestamp_usec) >= last_imu_timestamp) {
+    uint64_t start_timestamp = 0;
+    size_t sample_count = 0;
+    k4a_stream_result_t result;
+    while ((result = k4a_playback_get_imu_samples(playback_handle,
+                                                  start_timestamp,
+                                                  UINT64_MAX,
+                                                  imu_samples,
+                                                  IMU_SAMPLE_BATCH_SIZE,
+                                                  &sample_count)) == K4A_STREAM_RESULT_SUCCEEDED)
+    {
+        for (size_t i = 0; i < sample_count; i++)
+        {
+            k4a_imu_sample_t *imu_sample = &imu_samples[i];
+            fprintf(fpt, "%ld,%f,%f,%f,%ld,%f,%f,%f\n", \
+                imu_sample->gyro_timestamp_usec, imu_sample->gyro_sample.v[0], imu_sample->gyro_sample.v[1], imu_sample->gyro_sample.v[2], \
+                imu_sample->acc_timestamp_usec, imu_sample->acc_sample.v[0], imu_sample->acc_sample.v[1], imu_sample->acc_sample.v[2]);
+        }
+        if (sample_count < IMU_SAMPLE_BATCH_SIZE)
+        {
             break;
         }
-    }    
-    
+        start_timestamp = imu_samples[sample_count - 1].acc_timestamp_usec + 1;
+    }
+    if (result == K4A_STREAM_RESULT_FAILED)
+    {
+        printf("Failed to read IMU samples\n");
+    }
+
+    fclose(fpt);
+    free(imu_samples);
     k4a_playback_close(playback_handle);
+    return result == K4A_STREAM_RESULT_FAILED ? 1 : 0;
 }
@@ -2,6 +2,7 @@
 // Licensed under the MIT License.
 
 #include <stdio.h>
+#include <inttypes.h>
 #include <malloc.h>
 #include <k4a/k4a.h>
 #include <k4arecord/playback.h>
@@ -20,61 +21,9 @@ typedef struct
     char *filename;
     k4a_playback_t handle;
     k4a_record_configuration_t record_config;
-    k4a_capture_t capture;
+    k4a_playback_capture_info_t capture_info;
 } recording_t;
 
-static uint64_t first_capture_timestamp(k4a_capture_t capture)
-{
-    uint64_t min_timestamp = (uint64_t)-1;
-    k4a_image_t images[3];
-    images[0] = k4a_capture_get_color_image(capture);
-    images[1] = k4a_capture_get_depth_image(capture);
-    images[2] = k4a_capture_get_ir_image(capture);
-
-    for (int i = 0; i < 3; i++)
-    {
-        if (images[i] != NULL)
-        {
-            uint64_t timestamp = k4a_image_get_device_timestamp_usec(images[i]);
-            if (timestamp < min_timestamp)
-            {
-                min_timestamp = timestamp;
-            }
-            k4a_image_release(images[i]);
-            images[i] = NULL;
-        }
-    }
-
-    return min_timestamp;
-}
-
-/*static void print_capture_info(int i, recording_t *file)
-{
-    k4a_image_t images[3];
-    images[0] = k4a_capture_get_color_image(file->capture);
-    images[1] = k4a_capture_get_depth_image(file->capture);
-    images[2] = k4a_capture_get_ir_image(file->capture);
-        
-    printf("%d %-32s", i, file->filename);
-    for (int i = 0; i < 3; i++)
-    {
-        if (images[i] != NULL)
-        {
-            uint64_t timestamp = k4a_image_get_device_timestamp_usec(images[i]);
-            printf("  %7ju usec", timestamp);
-            k4a_image_release(images[i]);
-            images[i] = NULL;
-        }
-        else
-        {
-            printf("  %12s", "");
-        }
-    }
-    printf("\n");
-}*/
-
-
-
 int main(int argc, char **argv)
 {
     if (argc < 3)
@@ -109,8 +58,8 @@ int main(int argc, char **argv)
         return result == K4A_RESULT_SUCCEEDED ? 0 : 1;
     }
 
-    // Read the first capture of each recording into memory.
-    k4a_stream_result_t stream_result = k4a_playback_get_next_capture(files[i].handle, &files[i].capture);
+    // Only the capture metadata is read, so none of the image data is loaded or decoded.
+    k4a_stream_result_t stream_result = k4a_playback_get_next_capture_info(files[i].handle, &files[i].capture_info);
     if (stream_result == K4A_STREAM_RESULT_EOF)
     {
         printf("ERROR: Recording file is empty: %s\n", files[i].filename);
@@ -143,75 +92,36 @@ int main(int argc, char **argv)
         fprintf(fpt_ir, "timestamp_us\n");
 
 
-        int frame = 0;
-        while(true)
+        while (true)
         {
-            frame++;
-            uint64_t min_timestamp = (uint64_t)-1;
-            recording_t *min_file = NULL;
-
-            // Find the lowest timestamp out of each of the current captures.
-            i = 0;
-            if (files[i].capture != NULL)
-            {
-                uint64_t timestamp = first_capture_timestamp(files[i].capture);
-                if (timestamp < min_timestamp)
-                {
-                    min_timestamp = timestamp;
-                    min_file = &files[i];
-                }
-            }
-
-            k4a_image_t image = k4a_capture_get_color_image(files[i].capture);
-            if (image != NULL)
+            k4a_playback_capture_info_t *info = &files[i].capture_info;
+            if (info->color.present)
             {
-                uint64_t timestamp = k4a_image_get_device_timestamp_usec(image);
-                k4a_image_release(image);
-                image = NULL;
-                fprintf(fpt_color, "%ld\n", timestamp);
+                fprintf(fpt_color, "%" PRIu64 "\n", info->color.device_timestamp_usec);
             }
-
-            image = k4a_capture_get_depth_image(files[i].capture);
-            if (image != NULL)
+            if (info->depth.present)
             {
-                uint64_t timestamp = k4a_image_get_device_timestamp_usec(image);
-                k4a_image_release(image);
-                image = NULL;
-                fprintf(fpt_depth, "%ld\n", timestamp);
+                fprintf(fpt_depth, "%" PRIu64 "\n", info->depth.device_timestamp_usec);
             }
-            
-            image = k4a_capture_get_ir_image(files[i].capture);
-            if (image != NULL)
+            if (info->ir.present)
             {
-                uint64_t timestamp = k4a_image_get_device_timestamp_usec(image);
-                k4a_image_release(image);
-                image = NULL;
-                fprintf(fpt_ir, "%ld\n", timestamp);
+                fprintf(fpt_ir, "%" PRIu64 "\n", info->ir.device_timestamp_usec);
             }
 
-
-
-
-
-
-            //print_capture_info(frame, min_file);
-            
-
-            k4a_capture_release(min_file->capture);
-            min_file->capture = NULL;
-
-            // Advance the recording with the lowest current timestamp forward.
-            k4a_stream_result_t stream_result = k4a_playback_get_next_capture(min_file->handle, &min_file->capture);
+            stream_result = k4a_playback_get_next_capture_info(files[i].handle, info);
             if (stream_result != K4A_STREAM_RESULT_SUCCEEDED)
             {
-                if (stream_result == K4A_STREAM_RESULT_FAILED) {
-                    printf("ERROR: Failed to read next capture from file: %s\n", min_file->filename);
-                    //result = K4A_RESULT_FAILED;
-
+                if (stream_result == K4A_STREAM_RESULT_FAILED)
+                {
+                    printf("ERROR: Failed to read next capture from file: %s\n", files[i].filename);
                 }
                 break;
             }
         }
+
+        fclose(fpt_color);
+        fclose(fpt_depth);
+        fclose(fpt_ir);
     }
 
     i = 0;
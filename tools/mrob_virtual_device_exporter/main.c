@@ -0,0 +1,234 @@
+// Copyright (c) Microsoft Corporation. All rights reserved.
+// Licensed under the MIT License.
+
+// Converts a recording into a replay file for the virtual device backend (see K4A_VIRTUAL_DEVICE), so the recorded
+// session can be streamed through k4a_device_open() without hardware.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <k4a/k4a.h>
+#include <k4arecord/playback.h>
+#include <k4ainternal/virtual_device.h>
+
+#define IMU_SAMPLE_BATCH_SIZE 4096 // samples decoded per k4a_playback_get_imu_samples() call
+
+// Writes the IMU samples recorded before end_timestamp_usec, so records stay sorted by timestamp
+static int write_imu_until(k4a_playback_t playback,
+                           virtual_device_writer_t writer,
+                           k4a_imu_sample_t *imu_samples,
+                           uint64_t *imu_cursor_usec,
+                           uint64_t end_timestamp_usec)
+{
+    size_t sample_count = 0;
+    k4a_stream_result_t result = K4A_STREAM_RESULT_EOF;
+
+    while (*imu_cursor_usec < end_timestamp_usec &&
+           (result = k4a_playback_get_imu_samples(playback,
+                                                  *imu_cursor_usec,
+                                                  end_timestamp_usec,
+                                                  imu_samples,
+                                                  IMU_SAMPLE_BATCH_SIZE,
+                                                  &sample_count)) == K4A_STREAM_RESULT_SUCCEEDED)
+    {
+        if (virtual_device_writer_write_imu(writer, imu_samples, sample_count) != K4A_RESULT_SUCCEEDED)
+        {
+            return 1;
+        }
+
+        *imu_cursor_usec = imu_samples[sample_count - 1].acc_timestamp_usec + 1;
+        if (sample_count < IMU_SAMPLE_BATCH_SIZE)
+        {
+            break;
+        }
+    }
+
+    if (*imu_cursor_usec < end_timestamp_usec && result == K4A_STREAM_RESULT_FAILED)
+    {
+        printf("Failed to read IMU samples\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int write_depth(virtual_device_writer_t writer, k4a_capture_t capture)
+{
+    k4a_image_t depth = k4a_capture_get_depth_image(capture);
+    k4a_image_t ir = k4a_capture_get_ir_image(capture);
+    int failed = 0;
+
+    if (ir != NULL)
+    {
+        k4a_image_t timestamp_image = depth != NULL ? depth : ir;
+        if (virtual_device_writer_write_depth(writer,
+                                              k4a_image_get_device_timestamp_usec(timestamp_image),
+                                              depth != NULL ? (const uint16_t *)k4a_image_get_buffer(depth) : NULL,
+                                              (const uint16_t *)k4a_image_get_buffer(ir),
+                                              (uint32_t)k4a_image_get_width_pixels(ir),
+                                              (uint32_t)k4a_image_get_height_pixels(ir),
+                                              k4a_capture_get_temperature_c(capture)) != K4A_RESULT_SUCCEEDED)
+        {
+            printf("Failed to write depth frame\n");
+            failed = 1;
+        }
+    }
+
+    if (depth != NULL)
+    {
+        k4a_image_release(depth);
+    }
+    if (ir != NULL)
+    {
+        k4a_image_release(ir);
+    }
+    return failed;
+}
+
+static int write_color(virtual_device_writer_t writer, k4a_image_t color)
+{
+    if (virtual_device_writer_write_color(writer,
+                                          k4a_image_get_device_timestamp_usec(color),
+                                          (uint32_t)k4a_image_get_width_pixels(color),
+                                          (uint32_t)k4a_image_get_height_pixels(color),
+                                          (uint32_t)k4a_image_get_stride_bytes(color),
+                                          k4a_image_get_buffer(color),
+                                          k4a_image_get_size(color)) != K4A_RESULT_SUCCEEDED)
+    {
+        printf("Failed to write color frame\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        printf("Usage: mrob_virtual_device_exporter input.mkv output.k4avirt\n");
+        return 1;
+    }
+
+    k4a_playback_t playback = NULL;
+    if (k4a_playback_open(argv[1], &playback) != K4A_RESULT_SUCCEEDED)
+    {
+        printf("Failed to open recording\n");
+        return 1;
+    }
+
+    int failed = 0;
+    k4a_record_configuration_t record_config = { 0 };
+    char serial_number[MAX_SERIAL_NUMBER_LENGTH] = "virtual";
+    size_t serial_number_size = sizeof(serial_number);
+    uint8_t *calibration = NULL;
+    size_t calibration_size = 0;
+    k4a_imu_sample_t *imu_samples = NULL;
+    virtual_device_writer_t writer = NULL;
+
+    if (k4a_playback_get_record_configuration(playback, &record_config) != K4A_RESULT_SUCCEEDED)
+    {
+        printf("Failed to read recording configuration\n");
+        failed = 1;
+    }
+
+    if (!failed)
+    {
+        // Recordings without a serial number still get a valid one
+        (void)k4a_playback_get_tag(playback, "K4A_DEVICE_SERIAL_NUMBER", serial_number, &serial_number_size);
+
+        if (k4a_playback_get_raw_calibration(playback, NULL, &calibration_size) == K4A_BUFFER_RESULT_TOO_SMALL)
+        {
+            calibration = (uint8_t *)malloc(calibration_size);
+        }
+        if (calibration == NULL ||
+            k4a_playback_get_raw_calibration(playback, calibration, &calibration_size) != K4A_BUFFER_RESULT_SUCCEEDED)
+        {
+            printf("Failed to read calibration\n");
+            failed = 1;
+        }
+    }
+
+    if (!failed)
+    {
+        imu_samples = (k4a_imu_sample_t *)malloc(IMU_SAMPLE_BATCH_SIZE * sizeof(k4a_imu_sample_t));
+        if (imu_samples == NULL)
+        {
+            printf("Failed to allocate IMU sample buffer\n");
+            failed = 1;
+        }
+    }
+
+    if (!failed)
+    {
+        k4a_device_configuration_t config = K4A_DEVICE_CONFIG_INIT_DISABLE_ALL;
+        config.color_format = record_config.color_format;
+        config.color_resolution = record_config.color_track_enabled ? record_config.color_resolution :
+                                                                      K4A_COLOR_RESOLUTION_OFF;
+        config.depth_mode = record_config.depth_mode;
+        config.camera_fps = record_config.camera_fps;
+
+        if (virtual_device_writer_create(argv[2],
+                                         &config,
+                                         serial_number,
+                                         calibration,
+                                         calibration_size,
+                                         &writer) != K4A_RESULT_SUCCEEDED)
+        {
+            printf("Failed to create replay file\n");
+            failed = 1;
+        }
+    }
+
+    // Recordings without IMU samples start with the cursor past the end
+    uint64_t imu_cursor_usec = record_config.imu_track_enabled ? 0 : UINT64_MAX;
+    k4a_capture_t capture = NULL;
+    while (!failed && k4a_playback_get_next_capture(playback, &capture) == K4A_STREAM_RESULT_SUCCEEDED)
+    {
+        k4a_image_t color = k4a_capture_get_color_image(capture);
+        k4a_image_t ir = k4a_capture_get_ir_image(capture);
+        uint64_t depth_timestamp_usec = ir != NULL ? k4a_image_get_device_timestamp_usec(ir) : UINT64_MAX;
+        uint64_t color_timestamp_usec = color != NULL ? k4a_image_get_device_timestamp_usec(color) : UINT64_MAX;
+        if (ir != NULL)
+        {
+            k4a_image_release(ir);
+        }
+
+        // Depth and color of one capture are written in timestamp order, each after the IMU samples preceding it
+        bool color_first = color_timestamp_usec < depth_timestamp_usec;
+        uint64_t first_usec = color_first ? color_timestamp_usec : depth_timestamp_usec;
+        uint64_t second_usec = color_first ? depth_timestamp_usec : color_timestamp_usec;
+
+        failed = write_imu_until(playback, writer, imu_samples, &imu_cursor_usec, first_usec);
+        if (!failed && first_usec != UINT64_MAX)
+        {
+            failed = color_first ? write_color(writer, color) : write_depth(writer, capture);
+        }
+        if (!failed && second_usec != UINT64_MAX)
+        {
+            failed = write_imu_until(playback, writer, imu_samples, &imu_cursor_usec, second_usec);
+        }
+        if (!failed && second_usec != UINT64_MAX)
+        {
+            failed = color_first ? write_depth(writer, capture) : write_color(writer, color);
+        }
+
+        if (color != NULL)
+        {
+            k4a_image_release(color);
+        }
+        k4a_capture_release(capture);
+    }
+
+    if (!failed)
+    {
+        failed = write_imu_until(playback, writer, imu_samples, &imu_cursor_usec, UINT64_MAX);
+    }
+
+    if (writer != NULL && virtual_device_writer_close(writer) != K4A_RESULT_SUCCEEDED)
+    {
+        failed = 1;
+    }
+
+    free(imu_samples);
+    free(calibration);
+    k4a_playback_close(playback);
+    return failed;
+}